@@ -0,0 +1,173 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+// Throughput of b2nd_copy_buffer() when gathering all the blocks of a chunk and scattering
+// them back, compared with a memcpy per innermost row.
+
+# include <b2nd.h>
+# include <inttypes.h>
+
+#define NREPS 20
+
+typedef struct {
+  int8_t ndim;
+  uint8_t itemsize;
+  int64_t chunkshape[B2ND_MAX_DIM];
+  int64_t blockshape[B2ND_MAX_DIM];
+} copy_case;
+
+static const copy_case cases[] = {
+    {3, 4, {100, 100, 100}, {10, 10, 1}},
+    {3, 4, {32, 32, 32}, {4, 4, 4}},
+    {3, 4, {64, 64, 64}, {8, 8, 8}},
+    {3, 4, {64, 64, 64}, {16, 16, 16}},
+    {3, 8, {50, 150, 100}, {13, 21, 30}},
+    {3, 8, {64, 64, 64}, {4, 64, 64}},
+    {2, 8, {1000, 1000}, {100, 2}},
+};
+
+
+/* The plain copy, with a memcpy per innermost row */
+static void copy_rows_memcpy(int8_t ndim, uint8_t itemsize,
+                             const uint8_t *src, const int64_t *src_pad_shape, const int64_t *src_start,
+                             const int64_t *src_stop,
+                             uint8_t *dst, const int64_t *dst_pad_shape, const int64_t *dst_start) {
+  int64_t copy_shape[B2ND_MAX_DIM] = {0};
+  int64_t src_strides[B2ND_MAX_DIM] = {0};
+  int64_t dst_strides[B2ND_MAX_DIM] = {0};
+  int64_t src_offset = 0;
+  int64_t dst_offset = 0;
+  for (int i = ndim - 1; i >= 0; --i) {
+    copy_shape[i] = src_stop[i] - src_start[i];
+    src_strides[i] = i == ndim - 1 ? 1 : src_strides[i + 1] * src_pad_shape[i + 1];
+    dst_strides[i] = i == ndim - 1 ? 1 : dst_strides[i + 1] * dst_pad_shape[i + 1];
+    src_offset += src_start[i] * src_strides[i];
+    dst_offset += dst_start[i] * dst_strides[i];
+  }
+  int64_t row_nbytes = copy_shape[ndim - 1] * itemsize;
+  int64_t index[B2ND_MAX_DIM] = {0};
+  while (true) {
+    memcpy(&dst[dst_offset * itemsize], &src[src_offset * itemsize], row_nbytes);
+    int i = ndim - 2;
+    for (; i >= 0; --i) {
+      src_offset += src_strides[i];
+      dst_offset += dst_strides[i];
+      if (++index[i] < copy_shape[i]) {
+        break;
+      }
+      src_offset -= copy_shape[i] * src_strides[i];
+      dst_offset -= copy_shape[i] * dst_strides[i];
+      index[i] = 0;
+    }
+    if (i < 0) {
+      break;
+    }
+  }
+}
+
+
+/* Gather all the blocks of the chunk into `blocks` and scatter them back into the chunk */
+static void copy_blocks(const copy_case *c, uint8_t *chunk, uint8_t *blocks, bool plain) {
+  int64_t blocks_in_chunk[B2ND_MAX_DIM];
+  int64_t nblocks = 1;
+  int64_t block_nbytes = c->itemsize;
+  for (int i = 0; i < c->ndim; ++i) {
+    blocks_in_chunk[i] = c->chunkshape[i] / c->blockshape[i];
+    nblocks *= blocks_in_chunk[i];
+    block_nbytes *= c->blockshape[i];
+  }
+  int64_t block_start[B2ND_MAX_DIM] = {0};
+  int64_t block_zeros[B2ND_MAX_DIM] = {0};
+  for (int direction = 0; direction < 2; ++direction) {
+    for (int64_t nblock = 0; nblock < nblocks; ++nblock) {
+      int64_t block_stop[B2ND_MAX_DIM];
+      blosc2_unidim_to_multidim(c->ndim, blocks_in_chunk, nblock, block_start);
+      for (int i = 0; i < c->ndim; ++i) {
+        block_start[i] *= c->blockshape[i];
+        block_stop[i] = block_start[i] + c->blockshape[i];
+      }
+      uint8_t *block = &blocks[nblock * block_nbytes];
+      if (direction == 0 && plain) {
+        copy_rows_memcpy(c->ndim, c->itemsize, chunk, c->chunkshape, block_start, block_stop,
+                         block, c->blockshape, block_zeros);
+      } else if (direction == 0) {
+        b2nd_copy_buffer(c->ndim, c->itemsize, chunk, c->chunkshape, block_start, block_stop,
+                         block, c->blockshape, block_zeros);
+      } else if (plain) {
+        copy_rows_memcpy(c->ndim, c->itemsize, block, c->blockshape, block_zeros, c->blockshape,
+                         chunk, c->chunkshape, block_start);
+      } else {
+        b2nd_copy_buffer(c->ndim, c->itemsize, block, c->blockshape, block_zeros, c->blockshape,
+                         chunk, c->chunkshape, block_start);
+      }
+    }
+  }
+}
+
+
+int main() {
+  blosc_timestamp_t t0, t1;
+
+  blosc2_init();
+
+  printf("%-16s %-14s %4s %12s %12s\n", "chunkshape", "blockshape", "row", "memcpy GB/s", "copy GB/s");
+  for (size_t ncase = 0; ncase < sizeof(cases) / sizeof(cases[0]); ++ncase) {
+    const copy_case *c = &cases[ncase];
+    int64_t nbytes = c->itemsize;
+    for (int i = 0; i < c->ndim; ++i) {
+      nbytes *= c->chunkshape[i];
+    }
+    uint8_t *chunk = malloc(nbytes);
+    uint8_t *blocks = malloc(nbytes);
+    uint8_t *check = malloc(nbytes);
+    for (int64_t i = 0; i < nbytes; ++i) {
+      chunk[i] = (uint8_t) i;
+    }
+
+    double secs[2];
+    for (int plain = 1; plain >= 0; --plain) {
+      copy_blocks(c, chunk, blocks, plain);
+      blosc_set_timestamp(&t0);
+      for (int rep = 0; rep < NREPS; ++rep) {
+        copy_blocks(c, chunk, blocks, plain);
+      }
+      blosc_set_timestamp(&t1);
+      secs[plain] = blosc_elapsed_secs(t0, t1);
+      if (plain) {
+        memcpy(check, blocks, nbytes);
+      } else if (memcmp(check, blocks, nbytes) != 0) {
+        printf("Blocks differ!\n");
+        return -1;
+      }
+    }
+
+    char chunkshape[32];
+    char blockshape[32];
+    int pos = 0;
+    int pos2 = 0;
+    for (int i = 0; i < c->ndim; ++i) {
+      pos += snprintf(&chunkshape[pos], sizeof(chunkshape) - pos, i ? "x%" PRId64 : "%" PRId64,
+                      c->chunkshape[i]);
+      pos2 += snprintf(&blockshape[pos2], sizeof(blockshape) - pos2, i ? "x%" PRId64 : "%" PRId64,
+                       c->blockshape[i]);
+    }
+    double gbytes = 2. * NREPS * (double) nbytes / 1e9;
+    printf("%-16s %-14s %4" PRId64 " %12.2f %12.2f\n", chunkshape, blockshape,
+           c->blockshape[c->ndim - 1] * c->itemsize, gbytes / secs[1], gbytes / secs[0]);
+
+    free(chunk);
+    free(blocks);
+    free(check);
+  }
+
+  blosc2_destroy();
+
+  return 0;
+}
@@ -75,6 +75,41 @@ int main() {
   blosc_set_timestamp(&t1);
   printf("get_slice: %.4f s\n", blosc_elapsed_secs(t0, t1));
 
+  // Scaling of a slice spanning many small chunks (they are decompressed in parallel)
+  int64_t slice_start[] = {0, 0, 150};
+  int64_t slice_stop[] = {shape[0], shape[1], 151};
+  int64_t slice_shape[B2ND_MAX_DIM];
+  int64_t buffersize = itemsize;
+  for (int j = 0; j < ndim; ++j) {
+    slice_shape[j] = slice_stop[j] - slice_start[j];
+    buffersize *= slice_shape[j];
+  }
+  DATA_TYPE *buffer = malloc(buffersize);
+  int64_t nchunks = 1;
+  for (int j = 0; j < ndim; ++j) {
+    nchunks *= (slice_stop[j] - 1) / chunkshape[j] - slice_start[j] / chunkshape[j] + 1;
+  }
+  printf("slice of %.1f MB across %d chunks:\n", (double) buffersize / (1024 * 1024), (int) nchunks);
+  double t1thread = 0;
+  for (int nthreads = 1; nthreads <= 8; nthreads *= 2) {
+    blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+    dparams.nthreads = (int16_t) nthreads;
+    dparams.schunk = arr->sc;
+    blosc2_free_ctx(arr->sc->dctx);
+    arr->sc->dctx = blosc2_create_dctx(dparams);
+    blosc_set_timestamp(&t0);
+    for (int slice = 0; slice < nslices; ++slice) {
+      BLOSC_ERROR(b2nd_get_slice_cbuffer(arr, slice_start, slice_stop, buffer, slice_shape, buffersize));
+    }
+    blosc_set_timestamp(&t1);
+    double t = blosc_elapsed_secs(t0, t1);
+    if (nthreads == 1) {
+      t1thread = t;
+    }
+    printf("  %d threads: %.4f s (speedup %.2fx)\n", nthreads, t, t1thread / t);
+  }
+  free(buffer);
+
   free(src);
 
   BLOSC_ERROR(b2nd_free(arr));
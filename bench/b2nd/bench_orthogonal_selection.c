@@ -0,0 +1,112 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#define DATA_TYPE int64_t
+
+# include <b2nd.h>
+
+/* Gather a random orthogonal selection of every array with different numbers of threads */
+static int bench_gather(int8_t ndim, const int64_t *shape, const int32_t *chunkshape,
+                        const int32_t *blockshape, int64_t *selection_size) {
+  blosc_timestamp_t t0, t1;
+  int nselections = 10;
+  uint8_t itemsize = sizeof(DATA_TYPE);
+
+  int64_t nbytes = itemsize;
+  for (int i = 0; i < ndim; ++i) {
+    nbytes *= shape[i];
+  }
+  DATA_TYPE *src = malloc(nbytes);
+  for (int i = 0; i < nbytes / itemsize; ++i) {
+    src[i] = i;
+  }
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.nthreads = 4;
+  cparams.typesize = itemsize;
+  blosc2_storage b2_storage = {.cparams=&cparams};
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, ndim, shape, chunkshape, blockshape, NULL, 0,
+                                        NULL, 0);
+  b2nd_array_t *arr;
+  BLOSC_ERROR(b2nd_from_cbuffer(ctx, &arr, src, nbytes));
+
+  int64_t *selection[B2ND_MAX_DIM];
+  int64_t buffersize = itemsize;
+  int64_t nchunks = 1;
+  for (int i = 0; i < ndim; ++i) {
+    selection[i] = malloc(selection_size[i] * sizeof(int64_t));
+    for (int64_t j = 0; j < selection_size[i]; ++j) {
+      selection[i][j] = rand() % shape[i];
+    }
+    buffersize *= selection_size[i];
+    int64_t nchunks_dim = (shape[i] + chunkshape[i] - 1) / chunkshape[i];
+    nchunks *= selection_size[i] < nchunks_dim ? selection_size[i] : nchunks_dim;
+  }
+  DATA_TYPE *buffer = malloc(buffersize);
+
+  printf("%dD gather of %d items across up to %d chunks:\n", ndim, (int) (buffersize / itemsize),
+         (int) nchunks);
+  double t1thread = 0;
+  for (int nthreads = 1; nthreads <= 8; nthreads *= 2) {
+    blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+    dparams.nthreads = (int16_t) nthreads;
+    dparams.schunk = arr->sc;
+    blosc2_free_ctx(arr->sc->dctx);
+    arr->sc->dctx = blosc2_create_dctx(dparams);
+    blosc_set_timestamp(&t0);
+    for (int nselection = 0; nselection < nselections; ++nselection) {
+      BLOSC_ERROR(b2nd_get_orthogonal_selection(arr, selection, selection_size, buffer,
+                                                selection_size, buffersize));
+    }
+    blosc_set_timestamp(&t1);
+    double t = blosc_elapsed_secs(t0, t1);
+    if (nthreads == 1) {
+      t1thread = t;
+    }
+    printf("  %d threads: %.4f s (speedup %.2fx)\n", nthreads, t, t1thread / t);
+  }
+
+  free(buffer);
+  for (int i = 0; i < ndim; ++i) {
+    free(selection[i]);
+  }
+  free(src);
+  BLOSC_ERROR(b2nd_free(arr));
+  BLOSC_ERROR(b2nd_free_ctx(ctx));
+
+  return 0;
+}
+
+
+int main() {
+  blosc2_init();
+
+  int64_t shape1[] = {20 * 1000 * 1000};
+  int32_t chunkshape1[] = {10 * 1000};
+  int32_t blockshape1[] = {1000};
+  int64_t selection_size1[] = {100 * 1000};
+  BLOSC_ERROR(bench_gather(1, shape1, chunkshape1, blockshape1, selection_size1));
+
+  int64_t shape2[] = {5000, 4000};
+  int32_t chunkshape2[] = {100, 100};
+  int32_t blockshape2[] = {20, 20};
+  int64_t selection_size2[] = {500, 400};
+  BLOSC_ERROR(bench_gather(2, shape2, chunkshape2, blockshape2, selection_size2));
+
+  int64_t shape3[] = {300, 300, 200};
+  int32_t chunkshape3[] = {20, 20, 20};
+  int32_t blockshape3[] = {5, 10, 10};
+  int64_t selection_size3[] = {60, 60, 40};
+  BLOSC_ERROR(bench_gather(3, shape3, chunkshape3, blockshape3, selection_size3));
+
+  blosc2_destroy();
+
+  return 0;
+}
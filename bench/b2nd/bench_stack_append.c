@@ -11,7 +11,8 @@
 // Benchmark for appending data to a b2nd array.  A new accelerated path has been
 // added to b2nd_append() that allows for faster appending of data to a b2nd array
 // when data to append is of the same size as the chunkshape.  This benchmark
-// compares the performance of the new accelerated path with the old one.
+// compares the performance of the new accelerated path with the old one, and then the
+// concatenation of the stack with itself through appends and through b2nd_concatenate().
 
 #include <inttypes.h>
 #include "blosc2.h"
@@ -91,6 +92,40 @@ int main() {
     printf("Shape of array: (%" PRId64 ", %" PRId64 ", %" PRId64 ")\n",
            src->shape[0], src->shape[1], src->shape[2]);
 
+    if (accel) {
+      // Concatenate the stack with itself, by appending its images and then with its chunks as they are
+      b2nd_array_t *srcs[] = {src, src};
+      b2nd_array_t *array;
+      blosc_set_timestamp(&t0);
+      if (b2nd_empty(ctx, &array) < 0) {
+        printf("Error in b2nd_empty\n");
+        return -1;
+      }
+      for (int i = 0; i < 2 * N_images / nimages_inbuf; i++) {
+        int64_t start[] = {i % (N_images / nimages_inbuf) * nimages_inbuf, 0, 0};
+        int64_t stop[] = {start[0] + nimages_inbuf, height, width};
+        if (b2nd_get_slice_cbuffer(src, start, stop, image, buffershape, buffersize) < 0 ||
+            b2nd_append(array, image, buffersize, 0) < 0) {
+          printf("Error in b2nd_append\n");
+          return -1;
+        }
+      }
+      blosc_set_timestamp(&t1);
+      printf("Time to concatenate (append): %.4f s\n", blosc_elapsed_secs(t0, t1));
+      b2nd_free(array);
+
+      blosc_set_timestamp(&t0);
+      if (b2nd_concatenate(ctx, srcs, 2, 0, &array) < 0) {
+        printf("Error in b2nd_concatenate\n");
+        return -1;
+      }
+      blosc_set_timestamp(&t1);
+      printf("Time to concatenate (b2nd_concatenate): %.4f s\n", blosc_elapsed_secs(t0, t1));
+      printf("Shape of array: (%" PRId64 ", %" PRId64 ", %" PRId64 ")\n",
+             array->shape[0], array->shape[1], array->shape[2]);
+      b2nd_free(array);
+    }
+
     b2nd_free(src);
     b2nd_free_ctx(ctx);
   }
@@ -0,0 +1,101 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+// Benchmark for writing and reading b2nd arrays from/to Fortran-order buffers, either through
+// a C-order copy of them or straight with the strided variants.
+
+#define DATA_TYPE double
+
+# include <b2nd.h>
+
+
+int main() {
+  blosc2_init();
+  blosc_timestamp_t t0, t1;
+
+  int8_t ndim = 3;
+  int64_t shape[] = {200, 300, 400};
+  int32_t chunkshape[] = {50, 60, 80};
+  int32_t blockshape[] = {10, 20, 40};
+  int64_t itemsize = sizeof(DATA_TYPE);
+
+  int64_t nitems = shape[0] * shape[1] * shape[2];
+  int64_t nbytes = nitems * itemsize;
+  DATA_TYPE *fortran = malloc(nbytes);
+  DATA_TYPE *copy = malloc(nbytes);
+  int64_t fstrides[] = {itemsize, itemsize * shape[0], itemsize * shape[0] * shape[1]};
+  for (int64_t i = 0; i < nitems; ++i) {
+    fortran[i] = (DATA_TYPE) i;
+  }
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.nthreads = 4;
+  cparams.typesize = (int32_t) itemsize;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = 4;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, ndim, shape, chunkshape, blockshape, NULL, 0,
+                                        NULL, 0);
+  printf("Fortran-order buffer of %d x %d x %d items (%.1f MB):\n", (int) shape[0], (int) shape[1],
+         (int) shape[2], (double) nbytes / (1024 * 1024));
+
+  b2nd_array_t *array;
+  blosc_set_timestamp(&t0);
+  for (int64_t i = 0; i < shape[0]; ++i) {
+    for (int64_t j = 0; j < shape[1]; ++j) {
+      for (int64_t k = 0; k < shape[2]; ++k) {
+        copy[(i * shape[1] + j) * shape[2] + k] = fortran[(k * shape[1] + j) * shape[0] + i];
+      }
+    }
+  }
+  BLOSC_ERROR(b2nd_from_cbuffer(ctx, &array, copy, nbytes));
+  blosc_set_timestamp(&t1);
+  printf("  write through a C copy: %.4f s\n", blosc_elapsed_secs(t0, t1));
+  BLOSC_ERROR(b2nd_free(array));
+
+  blosc_set_timestamp(&t0);
+  BLOSC_ERROR(b2nd_from_cbuffer_strided(ctx, &array, fortran, fstrides, nbytes));
+  blosc_set_timestamp(&t1);
+  printf("  write strided: %.4f s\n", blosc_elapsed_secs(t0, t1));
+
+  blosc_set_timestamp(&t0);
+  BLOSC_ERROR(b2nd_to_cbuffer(array, copy, nbytes));
+  for (int64_t i = 0; i < shape[0]; ++i) {
+    for (int64_t j = 0; j < shape[1]; ++j) {
+      for (int64_t k = 0; k < shape[2]; ++k) {
+        fortran[(k * shape[1] + j) * shape[0] + i] = copy[(i * shape[1] + j) * shape[2] + k];
+      }
+    }
+  }
+  blosc_set_timestamp(&t1);
+  printf("  read through a C copy: %.4f s\n", blosc_elapsed_secs(t0, t1));
+
+  memset(fortran, 0, nbytes);
+  blosc_set_timestamp(&t0);
+  BLOSC_ERROR(b2nd_to_cbuffer_strided(array, fortran, fstrides, nbytes));
+  blosc_set_timestamp(&t1);
+  printf("  read strided: %.4f s\n", blosc_elapsed_secs(t0, t1));
+
+  for (int64_t i = 0; i < nitems; ++i) {
+    if (fortran[i] != (DATA_TYPE) i) {
+      printf("Wrong item %d\n", (int) i);
+      return -1;
+    }
+  }
+
+  BLOSC_ERROR(b2nd_free(array));
+  BLOSC_ERROR(b2nd_free_ctx(ctx));
+  free(copy);
+  free(fortran);
+
+  blosc2_destroy();
+
+  return 0;
+}
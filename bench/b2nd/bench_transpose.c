@@ -0,0 +1,115 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#define DATA_TYPE int64_t
+
+# include <b2nd.h>
+
+/* Transpose a 2D array slice by slice, through a C buffer (`ctx` has the transposed shape) */
+static int transpose_slices(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array) {
+  BLOSC_ERROR(b2nd_empty(ctx, array));
+  int64_t rows = src->chunkshape[0];
+  int64_t nitems = rows * src->shape[1];
+  DATA_TYPE *slice = malloc(nitems * sizeof(DATA_TYPE));
+  DATA_TYPE *transposed = malloc(nitems * sizeof(DATA_TYPE));
+  for (int64_t row = 0; row < src->shape[0]; row += rows) {
+    int64_t nrows = row + rows < src->shape[0] ? rows : src->shape[0] - row;
+    int64_t start[] = {row, 0};
+    int64_t stop[] = {row + nrows, src->shape[1]};
+    int64_t shape[] = {nrows, src->shape[1]};
+    BLOSC_ERROR(b2nd_get_slice_cbuffer(src, start, stop, slice, shape, nitems * sizeof(DATA_TYPE)));
+    for (int64_t i = 0; i < nrows; ++i) {
+      for (int64_t j = 0; j < src->shape[1]; ++j) {
+        transposed[j * nrows + i] = slice[i * src->shape[1] + j];
+      }
+    }
+    int64_t dest_start[] = {0, row};
+    int64_t dest_stop[] = {src->shape[1], row + nrows};
+    int64_t dest_shape[] = {src->shape[1], nrows};
+    BLOSC_ERROR(b2nd_set_slice_cbuffer(transposed, dest_shape, nitems * sizeof(DATA_TYPE), dest_start,
+                                       dest_stop, *array));
+  }
+  free(transposed);
+  free(slice);
+  return 0;
+}
+
+
+int main() {
+  blosc2_init();
+  blosc_timestamp_t t0, t1;
+
+  int8_t ndim = 2;
+  int64_t shape[] = {8000, 6000};
+  int64_t shape_t[] = {6000, 8000};
+  int32_t chunkshape[] = {500, 400};
+  int32_t blockshape[] = {50, 80};
+  int32_t chunkshape_t[] = {400, 500};
+  int32_t blockshape_t[] = {80, 50};
+  uint8_t itemsize = sizeof(DATA_TYPE);
+
+  int64_t nitems = shape[0] * shape[1];
+  DATA_TYPE *src_buffer = malloc(nitems * itemsize);
+  for (int64_t i = 0; i < nitems; ++i) {
+    src_buffer[i] = i;
+  }
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.nthreads = 4;
+  cparams.typesize = itemsize;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = 4;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, ndim, shape, chunkshape, blockshape, NULL, 0,
+                                        NULL, 0);
+  b2nd_context_t *ctx_t = b2nd_create_ctx(&b2_storage, ndim, shape_t, chunkshape_t, blockshape_t, NULL, 0,
+                                          NULL, 0);
+  b2nd_array_t *src;
+  BLOSC_ERROR(b2nd_from_cbuffer(ctx, &src, src_buffer, nitems * itemsize));
+  printf("Transposing a %d x %d array (%.1f MB):\n", (int) shape[0], (int) shape[1],
+         (double) nitems * itemsize / (1024 * 1024));
+
+  b2nd_array_t *array;
+  blosc_set_timestamp(&t0);
+  BLOSC_ERROR(transpose_slices(ctx_t, src, &array));
+  blosc_set_timestamp(&t1);
+  printf("  slice by slice: %.4f s\n", blosc_elapsed_secs(t0, t1));
+  BLOSC_ERROR(b2nd_free(array));
+
+  blosc_set_timestamp(&t0);
+  BLOSC_ERROR(b2nd_transpose(ctx_t, src, &array));
+  blosc_set_timestamp(&t1);
+  printf("  b2nd_transpose: %.4f s\n", blosc_elapsed_secs(t0, t1));
+
+  // Check a few items
+  for (int64_t i = 0; i < shape[0]; i += 997) {
+    for (int64_t j = 0; j < shape[1]; j += 991) {
+      int64_t start[] = {j, i};
+      int64_t stop[] = {j + 1, i + 1};
+      int64_t item_shape[] = {1, 1};
+      DATA_TYPE item;
+      BLOSC_ERROR(b2nd_get_slice_cbuffer(array, start, stop, &item, item_shape, itemsize));
+      if (item != src_buffer[i * shape[1] + j]) {
+        printf("Wrong item at (%d, %d)\n", (int) i, (int) j);
+        return -1;
+      }
+    }
+  }
+
+  BLOSC_ERROR(b2nd_free(array));
+  BLOSC_ERROR(b2nd_free(src));
+  BLOSC_ERROR(b2nd_free_ctx(ctx_t));
+  BLOSC_ERROR(b2nd_free_ctx(ctx));
+  free(src_buffer);
+
+  blosc2_destroy();
+
+  return 0;
+}
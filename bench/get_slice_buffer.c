@@ -0,0 +1,127 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  Benchmark for blosc2_schunk_get_slice_buffer() with slices of growing
+  length.  Short slices are served by getitem calls, while slices touching
+  many blocks of a chunk are decoded with a (parallel) masked decompression.
+  Comparing the 1 thread and NTHREADS columns shows where the crossover
+  happens on this machine.
+
+  To compile this program:
+
+  $ gcc -O3 get_slice_buffer.c -o get_slice_buffer -lblosc2
+
+  To run:
+
+  $ ./get_slice_buffer [nthreads]
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <blosc2.h>
+
+#define KB  1024.
+#define MB  (1024*KB)
+
+#define CHUNKSIZE (1000 * 1000)
+#define BLOCKSIZE (32 * 1024)
+#define NCHUNKS 20
+#define NTHREADS 4
+#define NREPS 5
+
+
+static double time_slices(blosc2_schunk *schunk, int64_t slice_len, int32_t *buffer) {
+  blosc_timestamp_t last, current;
+  double best = 1e9;
+
+  for (int rep = 0; rep < NREPS; rep++) {
+    blosc_set_timestamp(&last);
+    // Start every slice in the middle of a chunk so that it is always a partial read
+    for (int64_t nchunk = 0; nchunk < NCHUNKS - 1; nchunk++) {
+      int64_t start = nchunk * CHUNKSIZE + 1001;
+      int rc = blosc2_schunk_get_slice_buffer(schunk, start, start + slice_len, buffer);
+      if (rc < 0) {
+        printf("Error getting slice: %d\n", rc);
+        exit(1);
+      }
+    }
+    blosc_set_timestamp(&current);
+    double elapsed = blosc_elapsed_secs(last, current);
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+
+  return best;
+}
+
+
+int main(int argc, char *argv[]) {
+  int nthreads = NTHREADS;
+  if (argc > 1) {
+    nthreads = (int) strtol(argv[1], NULL, 10);
+  }
+
+  blosc2_init();
+  printf("Blosc version info: %s (%s)\n", BLOSC2_VERSION_STRING, BLOSC2_VERSION_DATE);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = sizeof(int32_t);
+  cparams.compcode = BLOSC_ZSTD;
+  cparams.clevel = 5;
+  cparams.blocksize = BLOCKSIZE;
+  cparams.nthreads = nthreads;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  blosc2_storage storage = {.cparams=&cparams, .dparams=&dparams};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+
+  int32_t *data = malloc(CHUNKSIZE * sizeof(int32_t));
+  for (int64_t nchunk = 0; nchunk < NCHUNKS; nchunk++) {
+    for (int i = 0; i < CHUNKSIZE; i++) {
+      data[i] = (int32_t) (nchunk * CHUNKSIZE + i);
+    }
+    if (blosc2_schunk_append_buffer(schunk, data, CHUNKSIZE * sizeof(int32_t)) < 0) {
+      printf("Error appending chunk\n");
+      return -1;
+    }
+  }
+
+  int32_t *buffer = malloc(CHUNKSIZE * sizeof(int32_t));
+  int nitems_block = BLOCKSIZE / (int) sizeof(int32_t);
+  printf("Chunk: %.1f MB, block: %.1f KB, %d chunks\n",
+         CHUNKSIZE * sizeof(int32_t) / MB, BLOCKSIZE / KB, NCHUNKS);
+  printf("%8s %12s %18s %18s\n", "blocks", "slice (KB)", "1 thread (MB/s)", "threads (MB/s)");
+
+  int nblocks_list[] = {1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 64, 100};
+  for (int i = 0; i < (int) (sizeof(nblocks_list) / sizeof(int)); i++) {
+    int64_t slice_len = (int64_t) nblocks_list[i] * nitems_block;
+    if (slice_len + 1001 > CHUNKSIZE) {
+      break;
+    }
+    double slice_mb = (double) (slice_len * sizeof(int32_t) * (NCHUNKS - 1)) / MB;
+
+    dparams.nthreads = 1;
+    blosc2_free_ctx(schunk->dctx);
+    schunk->dctx = blosc2_create_dctx(dparams);
+    double t1 = time_slices(schunk, slice_len, buffer);
+
+    dparams.nthreads = (int16_t) nthreads;
+    blosc2_free_ctx(schunk->dctx);
+    schunk->dctx = blosc2_create_dctx(dparams);
+    double tn = time_slices(schunk, slice_len, buffer);
+
+    printf("%8d %12.1f %18.1f %18.1f\n", nblocks_list[i], slice_len * sizeof(int32_t) / KB,
+           slice_mb / t1, slice_mb / tn);
+  }
+
+  free(data);
+  free(buffer);
+  blosc2_schunk_free(schunk);
+  blosc2_destroy();
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  Benchmark for the latency of opening many small on-disk frames, like a
+  catalog service does.  Every frame is opened with blosc2_schunk_open_udio()
+  using an input/output backend that counts the calls into the file system,
+  and then its first chunk is decompressed.
+
+  To compile this program:
+
+  $ gcc -O3 open_frames.c -o open_frames -lblosc2
+
+  To run:
+
+  $ ./open_frames [nframes]
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <blosc2.h>
+#include <blosc2/blosc2-stdio.h>
+
+#define NFRAMES 1000
+#define CHUNKSIZE (10 * 1000)
+#define NCHUNKS 4
+#define OPEN_FRAMES_IO_ID 245
+
+
+typedef struct {
+  int64_t open;
+  int64_t read;
+} open_frames_counters;
+
+static open_frames_counters counters = {0};
+
+
+static void* counting_open(const char *urlpath, const char *mode, void *params) {
+  counters.open++;
+  return blosc2_stdio_open(urlpath, mode, params);
+}
+
+static int64_t counting_read(void *ptr, int64_t size, int64_t nitems, void *stream) {
+  counters.read++;
+  return blosc2_stdio_read(ptr, size, nitems, stream);
+}
+
+
+static int create_frames(int nframes, bool contiguous) {
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = sizeof(int32_t);
+  cparams.clevel = 5;
+  int32_t data[CHUNKSIZE];
+  for (int i = 0; i < CHUNKSIZE; i++) {
+    data[i] = i;
+  }
+  int64_t meta = 42;
+
+  char urlpath[64];
+  for (int nframe = 0; nframe < nframes; nframe++) {
+    sprintf(urlpath, contiguous ? "open_frames_%d.b2frame" : "open_frames_%d_s.b2frame", nframe);
+    blosc2_remove_urlpath(urlpath);
+    blosc2_storage storage = {.cparams=&cparams, .contiguous=contiguous, .urlpath=urlpath};
+    blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+    if (schunk == NULL) {
+      return -1;
+    }
+    blosc2_meta_add(schunk, "meta", (uint8_t *) &meta, sizeof(meta));
+    for (int nchunk = 0; nchunk < NCHUNKS; nchunk++) {
+      if (blosc2_schunk_append_buffer(schunk, data, sizeof(data)) < 0) {
+        blosc2_schunk_free(schunk);
+        return -1;
+      }
+    }
+    blosc2_vlmeta_add(schunk, "vlmeta", (uint8_t *) &meta, sizeof(meta), NULL);
+    blosc2_schunk_free(schunk);
+  }
+  return 0;
+}
+
+
+static int open_frames(int nframes, bool contiguous) {
+  blosc2_io io = {.id = OPEN_FRAMES_IO_ID, .name = "counting", .params = NULL};
+  int32_t data[CHUNKSIZE];
+  char urlpath[64];
+  blosc_timestamp_t last, current;
+  double topen = 0, tfirst = 0;
+
+  counters = (open_frames_counters) {0};
+  for (int nframe = 0; nframe < nframes; nframe++) {
+    sprintf(urlpath, contiguous ? "open_frames_%d.b2frame" : "open_frames_%d_s.b2frame", nframe);
+    blosc_set_timestamp(&last);
+    blosc2_schunk *schunk = blosc2_schunk_open_udio(urlpath, &io);
+    blosc_set_timestamp(&current);
+    topen += blosc_elapsed_secs(last, current);
+    if (schunk == NULL) {
+      printf("Cannot open %s\n", urlpath);
+      return -1;
+    }
+    if (nframe == 0) {
+      printf("  reads per open: %ld, opens per open: %ld\n",
+             (long) counters.read, (long) counters.open);
+    }
+    blosc_set_timestamp(&last);
+    int nbytes = blosc2_schunk_decompress_chunk(schunk, 0, data, sizeof(data));
+    blosc_set_timestamp(&current);
+    tfirst += blosc_elapsed_secs(last, current);
+    if (nbytes < 0) {
+      printf("Decompression error.  Error code: %d\n", nbytes);
+      return nbytes;
+    }
+    blosc2_schunk_free(schunk);
+  }
+
+  printf("  open:\t\t\t %8.2f us/frame\n", topen * 1e6 / nframes);
+  printf("  first decompression:\t %8.2f us/frame\n", tfirst * 1e6 / nframes);
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  int nframes = NFRAMES;
+  if (argc > 1) {
+    nframes = (int) strtol(argv[1], NULL, 10);
+  }
+
+  blosc2_init();
+  printf("Blosc version info: %s (%s)\n", BLOSC2_VERSION_STRING, BLOSC2_VERSION_DATE);
+
+  blosc2_io_cb io_cb = {
+      .id = OPEN_FRAMES_IO_ID,
+      .name = "counting",
+      .open = (blosc2_open_cb) counting_open,
+      .close = (blosc2_close_cb) blosc2_stdio_close,
+      .tell = (blosc2_tell_cb) blosc2_stdio_tell,
+      .seek = (blosc2_seek_cb) blosc2_stdio_seek,
+      .write = (blosc2_write_cb) blosc2_stdio_write,
+      .read = (blosc2_read_cb) counting_read,
+      .truncate = (blosc2_truncate_cb) blosc2_stdio_truncate,
+  };
+  blosc2_register_io_cb(&io_cb);
+
+  for (int contiguous = 1; contiguous >= 0; contiguous--) {
+    if (create_frames(nframes, contiguous) < 0) {
+      printf("Cannot create the frames\n");
+      return -1;
+    }
+    printf("%d %s frames of %d chunks:\n", nframes, contiguous ? "contiguous" : "sparse", NCHUNKS);
+    int rc = open_frames(nframes, contiguous);
+
+    char urlpath[64];
+    for (int nframe = 0; nframe < nframes; nframe++) {
+      sprintf(urlpath, contiguous ? "open_frames_%d.b2frame" : "open_frames_%d_s.b2frame", nframe);
+      blosc2_remove_urlpath(urlpath);
+    }
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
+  blosc2_destroy();
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  Benchmark comparing a sum over all the chunks of a super-chunk using a plain
+  loop of blosc2_schunk_decompress_chunk() calls against a blosc2_schunk_iter,
+  which decompresses the next chunks in the background while the current one
+  is being reduced.
+
+  To compile this program:
+
+  $ gcc -O3 schunk_iter.c -o schunk_iter -lblosc2
+
+  To run:
+
+  $ ./schunk_iter [nthreads] [nbuffers]
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <blosc2.h>
+
+#define KB  1024.
+#define MB  (1024*KB)
+#define GB  (1024*MB)
+
+#define CHUNKSIZE (4 * 1000 * 1000)
+#define NCHUNKS 100
+#define NTHREADS 4
+#define NBUFFERS 3
+
+
+static double sum_chunk(const double *values, int64_t nitems) {
+  double sum = 0;
+  for (int64_t i = 0; i < nitems; i++) {
+    sum += values[i] * values[i];
+  }
+  return sum;
+}
+
+
+int main(int argc, char *argv[]) {
+  int nthreads = NTHREADS;
+  int nbuffers = NBUFFERS;
+  if (argc > 1) {
+    nthreads = (int) strtol(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    nbuffers = (int) strtol(argv[2], NULL, 10);
+  }
+  blosc_timestamp_t last, current;
+
+  blosc2_init();
+  printf("Blosc version info: %s (%s)\n", BLOSC2_VERSION_STRING, BLOSC2_VERSION_DATE);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = sizeof(double);
+  cparams.compcode = BLOSC_LZ4;
+  cparams.clevel = 5;
+  cparams.nthreads = nthreads;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage storage = {.cparams=&cparams, .dparams=&dparams};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+
+  double *data = malloc(CHUNKSIZE * sizeof(double));
+  for (int nchunk = 0; nchunk < NCHUNKS; nchunk++) {
+    for (int i = 0; i < CHUNKSIZE; i++) {
+      data[i] = (double) (i % 1000) + nchunk;
+    }
+    if (blosc2_schunk_append_buffer(schunk, data, CHUNKSIZE * sizeof(double)) < 0) {
+      printf("Error appending chunk\n");
+      return -1;
+    }
+  }
+  double totalsize = (double) schunk->nbytes;
+  printf("Super-chunk: %.1f MB (%d chunks), %d threads, %d buffers\n",
+         totalsize / MB, NCHUNKS, nthreads, nbuffers);
+
+  /* Plain loop */
+  blosc_set_timestamp(&last);
+  double sum1 = 0;
+  for (int nchunk = 0; nchunk < NCHUNKS; nchunk++) {
+    int nbytes = blosc2_schunk_decompress_chunk(schunk, nchunk, data, CHUNKSIZE * sizeof(double));
+    if (nbytes < 0) {
+      printf("Decompression error.  Error code: %d\n", nbytes);
+      return nbytes;
+    }
+    sum1 += sum_chunk(data, nbytes / (int) sizeof(double));
+  }
+  blosc_set_timestamp(&current);
+  double ttime = blosc_elapsed_secs(last, current);
+  printf("[Loop] Elapsed time:\t %6.3f s.  Processed data: %.3f GB (%.3f GB/s)\n",
+         ttime, totalsize / GB, totalsize / (GB * ttime));
+
+  /* Iterator */
+  blosc_set_timestamp(&last);
+  double sum2 = 0;
+  blosc2_schunk_iter *iter = blosc2_schunk_iter_new(schunk, nbuffers);
+  if (iter == NULL) {
+    printf("Cannot create iterator\n");
+    return -1;
+  }
+  uint8_t *chunk_data;
+  int32_t nbytes;
+  int rc;
+  while ((rc = blosc2_schunk_iter_next(iter, NULL, &chunk_data, &nbytes)) > 0) {
+    sum2 += sum_chunk((double *) chunk_data, nbytes / (int) sizeof(double));
+  }
+  blosc2_schunk_iter_free(iter);
+  if (rc < 0) {
+    printf("Iteration error.  Error code: %d\n", rc);
+    return rc;
+  }
+  blosc_set_timestamp(&current);
+  ttime = blosc_elapsed_secs(last, current);
+  printf("[Iter] Elapsed time:\t %6.3f s.  Processed data: %.3f GB (%.3f GB/s)\n",
+         ttime, totalsize / GB, totalsize / (GB * ttime));
+
+  if (sum1 != sum2) {
+    printf("Sums differ! %f != %f\n", sum1, sum2);
+    return -1;
+  }
+
+  free(data);
+  blosc2_schunk_free(schunk);
+  blosc2_destroy();
+
+  return 0;
+}
@@ -37,4 +37,315 @@
  */
 int b2nd_get_slice_nchunks(b2nd_array_t *array, const int64_t *start, const int64_t *stop, int64_t **chunks_idx);
 
+/**
+ * @brief Copy a box of items between two buffers with arbitrary strides.
+ *
+ * @param ndim The number of dimensions of the box.
+ * @param itemsize The size of the items.
+ * @param copy_shape The shape of the box.
+ * @param src The first item of the box in the source buffer.
+ * @param src_strides The strides (in bytes) of the source buffer.
+ * @param dst The first item of the box in the destination buffer.
+ * @param dst_strides The strides (in bytes) of the destination buffer.
+ *
+ * @return An error code.
+ *
+ * @note Dimensions contiguous in both buffers are merged, so rows are copied whole when the items
+ * of the innermost one are contiguous, and item by item (gathered or scattered) otherwise.
+ */
+int b2nd_copy_strided(int8_t ndim, uint8_t itemsize, const int64_t *copy_shape,
+                      const void *src, const int64_t *src_strides,
+                      void *dst, const int64_t *dst_strides);
+
+/**
+ * @brief The state of a b2nd_appender_t.
+ */
+struct b2nd_appender_s {
+  b2nd_array_t *array;
+  //!< The array where the rows are appended.
+  int64_t base;
+  //!< The first row of the trailing chunk row (along axis 0).
+  int64_t npending;
+  //!< The rows of the trailing chunk row kept in @p slab (some may be in the array too).
+  bool loaded;
+  //!< Whether the rows of the trailing chunk row that were in the array are in @p slab too.
+  int64_t row_nbytes;
+  //!< The size of a row.
+  int64_t slab_shape[B2ND_MAX_DIM];
+  //!< The shape of @p slab.
+  uint8_t *slab;
+  //!< The rows of the trailing chunk row, in C order.
+  uint8_t *data;
+  //!< A buffer for a chunk, or NULL when the chunks have the layout of @p slab.
+};
+
+/**
+ * @brief The kinds of items that can be converted to doubles.
+ */
+typedef enum {
+  B2ND_ITEM_INT,
+  B2ND_ITEM_UINT,
+  B2ND_ITEM_FLOAT,
+} b2nd_item_kind;
+
+/**
+ * @brief Get the kind and size of the items of an array from its NumPy dtype (like "<f8").
+ *
+ * @param array The b2nd array.
+ * @param kind The kind of the items.
+ * @param itemsize The size of the items.
+ *
+ * @return An error code if the dtype is not a little-endian NumPy int, uint, float or bool.
+ */
+int b2nd_get_item_kind(const b2nd_array_t *array, b2nd_item_kind *kind, int32_t *itemsize);
+
+/**
+ * @brief Convert @p nitems consecutive items into doubles.
+ *
+ * @param kind The kind of the items.
+ * @param itemsize The size of the items.
+ * @param src The items (they do not need to be aligned).
+ * @param nitems The number of items.
+ * @param dest The buffer where the doubles will be written.
+ */
+void b2nd_items_to_doubles(b2nd_item_kind kind, int32_t itemsize, const uint8_t *src, int64_t nitems,
+                           double *dest);
+
+/**
+ * @brief Convert @p nitems doubles into consecutive items, as C casts do (NaNs become 0 for
+ * integers).
+ *
+ * @param kind The kind of the items.
+ * @param itemsize The size of the items.
+ * @param src The doubles.
+ * @param nitems The number of items.
+ * @param dest The buffer where the items will be written (it does not need to be aligned).
+ */
+void b2nd_doubles_to_items(b2nd_item_kind kind, int32_t itemsize, const double *src, int64_t nitems,
+                           uint8_t *dest);
+
+/**
+ * @brief Get the part of a block that lies inside both its chunk and the array.
+ *
+ * @param array The b2nd array.
+ * @param chunk_start The coordinates where the chunk begins.
+ * @param nblock The index of the block in the chunk.
+ * @param block_start The coordinates where the block begins.
+ * @param block_shape The shape of the part of the block inside the chunk and the array.
+ *
+ * @return The number of items in that part (0 for blocks in the padding of the chunk).
+ */
+int64_t b2nd_block_extent(const b2nd_array_t *array, const int64_t *chunk_start, int32_t nblock,
+                          int64_t *block_start, int64_t *block_shape);
+
+/**
+ * @brief The state for scanning the blocks of the chunks of an array as they are decompressed.
+ */
+typedef struct b2nd_scanner_s b2nd_scanner;
+
+struct b2nd_scanner_s {
+  const b2nd_array_t *array;
+  //!< The array being scanned.
+  void *user_data;
+  //!< The state of the scan.
+  void (*scan_block)(b2nd_scanner *scanner, int tid, int32_t nblock, const uint8_t *block);
+  //!< Scan a block of the current chunk. Up to @p nthreads threads (told apart by @p tid) may call it at once.
+  bool (*scan_special)(b2nd_scanner *scanner, int special_type, const uint8_t *value);
+  //!< Scan a special chunk (of zeros, NaNs, @p value or uninitialized items). Returns false when the chunk has to be decompressed instead. Optional.
+  int nthreads;
+  //!< The number of threads that may scan blocks at once.
+  int64_t nchunk;
+  //!< The chunk being scanned.
+  int64_t chunk_start[B2ND_MAX_DIM];
+  //!< The coordinates where the current chunk begins.
+  int32_t nblocks;
+  //!< The number of blocks in a chunk.
+  blosc2_context *dctx;
+  //!< The decompression context, scanning the blocks in its postfilter.
+  uint8_t *data;
+  //!< A buffer for a chunk.
+  int32_t data_nbytes;
+  //!< The size of @p data.
+  bool *maskout;
+  //!< The blocks of the current chunk that are not decompressed.
+};
+
+/**
+ * @brief Create the contexts and buffers of a scanner. The callbacks and @p user_data can be set before or after.
+ *
+ * @param scanner The scanner.
+ * @param array The array to scan.
+ *
+ * @return An error code.
+ */
+int b2nd_scanner_init(b2nd_scanner *scanner, const b2nd_array_t *array);
+
+/**
+ * @brief Free the contexts and buffers of a scanner.
+ *
+ * @param scanner The scanner.
+ */
+void b2nd_scanner_destroy(b2nd_scanner *scanner);
+
+/**
+ * @brief Scan the blocks of a chunk inside the array, or the whole chunk if it is a special one.
+ *
+ * @param scanner The scanner.
+ * @param nchunk The chunk to scan.
+ * @param skip The blocks not to scan (they are not decompressed either), or NULL.
+ *
+ * @return An error code.
+ */
+int b2nd_scan_chunk(b2nd_scanner *scanner, int64_t nchunk, const bool *skip);
+
+/* The vlmetalayer describing the pyramid (its levels may be kept in `b2nd_pyramid_<n>` ones) */
+#define B2ND_PYRAMID_NAME "b2nd_pyramid"
+
+/**
+ * @brief The levels of the pyramid of an in-memory array, kept in it while it is written.
+ */
+typedef struct b2nd_pyramid_levels_s {
+  int8_t nlevels;
+  //!< The number of levels.
+  b2nd_array_t **levels;
+  //!< The levels (owned), or NULL for the ones that have not been loaded from the vlmetalayers.
+  bool dirty;
+  //!< Whether the levels have changed since they were stored.
+} b2nd_pyramid_levels;
+
+/**
+ * @brief Store the levels of the pyramid that an in-memory array keeps, if they have changed.
+ *
+ * @param array The b2nd array.
+ *
+ * @return An error code.
+ */
+int b2nd_pyramid_flush(const b2nd_array_t *array);
+
+/**
+ * @brief Free the levels of a pyramid.
+ *
+ * @param levels The levels.
+ */
+void b2nd_pyramid_levels_free(b2nd_pyramid_levels *levels);
+
+/* The vlmetalayer keeping the zone map */
+#define B2ND_ZONEMAP_NAME "b2nd_zonemap"
+
+/**
+ * @brief The statistics of a chunk or block of an array (the padding is not considered).
+ */
+typedef struct {
+  double min;
+  //!< The minimum of the items that are not NaN.
+  double max;
+  //!< The maximum of the items that are not NaN.
+  int64_t nitems;
+  //!< The number of items, or -1 when the statistics are unknown.
+  int64_t nnans;
+  //!< The number of NaNs.
+} b2nd_zone;
+
+/**
+ * @brief The statistics of all the chunks and blocks of an array.
+ */
+typedef struct b2nd_zonemap_s {
+  int64_t nchunks;
+  //!< The number of chunks.
+  int32_t nblocks;
+  //!< The number of blocks in a chunk.
+  b2nd_item_kind kind;
+  //!< The kind of the items.
+  int32_t itemsize;
+  //!< The size of the items.
+  b2nd_zone *zones;
+  //!< The zone of every chunk, followed by the zones of its blocks.
+  uint64_t *fingerprints;
+  //!< The fingerprint of every chunk (see b2nd_zonemap_set_chunk()) when its zones were computed.
+  bool dirty;
+  //!< Whether the zone map has changed since it was stored.
+} b2nd_zonemap;
+
+/**
+ * @brief Load the zone map of an array.
+ *
+ * @param array The b2nd array.
+ * @param zonemap The pointer where the zone map will be written. It is NULL when the array has
+ * no zone map, or when it does not match the shape of the array.
+ *
+ * @return An error code.
+ */
+int b2nd_zonemap_load(const b2nd_array_t *array, b2nd_zonemap **zonemap);
+
+/**
+ * @brief Get the zone map that an array keeps in memory while it is written, loading it first.
+ *
+ * @param array The b2nd array.
+ * @param zonemap The pointer where the zone map (owned by the array) will be written. It is NULL
+ * when the array has no zone map.
+ *
+ * @return An error code.
+ */
+int b2nd_zonemap_get(b2nd_array_t *array, b2nd_zonemap **zonemap);
+
+/**
+ * @brief Store the zone map of an array in its `b2nd_zonemap` vlmetalayer.
+ *
+ * @param array The b2nd array.
+ * @param zonemap The zone map.
+ *
+ * @return An error code.
+ */
+int b2nd_zonemap_save(const b2nd_array_t *array, const b2nd_zonemap *zonemap);
+
+/**
+ * @brief Store the zone map that an array keeps in memory, if it has changed.
+ *
+ * @param array The b2nd array.
+ *
+ * @return An error code.
+ */
+int b2nd_zonemap_flush(const b2nd_array_t *array);
+
+/**
+ * @brief Remove the zone map of an array (if any), in memory too.
+ *
+ * @param array The b2nd array.
+ *
+ * @return An error code.
+ */
+int b2nd_zonemap_drop(b2nd_array_t *array);
+
+/**
+ * @brief Free a zone map.
+ *
+ * @param zonemap The zone map.
+ */
+void b2nd_zonemap_free(b2nd_zonemap *zonemap);
+
+/**
+ * @brief Update the zones of a chunk that is about to be compressed.
+ *
+ * @param array The b2nd array.
+ * @param zonemap The zone map.
+ * @param nchunk The chunk.
+ * @param data The items of the chunk, block after block.
+ * @param blocks The blocks of @p data to take into account (the zones of the others are kept),
+ * or NULL for all of them.
+ *
+ * @return An error code.
+ */
+int b2nd_zonemap_update(const b2nd_array_t *array, b2nd_zonemap *zonemap, int64_t nchunk,
+                        const uint8_t *data, const bool *blocks);
+
+/**
+ * @brief Record the chunk that is about to replace another one, so that the zones of the latter
+ * are not mistaken for those of chunks replaced without the zone map.
+ *
+ * @param zonemap The zone map.
+ * @param nchunk The chunk.
+ * @param chunk The new chunk (it cannot be a lazy one).
+ */
+void b2nd_zonemap_set_chunk(b2nd_zonemap *zonemap, int64_t nchunk, const uint8_t *chunk);
+
 #endif /* BLOSC_B2ND_PRIVATE_H */
@@ -9,11 +9,14 @@
 **********************************************************************/
 
 #include "b2nd.h"
+#include "b2nd-private.h"
 #include "context.h"
+#include "schunk-private.h"
 #include "blosc2/blosc2-common.h"
 #include "blosc2.h"
 
 #include <inttypes.h>
+#include <math.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -114,16 +117,16 @@ int update_shape(b2nd_array_t *array, int8_t ndim, const int64_t *shape,
         } else {
           array->extshape[i] = shape[i] + chunkshape[i] - shape[i] % chunkshape[i];
         }
-        if (chunkshape[i] % blockshape[i] == 0) {
-          array->extchunkshape[i] = chunkshape[i];
-        } else {
-          array->extchunkshape[i] =
-                  chunkshape[i] + blockshape[i] - chunkshape[i] % blockshape[i];
-        }
       } else {
-        array->extchunkshape[i] = chunkshape[i];
         array->extshape[i] = 0;
       }
+      // The chunks must keep their size when empty arrays are extended
+      if (chunkshape[i] == 0 || chunkshape[i] % blockshape[i] == 0) {
+        array->extchunkshape[i] = chunkshape[i];
+      } else {
+        array->extchunkshape[i] =
+                chunkshape[i] + blockshape[i] - chunkshape[i] % blockshape[i];
+      }
     } else {
       array->blockshape[i] = 1;
       array->chunkshape[i] = 1;
@@ -169,6 +172,10 @@ int update_shape(b2nd_array_t *array, int8_t ndim, const int64_t *shape,
     }
   }
   if (array->sc) {
+    if (array->sc->nchunks == 0) {
+      // Empty arrays created by earlier versions may have a smaller chunksize
+      array->sc->chunksize = (int32_t) array->extchunknitems * array->sc->typesize;
+    }
     uint8_t *smeta = NULL;
     // Serialize the dimension info ...
     int32_t smeta_len =
@@ -189,6 +196,8 @@ int update_shape(b2nd_array_t *array, int8_t ndim, const int64_t *shape,
       }
     }
     free(smeta);
+    // The zones of the chunks do not apply to the new shape
+    BLOSC_ERROR(b2nd_zonemap_drop(array));
   }
 
   return BLOSC2_ERROR_SUCCESS;
@@ -221,6 +230,10 @@ int array_without_schunk(b2nd_context_t *ctx, b2nd_array_t **array) {
   (*array)->chunk_cache.data = NULL;
   (*array)->chunk_cache.nchunk = -1;  // means no valid cache yet
 
+  // The zone map and the levels of the pyramid are only kept in memory while they are written
+  (*array)->zonemap = NULL;
+  (*array)->pyramid_levels = NULL;
+
   return BLOSC2_ERROR_SUCCESS;
 }
 
@@ -405,6 +418,8 @@ int b2nd_to_cframe(const b2nd_array_t *array, uint8_t **cframe, int64_t *cframe_
   BLOSC_ERROR_NULL(cframe_len, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(needs_free, BLOSC2_ERROR_NULL_POINTER);
 
+  BLOSC_ERROR(b2nd_zonemap_flush(array));
+  BLOSC_ERROR(b2nd_pyramid_flush(array));
   *cframe_len = blosc2_schunk_to_buffer(array->sc, cframe, needs_free);
   if (*cframe_len <= 0) {
     BLOSC_TRACE_ERROR("Error serializing the b2nd array");
@@ -459,13 +474,18 @@ int b2nd_open_offset(const char *urlpath, b2nd_array_t **array, int64_t offset)
 int b2nd_free(b2nd_array_t *array) {
   BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
 
+  int rc = BLOSC2_ERROR_SUCCESS;
   if (array) {
     if (array->sc != NULL) {
+      rc = b2nd_zonemap_flush(array);
       blosc2_schunk_free(array->sc);
     }
+    b2nd_zonemap_free(array->zonemap);
+    b2nd_pyramid_levels_free(array->pyramid_levels);
     free(array->dtype);
     free(array);
   }
+  BLOSC_ERROR(rc);
   return BLOSC2_ERROR_SUCCESS;
 }
 
@@ -516,176 +536,454 @@ int b2nd_to_cbuffer(const b2nd_array_t *array, void *buffer,
 }
 
 
-// Setting and getting slices
-int get_set_slice(void *buffer, int64_t buffersize, const int64_t *start, const int64_t *stop,
-                  const int64_t *shape, b2nd_array_t *array, bool set_slice) {
+int b2nd_from_cbuffer_strided(b2nd_context_t *ctx, b2nd_array_t **array, const void *buffer,
+                              const int64_t *bufferstrides, int64_t buffersize) {
+  BLOSC_ERROR_NULL(ctx, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
-  if (buffersize < 0) {
-    BLOSC_TRACE_ERROR("buffersize is < 0");
-    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+
+  BLOSC_ERROR(b2nd_empty(ctx, array));
+
+  int64_t start[B2ND_MAX_DIM] = {0};
+  int rc = b2nd_set_slice_cbuffer_strided(buffer, bufferstrides, buffersize, start, (*array)->shape,
+                                          *array);
+  if (rc < 0) {
+    b2nd_free(*array);
+    *array = NULL;
+    BLOSC_ERROR(rc);
   }
 
-  uint8_t *buffer_b = (uint8_t *) buffer;
-  const int64_t *buffer_start = start;
-  const int64_t *buffer_stop = stop;
-  const int64_t *buffer_shape = shape;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_to_cbuffer_strided(const b2nd_array_t *array, void *buffer, const int64_t *bufferstrides,
+                            int64_t buffersize) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+
+  int64_t start[B2ND_MAX_DIM] = {0};
+  BLOSC_ERROR(b2nd_get_slice_cbuffer_strided(array, start, array->shape, buffer, bufferstrides,
+                                             buffersize));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
 
+
+/* The state of getting or setting a slice, shared by the workers when chunks go in parallel */
+typedef struct {
+  b2nd_array_t *array;
+  uint8_t *buffer;
+  const int64_t *start;
+  const int64_t *stop;
+  int64_t strides[B2ND_MAX_DIM];  // of the buffer (in bytes)
+  bool set_slice;
+  int64_t chunks_in_array_strides[B2ND_MAX_DIM];
+  int64_t blocks_in_chunk[B2ND_MAX_DIM];
+  int64_t update_start[B2ND_MAX_DIM];
+  int64_t update_shape[B2ND_MAX_DIM];
+  int64_t update_nchunks;
+  bool parallel;           // the super-chunk is shared by several workers
+  blosc2_cparams cparams;  // params for the worker contexts
+  blosc2_dparams dparams;
+  int64_t next;            // next chunk to be processed by a worker
+  int error;
+  pthread_mutex_t mutex;   // serializes the accesses to the super-chunk
+  b2nd_zonemap *zonemap;   // the zones of the chunks that are set are updated here (if not NULL)
+} slice_job;
+
+
+static void slice_lock(slice_job *job) {
+  if (job->parallel) {
+    pthread_mutex_lock(&job->mutex);
+  }
+}
+
+static void slice_unlock(slice_job *job) {
+  if (job->parallel) {
+    pthread_mutex_unlock(&job->mutex);
+  }
+}
+
+
+/* Copy the intersection of the slice with a block of a chunk (from the block when getting) */
+static void slice_copy_block(slice_job *job, const int64_t *chunk_start, const int64_t *chunk_stop,
+                             int32_t nblock, uint8_t *block) {
+  b2nd_array_t *array = job->array;
   int8_t ndim = array->ndim;
+  const int64_t *buffer_start = job->start;
+  const int64_t *buffer_stop = job->stop;
 
-  // 0-dim case
-  if (ndim == 0) {
-    if (set_slice) {
-      int32_t chunk_size = array->sc->typesize + BLOSC2_MAX_OVERHEAD;
-      uint8_t *chunk = malloc(chunk_size);
-      BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
-      if (blosc2_compress_ctx(array->sc->cctx, buffer_b, array->sc->typesize, chunk, chunk_size) < 0) {
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-      }
-      if (blosc2_schunk_update_chunk(array->sc, 0, chunk, false) < 0) {
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-      }
+  int64_t nblock_ndim[B2ND_MAX_DIM] = {0};
+  blosc2_unidim_to_multidim(ndim, job->blocks_in_chunk, nblock, nblock_ndim);
+
+  // Check if the block needs to be updated
+  int64_t block_start[B2ND_MAX_DIM] = {0};
+  int64_t block_stop[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    block_start[i] = nblock_ndim[i] * array->blockshape[i];
+    block_stop[i] = block_start[i] + array->blockshape[i];
+    block_start[i] += chunk_start[i];
+    block_stop[i] += chunk_start[i];
+
+    if (block_start[i] > chunk_stop[i]) {
+      block_start[i] = chunk_stop[i];
+    }
+    if (block_stop[i] > chunk_stop[i]) {
+      block_stop[i] = chunk_stop[i];
+    }
+  }
+  int64_t block_shape[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    block_shape[i] = block_stop[i] - block_start[i];
+  }
+  bool block_empty = false;
+  for (int i = 0; i < ndim; ++i) {
+    block_empty |= (block_stop[i] <= buffer_start[i] || block_start[i] >= buffer_stop[i]);
+  }
+  if (block_empty) {
+    return;
+  }
 
+  // compute the start of the slice inside the block
+  int64_t slice_start[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    if (block_start[i] < buffer_start[i]) {
+      slice_start[i] = buffer_start[i] - block_start[i];
     } else {
-      if (blosc2_schunk_decompress_chunk(array->sc, 0, buffer_b, array->sc->typesize) < 0) {
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-      }
+      slice_start[i] = 0;
     }
-    return BLOSC2_ERROR_SUCCESS;
+    slice_start[i] += block_start[i];
   }
 
-  int32_t data_nbytes = (int32_t) array->extchunknitems * array->sc->typesize;
-  uint8_t *data = malloc(data_nbytes);
-  BLOSC_ERROR_NULL(data, BLOSC2_ERROR_MEMORY_ALLOC);
+  int64_t slice_stop[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    if (block_stop[i] > buffer_stop[i]) {
+      slice_stop[i] = block_shape[i] - (block_stop[i] - buffer_stop[i]);
+    } else {
+      slice_stop[i] = block_stop[i] - block_start[i];
+    }
+    slice_stop[i] += block_start[i];
+  }
 
-  int64_t chunks_in_array[B2ND_MAX_DIM] = {0};
+  int64_t slice_shape[B2ND_MAX_DIM] = {0};
   for (int i = 0; i < ndim; ++i) {
-    chunks_in_array[i] = array->extshape[i] / array->chunkshape[i];
+    slice_shape[i] = slice_stop[i] - slice_start[i];
   }
 
-  int64_t chunks_in_array_strides[B2ND_MAX_DIM];
-  chunks_in_array_strides[ndim - 1] = 1;
+  // The intersection in the buffer and in the block
+  int32_t typesize = array->sc->typesize;
+  int64_t block_strides[B2ND_MAX_DIM];
+  block_strides[ndim - 1] = typesize;
   for (int i = ndim - 2; i >= 0; --i) {
-    chunks_in_array_strides[i] = chunks_in_array_strides[i + 1] * chunks_in_array[i + 1];
+    block_strides[i] = block_strides[i + 1] * array->blockshape[i + 1];
   }
-
-  int64_t blocks_in_chunk[B2ND_MAX_DIM] = {0};
+  uint8_t *buffer = job->buffer;
   for (int i = 0; i < ndim; ++i) {
-    blocks_in_chunk[i] = array->extchunkshape[i] / array->blockshape[i];
+    buffer += (slice_start[i] - buffer_start[i]) * job->strides[i];
+    block += (slice_start[i] - block_start[i]) * block_strides[i];
   }
 
-  // Compute the number of chunks to update
-  int64_t update_start[B2ND_MAX_DIM];
-  int64_t update_shape[B2ND_MAX_DIM];
+  if (job->set_slice) {
+    b2nd_copy_strided(ndim, (uint8_t) typesize, slice_shape, buffer, job->strides, block, block_strides);
+  } else {
+    b2nd_copy_strided(ndim, (uint8_t) typesize, slice_shape, block, block_strides, buffer, job->strides);
+  }
+}
 
-  int64_t update_nchunks = 1;
+
+/* A decompression context that copies the blocks of a chunk straight into the slice buffer */
+typedef struct {
+  slice_job *job;
+  blosc2_context *dctx;  // runs slice_postfilter() on every block
+  int64_t chunk_start[B2ND_MAX_DIM];  // the chunk being decompressed
+  int64_t chunk_stop[B2ND_MAX_DIM];
+} slice_direct;
+
+
+/* The blocks are decompressed into the thread temporaries, so this saves a chunk-sized staging
+ * buffer and a pass over it.  Different blocks map to disjoint regions of the slice buffer. */
+static int slice_postfilter(blosc2_postfilter_params *params) {
+  slice_direct *direct = (slice_direct *) params->user_data;
+  slice_copy_block(direct->job, direct->chunk_start, direct->chunk_stop, params->nblock,
+                   (uint8_t *) params->input);
+  return 0;
+}
+
+
+static int slice_direct_init(slice_direct *direct, slice_job *job, blosc2_dparams dparams) {
+  blosc2_postfilter_params postparams = {0};
+  postparams.user_data = direct;
+  dparams.postfilter = slice_postfilter;
+  dparams.postparams = &postparams;
+  direct->job = job;
+  direct->dctx = blosc2_create_dctx(dparams);
+  BLOSC_ERROR_NULL(direct->dctx, BLOSC2_ERROR_MEMORY_ALLOC);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Fill the part of the slice buffer that lies in a chunk with copies of the item at `value` (or
+ * with zeros if it is NULL) */
+static void slice_fill(slice_job *job, const int64_t *chunk_start, const int64_t *chunk_stop,
+                       const uint8_t *value) {
+  int8_t ndim = job->array->ndim;
+  int32_t typesize = job->array->sc->typesize;
+  const int64_t *strides = job->strides;
+  int64_t fill_shape[B2ND_MAX_DIM];
+  int64_t offset = 0;
   for (int i = 0; i < ndim; ++i) {
-    int64_t pos = 0;
-    while (pos <= buffer_start[i]) {
-      pos += array->chunkshape[i];
+    int64_t fill_start = chunk_start[i] > job->start[i] ? chunk_start[i] : job->start[i];
+    int64_t fill_stop = chunk_stop[i] < job->stop[i] ? chunk_stop[i] : job->stop[i];
+    fill_shape[i] = fill_stop - fill_start;
+    offset += (fill_start - job->start[i]) * strides[i];
+  }
+  uint8_t *first_row = &job->buffer[offset];
+  int64_t row_nitems = fill_shape[ndim - 1];
+  int64_t row_nbytes = row_nitems * typesize;
+  bool contiguous = strides[ndim - 1] == typesize;
+
+  // The first row is filled item by item, and the rest are copies of it
+  if (value == NULL && contiguous) {
+    memset(first_row, 0, row_nbytes);
+  } else {
+    for (int64_t nitem = 0; nitem < row_nitems; ++nitem) {
+      if (value == NULL) {
+        memset(&first_row[nitem * strides[ndim - 1]], 0, typesize);
+      } else {
+        memcpy(&first_row[nitem * strides[ndim - 1]], value, typesize);
+      }
     }
-    update_start[i] = pos / array->chunkshape[i] - 1;
-    while (pos < buffer_stop[i]) {
-      pos += array->chunkshape[i];
+  }
+  int64_t nrows = 1;
+  for (int i = 0; i < ndim - 1; ++i) {
+    nrows *= fill_shape[i];
+  }
+  for (int64_t nrow = 1; nrow < nrows; ++nrow) {
+    int64_t row_start[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim((int8_t) (ndim - 1), fill_shape, nrow, row_start);
+    int64_t row_offset;
+    blosc2_multidim_to_unidim(row_start, (int8_t) (ndim - 1), strides, &row_offset);
+    if (!contiguous) {
+      b2nd_copy_strided(1, (uint8_t) typesize, &row_nitems, first_row, &strides[ndim - 1],
+                        &first_row[row_offset], &strides[ndim - 1]);
+    } else if (value == NULL) {
+      memset(&first_row[row_offset], 0, row_nbytes);
+    } else {
+      memcpy(&first_row[row_offset], first_row, row_nbytes);
     }
-    update_shape[i] = pos / array->chunkshape[i] - update_start[i];
-    update_nchunks *= update_shape[i];
   }
+}
 
-  for (int update_nchunk = 0; update_nchunk < update_nchunks; ++update_nchunk) {
-    int64_t nchunk_ndim[B2ND_MAX_DIM] = {0};
-    blosc2_unidim_to_multidim(ndim, update_shape, update_nchunk, nchunk_ndim);
-    for (int i = 0; i < ndim; ++i) {
-      nchunk_ndim[i] += update_start[i];
-    }
-    int64_t nchunk;
-    blosc2_multidim_to_unidim(nchunk_ndim, ndim, chunks_in_array_strides, &nchunk);
 
-    // Check if the chunk needs to be updated
-    int64_t chunk_start[B2ND_MAX_DIM] = {0};
-    int64_t chunk_stop[B2ND_MAX_DIM] = {0};
-    for (int i = 0; i < ndim; ++i) {
-      chunk_start[i] = nchunk_ndim[i] * array->chunkshape[i];
-      chunk_stop[i] = chunk_start[i] + array->chunkshape[i];
-      if (chunk_stop[i] > array->shape[i]) {
-        chunk_stop[i] = array->shape[i];
+/* Get the part of the slice in a special chunk (zeros, NaNs, a repeated value or uninitialized
+ * data) straight from its header.  Returns false if the chunk has to be decompressed instead. */
+static bool slice_get_special(slice_job *job, const int64_t *chunk_start, const int64_t *chunk_stop,
+                              const uint8_t *chunk, int32_t cbytes) {
+  if (cbytes < BLOSC_EXTENDED_HEADER_LENGTH) {
+    return false;
+  }
+  int32_t typesize = job->array->sc->typesize;
+  uint8_t nan_value[sizeof(double)];
+  switch ((chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK) {
+    case BLOSC2_SPECIAL_ZERO:
+      slice_fill(job, chunk_start, chunk_stop, NULL);
+      return true;
+    case BLOSC2_SPECIAL_NAN:
+      if (typesize == sizeof(float)) {
+        float value = nanf("");
+        memcpy(nan_value, &value, sizeof(value));
+      } else if (typesize == sizeof(double)) {
+        double value = nan("");
+        memcpy(nan_value, &value, sizeof(value));
+      } else {
+        return false;
       }
+      slice_fill(job, chunk_start, chunk_stop, nan_value);
+      return true;
+    case BLOSC2_SPECIAL_VALUE:
+      if (cbytes < BLOSC_EXTENDED_HEADER_LENGTH + typesize) {
+        return false;
+      }
+      slice_fill(job, chunk_start, chunk_stop, &chunk[BLOSC_EXTENDED_HEADER_LENGTH]);
+      return true;
+    case BLOSC2_SPECIAL_UNINIT:
+      // The contents are undefined, so leave the buffer alone
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+/* Replace a chunk of the array; the super-chunk takes ownership of `chunk` */
+static int64_t slice_update_chunk(slice_job *job, int64_t nchunk, uint8_t *chunk) {
+  slice_lock(job);
+  int64_t rc = blosc2_schunk_update_chunk(job->array->sc, nchunk, chunk, false);
+  slice_unlock(job);
+  return rc;
+}
+
+
+/* Get or set the part of the slice that lies in one chunk, using `data` as scratch.  When getting,
+ * `direct` (if not NULL) copies the blocks into the buffer as they are decompressed. */
+static int get_set_slice_chunk(slice_job *job, int64_t update_nchunk, blosc2_context *cctx,
+                               blosc2_context *dctx, slice_direct *direct, uint8_t *data,
+                               int32_t data_nbytes) {
+  b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+  bool set_slice = job->set_slice;
+  const int64_t *start = job->start;
+  const int64_t *stop = job->stop;
+  const int64_t *buffer_start = job->start;
+  const int64_t *buffer_stop = job->stop;
+  const int64_t *update_start = job->update_start;
+  int64_t *update_shape = job->update_shape;
+  int64_t *blocks_in_chunk = job->blocks_in_chunk;
+
+  int64_t nchunk_ndim[B2ND_MAX_DIM] = {0};
+  blosc2_unidim_to_multidim(ndim, update_shape, update_nchunk, nchunk_ndim);
+  for (int i = 0; i < ndim; ++i) {
+    nchunk_ndim[i] += update_start[i];
+  }
+  int64_t nchunk;
+  blosc2_multidim_to_unidim(nchunk_ndim, ndim, job->chunks_in_array_strides, &nchunk);
+
+  // Check if the chunk needs to be updated
+  int64_t chunk_start[B2ND_MAX_DIM] = {0};
+  int64_t chunk_stop[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    chunk_start[i] = nchunk_ndim[i] * array->chunkshape[i];
+    chunk_stop[i] = chunk_start[i] + array->chunkshape[i];
+    if (chunk_stop[i] > array->shape[i]) {
+      chunk_stop[i] = array->shape[i];
     }
-    bool chunk_empty = false;
+  }
+  bool chunk_empty = false;
+  for (int i = 0; i < ndim; ++i) {
+    chunk_empty |= (chunk_stop[i] <= buffer_start[i] || chunk_start[i] >= buffer_stop[i]);
+  }
+  if (chunk_empty) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  int32_t nblocks = (int32_t) array->extchunknitems / array->blocknitems;
+  uint8_t *chunk_old = NULL;
+  int32_t chunk_old_cbytes = 0;
+  bool chunk_old_needs_free = false;
+  bool *touched = NULL;
+  bool *block_maskout = NULL;
+  uint8_t *chunk = NULL;
+  bool chunk_needs_free = false;
+  bool copy_blocks = true;
+  int rc = BLOSC2_ERROR_SUCCESS;
+  if (set_slice) {
+    // Check if all the chunk is going to be updated and avoid the decompression
+    bool decompress_chunk = false;
     for (int i = 0; i < ndim; ++i) {
-      chunk_empty |= (chunk_stop[i] <= buffer_start[i] || chunk_start[i] >= buffer_stop[i]);
+      decompress_chunk |= (chunk_start[i] < buffer_start[i] || chunk_stop[i] > buffer_stop[i]);
     }
-    if (chunk_empty) {
-      continue;
-    }
-
-    int32_t nblocks = (int32_t) array->extchunknitems / array->blocknitems;
-    if (set_slice) {
-      // Check if all the chunk is going to be updated and avoid the decompression
-      bool decompress_chunk = false;
-      for (int i = 0; i < ndim; ++i) {
-        decompress_chunk |= (chunk_start[i] < buffer_start[i] || chunk_stop[i] > buffer_stop[i]);
-      }
 
-      if (decompress_chunk) {
-        int err = blosc2_schunk_decompress_chunk(array->sc, nchunk, data, data_nbytes);
-        if (err < 0) {
-          BLOSC_TRACE_ERROR("Error decompressing chunk");
-          BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+    if (decompress_chunk) {
+      slice_lock(job);
+      chunk_old_cbytes = blosc2_schunk_get_chunk(array->sc, nchunk, &chunk_old, &chunk_old_needs_free);
+      if (job->parallel && chunk_old_cbytes > 0 && !chunk_old_needs_free) {
+        // Other workers may move the storage of the super-chunk when updating their chunks
+        uint8_t *chunk_copy = malloc(chunk_old_cbytes);
+        if (chunk_copy != NULL) {
+          memcpy(chunk_copy, chunk_old, chunk_old_cbytes);
+          chunk_old_needs_free = true;
         }
-      } else {
-        // Avoid writing non zero padding from previous chunk
-        memset(data, 0, data_nbytes);
+        chunk_old = chunk_copy;
       }
-    } else {
-      bool *block_maskout = malloc(nblocks);
-      BLOSC_ERROR_NULL(block_maskout, BLOSC2_ERROR_MEMORY_ALLOC);
-      for (int nblock = 0; nblock < nblocks; ++nblock) {
-        int64_t nblock_ndim[B2ND_MAX_DIM] = {0};
-        blosc2_unidim_to_multidim(ndim, blocks_in_chunk, nblock, nblock_ndim);
-
-        // Check if the block needs to be updated
-        int64_t block_start[B2ND_MAX_DIM] = {0};
-        int64_t block_stop[B2ND_MAX_DIM] = {0};
-        for (int i = 0; i < ndim; ++i) {
-          block_start[i] = nblock_ndim[i] * array->blockshape[i];
-          block_stop[i] = block_start[i] + array->blockshape[i];
-          block_start[i] += chunk_start[i];
-          block_stop[i] += chunk_start[i];
-
-          if (block_start[i] > chunk_stop[i]) {
-            block_start[i] = chunk_stop[i];
+      slice_unlock(job);
+      if (chunk_old_cbytes < 0) {
+        BLOSC_TRACE_ERROR("Error getting chunk");
+        rc = BLOSC2_ERROR_FAILURE;
+        goto out;
+      }
+      if (chunk_old == NULL) {
+        rc = BLOSC2_ERROR_MEMORY_ALLOC;
+        goto out;
+      }
+      if (schunk_chunk_blocks_updatable(array->sc, chunk_old, chunk_old_cbytes)) {
+        // Only the blocks overlapping the slice will be recompressed, and only the
+        // ones that are not completely overwritten need to be decompressed
+        touched = malloc(nblocks);
+        block_maskout = malloc(nblocks);
+        if (touched == NULL || block_maskout == NULL) {
+          rc = BLOSC2_ERROR_MEMORY_ALLOC;
+          goto out;
+        }
+        for (int nblock = 0; nblock < nblocks; ++nblock) {
+          int64_t nblock_ndim[B2ND_MAX_DIM] = {0};
+          blosc2_unidim_to_multidim(ndim, blocks_in_chunk, nblock, nblock_ndim);
+          bool block_empty = false;
+          bool block_covered = true;
+          for (int i = 0; i < ndim; ++i) {
+            int64_t block_start = chunk_start[i] + nblock_ndim[i] * array->blockshape[i];
+            int64_t block_stop = block_start + array->blockshape[i];
+            if (block_stop > chunk_stop[i]) {
+              block_stop = chunk_stop[i];
+            }
+            block_empty |= (block_stop <= buffer_start[i] || block_start >= buffer_stop[i]);
+            block_covered &= (block_start >= buffer_start[i] && block_stop <= buffer_stop[i]);
           }
-          if (block_stop[i] > chunk_stop[i]) {
-            block_stop[i] = chunk_stop[i];
+          touched[nblock] = !block_empty;
+          block_maskout[nblock] = block_empty || block_covered;
+          if (!block_empty && block_covered) {
+            // Avoid writing non zero padding from previous chunk
+            memset(&data[nblock * array->blocknitems * array->sc->typesize], 0,
+                   array->blocknitems * array->sc->typesize);
           }
         }
-
-        bool block_empty = false;
-        for (int i = 0; i < ndim; ++i) {
-          block_empty |= (block_stop[i] <= start[i] || block_start[i] >= stop[i]);
+        if (blosc2_set_maskout(dctx, block_maskout, nblocks) != BLOSC2_ERROR_SUCCESS) {
+          BLOSC_TRACE_ERROR("Error setting the maskout");
+          rc = BLOSC2_ERROR_FAILURE;
+          goto out;
         }
-        block_maskout[nblock] = block_empty ? true : false;
       }
-
-      if (blosc2_set_maskout(array->sc->dctx, block_maskout, nblocks) != BLOSC2_ERROR_SUCCESS) {
-        BLOSC_TRACE_ERROR("Error setting the maskout");
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+      if (!job->parallel) {
+        array->sc->current_nchunk = nchunk;
       }
-
-      int err = blosc2_schunk_decompress_chunk(array->sc, nchunk, data, data_nbytes);
-      if (err < 0) {
+      if (blosc2_decompress_ctx(dctx, chunk_old, chunk_old_cbytes, data, data_nbytes) < 0) {
         BLOSC_TRACE_ERROR("Error decompressing chunk");
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+        rc = BLOSC2_ERROR_FAILURE;
+        goto out;
       }
-
-      free(block_maskout);
+    } else {
+      // Avoid writing non zero padding from previous chunk
+      memset(data, 0, data_nbytes);
+    }
+  } else {
+    slice_lock(job);
+    // Lazy chunks only read the blocks that are not masked out
+    int cbytes = blosc2_schunk_get_lazychunk(array->sc, nchunk, &chunk, &chunk_needs_free);
+    slice_unlock(job);
+    if (cbytes < 0) {
+      BLOSC_TRACE_ERROR("Error getting chunk");
+      rc = cbytes;
+      goto out;
+    }
+    // Special chunks hold no data, so there is nothing to decompress (unless a postfilter of
+    // the array has to process them)
+    if (direct != NULL && slice_get_special(job, chunk_start, chunk_stop, chunk, cbytes)) {
+      goto out;
+    }
+    // The delta filter decodes every block against the first one in the destination
+    if (direct != NULL && !schunk_chunk_uses_delta(chunk)) {
+      for (int i = 0; i < ndim; ++i) {
+        direct->chunk_start[i] = chunk_start[i];
+        direct->chunk_stop[i] = chunk_stop[i];
+      }
+      dctx = direct->dctx;
+      copy_blocks = false;
     }
 
-    // Iterate over blocks
-
+    block_maskout = malloc(nblocks);
+    if (block_maskout == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+      goto out;
+    }
     for (int nblock = 0; nblock < nblocks; ++nblock) {
       int64_t nblock_ndim[B2ND_MAX_DIM] = {0};
       blosc2_unidim_to_multidim(ndim, blocks_in_chunk, nblock, nblock_ndim);
@@ -706,130 +1004,378 @@ int get_set_slice(void *buffer, int64_t buffersize, const int64_t *start, const
           block_stop[i] = chunk_stop[i];
         }
       }
-      int64_t block_shape[B2ND_MAX_DIM] = {0};
-      for (int i = 0; i < ndim; ++i) {
-        block_shape[i] = block_stop[i] - block_start[i];
-      }
+
       bool block_empty = false;
       for (int i = 0; i < ndim; ++i) {
         block_empty |= (block_stop[i] <= start[i] || block_start[i] >= stop[i]);
       }
-      if (block_empty) {
-        continue;
-      }
-
-      // compute the start of the slice inside the block
-      int64_t slice_start[B2ND_MAX_DIM] = {0};
-      for (int i = 0; i < ndim; ++i) {
-        if (block_start[i] < buffer_start[i]) {
-          slice_start[i] = buffer_start[i] - block_start[i];
-        } else {
-          slice_start[i] = 0;
-        }
-        slice_start[i] += block_start[i];
-      }
-
-      int64_t slice_stop[B2ND_MAX_DIM] = {0};
-      for (int i = 0; i < ndim; ++i) {
-        if (block_stop[i] > buffer_stop[i]) {
-          slice_stop[i] = block_shape[i] - (block_stop[i] - buffer_stop[i]);
-        } else {
-          slice_stop[i] = block_stop[i] - block_start[i];
-        }
-        slice_stop[i] += block_start[i];
-      }
-
-      int64_t slice_shape[B2ND_MAX_DIM] = {0};
-      for (int i = 0; i < ndim; ++i) {
-        slice_shape[i] = slice_stop[i] - slice_start[i];
-      }
-
-      uint8_t *src = &buffer_b[0];
-      const int64_t *src_pad_shape = buffer_shape;
+      block_maskout[nblock] = block_empty ? true : false;
+    }
 
-      int64_t src_start[B2ND_MAX_DIM] = {0};
-      int64_t src_stop[B2ND_MAX_DIM] = {0};
-      for (int i = 0; i < ndim; ++i) {
-        src_start[i] = slice_start[i] - buffer_start[i];
-        src_stop[i] = slice_stop[i] - buffer_start[i];
-      }
+    if (schunk_set_chunk_maskout(dctx, chunk, block_maskout, nblocks) != BLOSC2_ERROR_SUCCESS) {
+      BLOSC_TRACE_ERROR("Error setting the maskout");
+      rc = BLOSC2_ERROR_FAILURE;
+      goto out;
+    }
 
-      uint8_t *dst = &data[nblock * array->blocknitems * array->sc->typesize];
-      int64_t dst_pad_shape[B2ND_MAX_DIM];
-      for (int i = 0; i < ndim; ++i) {
-        dst_pad_shape[i] = array->blockshape[i];
-      }
+    // Update current_chunk in case a postfilter is applied
+    if (!job->parallel) {
+      array->sc->current_nchunk = nchunk;
+    }
+    // `data` is not written when the blocks go straight into the buffer
+    if (blosc2_decompress_ctx(dctx, chunk, cbytes, data, data_nbytes) < 0) {
+      BLOSC_TRACE_ERROR("Error decompressing chunk");
+      rc = BLOSC2_ERROR_FAILURE;
+      goto out;
+    }
+  }
 
-      int64_t dst_start[B2ND_MAX_DIM] = {0};
-      int64_t dst_stop[B2ND_MAX_DIM] = {0};
-      for (int i = 0; i < ndim; ++i) {
-        dst_start[i] = slice_start[i] - block_start[i];
-        dst_stop[i] = dst_start[i] + slice_shape[i];
-      }
+  // Iterate over blocks
+  if (copy_blocks) {
+    for (int nblock = 0; nblock < nblocks; ++nblock) {
+      slice_copy_block(job, chunk_start, chunk_stop, nblock,
+                       &data[nblock * array->blocknitems * array->sc->typesize]);
+    }
+  }
 
-      if (set_slice) {
-        b2nd_copy_buffer(ndim, array->sc->typesize,
-                         src, src_pad_shape, src_start, src_stop,
-                         dst, dst_pad_shape, dst_start);
-      } else {
-        b2nd_copy_buffer(ndim, array->sc->typesize,
-                         dst, dst_pad_shape, dst_start, dst_stop,
-                         src, src_pad_shape, src_start);
-      }
+  // Every thread updates the zones of different chunks
+  if (set_slice && job->zonemap != NULL) {
+    rc = b2nd_zonemap_update(array, job->zonemap, nchunk, data, touched);
+    if (rc < 0) {
+      goto out;
     }
+  }
 
-    if (set_slice) {
-      // Recompress the data
-      int32_t chunk_nbytes = data_nbytes + BLOSC2_MAX_OVERHEAD;
-      uint8_t *chunk = malloc(chunk_nbytes);
-      BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
-      int brc;
-      // Update current_chunk in case a prefilter is applied
+  if (set_slice && touched != NULL) {
+    if (!job->parallel) {
       array->sc->current_nchunk = nchunk;
-      brc = blosc2_compress_ctx(array->sc->cctx, data, data_nbytes, chunk, chunk_nbytes);
-      if (brc < 0) {
-        BLOSC_TRACE_ERROR("Blosc can not compress the data");
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-      }
-      int64_t brc_ = blosc2_schunk_update_chunk(array->sc, nchunk, chunk, false);
-      if (brc_ < 0) {
-        BLOSC_TRACE_ERROR("Blosc can not update the chunk");
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+    }
+    uint8_t *new_chunk;
+    int64_t brc_ = schunk_build_chunk_blocks(array->sc, cctx, dctx, nchunk, chunk_old, chunk_old_cbytes,
+                                             data, touched, &new_chunk);
+    if (brc_ >= 0) {
+      if (job->zonemap != NULL) {
+        b2nd_zonemap_set_chunk(job->zonemap, nchunk, new_chunk);
       }
+      brc_ = slice_update_chunk(job, nchunk, new_chunk);
+    }
+    if (brc_ < 0) {
+      BLOSC_TRACE_ERROR("Blosc can not update the chunk");
+      rc = BLOSC2_ERROR_FAILURE;
+      goto out;
+    }
+  }
+  else if (set_slice) {
+    // Recompress the data
+    int32_t chunk_nbytes = data_nbytes + BLOSC2_MAX_OVERHEAD;
+    uint8_t *new_chunk = malloc(chunk_nbytes);
+    if (new_chunk == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+      goto out;
+    }
+    // Update current_chunk in case a prefilter is applied
+    if (!job->parallel) {
+      array->sc->current_nchunk = nchunk;
+    }
+    if (blosc2_compress_ctx(cctx, data, data_nbytes, new_chunk, chunk_nbytes) < 0) {
+      free(new_chunk);
+      BLOSC_TRACE_ERROR("Blosc can not compress the data");
+      rc = BLOSC2_ERROR_FAILURE;
+      goto out;
+    }
+    if (job->zonemap != NULL) {
+      b2nd_zonemap_set_chunk(job->zonemap, nchunk, new_chunk);
+    }
+    if (slice_update_chunk(job, nchunk, new_chunk) < 0) {
+      BLOSC_TRACE_ERROR("Blosc can not update the chunk");
+      rc = BLOSC2_ERROR_FAILURE;
+      goto out;
     }
   }
 
-  free(data);
-
+  out:
+  free(block_maskout);
+  free(touched);
+  if (chunk_needs_free) {
+    free(chunk);
+  }
+  if (chunk_old_needs_free) {
+    free(chunk_old);
+  }
+  BLOSC_ERROR(rc);
   return BLOSC2_ERROR_SUCCESS;
 }
 
 
-int b2nd_get_slice_cbuffer(const b2nd_array_t *array, const int64_t *start, const int64_t *stop,
-                           void *buffer, const int64_t *buffershape, int64_t buffersize) {
-  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(buffershape, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+static void *get_set_slice_worker(void *arg) {
+  slice_job *job = (slice_job *) arg;
+  blosc2_context *cctx = job->set_slice ? blosc2_create_cctx(job->cparams) : NULL;
+  blosc2_context *dctx = blosc2_create_dctx(job->dparams);
+  slice_direct direct = {0};
+  int direct_rc = job->set_slice ? BLOSC2_ERROR_SUCCESS : slice_direct_init(&direct, job, job->dparams);
+  int32_t data_nbytes = (int32_t) job->array->extchunknitems * job->array->sc->typesize;
+  uint8_t *data = malloc(data_nbytes);
 
-  int64_t size = array->sc->typesize;
-  for (int i = 0; i < array->ndim; ++i) {
-    if (stop[i] - start[i] > buffershape[i]) {
-      BLOSC_TRACE_ERROR("The buffer shape can not be smaller than the slice shape");
-      return BLOSC2_ERROR_INVALID_PARAM;
+  pthread_mutex_lock(&job->mutex);
+  if (dctx == NULL || data == NULL || (job->set_slice && cctx == NULL) || direct_rc < 0) {
+    job->error = BLOSC2_ERROR_FAILURE;
+  }
+  while (job->error == 0 && job->next < job->update_nchunks) {
+    int64_t update_nchunk = job->next++;
+    pthread_mutex_unlock(&job->mutex);
+    int rc = get_set_slice_chunk(job, update_nchunk, cctx, dctx, job->set_slice ? NULL : &direct,
+                                 data, data_nbytes);
+    pthread_mutex_lock(&job->mutex);
+    if (rc < 0 && job->error == 0) {
+      job->error = rc;
     }
-    size *= buffershape[i];
   }
+  pthread_mutex_unlock(&job->mutex);
 
-  if (array->nitems == 0) {
-    return BLOSC2_ERROR_SUCCESS;
+  free(data);
+  if (cctx != NULL) {
+    blosc2_free_ctx(cctx);
+  }
+  if (dctx != NULL) {
+    blosc2_free_ctx(dctx);
+  }
+  if (direct.dctx != NULL) {
+    blosc2_free_ctx(direct.dctx);
+  }
+  return NULL;
+}
+
+
+/* Process the chunks of a slice with `nworkers` workers, each one with its own contexts (using
+ * `nthreads` threads) and scratch buffer.  Every chunk maps to a disjoint region of the buffer. */
+static int get_set_slice_parallel(slice_job *job, int nworkers, int nthreads) {
+  blosc2_ctx_get_cparams(job->array->sc->cctx, &job->cparams);
+  blosc2_ctx_get_dparams(job->array->sc->dctx, &job->dparams);
+  job->cparams.nthreads = (int16_t) nthreads;
+  job->dparams.nthreads = (int16_t) nthreads;
+  job->parallel = true;
+  pthread_mutex_init(&job->mutex, NULL);
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  pthread_t *threads = malloc(nworkers * sizeof(pthread_t));
+  BLOSC_ERROR_NULL(threads, BLOSC2_ERROR_MEMORY_ALLOC);
+  int nstarted = 0;
+  for (; nstarted < nworkers; nstarted++) {
+    if (pthread_create(&threads[nstarted], NULL, get_set_slice_worker, job) != 0) {
+      BLOSC_TRACE_ERROR("Cannot create a slice thread.");
+      rc = BLOSC2_ERROR_THREAD_CREATE;
+      pthread_mutex_lock(&job->mutex);
+      job->error = rc;
+      pthread_mutex_unlock(&job->mutex);
+      break;
+    }
+  }
+  for (int i = 0; i < nstarted; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+  pthread_mutex_destroy(&job->mutex);
+
+  return job->error < 0 ? job->error : rc;
+}
+
+
+// Setting and getting slices (the item at `start` goes at the start of `buffer`, and `strides`
+// are the ones of the buffer, in bytes)
+int get_set_slice(void *buffer, int64_t buffersize, const int64_t *start, const int64_t *stop,
+                  const int64_t *strides, b2nd_array_t *array, bool set_slice) {
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  if (buffersize < 0) {
+    BLOSC_TRACE_ERROR("buffersize is < 0");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  uint8_t *buffer_b = (uint8_t *) buffer;
+  const int64_t *buffer_start = start;
+  const int64_t *buffer_stop = stop;
+
+  int8_t ndim = array->ndim;
+
+  // 0-dim case
+  if (ndim == 0) {
+    if (set_slice) {
+      int32_t chunk_size = array->sc->typesize + BLOSC2_MAX_OVERHEAD;
+      uint8_t *chunk = malloc(chunk_size);
+      BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
+      if (blosc2_compress_ctx(array->sc->cctx, buffer_b, array->sc->typesize, chunk, chunk_size) < 0) {
+        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+      }
+      if (blosc2_schunk_update_chunk(array->sc, 0, chunk, false) < 0) {
+        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+      }
+
+    } else {
+      if (blosc2_schunk_decompress_chunk(array->sc, 0, buffer_b, array->sc->typesize) < 0) {
+        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+      }
+    }
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  slice_job job = {0};
+  job.array = array;
+  job.buffer = buffer_b;
+  job.start = start;
+  job.stop = stop;
+  for (int i = 0; i < ndim; ++i) {
+    job.strides[i] = strides[i];
+  }
+  job.set_slice = set_slice;
+
+  int64_t chunks_in_array[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    chunks_in_array[i] = array->extshape[i] / array->chunkshape[i];
+  }
+
+  int64_t *chunks_in_array_strides = job.chunks_in_array_strides;
+  chunks_in_array_strides[ndim - 1] = 1;
+  for (int i = ndim - 2; i >= 0; --i) {
+    chunks_in_array_strides[i] = chunks_in_array_strides[i + 1] * chunks_in_array[i + 1];
+  }
+
+  for (int i = 0; i < ndim; ++i) {
+    job.blocks_in_chunk[i] = array->extchunkshape[i] / array->blockshape[i];
+  }
+
+  // Compute the number of chunks to update
+  int64_t *update_start = job.update_start;
+  int64_t *update_shape = job.update_shape;
+
+  int64_t update_nchunks = 1;
+  for (int i = 0; i < ndim; ++i) {
+    int64_t pos = 0;
+    while (pos <= buffer_start[i]) {
+      pos += array->chunkshape[i];
+    }
+    update_start[i] = pos / array->chunkshape[i] - 1;
+    while (pos < buffer_stop[i]) {
+      pos += array->chunkshape[i];
+    }
+    update_shape[i] = pos / array->chunkshape[i] - update_start[i];
+    update_nchunks *= update_shape[i];
+  }
+  job.update_nchunks = update_nchunks;
+
+  // The zone map (if any) follows the chunks that are set
+  if (set_slice) {
+    BLOSC_ERROR(b2nd_zonemap_get(array, &job.zonemap));
+  }
+
+  // Spread the threads over the chunks when the slice spans several of them.  Pre- and
+  // postfilters may depend on the state of the super-chunk, so they keep the serial path.
+  int rc = BLOSC2_ERROR_SUCCESS;
+  int nthreads = set_slice ? array->sc->cctx->nthreads : array->sc->dctx->nthreads;
+  int nworkers = update_nchunks < nthreads ? (int) update_nchunks : nthreads;
+  if (nworkers > 1 && array->sc->cctx->prefilter == NULL && array->sc->dctx->postfilter == NULL) {
+    rc = get_set_slice_parallel(&job, nworkers, nthreads / nworkers);
+  }
+  else {
+    // A postfilter of the array needs the whole chunk in the destination
+    slice_direct direct = {0};
+    bool use_direct = !set_slice && array->sc->dctx->postfilter == NULL;
+    if (use_direct) {
+      blosc2_dparams dparams;
+      blosc2_ctx_get_dparams(array->sc->dctx, &dparams);
+      BLOSC_ERROR(slice_direct_init(&direct, &job, dparams));
+    }
+    int32_t data_nbytes = (int32_t) array->extchunknitems * array->sc->typesize;
+    uint8_t *data = malloc(data_nbytes);
+    rc = data == NULL ? BLOSC2_ERROR_MEMORY_ALLOC : BLOSC2_ERROR_SUCCESS;
+    for (int64_t update_nchunk = 0; update_nchunk < update_nchunks && rc >= 0; ++update_nchunk) {
+      rc = get_set_slice_chunk(&job, update_nchunk, array->sc->cctx, array->sc->dctx,
+                               use_direct ? &direct : NULL, data, data_nbytes);
+    }
+    free(data);
+    if (use_direct) {
+      blosc2_free_ctx(direct.dctx);
+    }
+  }
+
+  if (job.zonemap != NULL) {
+    // Zones may be ahead of the chunks after an error.  Otherwise, the zone map is stored when
+    // the array is freed or serialized.
+    if (rc >= 0) {
+      job.zonemap->dirty = true;
+    } else {
+      b2nd_zonemap_drop(array);
+    }
+  }
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* The strides (in bytes) of a C buffer with shape `buffershape` */
+static void buffer_c_strides(const b2nd_array_t *array, const int64_t *buffershape, int64_t *strides) {
+  if (array->ndim == 0) {
+    return;
+  }
+  strides[array->ndim - 1] = array->sc->typesize;
+  for (int i = array->ndim - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * buffershape[i + 1];
+  }
+}
+
+
+/* Check that a slice fits in a buffer with `strides` (in bytes) and `buffersize` */
+static int check_strided_buffer(const b2nd_array_t *array, const int64_t *start, const int64_t *stop,
+                                const int64_t *bufferstrides, int64_t buffersize) {
+  int64_t span = array->sc->typesize;
+  for (int i = 0; i < array->ndim; ++i) {
+    if (bufferstrides[i] < 0) {
+      BLOSC_TRACE_ERROR("The buffer strides can not be negative");
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
+    if (stop[i] <= start[i]) {
+      return BLOSC2_ERROR_SUCCESS;
+    }
+    span += (stop[i] - start[i] - 1) * bufferstrides[i];
+  }
+  if (buffersize < span) {
+    BLOSC_TRACE_ERROR("The buffersize (%lld) is smaller than the span of the slice in it (%lld)",
+                      (long long) buffersize, (long long) span);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_get_slice_cbuffer(const b2nd_array_t *array, const int64_t *start, const int64_t *stop,
+                           void *buffer, const int64_t *buffershape, int64_t buffersize) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffershape, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+
+  int64_t size = array->sc->typesize;
+  for (int i = 0; i < array->ndim; ++i) {
+    if (stop[i] - start[i] > buffershape[i]) {
+      BLOSC_TRACE_ERROR("The buffer shape can not be smaller than the slice shape");
+      return BLOSC2_ERROR_INVALID_PARAM;
+    }
+    size *= buffershape[i];
+  }
+
+  if (array->nitems == 0) {
+    return BLOSC2_ERROR_SUCCESS;
   }
 
   if (buffersize < size) {
     BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
   }
-  BLOSC_ERROR(get_set_slice(buffer, buffersize, start, stop, buffershape, (b2nd_array_t *)array, false));
+  int64_t strides[B2ND_MAX_DIM];
+  buffer_c_strides(array, buffershape, strides);
+  BLOSC_ERROR(get_set_slice(buffer, buffersize, start, stop, strides, (b2nd_array_t *)array, false));
 
   return BLOSC2_ERROR_SUCCESS;
 }
@@ -856,7 +1402,52 @@ int b2nd_set_slice_cbuffer(const void *buffer, const int64_t *buffershape, int64
     return BLOSC2_ERROR_SUCCESS;
   }
 
-  BLOSC_ERROR(get_set_slice((void*)buffer, buffersize, start, stop, (int64_t *)buffershape, array, true));
+  int64_t strides[B2ND_MAX_DIM];
+  buffer_c_strides(array, buffershape, strides);
+  BLOSC_ERROR(get_set_slice((void*)buffer, buffersize, start, stop, strides, array, true));
+  // This is a no-op without a pyramid, but it rewrites the levels kept in vlmetalayers otherwise
+  BLOSC_ERROR(b2nd_pyramid_update(array, start, stop));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_get_slice_cbuffer_strided(const b2nd_array_t *array, const int64_t *start, const int64_t *stop,
+                                   void *buffer, const int64_t *bufferstrides, int64_t buffersize) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  if (array->ndim > 0) {
+    BLOSC_ERROR_NULL(bufferstrides, BLOSC2_ERROR_NULL_POINTER);
+  }
+
+  BLOSC_ERROR(check_strided_buffer(array, start, stop, bufferstrides, buffersize));
+  if (array->nitems == 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  BLOSC_ERROR(get_set_slice(buffer, buffersize, start, stop, bufferstrides, (b2nd_array_t *)array, false));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_set_slice_cbuffer_strided(const void *buffer, const int64_t *bufferstrides, int64_t buffersize,
+                                   const int64_t *start, const int64_t *stop, b2nd_array_t *array) {
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  if (array->ndim > 0) {
+    BLOSC_ERROR_NULL(bufferstrides, BLOSC2_ERROR_NULL_POINTER);
+  }
+
+  BLOSC_ERROR(check_strided_buffer(array, start, stop, bufferstrides, buffersize));
+  if (array->nitems == 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  BLOSC_ERROR(get_set_slice((void*)buffer, buffersize, start, stop, bufferstrides, array, true));
+  BLOSC_ERROR(b2nd_pyramid_update(array, start, stop));
 
   return BLOSC2_ERROR_SUCCESS;
 }
@@ -1068,10 +1659,114 @@ int b2nd_squeeze_index(b2nd_array_t *array, const bool *index) {
 }
 
 
-int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array) {
-  BLOSC_ERROR_NULL(src, BLOSC2_ERROR_NULL_POINTER);
-  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+static int64_t gcd(int64_t a, int64_t b) {
+  while (b != 0) {
+    int64_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+
+/* The size (in bytes) of the largest tile with extents `tile` */
+static int64_t rechunk_tile_nbytes(const b2nd_array_t *array, const int64_t *tile) {
+  int64_t nbytes = array->sc->typesize;
+  for (int i = 0; i < array->ndim; ++i) {
+    nbytes *= tile[i] < array->shape[i] ? tile[i] : array->shape[i];
+  }
+  return nbytes;
+}
+
+
+/* Plan the tiles in which `src` is copied into `array`.  Tiles are made of whole chunks of `array`,
+ * so these are compressed once and never read back, and they are aligned with the chunks of `src`
+ * where the budget allows, so these are decompressed once.  Then they grow, innermost dimension
+ * first, so that the chunks of a tile keep all the threads busy. */
+static void rechunk_plan(const b2nd_array_t *src, const b2nd_array_t *array, int64_t max_nbytes,
+                         int64_t *tile) {
+  int8_t ndim = array->ndim;
+  for (int i = 0; i < ndim; ++i) {
+    tile[i] = array->chunkshape[i];
+  }
+  for (int i = ndim - 1; i >= 0; --i) {
+    int64_t dst = array->chunkshape[i];
+    int64_t aligned = dst / gcd(dst, src->chunkshape[i]) * src->chunkshape[i];
+    int64_t old = tile[i];
+    tile[i] = aligned < array->extshape[i] ? aligned : array->extshape[i];
+    if (rechunk_tile_nbytes(array, tile) > max_nbytes) {
+      tile[i] = old;
+    }
+  }
+  for (int i = ndim - 1; i >= 0; --i) {
+    int64_t step = tile[i];
+    while (tile[i] < array->extshape[i]) {
+      tile[i] += step;
+      if (rechunk_tile_nbytes(array, tile) > max_nbytes) {
+        tile[i] -= step;
+        return;
+      }
+    }
+  }
+}
+
+
+/* Copy the items of `src` into `array` (with the same shape) tile by tile, using about
+ * `max_memory` bytes.  Both the reads and the writes of a tile spread the chunks over the threads. */
+static int rechunk_data(const b2nd_array_t *src, b2nd_array_t *array, int64_t max_memory) {
+  int8_t ndim = array->ndim;
+  if (array->nitems == 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  // Every thread needs a chunk of each array as scratch
+  int nthreads = src->sc->dctx->nthreads > array->sc->cctx->nthreads ?
+                 src->sc->dctx->nthreads : array->sc->cctx->nthreads;
+  int64_t scratch = nthreads * (src->extchunknitems * src->sc->typesize +
+                                2 * array->extchunknitems * array->sc->typesize);
+  int64_t tile[B2ND_MAX_DIM];
+  rechunk_plan(src, array, max_memory - scratch, tile);
+
+  int64_t ntiles[B2ND_MAX_DIM];
+  int64_t tiles = 1;
+  for (int i = 0; i < ndim; ++i) {
+    ntiles[i] = (array->shape[i] + tile[i] - 1) / tile[i];
+    tiles *= ntiles[i];
+  }
+  int64_t buffersize = rechunk_tile_nbytes(array, tile);
+  uint8_t *buffer = malloc(buffersize);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_MEMORY_ALLOC);
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  for (int64_t ntile = 0; ntile < tiles && rc >= 0; ++ntile) {
+    int64_t ntile_ndim[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(ndim, ntiles, ntile, ntile_ndim);
+    int64_t start[B2ND_MAX_DIM] = {0};
+    int64_t stop[B2ND_MAX_DIM] = {0};
+    int64_t shape[B2ND_MAX_DIM] = {0};
+    int64_t nbytes = array->sc->typesize;
+    for (int i = 0; i < ndim; ++i) {
+      start[i] = ntile_ndim[i] * tile[i];
+      stop[i] = start[i] + tile[i] < array->shape[i] ? start[i] + tile[i] : array->shape[i];
+      shape[i] = stop[i] - start[i];
+      nbytes *= shape[i];
+    }
+    rc = b2nd_get_slice_cbuffer(src, start, stop, buffer, shape, nbytes);
+    if (rc >= 0) {
+      // The tile covers whole chunks, so they are compressed without reading them
+      rc = b2nd_set_slice_cbuffer(buffer, shape, nbytes, start, stop, array);
+    }
+  }
+  free(buffer);
+  BLOSC_ERROR(rc);
 
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Copy `src` into a new array, rechunking it with at most about `max_memory` bytes if needed */
+static int copy_array(b2nd_context_t *ctx, const b2nd_array_t *src, int64_t max_memory,
+                      b2nd_array_t **array) {
   ctx->ndim = src->ndim;
 
   for (int i = 0; i < src->ndim; ++i) {
@@ -1093,6 +1788,8 @@ int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array
   if (equals) {
     BLOSC_ERROR(array_without_schunk(ctx, array));
 
+    // The zone map is copied along with the chunks
+    BLOSC_ERROR(b2nd_zonemap_flush(src));
     blosc2_schunk *new_sc = blosc2_schunk_copy(src->sc, ctx->b2_storage);
 
     if (new_sc == NULL) {
@@ -1100,13 +1797,14 @@ int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array
     }
     (*array)->sc = new_sc;
 
-  } else {
-    int64_t start[B2ND_MAX_DIM] = {0};
-
-    int64_t stop[B2ND_MAX_DIM];
-    for (int i = 0; i < src->ndim; ++i) {
-      stop[i] = src->shape[i];
+    // The pyramid is not carried over, as it may be kept next to the source
+    for (int i = new_sc->nvlmetalayers - 1; i >= 0; --i) {
+      if (strncmp(new_sc->vlmetalayers[i]->name, B2ND_PYRAMID_NAME, strlen(B2ND_PYRAMID_NAME)) == 0) {
+        BLOSC_ERROR(blosc2_vlmeta_delete(new_sc, new_sc->vlmetalayers[i]->name));
+      }
     }
+
+  } else {
     // Copy metalayers
     b2nd_context_t params_meta;
     memcpy(&params_meta, ctx, sizeof(params_meta));
@@ -1125,10 +1823,20 @@ int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array
     params_meta.nmetalayers = j;
 
     // Copy data
-    BLOSC_ERROR(b2nd_get_slice(&params_meta, array, src, start, stop));
+    BLOSC_ERROR(b2nd_empty(&params_meta, array));
+    int rc = rechunk_data(src, *array, max_memory);
+    if (rc < 0) {
+      b2nd_free(*array);
+      BLOSC_ERROR(rc);
+    }
 
-    // Copy vlmetayers
+    // Copy vlmetayers (but the zone map, which depends on the chunks, and the pyramid, which
+    // may be kept next to the source)
     for (int i = 0; i < src->sc->nvlmetalayers; ++i) {
+      if (strcmp(src->sc->vlmetalayers[i]->name, B2ND_ZONEMAP_NAME) == 0 ||
+          strncmp(src->sc->vlmetalayers[i]->name, B2ND_PYRAMID_NAME, strlen(B2ND_PYRAMID_NAME)) == 0) {
+        continue;
+      }
       uint8_t *content;
       int32_t content_len;
       if (blosc2_vlmeta_get(src->sc, src->sc->vlmetalayers[i]->name, &content,
@@ -1144,6 +1852,33 @@ int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array
 }
 
 
+int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array) {
+  BLOSC_ERROR_NULL(ctx, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(src, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+
+  BLOSC_ERROR(copy_array(ctx, src, B2ND_RECHUNK_MEMORY, array));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_rechunk(b2nd_context_t *ctx, const b2nd_array_t *src, int64_t max_memory,
+                 b2nd_array_t **array) {
+  BLOSC_ERROR_NULL(ctx, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(src, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  if (max_memory < 0) {
+    BLOSC_TRACE_ERROR("max_memory cannot be negative");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  BLOSC_ERROR(copy_array(ctx, src, max_memory > 0 ? max_memory : B2ND_RECHUNK_MEMORY, array));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
 int b2nd_save(const b2nd_array_t *array, char *urlpath) {
   BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(urlpath, BLOSC2_ERROR_NULL_POINTER);
@@ -1451,52 +2186,373 @@ int b2nd_append(b2nd_array_t *array, const void *buffer, int64_t buffersize,
   BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
 
-  int32_t chunksize = array->sc->chunksize;
-  int64_t nchunks_append = buffersize / chunksize;
-  // Check whether chunkshape and blockshape are compatible with accelerated path.
-  // Essentially, we are checking whether the buffer is a multiple of the chunksize
-  // and that the chunkshape and blockshape are the same, except for the first axis.
-  // Also, axis needs to be the first one.
-  bool compat_chunks_blocks = true;
+  int64_t row_nitems = 1;
   for (int i = 1; i < array->ndim; ++i) {
-    if (array->chunkshape[i] != array->blockshape[i]) {
-      compat_chunks_blocks = false;
-      break;
-    }
-  }
-  if (axis > 0) {
-    compat_chunks_blocks = false;
+    row_nitems *= array->shape[i];
   }
-  // General case where a buffer has a different size than the chunksize
-  if (!compat_chunks_blocks || buffersize % chunksize != 0 || nchunks_append != 1) {
+  // General case for appending along other axes
+  if (axis != 0 || array->ndim == 0 || row_nitems == 0) {
     BLOSC_ERROR(b2nd_insert(array, buffer, buffersize, axis, array->shape[axis]));
     return BLOSC2_ERROR_SUCCESS;
   }
 
-  // Accelerated path for buffers that are of the same size as the chunksize
-  // printf("accelerated path\n");
-
-  // Append the buffer to the underlying schunk. This is very fast, as
-  // it doesn't need to do internal partitioning.
-  BLOSC_ERROR(blosc2_schunk_append_buffer(array->sc, (void*)buffer, buffersize));
+  // Rows that do not complete the trailing chunk row just go through slicing
+  int64_t nrows = buffersize / (row_nitems * array->sc->typesize);
+  if (array->shape[0] % array->chunkshape[0] + nrows < array->chunkshape[0]) {
+    BLOSC_ERROR(b2nd_insert(array, buffer, buffersize, axis, array->shape[axis]));
+    return BLOSC2_ERROR_SUCCESS;
+  }
 
-  // Finally, resize the array
-  int64_t newshape[B2ND_MAX_DIM];
-  memcpy(newshape, array->shape, array->ndim * sizeof(int64_t));
-  newshape[axis] += nchunks_append * array->chunkshape[axis];
-  BLOSC_ERROR(b2nd_resize(array, newshape, NULL));
+  // Whole chunk rows are appended straight to the underlying schunk, and only the trailing
+  // partial one goes through slicing
+  b2nd_appender_t *appender;
+  BLOSC_ERROR(b2nd_appender_new(array, &appender));
+  int rc = b2nd_appender_append(appender, buffer, buffersize);
+  int free_rc = b2nd_appender_free(appender);
+  BLOSC_ERROR(rc);
+  BLOSC_ERROR(free_rc);
 
   return BLOSC2_ERROR_SUCCESS;
 }
 
 
-int b2nd_delete(b2nd_array_t *array, const int8_t axis,
-                int64_t delete_start, int64_t delete_len) {
-  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
-
-  if (axis >= array->ndim) {
-    BLOSC_TRACE_ERROR("axis cannot be greater than the number of dimensions");
-    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+/* The chunks of the array have the same layout as the rows of a chunk row */
+static bool appender_direct(const b2nd_array_t *array) {
+  if (array->extchunkshape[0] != array->chunkshape[0]) {
+    return false;
+  }
+  for (int i = 1; i < array->ndim; ++i) {
+    if (array->blockshape[i] != array->chunkshape[i] || array->chunkshape[i] != array->shape[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* Copy the part of the chunk row in `slab` that lies in the chunk starting at `chunk_start` into
+ * `data`, block after block */
+static void appender_build_chunk(const b2nd_appender_t *appender, const uint8_t *slab,
+                                 const int64_t *chunk_start, uint8_t *data) {
+  const b2nd_array_t *array = appender->array;
+  int8_t ndim = array->ndim;
+  int32_t typesize = array->sc->typesize;
+  int64_t blocks_in_chunk[B2ND_MAX_DIM];
+  int64_t blockshape[B2ND_MAX_DIM];
+  int64_t limit[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    blocks_in_chunk[i] = array->extchunkshape[i] / array->blockshape[i];
+    blockshape[i] = array->blockshape[i];
+    limit[i] = i == 0 ? appender->base + array->chunkshape[0] : array->shape[i];
+  }
+
+  // The padding is zeroed for a better compression
+  memset(data, 0, array->extchunknitems * typesize);
+  int32_t nblocks = (int32_t) (array->extchunknitems / array->blocknitems);
+  for (int32_t nblock = 0; nblock < nblocks; ++nblock) {
+    int64_t nblock_ndim[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(ndim, blocks_in_chunk, nblock, nblock_ndim);
+    int64_t src_start[B2ND_MAX_DIM];
+    int64_t src_stop[B2ND_MAX_DIM];
+    int64_t dst_start[B2ND_MAX_DIM] = {0};
+    bool empty = false;
+    for (int i = 0; i < ndim; ++i) {
+      int64_t block_start = chunk_start[i] + nblock_ndim[i] * array->blockshape[i];
+      int64_t block_stop = block_start + array->blockshape[i];
+      block_stop = block_stop < chunk_start[i] + array->chunkshape[i] ? block_stop :
+                   chunk_start[i] + array->chunkshape[i];
+      block_stop = block_stop < limit[i] ? block_stop : limit[i];
+      empty |= block_stop <= block_start;
+      src_start[i] = block_start - (i == 0 ? appender->base : 0);
+      src_stop[i] = block_stop - (i == 0 ? appender->base : 0);
+    }
+    if (!empty) {
+      b2nd_copy_buffer(ndim, (uint8_t) typesize, slab, appender->slab_shape, src_start, src_stop,
+                       &data[nblock * array->blocknitems * typesize], blockshape, dst_start);
+    }
+  }
+}
+
+
+/* The rows that are read from the array rather than from the slab */
+static int64_t appender_array_nrows(const b2nd_appender_t *appender) {
+  return appender->loaded ? appender->base : appender->array->shape[0];
+}
+
+
+/* Read the rows of the trailing chunk row that are in the array into the slab, which is only
+ * needed once the chunk row is complete */
+static int appender_load_slab(b2nd_appender_t *appender) {
+  b2nd_array_t *array = appender->array;
+  if (!appender->loaded) {
+    int64_t start[B2ND_MAX_DIM] = {0};
+    int64_t buffershape[B2ND_MAX_DIM];
+    start[0] = appender->base;
+    memcpy(buffershape, array->shape, array->ndim * sizeof(int64_t));
+    buffershape[0] = array->shape[0] - appender->base;
+    BLOSC_ERROR(b2nd_get_slice_cbuffer(array, start, array->shape, appender->slab, buffershape,
+                                       buffershape[0] * appender->row_nbytes));
+    appender->loaded = true;
+  }
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Write the full chunk row in `slab` to the array, appending its chunks when they are new */
+static int appender_write_slab(b2nd_appender_t *appender, const uint8_t *slab) {
+  b2nd_array_t *array = appender->array;
+  int8_t ndim = array->ndim;
+  int64_t chunks_in_row[B2ND_MAX_DIM] = {1};
+  int64_t nchunks_row = 1;
+  for (int i = 1; i < ndim; ++i) {
+    chunks_in_row[i] = array->extshape[i] / array->chunkshape[i];
+    nchunks_row *= chunks_in_row[i];
+  }
+  int64_t first_nchunk = appender->base / array->chunkshape[0] * nchunks_row;
+  int32_t data_nbytes = (int32_t) array->extchunknitems * array->sc->typesize;
+
+  for (int64_t i = 0; i < nchunks_row; ++i) {
+    const uint8_t *data = slab;
+    if (appender->data != NULL) {
+      int64_t chunk_start[B2ND_MAX_DIM] = {0};
+      blosc2_unidim_to_multidim(ndim, chunks_in_row, i, chunk_start);
+      for (int j = 0; j < ndim; ++j) {
+        chunk_start[j] = j == 0 ? appender->base : chunk_start[j] * array->chunkshape[j];
+      }
+      appender_build_chunk(appender, slab, chunk_start, appender->data);
+      data = appender->data;
+    }
+    int64_t nchunk = first_nchunk + i;
+    if (nchunk == array->sc->nchunks) {
+      if (blosc2_schunk_append_buffer(array->sc, data, data_nbytes) < 0) {
+        BLOSC_TRACE_ERROR("Error appending a chunk");
+        BLOSC_ERROR(BLOSC2_ERROR_CHUNK_APPEND);
+      }
+      continue;
+    }
+    // The chunk row was partially in the array
+    int32_t chunk_nbytes = data_nbytes + BLOSC2_MAX_OVERHEAD;
+    uint8_t *chunk = malloc(chunk_nbytes);
+    BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
+    array->sc->current_nchunk = nchunk;
+    if (blosc2_compress_ctx(array->sc->cctx, data, data_nbytes, chunk, chunk_nbytes) < 0) {
+      free(chunk);
+      BLOSC_TRACE_ERROR("Blosc can not compress the data");
+      BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+    }
+    if (blosc2_schunk_update_chunk(array->sc, nchunk, chunk, false) < 0) {
+      BLOSC_TRACE_ERROR("Error updating a chunk");
+      BLOSC_ERROR(BLOSC2_ERROR_CHUNK_UPDATE);
+    }
+  }
+
+  appender->base += array->chunkshape[0];
+  appender->npending = 0;
+  appender->loaded = true;
+  if (array->shape[0] < appender->base) {
+    int64_t newshape[B2ND_MAX_DIM];
+    memcpy(newshape, array->shape, ndim * sizeof(int64_t));
+    newshape[0] = appender->base;
+    BLOSC_ERROR(update_shape(array, ndim, newshape, array->chunkshape, array->blockshape));
+  }
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_appender_new(b2nd_array_t *array, b2nd_appender_t **appender) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(appender, BLOSC2_ERROR_NULL_POINTER);
+  if (array->ndim == 0) {
+    BLOSC_TRACE_ERROR("Cannot append to arrays without dimensions");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  int64_t row_nbytes = array->sc->typesize;
+  for (int i = 1; i < array->ndim; ++i) {
+    row_nbytes *= array->shape[i];
+  }
+  if (row_nbytes == 0) {
+    BLOSC_TRACE_ERROR("Cannot append to arrays with empty dimensions");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  b2nd_appender_t *appender_ = calloc(1, sizeof(b2nd_appender_t));
+  BLOSC_ERROR_NULL(appender_, BLOSC2_ERROR_MEMORY_ALLOC);
+  appender_->array = array;
+  appender_->row_nbytes = row_nbytes;
+  for (int i = 0; i < array->ndim; ++i) {
+    appender_->slab_shape[i] = i == 0 ? array->chunkshape[0] : array->shape[i];
+  }
+  appender_->slab = malloc(array->chunkshape[0] * row_nbytes);
+  if (!appender_direct(array)) {
+    appender_->data = malloc(array->extchunknitems * array->sc->typesize);
+  }
+  if (appender_->slab == NULL || (appender_->data == NULL && !appender_direct(array))) {
+    b2nd_appender_free(appender_);
+    BLOSC_ERROR(BLOSC2_ERROR_MEMORY_ALLOC);
+  }
+
+  // The rows of the trailing partial chunk row are kept in memory, but the ones in the array
+  // are only read when the chunk row is complete
+  appender_->base = array->shape[0] / array->chunkshape[0] * array->chunkshape[0];
+  appender_->npending = array->shape[0] - appender_->base;
+  appender_->loaded = appender_->npending == 0;
+  *appender = appender_;
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_appender_append(b2nd_appender_t *appender, const void *buffer, int64_t buffersize) {
+  BLOSC_ERROR_NULL(appender, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  if (buffersize < 0 || buffersize % appender->row_nbytes != 0) {
+    BLOSC_TRACE_ERROR("`buffersize` must be a multiple of the size of the rows");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  const uint8_t *rows = (const uint8_t *) buffer;
+  int64_t nrows = buffersize / appender->row_nbytes;
+  int64_t slab_nrows = appender->array->chunkshape[0];
+  while (nrows > 0) {
+    if (appender->npending == 0 && nrows >= slab_nrows) {
+      // Whole chunk rows do not need to be buffered
+      BLOSC_ERROR(appender_write_slab(appender, rows));
+      rows += slab_nrows * appender->row_nbytes;
+      nrows -= slab_nrows;
+      continue;
+    }
+    int64_t ncopy = slab_nrows - appender->npending < nrows ? slab_nrows - appender->npending : nrows;
+    memcpy(&appender->slab[appender->npending * appender->row_nbytes], rows, ncopy * appender->row_nbytes);
+    appender->npending += ncopy;
+    rows += ncopy * appender->row_nbytes;
+    nrows -= ncopy;
+    if (appender->npending == slab_nrows) {
+      BLOSC_ERROR(appender_load_slab(appender));
+      BLOSC_ERROR(appender_write_slab(appender, appender->slab));
+    }
+  }
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_appender_flush(b2nd_appender_t *appender) {
+  BLOSC_ERROR_NULL(appender, BLOSC2_ERROR_NULL_POINTER);
+
+  b2nd_array_t *array = appender->array;
+  int64_t old_nrows = array->shape[0];
+  int64_t nrows = appender->base + appender->npending;
+  if (nrows <= old_nrows) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  int64_t newshape[B2ND_MAX_DIM];
+  memcpy(newshape, array->shape, array->ndim * sizeof(int64_t));
+  newshape[0] = nrows;
+  BLOSC_ERROR(b2nd_resize(array, newshape, NULL));
+
+  // Only the rows that are not in the array yet are written
+  int64_t start[B2ND_MAX_DIM] = {0};
+  start[0] = old_nrows;
+  int64_t buffershape[B2ND_MAX_DIM];
+  memcpy(buffershape, array->shape, array->ndim * sizeof(int64_t));
+  buffershape[0] = nrows - old_nrows;
+  BLOSC_ERROR(b2nd_set_slice_cbuffer(&appender->slab[(old_nrows - appender->base) * appender->row_nbytes],
+                                     buffershape, buffershape[0] * appender->row_nbytes, start,
+                                     array->shape, array));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_appender_get_shape(const b2nd_appender_t *appender, int64_t *shape) {
+  BLOSC_ERROR_NULL(appender, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(shape, BLOSC2_ERROR_NULL_POINTER);
+
+  memcpy(shape, appender->array->shape, appender->array->ndim * sizeof(int64_t));
+  shape[0] = appender->base + appender->npending;
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_appender_get_slice_cbuffer(const b2nd_appender_t *appender, const int64_t *start,
+                                    const int64_t *stop, void *buffer, const int64_t *buffershape,
+                                    int64_t buffersize) {
+  BLOSC_ERROR_NULL(appender, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffershape, BLOSC2_ERROR_NULL_POINTER);
+
+  const b2nd_array_t *array = appender->array;
+  int8_t ndim = array->ndim;
+  int64_t shape[B2ND_MAX_DIM];
+  BLOSC_ERROR(b2nd_appender_get_shape(appender, shape));
+  int64_t size = array->sc->typesize;
+  for (int i = 0; i < ndim; ++i) {
+    if (start[i] < 0 || start[i] > stop[i] || stop[i] > shape[i]) {
+      BLOSC_TRACE_ERROR("The slice must be inside the array");
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
+    if (stop[i] - start[i] > buffershape[i]) {
+      BLOSC_TRACE_ERROR("The buffer shape can not be smaller than the slice shape");
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
+    size *= buffershape[i];
+  }
+  if (buffersize < size) {
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  // The rows in the array come from it, and the others from memory
+  int64_t array_nrows = appender_array_nrows(appender);
+  if (start[0] < array_nrows) {
+    int64_t array_stop[B2ND_MAX_DIM];
+    memcpy(array_stop, stop, ndim * sizeof(int64_t));
+    array_stop[0] = stop[0] < array_nrows ? stop[0] : array_nrows;
+    BLOSC_ERROR(b2nd_get_slice_cbuffer(array, start, array_stop, buffer, buffershape, buffersize));
+  }
+  if (stop[0] > array_nrows) {
+    int64_t slab_start[B2ND_MAX_DIM];
+    int64_t slab_stop[B2ND_MAX_DIM];
+    int64_t dst_start[B2ND_MAX_DIM] = {0};
+    memcpy(slab_start, start, ndim * sizeof(int64_t));
+    memcpy(slab_stop, stop, ndim * sizeof(int64_t));
+    slab_start[0] = (start[0] > array_nrows ? start[0] : array_nrows) - appender->base;
+    slab_stop[0] = stop[0] - appender->base;
+    dst_start[0] = slab_start[0] + appender->base - start[0];
+    BLOSC_ERROR(b2nd_copy_buffer(ndim, (uint8_t) array->sc->typesize, appender->slab,
+                                 appender->slab_shape, slab_start, slab_stop, buffer, buffershape,
+                                 dst_start));
+  }
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_appender_free(b2nd_appender_t *appender) {
+  if (appender == NULL) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  int rc = appender->npending > 0 ? b2nd_appender_flush(appender) : BLOSC2_ERROR_SUCCESS;
+  free(appender->slab);
+  free(appender->data);
+  free(appender);
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_delete(b2nd_array_t *array, const int8_t axis,
+                int64_t delete_start, int64_t delete_len) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+
+  if (axis >= array->ndim) {
+    BLOSC_TRACE_ERROR("axis cannot be greater than the number of dimensions");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
   }
 
 
@@ -1524,305 +2580,417 @@ typedef struct {
 
 
 int compare_selection(const void *a, const void *b) {
-  int res = (int) (((b2nd_selection_t *) a)->value - ((b2nd_selection_t *) b)->value);
+  const b2nd_selection_t *sel_a = (const b2nd_selection_t *) a;
+  const b2nd_selection_t *sel_b = (const b2nd_selection_t *) b;
+  if (sel_a->value != sel_b->value) {
+    return sel_a->value < sel_b->value ? -1 : 1;
+  }
   // In case values are equal, sort by index
-  if (res == 0) {
-    res = (int) (((b2nd_selection_t *) a)->index - ((b2nd_selection_t *) b)->index);
-  }
-  return res;
-}
-
-
-int copy_block_buffer_data(b2nd_array_t *array,
-                           int8_t ndim,
-                           int64_t *block_selection_size,
-                           b2nd_selection_t **chunk_selection,
-                           b2nd_selection_t **p_block_selection_0,
-                           b2nd_selection_t **p_block_selection_1,
-                           uint8_t *block,
-                           uint8_t *buffer,
-                           int64_t *buffershape,
-                           int64_t *bufferstrides,
-                           bool get) {
-  p_block_selection_0[ndim] = chunk_selection[ndim];
-  p_block_selection_1[ndim] = chunk_selection[ndim];
-  while (p_block_selection_1[ndim] - p_block_selection_0[ndim] < block_selection_size[ndim]) {
-    if (ndim == array->ndim - 1) {
-
-      int64_t index_in_block_n[B2ND_MAX_DIM];
-      for (int i = 0; i < array->ndim; ++i) {
-        index_in_block_n[i] = p_block_selection_1[i]->value % array->chunkshape[i] % array->blockshape[i];
-      }
-      int64_t index_in_block = 0;
-      for (int i = 0; i < array->ndim; ++i) {
-        index_in_block += index_in_block_n[i] * array->item_block_strides[i];
-      }
+  return sel_a->index < sel_b->index ? -1 : (sel_a->index > sel_b->index);
+}
 
-      int64_t index_in_buffer_n[B2ND_MAX_DIM];
-      for (int i = 0; i < array->ndim; ++i) {
-        index_in_buffer_n[i] = p_block_selection_1[i]->index;
-      }
-      int64_t index_in_buffer = 0;
-      for (int i = 0; i < array->ndim; ++i) {
-        index_in_buffer += index_in_buffer_n[i] * bufferstrides[i];
-      }
-      if (get) {
-        memcpy(&buffer[index_in_buffer * array->sc->typesize],
-               &block[index_in_block * array->sc->typesize],
-               array->sc->typesize);
-      } else {
-        memcpy(&block[index_in_block * array->sc->typesize],
-               &buffer[index_in_buffer * array->sc->typesize],
-               array->sc->typesize);
-      }
-    } else {
-      BLOSC_ERROR(copy_block_buffer_data(array, (int8_t) (ndim + 1), block_selection_size,
-                                         chunk_selection,
-                                         p_block_selection_0, p_block_selection_1, block,
-                                         buffer, buffershape, bufferstrides, get)
-      );
-    }
-    p_block_selection_1[ndim]++;
+
+/* The sorted selection along a dimension, split in runs of items lying in the same chunk */
+typedef struct {
+  b2nd_selection_t *items;
+  int64_t *nblock;      // the block of every item inside its chunk (along the dimension)
+  int64_t *nitem;       // the position of every item inside its block (along the dimension)
+  int64_t *runs;        // the first item of every run (plus the number of items)
+  int64_t *run_nchunk;  // the chunk of every run (along the dimension)
+  int64_t nruns;
+  int64_t max_run;      // the number of items of the longest run
+} oindex_dim;
+
+
+/* The state of an orthogonal selection, shared by the workers when chunks go in parallel */
+typedef struct {
+  b2nd_array_t *array;
+  uint8_t *buffer;
+  bool get;
+  oindex_dim dims[B2ND_MAX_DIM];
+  int64_t runs_shape[B2ND_MAX_DIM];  // the number of runs along every dimension
+  int64_t nchunks;                   // the number of chunks visited by the selection
+  int64_t bufferstrides[B2ND_MAX_DIM];
+  int64_t chunk_strides[B2ND_MAX_DIM];
+  int64_t block_strides[B2ND_MAX_DIM];
+  b2nd_zonemap *zonemap;   // the zones of the chunks that are set are updated here (if not NULL)
+  bool parallel;           // the super-chunk is shared by several workers
+  blosc2_cparams cparams;  // params for the worker contexts
+  blosc2_dparams dparams;
+  int64_t next;            // next chunk to be processed by a worker
+  int error;
+  pthread_mutex_t mutex;   // serializes the accesses to the super-chunk
+} oindex_job;
+
+
+/* The scratch of a worker, allocated once for all the chunks that it processes */
+typedef struct {
+  uint8_t *data;    // a chunk
+  bool *maskout;    // the blocks of a chunk
+  int64_t *blocks;  // the distinct blocks of a run along every dimension
+} oindex_scratch;
+
+
+static int oindex_scratch_init(oindex_job *job, oindex_scratch *scratch) {
+  b2nd_array_t *array = job->array;
+  int64_t nblocks = 0;
+  for (int i = 0; i < array->ndim; ++i) {
+    nblocks += job->dims[i].max_run;
+  }
+  scratch->data = malloc(array->extchunknitems * array->sc->typesize);
+  scratch->maskout = malloc(array->extchunknitems / array->blocknitems);
+  scratch->blocks = malloc(nblocks * sizeof(int64_t));
+  if (scratch->data == NULL || scratch->maskout == NULL || scratch->blocks == NULL) {
+    BLOSC_ERROR(BLOSC2_ERROR_MEMORY_ALLOC);
   }
   return BLOSC2_ERROR_SUCCESS;
 }
 
 
-int iter_block_copy(b2nd_array_t *array, int8_t ndim,
-                    int64_t *chunk_selection_size,
-                    b2nd_selection_t **ordered_selection,
-                    b2nd_selection_t **chunk_selection_0,
-                    b2nd_selection_t **chunk_selection_1,
-                    uint8_t *data,
-                    uint8_t *buffer,
-                    int64_t *buffershape,
-                    int64_t *bufferstrides,
-                    bool get) {
-  chunk_selection_0[ndim] = ordered_selection[ndim];
-  chunk_selection_1[ndim] = ordered_selection[ndim];
-  while (chunk_selection_1[ndim] - ordered_selection[ndim] < chunk_selection_size[ndim]) {
-    int64_t block_index_ndim = ((*chunk_selection_1[ndim]).value % array->chunkshape[ndim]) / array->blockshape[ndim];
-    while (chunk_selection_1[ndim] - ordered_selection[ndim] < chunk_selection_size[ndim] &&
-           block_index_ndim == ((*chunk_selection_1[ndim]).value % array->chunkshape[ndim]) / array->blockshape[ndim]) {
-      chunk_selection_1[ndim]++;
-    }
-    if (ndim == array->ndim - 1) {
-      int64_t block_chunk_strides[B2ND_MAX_DIM];
-      block_chunk_strides[array->ndim - 1] = 1;
-      for (int i = array->ndim - 2; i >= 0; --i) {
-        block_chunk_strides[i] = block_chunk_strides[i + 1] * (array->extchunkshape[i + 1] / array->blockshape[i + 1]);
-      }
-      int64_t block_index[B2ND_MAX_DIM];
-      for (int i = 0; i < array->ndim; ++i) {
-        block_index[i] = ((*chunk_selection_0[i]).value % array->chunkshape[i]) / array->blockshape[i];
-      }
-      int64_t nblock = 0;
-      for (int i = 0; i < array->ndim; ++i) {
-        nblock += block_index[i] * block_chunk_strides[i];
-      }
-      b2nd_selection_t **p_block_selection_0 = malloc(array->ndim * sizeof(b2nd_selection_t *));
-      BLOSC_ERROR_NULL(p_block_selection_0, BLOSC2_ERROR_MEMORY_ALLOC);
-      b2nd_selection_t **p_block_selection_1 = malloc(array->ndim * sizeof(b2nd_selection_t *));
-      BLOSC_ERROR_NULL(p_block_selection_1, BLOSC2_ERROR_MEMORY_ALLOC);
-      int64_t *block_selection_size = malloc(array->ndim * sizeof(int64_t));
-      BLOSC_ERROR_NULL(block_selection_size, BLOSC2_ERROR_MEMORY_ALLOC);
-      for (int i = 0; i < array->ndim; ++i) {
-        block_selection_size[i] = chunk_selection_1[i] - chunk_selection_0[i];
-      }
+static void oindex_scratch_free(oindex_scratch *scratch) {
+  free(scratch->data);
+  free(scratch->maskout);
+  free(scratch->blocks);
+}
 
-      BLOSC_ERROR(copy_block_buffer_data(array,
-                                         (int8_t) 0,
-                                         block_selection_size,
-                                         chunk_selection_0,
-                                         p_block_selection_0,
-                                         p_block_selection_1,
-                                         &data[nblock * array->blocknitems * array->sc->typesize],
-                                         buffer,
-                                         buffershape,
-                                         bufferstrides,
-                                         get)
-      );
-      free(p_block_selection_0);
-      free(p_block_selection_1);
-      free(block_selection_size);
-    } else {
-      BLOSC_ERROR(iter_block_copy(array, (int8_t) (ndim + 1), chunk_selection_size,
-                                  ordered_selection, chunk_selection_0, chunk_selection_1,
-                                  data, buffer, buffershape, bufferstrides, get)
-      );
-    }
-    chunk_selection_0[ndim] = chunk_selection_1[ndim];
 
+static void oindex_lock(oindex_job *job) {
+  if (job->parallel) {
+    pthread_mutex_lock(&job->mutex);
   }
+}
 
-  return BLOSC2_ERROR_SUCCESS;
+static void oindex_unlock(oindex_job *job) {
+  if (job->parallel) {
+    pthread_mutex_unlock(&job->mutex);
+  }
 }
 
 
-int iter_block_maskout(b2nd_array_t *array, int8_t ndim,
-                       int64_t *sel_block_size,
-                       b2nd_selection_t **o_selection,
-                       b2nd_selection_t **p_o_sel_block_0,
-                       b2nd_selection_t **p_o_sel_block_1,
-                       bool *maskout) {
-  p_o_sel_block_0[ndim] = o_selection[ndim];
-  p_o_sel_block_1[ndim] = o_selection[ndim];
-  while (p_o_sel_block_1[ndim] - o_selection[ndim] < sel_block_size[ndim]) {
-    int64_t block_index_ndim = ((*p_o_sel_block_1[ndim]).value % array->chunkshape[ndim]) / array->blockshape[ndim];
-    while (p_o_sel_block_1[ndim] - o_selection[ndim] < sel_block_size[ndim] &&
-           block_index_ndim == ((*p_o_sel_block_1[ndim]).value % array->chunkshape[ndim]) / array->blockshape[ndim]) {
-      p_o_sel_block_1[ndim]++;
-    }
-    if (ndim == array->ndim - 1) {
-      int64_t block_chunk_strides[B2ND_MAX_DIM];
-      block_chunk_strides[array->ndim - 1] = 1;
-      for (int i = array->ndim - 2; i >= 0; --i) {
-        block_chunk_strides[i] = block_chunk_strides[i + 1] * (array->extchunkshape[i + 1] / array->blockshape[i + 1]);
-      }
-      int64_t block_index[B2ND_MAX_DIM];
-      for (int i = 0; i < array->ndim; ++i) {
-        block_index[i] = ((*p_o_sel_block_0[i]).value % array->chunkshape[i]) / array->blockshape[i];
-      }
-      int64_t nblock = 0;
-      for (int i = 0; i < array->ndim; ++i) {
-        nblock += block_index[i] * block_chunk_strides[i];
+/* Mask out the blocks of a chunk that hold no item of the selection */
+static void oindex_maskout(oindex_job *job, oindex_scratch *scratch, const int64_t *first,
+                           const int64_t *last) {
+  b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+  int64_t nblocks = array->extchunknitems / array->blocknitems;
+  memset(scratch->maskout, true, nblocks);
+
+  // The items of a run are sorted, and so are their blocks
+  int64_t *blocks[B2ND_MAX_DIM];
+  int64_t blocks_shape[B2ND_MAX_DIM];
+  int64_t *p = scratch->blocks;
+  for (int i = 0; i < ndim; ++i) {
+    const oindex_dim *dim = &job->dims[i];
+    blocks[i] = p;
+    blocks_shape[i] = 0;
+    for (int64_t j = first[i]; j < last[i]; ++j) {
+      if (blocks_shape[i] == 0 || blocks[i][blocks_shape[i] - 1] != dim->nblock[j]) {
+        blocks[i][blocks_shape[i]++] = dim->nblock[j];
       }
-      maskout[nblock] = false;
-    } else {
-      BLOSC_ERROR(iter_block_maskout(array, (int8_t) (ndim + 1), sel_block_size,
-                                     o_selection, p_o_sel_block_0, p_o_sel_block_1,
-                                     maskout)
-      );
     }
-    p_o_sel_block_0[ndim] = p_o_sel_block_1[ndim];
-
+    p += dim->max_run;
   }
 
-  return BLOSC2_ERROR_SUCCESS;
+  int64_t pos[B2ND_MAX_DIM] = {0};
+  while (true) {
+    int64_t nblock = 0;
+    for (int i = 0; i < ndim; ++i) {
+      nblock += blocks[i][pos[i]] * job->block_strides[i];
+    }
+    scratch->maskout[nblock] = false;
+    int i = ndim - 1;
+    for (; i >= 0; --i) {
+      if (++pos[i] < blocks_shape[i]) {
+        break;
+      }
+      pos[i] = 0;
+    }
+    if (i < 0) {
+      break;
+    }
+  }
 }
 
 
-int iter_chunk(b2nd_array_t *array, int8_t ndim,
-               int64_t *selection_size,
-               b2nd_selection_t **ordered_selection,
-               b2nd_selection_t **p_ordered_selection_0,
-               b2nd_selection_t **p_ordered_selection_1,
-               uint8_t *buffer,
-               int64_t *buffershape,
-               int64_t *bufferstrides,
-               bool get) {
-  p_ordered_selection_0[ndim] = ordered_selection[ndim];
-  p_ordered_selection_1[ndim] = ordered_selection[ndim];
-  while (p_ordered_selection_1[ndim] - ordered_selection[ndim] < selection_size[ndim]) {
-    int64_t chunk_index_ndim = (*p_ordered_selection_1[ndim]).value / array->chunkshape[ndim];
-    while (p_ordered_selection_1[ndim] - ordered_selection[ndim] < selection_size[ndim] &&
-           chunk_index_ndim == (*p_ordered_selection_1[ndim]).value / array->chunkshape[ndim]) {
-      p_ordered_selection_1[ndim]++;
-    }
-    if (ndim == array->ndim - 1) {
-      int64_t chunk_array_strides[B2ND_MAX_DIM];
-      chunk_array_strides[array->ndim - 1] = 1;
-      for (int i = array->ndim - 2; i >= 0; --i) {
-        chunk_array_strides[i] = chunk_array_strides[i + 1] *
-                                 (array->extshape[i + 1] / array->chunkshape[i + 1]);
-      }
-      int64_t chunk_index[B2ND_MAX_DIM];
-      for (int i = 0; i < array->ndim; ++i) {
-        chunk_index[i] = (*p_ordered_selection_0[i]).value / array->chunkshape[i];
+/* Copy the items of the selection between the buffer and a chunk */
+static void oindex_copy(oindex_job *job, const int64_t *first, const int64_t *last, uint8_t *data) {
+  b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+  int32_t typesize = array->sc->typesize;
+  const oindex_dim *inner = &job->dims[ndim - 1];
+  int64_t inner_stride = job->bufferstrides[ndim - 1];
+
+  // The outer dimensions are iterated like an odometer, and the inner one in a plain loop
+  int64_t pos[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim - 1; ++i) {
+    pos[i] = first[i];
+  }
+  while (true) {
+    int64_t nblock = 0;
+    int64_t nitem = 0;
+    int64_t index = 0;
+    for (int i = 0; i < ndim - 1; ++i) {
+      const oindex_dim *dim = &job->dims[i];
+      nblock += dim->nblock[pos[i]] * job->block_strides[i];
+      nitem += dim->nitem[pos[i]] * array->item_block_strides[i];
+      index += dim->items[pos[i]].index * job->bufferstrides[i];
+    }
+    for (int64_t j = first[ndim - 1]; j < last[ndim - 1]; ++j) {
+      int64_t chunk_offset = (nblock + inner->nblock[j]) * array->blocknitems + nitem + inner->nitem[j];
+      int64_t buffer_offset = index + inner->items[j].index * inner_stride;
+      if (job->get) {
+        memcpy(&job->buffer[buffer_offset * typesize], &data[chunk_offset * typesize], typesize);
+      } else {
+        memcpy(&data[chunk_offset * typesize], &job->buffer[buffer_offset * typesize], typesize);
       }
-      int64_t nchunk = 0;
-      for (int i = 0; i < array->ndim; ++i) {
-        nchunk += chunk_index[i] * chunk_array_strides[i];
+    }
+    int i = ndim - 2;
+    for (; i >= 0; --i) {
+      if (++pos[i] < last[i]) {
+        break;
       }
+      pos[i] = first[i];
+    }
+    if (i < 0) {
+      break;
+    }
+  }
+}
 
-      int64_t nblocks = array->extchunknitems / array->blocknitems;
-      b2nd_selection_t **p_chunk_selection_0 = malloc(array->ndim * sizeof(b2nd_selection_t *));
-      BLOSC_ERROR_NULL(p_chunk_selection_0, BLOSC2_ERROR_MEMORY_ALLOC);
-      b2nd_selection_t **p_chunk_selection_1 = malloc(array->ndim * sizeof(b2nd_selection_t *));
-      BLOSC_ERROR_NULL(p_chunk_selection_1, BLOSC2_ERROR_MEMORY_ALLOC);
-      int64_t *chunk_selection_size = malloc(array->ndim * sizeof(int64_t));
-      BLOSC_ERROR_NULL(chunk_selection_size, BLOSC2_ERROR_MEMORY_ALLOC);
-      for (int i = 0; i < array->ndim; ++i) {
-        chunk_selection_size[i] = p_ordered_selection_1[i] - p_ordered_selection_0[i];
-      }
 
-      if (get) {
-        bool *maskout = calloc(nblocks, sizeof(bool));
-        for (int i = 0; i < nblocks; ++i) {
-          maskout[i] = true;
-        }
+/* Get or set the items of the selection lying in one of the chunks that it visits */
+static int oindex_chunk(oindex_job *job, oindex_scratch *scratch, int64_t nvisit, blosc2_context *cctx,
+                        blosc2_context *dctx) {
+  b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+  int64_t run[B2ND_MAX_DIM] = {0};
+  blosc2_unidim_to_multidim(ndim, job->runs_shape, nvisit, run);
+  int64_t first[B2ND_MAX_DIM];
+  int64_t last[B2ND_MAX_DIM];
+  int64_t nchunk = 0;
+  for (int i = 0; i < ndim; ++i) {
+    const oindex_dim *dim = &job->dims[i];
+    first[i] = dim->runs[run[i]];
+    last[i] = dim->runs[run[i] + 1];
+    nchunk += dim->run_nchunk[run[i]] * job->chunk_strides[i];
+  }
 
-        BLOSC_ERROR(iter_block_maskout(array, (int8_t) 0,
-                                       chunk_selection_size,
-                                       p_ordered_selection_0,
-                                       p_chunk_selection_0,
-                                       p_chunk_selection_1,
-                                       maskout));
+  int32_t nblocks = (int32_t) (array->extchunknitems / array->blocknitems);
+  int32_t data_nbytes = (int32_t) array->extchunknitems * array->sc->typesize;
+  uint8_t *chunk = NULL;
+  bool chunk_needs_free = false;
+  oindex_lock(job);
+  // Lazy chunks only read the blocks that are not masked out
+  int cbytes = blosc2_schunk_get_lazychunk(array->sc, nchunk, &chunk, &chunk_needs_free);
+  if (cbytes < 0) {
+    oindex_unlock(job);
+    BLOSC_TRACE_ERROR("Error getting chunk");
+    BLOSC_ERROR(cbytes);
+  }
+  if (!job->get && job->parallel && cbytes > 0 && !chunk_needs_free) {
+    // Other workers may move the storage of the super-chunk when updating their chunks
+    uint8_t *chunk_copy = malloc(cbytes);
+    if (chunk_copy != NULL) {
+      memcpy(chunk_copy, chunk, cbytes);
+      chunk_needs_free = true;
+    }
+    chunk = chunk_copy;
+  }
+  oindex_unlock(job);
+  BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
 
-        if (blosc2_set_maskout(array->sc->dctx, maskout, (int) nblocks) !=
-            BLOSC2_ERROR_SUCCESS) {
-          BLOSC_TRACE_ERROR("Error setting the maskout");
-          BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-        }
-        free(maskout);
-      }
-      int data_nitems = (int) array->extchunknitems;
-      int data_nbytes = data_nitems * array->sc->typesize;
-      uint8_t *data = malloc(data_nitems * array->sc->typesize);
-      BLOSC_ERROR_NULL(data, BLOSC2_ERROR_MEMORY_ALLOC);
-      int err = blosc2_schunk_decompress_chunk(array->sc, nchunk, data, data_nbytes);
-      if (err < 0) {
-        BLOSC_TRACE_ERROR("Error decompressing chunk");
-        BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-      }
-      BLOSC_ERROR(iter_block_copy(array, 0, chunk_selection_size,
-                                  p_ordered_selection_0, p_chunk_selection_0, p_chunk_selection_1,
-                                  data, buffer, buffershape, bufferstrides, get));
-
-      if (!get) {
-        int32_t chunk_size = data_nbytes + BLOSC_EXTENDED_HEADER_LENGTH;
-        uint8_t *chunk = malloc(chunk_size);
-        BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
-        err = blosc2_compress_ctx(array->sc->cctx, data, data_nbytes, chunk, chunk_size);
-        if (err < 0) {
-          BLOSC_TRACE_ERROR("Error compressing data");
-          BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-        }
-        err = (int) blosc2_schunk_update_chunk(array->sc, nchunk, chunk, false);
-        if (err < 0) {
-          BLOSC_TRACE_ERROR("Error updating chunk");
-          BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
-        }
+  // Setting needs the whole chunk for recompressing it
+  if (job->get) {
+    oindex_maskout(job, scratch, first, last);
+    if (schunk_set_chunk_maskout(dctx, chunk, scratch->maskout, nblocks) != BLOSC2_ERROR_SUCCESS) {
+      if (chunk_needs_free) {
+        free(chunk);
       }
-      free(data);
-      free(chunk_selection_size);
-      free(p_chunk_selection_0);
-      free(p_chunk_selection_1);
-    } else {
-      BLOSC_ERROR(iter_chunk(array, (int8_t) (ndim + 1), selection_size,
-                             ordered_selection, p_ordered_selection_0, p_ordered_selection_1,
-                             buffer, buffershape, bufferstrides, get));
+      BLOSC_TRACE_ERROR("Error setting the maskout");
+      BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
     }
+  }
+  // Update current_chunk in case a postfilter is applied
+  if (!job->parallel) {
+    array->sc->current_nchunk = nchunk;
+  }
+  int err = blosc2_decompress_ctx(dctx, chunk, cbytes, scratch->data, data_nbytes);
+  if (chunk_needs_free) {
+    free(chunk);
+  }
+  if (err < 0) {
+    BLOSC_TRACE_ERROR("Error decompressing chunk");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
 
-    p_ordered_selection_0[ndim] = p_ordered_selection_1[ndim];
+  oindex_copy(job, first, last, scratch->data);
+  if (job->get) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  // Every thread updates the zones of different chunks
+  if (job->zonemap != NULL) {
+    BLOSC_ERROR(b2nd_zonemap_update(array, job->zonemap, nchunk, scratch->data, NULL));
+  }
+  // The super-chunk takes ownership of the new chunk
+  int32_t chunk_nbytes = data_nbytes + BLOSC2_MAX_OVERHEAD;
+  chunk = malloc(chunk_nbytes);
+  BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
+  // Update current_chunk in case a prefilter is applied
+  if (!job->parallel) {
+    array->sc->current_nchunk = nchunk;
+  }
+  if (blosc2_compress_ctx(cctx, scratch->data, data_nbytes, chunk, chunk_nbytes) < 0) {
+    free(chunk);
+    BLOSC_TRACE_ERROR("Error compressing data");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+  if (job->zonemap != NULL) {
+    b2nd_zonemap_set_chunk(job->zonemap, nchunk, chunk);
   }
+  oindex_lock(job);
+  int64_t rc = blosc2_schunk_update_chunk(array->sc, nchunk, chunk, false);
+  oindex_unlock(job);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error updating chunk");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+
   return BLOSC2_ERROR_SUCCESS;
 }
 
 
+static void *oindex_worker(void *arg) {
+  oindex_job *job = (oindex_job *) arg;
+  blosc2_context *cctx = job->get ? NULL : blosc2_create_cctx(job->cparams);
+  blosc2_context *dctx = blosc2_create_dctx(job->dparams);
+  oindex_scratch scratch = {0};
+  int scratch_rc = oindex_scratch_init(job, &scratch);
+
+  pthread_mutex_lock(&job->mutex);
+  if (dctx == NULL || (!job->get && cctx == NULL) || scratch_rc < 0) {
+    job->error = BLOSC2_ERROR_FAILURE;
+  }
+  while (job->error == 0 && job->next < job->nchunks) {
+    int64_t nvisit = job->next++;
+    pthread_mutex_unlock(&job->mutex);
+    int rc = oindex_chunk(job, &scratch, nvisit, cctx, dctx);
+    pthread_mutex_lock(&job->mutex);
+    if (rc < 0 && job->error == 0) {
+      job->error = rc;
+    }
+  }
+  pthread_mutex_unlock(&job->mutex);
+
+  oindex_scratch_free(&scratch);
+  if (cctx != NULL) {
+    blosc2_free_ctx(cctx);
+  }
+  if (dctx != NULL) {
+    blosc2_free_ctx(dctx);
+  }
+  return NULL;
+}
+
+
+/* Process the chunks visited by the selection with `nworkers` workers, each one with its own
+ * contexts (using `nthreads` threads) and scratch.  When getting, every item of the buffer is
+ * written by a single chunk. */
+static int oindex_parallel(oindex_job *job, int nworkers, int nthreads) {
+  blosc2_ctx_get_cparams(job->array->sc->cctx, &job->cparams);
+  blosc2_ctx_get_dparams(job->array->sc->dctx, &job->dparams);
+  job->cparams.nthreads = (int16_t) nthreads;
+  job->dparams.nthreads = (int16_t) nthreads;
+  job->parallel = true;
+  pthread_mutex_init(&job->mutex, NULL);
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  pthread_t *threads = malloc(nworkers * sizeof(pthread_t));
+  BLOSC_ERROR_NULL(threads, BLOSC2_ERROR_MEMORY_ALLOC);
+  int nstarted = 0;
+  for (; nstarted < nworkers; nstarted++) {
+    if (pthread_create(&threads[nstarted], NULL, oindex_worker, job) != 0) {
+      BLOSC_TRACE_ERROR("Cannot create a selection thread.");
+      rc = BLOSC2_ERROR_THREAD_CREATE;
+      pthread_mutex_lock(&job->mutex);
+      job->error = rc;
+      pthread_mutex_unlock(&job->mutex);
+      break;
+    }
+  }
+  for (int i = 0; i < nstarted; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+  pthread_mutex_destroy(&job->mutex);
+
+  return job->error < 0 ? job->error : rc;
+}
+
+
+/* Sort the selection along a dimension and split it in runs by chunk */
+static int oindex_dim_init(const b2nd_array_t *array, int dim, const int64_t *selection, int64_t size,
+                           oindex_dim *oindex) {
+  oindex->items = malloc(size * sizeof(b2nd_selection_t));
+  oindex->nblock = malloc(size * sizeof(int64_t));
+  oindex->nitem = malloc(size * sizeof(int64_t));
+  oindex->runs = malloc((size + 1) * sizeof(int64_t));
+  oindex->run_nchunk = malloc(size * sizeof(int64_t));
+  if (oindex->items == NULL || oindex->nblock == NULL || oindex->nitem == NULL ||
+      oindex->runs == NULL || oindex->run_nchunk == NULL) {
+    BLOSC_ERROR(BLOSC2_ERROR_MEMORY_ALLOC);
+  }
+  for (int64_t i = 0; i < size; ++i) {
+    oindex->items[i].index = i;
+    oindex->items[i].value = selection[i];
+  }
+  qsort(oindex->items, size, sizeof(b2nd_selection_t), compare_selection);
+
+  int32_t chunkshape = array->chunkshape[dim];
+  int32_t blockshape = array->blockshape[dim];
+  oindex->nruns = 0;
+  oindex->max_run = 0;
+  for (int64_t i = 0; i < size; ++i) {
+    int64_t value = oindex->items[i].value;
+    oindex->nblock[i] = value % chunkshape / blockshape;
+    oindex->nitem[i] = value % chunkshape % blockshape;
+    if (i == 0 || value / chunkshape != oindex->run_nchunk[oindex->nruns - 1]) {
+      oindex->runs[oindex->nruns] = i;
+      oindex->run_nchunk[oindex->nruns] = value / chunkshape;
+      oindex->nruns++;
+    }
+    int64_t run = i + 1 - oindex->runs[oindex->nruns - 1];
+    oindex->max_run = run > oindex->max_run ? run : oindex->max_run;
+  }
+  oindex->runs[oindex->nruns] = size;
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static void oindex_dim_free(oindex_dim *oindex) {
+  free(oindex->items);
+  free(oindex->nblock);
+  free(oindex->nitem);
+  free(oindex->runs);
+  free(oindex->run_nchunk);
+}
+
+
 int orthogonal_selection(b2nd_array_t *array, int64_t **selection, int64_t *selection_size, void *buffer,
                          int64_t *buffershape, int64_t buffersize, bool get) {
   BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(selection, BLOSC2_ERROR_NULL_POINTER);
   BLOSC_ERROR_NULL(selection_size, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
 
   int8_t ndim = array->ndim;
 
   for (int i = 0; i < ndim; ++i) {
     BLOSC_ERROR_NULL(selection[i], BLOSC2_ERROR_NULL_POINTER);
-    // Check that indexes are not larger than array shape
+    // Check that indexes are inside the array
     for (int j = 0; j < selection_size[i]; ++j) {
-      if (selection[i][j] > array->shape[i]) {
+      if (selection[i][j] < 0 || selection[i][j] >= array->shape[i]) {
         BLOSC_ERROR(BLOSC2_ERROR_INVALID_INDEX);
       }
     }
@@ -1830,51 +2998,84 @@ int orthogonal_selection(b2nd_array_t *array, int64_t **selection, int64_t *sele
 
   // Check buffer size
   int64_t sel_size = array->sc->typesize;
+  int64_t buffer_nbytes = array->sc->typesize;
   for (int i = 0; i < ndim; ++i) {
+    BLOSC_ERROR_NULL(buffershape, BLOSC2_ERROR_NULL_POINTER);
+    if (buffershape[i] < selection_size[i]) {
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
     sel_size *= selection_size[i];
+    buffer_nbytes *= buffershape[i];
   }
-
-  if (sel_size < buffersize) {
+  if (buffersize < buffer_nbytes) {
     BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
   }
-
-  // Sort selections
-  b2nd_selection_t **ordered_selection = malloc(ndim * sizeof(b2nd_selection_t *));
-  BLOSC_ERROR_NULL(ordered_selection, BLOSC2_ERROR_MEMORY_ALLOC);
-  for (int i = 0; i < ndim; ++i) {
-    ordered_selection[i] = malloc(selection_size[i] * sizeof(b2nd_selection_t));
-    for (int j = 0; j < selection_size[i]; ++j) {
-      ordered_selection[i][j].index = j;
-      ordered_selection[i][j].value = selection[i][j];
-    }
-    qsort(ordered_selection[i], selection_size[i], sizeof(b2nd_selection_t), compare_selection);
+  if (sel_size == 0) {
+    return BLOSC2_ERROR_SUCCESS;
   }
 
-  // Define pointers to iterate over ordered_selection data
-  b2nd_selection_t **p_ordered_selection_0 = malloc(ndim * sizeof(b2nd_selection_t *));
-  BLOSC_ERROR_NULL(p_ordered_selection_0, BLOSC2_ERROR_MEMORY_ALLOC);
-  b2nd_selection_t **p_ordered_selection_1 = malloc(ndim * sizeof(b2nd_selection_t *));
-  BLOSC_ERROR_NULL(p_ordered_selection_1, BLOSC2_ERROR_MEMORY_ALLOC);
+  // 0-dim case
+  if (ndim == 0) {
+    int64_t start[B2ND_MAX_DIM] = {0};
+    return get_set_slice(buffer, buffersize, start, start, start, array, !get);
+  }
+
+  oindex_job job = {0};
+  job.array = array;
+  job.buffer = buffer;
+  job.get = get;
+  job.nchunks = 1;
+  int rc = BLOSC2_ERROR_SUCCESS;
+  for (int i = 0; i < ndim && rc >= 0; ++i) {
+    rc = oindex_dim_init(array, i, selection[i], selection_size[i], &job.dims[i]);
+    job.runs_shape[i] = job.dims[i].nruns;
+    job.nchunks *= job.dims[i].nruns;
+  }
+  job.bufferstrides[ndim - 1] = 1;
+  job.chunk_strides[ndim - 1] = 1;
+  job.block_strides[ndim - 1] = 1;
+  for (int i = ndim - 2; i >= 0; --i) {
+    job.bufferstrides[i] = job.bufferstrides[i + 1] * buffershape[i + 1];
+    job.chunk_strides[i] = job.chunk_strides[i + 1] * (array->extshape[i + 1] / array->chunkshape[i + 1]);
+    job.block_strides[i] = job.block_strides[i + 1] * (array->extchunkshape[i + 1] / array->blockshape[i + 1]);
+  }
 
-  int64_t bufferstrides[B2ND_MAX_DIM];
-  bufferstrides[array->ndim - 1] = 1;
-  for (int i = array->ndim - 2; i >= 0; --i) {
-    bufferstrides[i] = bufferstrides[i + 1] * buffershape[i + 1];
+  // The zone map (if any) follows the chunks that are set
+  if (rc >= 0 && !get) {
+    rc = b2nd_zonemap_get(array, &job.zonemap);
   }
 
-  BLOSC_ERROR(iter_chunk(array, 0,
-                         selection_size, ordered_selection,
-                         p_ordered_selection_0,
-                         p_ordered_selection_1,
-                         buffer, buffershape, bufferstrides, get));
+  // Spread the threads over the chunks when the selection visits several of them.  Pre- and
+  // postfilters may depend on the state of the super-chunk, so they keep the serial path.
+  int nthreads = get ? array->sc->dctx->nthreads : array->sc->cctx->nthreads;
+  int nworkers = job.nchunks < nthreads ? (int) job.nchunks : nthreads;
+  if (rc >= 0) {
+    if (nworkers > 1 && array->sc->cctx->prefilter == NULL && array->sc->dctx->postfilter == NULL) {
+      rc = oindex_parallel(&job, nworkers, nthreads / nworkers);
+    }
+    else {
+      oindex_scratch scratch = {0};
+      rc = oindex_scratch_init(&job, &scratch);
+      for (int64_t nvisit = 0; nvisit < job.nchunks && rc >= 0; ++nvisit) {
+        rc = oindex_chunk(&job, &scratch, nvisit, array->sc->cctx, array->sc->dctx);
+      }
+      oindex_scratch_free(&scratch);
+    }
+  }
 
-  // Free allocated memory
-  free(p_ordered_selection_0);
-  free(p_ordered_selection_1);
+  if (job.zonemap != NULL) {
+    // Zones may be ahead of the chunks after an error.  Otherwise, the zone map is stored when
+    // the array is freed or serialized.
+    if (rc >= 0) {
+      job.zonemap->dirty = true;
+    } else {
+      b2nd_zonemap_drop(array);
+    }
+  }
   for (int i = 0; i < ndim; ++i) {
-    free(ordered_selection[i]);
+    oindex_dim_free(&job.dims[i]);
   }
-  free(ordered_selection);
+  BLOSC_ERROR(rc);
 
   return BLOSC2_ERROR_SUCCESS;
 }
@@ -1888,7 +3089,27 @@ int b2nd_get_orthogonal_selection(const b2nd_array_t *array, int64_t **selection
 
 int b2nd_set_orthogonal_selection(b2nd_array_t *array, int64_t **selection, int64_t *selection_size, const void *buffer,
                                   int64_t *buffershape, int64_t buffersize) {
-  return orthogonal_selection(array, selection, selection_size, (void*)buffer, buffershape, buffersize, false);
+  BLOSC_ERROR(orthogonal_selection(array, selection, selection_size, (void*)buffer, buffershape, buffersize,
+                                   false));
+
+  // The levels of the pyramid (if any) are updated over the bounding box of the selection
+  if (array->ndim > 0 && blosc2_vlmeta_exists(array->sc, B2ND_PYRAMID_NAME) >= 0) {
+    int64_t start[B2ND_MAX_DIM];
+    int64_t stop[B2ND_MAX_DIM];
+    for (int i = 0; i < array->ndim; ++i) {
+      if (selection_size[i] == 0) {
+        return BLOSC2_ERROR_SUCCESS;
+      }
+      start[i] = selection[i][0];
+      stop[i] = selection[i][0] + 1;
+      for (int64_t j = 1; j < selection_size[i]; ++j) {
+        start[i] = selection[i][j] < start[i] ? selection[i][j] : start[i];
+        stop[i] = selection[i][j] >= stop[i] ? selection[i][j] + 1 : stop[i];
+      }
+    }
+    BLOSC_ERROR(b2nd_pyramid_update(array, start, stop));
+  }
+  return BLOSC2_ERROR_SUCCESS;
 }
 
 
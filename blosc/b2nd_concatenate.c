@@ -0,0 +1,359 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "schunk-private.h"
+#include "blosc2/blosc2-common.h"
+#include "blosc2.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* An array to be concatenated, along the axes of the new array */
+typedef struct {
+  const b2nd_array_t *array;
+  int64_t offset;                // where it starts along the concatenation axis
+  int64_t shape[B2ND_MAX_DIM];
+  int64_t chunks_strides[B2ND_MAX_DIM];  // of `array`, along its own axes
+  bool direct;                   // its chunks can be copied without recompressing them
+} concat_src;
+
+
+/* The axis of a source for the axis `k` of the new array, or -1 for the one of stacking */
+static int8_t concat_src_axis(int8_t k, int8_t axis, bool stack) {
+  if (!stack || k < axis) {
+    return k;
+  }
+  return k == axis ? -1 : (int8_t) (k - 1);
+}
+
+
+/* Whether two contexts compress chunks the same way (as in blosc2_schunk_copy) */
+static bool concat_same_cparams(const blosc2_context *cctx, const blosc2_context *src_cctx) {
+  if (cctx->typesize != src_cctx->typesize ||
+      cctx->clevel != src_cctx->clevel ||
+      cctx->compcode != src_cctx->compcode ||
+      cctx->compcode_meta != src_cctx->compcode_meta ||
+      cctx->splitmode != src_cctx->splitmode ||
+      cctx->use_dict != src_cctx->use_dict) {
+    return false;
+  }
+  for (int i = 0; i < BLOSC2_MAX_FILTERS; ++i) {
+    if (cctx->filters[i] != src_cctx->filters[i] || cctx->filters_meta[i] != src_cctx->filters_meta[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* Whether the chunks of `src` are chunks of `array` as they are: the same chunk and block
+ * layout, the same compression and the first one starting a chunk of `array` */
+static bool concat_direct(const b2nd_array_t *array, const concat_src *src, int8_t axis, bool stack) {
+  if (src->offset % array->chunkshape[axis] != 0) {
+    return false;
+  }
+  for (int8_t k = 0; k < array->ndim; ++k) {
+    int8_t i = concat_src_axis(k, axis, stack);
+    int32_t chunkshape = i < 0 ? 1 : src->array->chunkshape[i];
+    int32_t blockshape = i < 0 ? 1 : src->array->blockshape[i];
+    if (array->chunkshape[k] != chunkshape || array->blockshape[k] != blockshape) {
+      return false;
+    }
+  }
+  // Pre- and postfilters must run on the items
+  if (array->sc->cctx->prefilter != NULL || src->array->sc->dctx->postfilter != NULL) {
+    return false;
+  }
+  return concat_same_cparams(array->sc->cctx, src->array->sc->cctx);
+}
+
+
+/* Copy a compressed chunk of `src` into the chunk `nchunk` of `array`, recompressing it (with
+ * `buffer` as scratch) when its header does not match the `cparams` of `array` */
+static int concat_copy_chunk(b2nd_array_t *array, int64_t nchunk, const b2nd_array_t *src,
+                             int64_t src_nchunk, const blosc2_cparams *cparams, uint8_t *buffer) {
+  uint8_t *chunk;
+  bool needs_free;
+  int cbytes = blosc2_schunk_get_chunk(src->sc, src_nchunk, &chunk, &needs_free);
+  if (cbytes < 0) {
+    BLOSC_TRACE_ERROR("Error getting chunk");
+    BLOSC_ERROR(cbytes);
+  }
+  // Special chunks carry no data, and the typesizes are the same already
+  int special_value = (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+  if (special_value == 0 && !schunk_chunk_matches_cparams(chunk, cparams)) {
+    // A super-chunk may hold chunks encoded otherwise (e.g. with other checksums)
+    int32_t nbytes = (int32_t) (array->chunknitems * array->sc->typesize);
+    int dsize = blosc2_decompress_ctx(src->sc->dctx, chunk, cbytes, buffer, nbytes);
+    if (needs_free) {
+      free(chunk);
+    }
+    if (dsize < 0) {
+      BLOSC_TRACE_ERROR("Error decompressing chunk");
+      BLOSC_ERROR(dsize);
+    }
+    chunk = malloc(nbytes + BLOSC2_MAX_OVERHEAD);
+    BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
+    cbytes = blosc2_compress_ctx(array->sc->cctx, buffer, nbytes, chunk, nbytes + BLOSC2_MAX_OVERHEAD);
+    if (cbytes < 0) {
+      free(chunk);
+      BLOSC_TRACE_ERROR("Error compressing chunk");
+      BLOSC_ERROR(cbytes);
+    }
+    needs_free = true;
+  }
+  // The super-chunk takes ownership of the chunk when it is a copy already
+  int64_t rc = blosc2_schunk_update_chunk(array->sc, nchunk, chunk, !needs_free);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Blosc can not update the chunk");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Gather the items of the chunk `nchunk` of `array` from the sources that it overlaps into
+ * `region` (in C order), and set them at once, so the chunk is compressed once */
+static int concat_set_chunk(b2nd_array_t *array, const int64_t *chunk_start, const int64_t *chunk_stop,
+                            const concat_src *srcs, int nsrcs, int8_t axis, bool stack, uint8_t *region,
+                            uint8_t *part) {
+  int8_t ndim = array->ndim;
+  int32_t itemsize = array->sc->typesize;
+
+  int64_t region_shape[B2ND_MAX_DIM];
+  int64_t region_nitems = 1;
+  for (int k = 0; k < ndim; ++k) {
+    region_shape[k] = chunk_stop[k] - chunk_start[k];
+    region_nitems *= region_shape[k];
+  }
+
+  for (int s = 0; s < nsrcs; ++s) {
+    const concat_src *src = &srcs[s];
+    int64_t part_start = src->offset > chunk_start[axis] ? src->offset : chunk_start[axis];
+    int64_t part_stop = src->offset + src->shape[axis];
+    if (part_stop > chunk_stop[axis]) {
+      part_stop = chunk_stop[axis];
+    }
+    if (part_start >= part_stop) {
+      continue;
+    }
+
+    int64_t part_shape[B2ND_MAX_DIM];
+    int64_t part_nitems = 1;
+    int64_t start[B2ND_MAX_DIM];  // along the axes of the source
+    int64_t stop[B2ND_MAX_DIM];
+    int64_t shape[B2ND_MAX_DIM];
+    for (int8_t k = 0; k < ndim; ++k) {
+      part_shape[k] = k == axis ? part_stop - part_start : region_shape[k];
+      part_nitems *= part_shape[k];
+      int8_t i = concat_src_axis(k, axis, stack);
+      if (i < 0) {
+        continue;
+      }
+      start[i] = k == axis ? part_start - src->offset : chunk_start[k];
+      stop[i] = start[i] + part_shape[k];
+      shape[i] = part_shape[k];
+    }
+    // A source covering the whole chunk goes straight into the region
+    bool whole = part_nitems == region_nitems;
+    BLOSC_ERROR(b2nd_get_slice_cbuffer(src->array, start, stop, whole ? region : part, shape,
+                                       part_nitems * itemsize));
+    if (!whole) {
+      int64_t zeros[B2ND_MAX_DIM] = {0};
+      int64_t region_start[B2ND_MAX_DIM] = {0};
+      region_start[axis] = part_start - chunk_start[axis];
+      BLOSC_ERROR(b2nd_copy_buffer(ndim, (uint8_t) itemsize, part, part_shape, zeros, part_shape,
+                                   region, region_shape, region_start));
+    }
+  }
+
+  BLOSC_ERROR(b2nd_set_slice_cbuffer(region, region_shape, region_nitems * itemsize, chunk_start,
+                                     chunk_stop, array));
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Fill the chunks of `array` with the sources, one after the other along `axis` */
+static int concat_data(b2nd_array_t *array, const concat_src *srcs, int nsrcs, int8_t axis, bool stack) {
+  int8_t ndim = array->ndim;
+  int32_t itemsize = array->sc->typesize;
+
+  int64_t chunks_in_array[B2ND_MAX_DIM];
+  int64_t nchunks = 1;
+  for (int k = 0; k < ndim; ++k) {
+    chunks_in_array[k] = array->extshape[k] / array->chunkshape[k];
+    nchunks *= chunks_in_array[k];
+  }
+  uint8_t *region = malloc(array->chunknitems * itemsize);
+  uint8_t *part = malloc(array->chunknitems * itemsize);
+  if (region == NULL || part == NULL) {
+    free(part);
+    free(region);
+    BLOSC_ERROR(BLOSC2_ERROR_MEMORY_ALLOC);
+  }
+
+  // The chunks copied as they are must match these, chunk by chunk
+  blosc2_cparams cparams;
+  blosc2_ctx_get_cparams(array->sc->cctx, &cparams);
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  for (int64_t nchunk = 0; nchunk < nchunks && rc >= 0; ++nchunk) {
+    int64_t nchunk_ndim[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, chunks_in_array, nchunk, nchunk_ndim);
+    int64_t chunk_start[B2ND_MAX_DIM];
+    int64_t chunk_stop[B2ND_MAX_DIM];
+    for (int k = 0; k < ndim; ++k) {
+      chunk_start[k] = nchunk_ndim[k] * array->chunkshape[k];
+      chunk_stop[k] = chunk_start[k] + array->chunkshape[k];
+      if (chunk_stop[k] > array->shape[k]) {
+        chunk_stop[k] = array->shape[k];
+      }
+    }
+
+    // The source where the chunk starts, which may hold all of it
+    int s = 0;
+    while (srcs[s].offset + srcs[s].shape[axis] <= chunk_start[axis]) {
+      s++;
+    }
+    const concat_src *src = &srcs[s];
+    if (src->direct && chunk_stop[axis] <= src->offset + src->shape[axis]) {
+      int64_t src_nchunk = 0;
+      for (int8_t k = 0; k < ndim; ++k) {
+        int8_t i = concat_src_axis(k, axis, stack);
+        if (i < 0) {
+          continue;
+        }
+        int64_t index = k == axis ? (chunk_start[k] - src->offset) / array->chunkshape[k] : nchunk_ndim[k];
+        src_nchunk += index * src->chunks_strides[i];
+      }
+      rc = concat_copy_chunk(array, nchunk, src->array, src_nchunk, &cparams, region);
+    } else {
+      rc = concat_set_chunk(array, chunk_start, chunk_stop, srcs, nsrcs, axis, stack, region, part);
+    }
+  }
+
+  free(part);
+  free(region);
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static int concatenate(b2nd_context_t *ctx, b2nd_array_t **srcs, int nsrcs, int8_t axis, bool stack,
+                       b2nd_array_t **array) {
+  BLOSC_ERROR_NULL(ctx, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(srcs, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  if (nsrcs < 1) {
+    BLOSC_TRACE_ERROR("There must be one array at least");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  for (int s = 0; s < nsrcs; ++s) {
+    BLOSC_ERROR_NULL(srcs[s], BLOSC2_ERROR_NULL_POINTER);
+  }
+
+  const b2nd_array_t *first = srcs[0];
+  int8_t ndim = (int8_t) (stack ? first->ndim + 1 : first->ndim);
+  if (ndim > B2ND_MAX_DIM) {
+    BLOSC_TRACE_ERROR("The new array can not have more than %d dimensions", B2ND_MAX_DIM);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (axis < 0 || axis >= ndim) {
+    BLOSC_TRACE_ERROR("`axis` must be one of the axes of the new array");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (ctx->b2_storage->cparams->typesize != first->sc->typesize) {
+    BLOSC_TRACE_ERROR("The typesize of the new array must be the one of the sources");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  for (int s = 1; s < nsrcs; ++s) {
+    bool same = srcs[s]->ndim == first->ndim && srcs[s]->sc->typesize == first->sc->typesize;
+    for (int i = 0; same && i < first->ndim; ++i) {
+      same = srcs[s]->shape[i] == first->shape[i] || (!stack && i == axis);
+    }
+    if (!same) {
+      BLOSC_TRACE_ERROR("The arrays must have the same typesize and shape (but along `axis` "
+                        "when concatenating)");
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
+  }
+
+  concat_src *views = malloc(nsrcs * sizeof(concat_src));
+  BLOSC_ERROR_NULL(views, BLOSC2_ERROR_MEMORY_ALLOC);
+  int64_t offset = 0;
+  for (int s = 0; s < nsrcs; ++s) {
+    concat_src *view = &views[s];
+    view->array = srcs[s];
+    view->offset = offset;
+    for (int8_t k = 0; k < ndim; ++k) {
+      int8_t i = concat_src_axis(k, axis, stack);
+      view->shape[k] = i < 0 ? 1 : srcs[s]->shape[i];
+    }
+    if (srcs[s]->ndim > 0) {
+      int64_t src_chunks_in_array[B2ND_MAX_DIM];
+      for (int i = 0; i < srcs[s]->ndim; ++i) {
+        src_chunks_in_array[i] = srcs[s]->extshape[i] / srcs[s]->chunkshape[i];
+      }
+      view->chunks_strides[srcs[s]->ndim - 1] = 1;
+      for (int i = srcs[s]->ndim - 2; i >= 0; --i) {
+        view->chunks_strides[i] = view->chunks_strides[i + 1] * src_chunks_in_array[i + 1];
+      }
+    }
+    offset += view->shape[axis];
+  }
+
+  ctx->ndim = ndim;
+  for (int k = 0; k < ndim; ++k) {
+    ctx->shape[k] = k == axis ? offset : views[0].shape[k];
+  }
+  int rc = b2nd_empty(ctx, array);
+  if (rc < 0) {
+    free(views);
+    BLOSC_ERROR(rc);
+  }
+  if ((*array)->nitems == 0) {
+    free(views);
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  for (int s = 0; s < nsrcs; ++s) {
+    views[s].direct = concat_direct(*array, &views[s], axis, stack);
+  }
+  rc = concat_data(*array, views, nsrcs, axis, stack);
+  free(views);
+  if (rc < 0) {
+    b2nd_free(*array);
+    *array = NULL;
+    BLOSC_ERROR(rc);
+  }
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_concatenate(b2nd_context_t *ctx, b2nd_array_t **srcs, int nsrcs, int8_t axis,
+                     b2nd_array_t **array) {
+  BLOSC_ERROR(concatenate(ctx, srcs, nsrcs, axis, false, array));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_stack(b2nd_context_t *ctx, b2nd_array_t **srcs, int nsrcs, int8_t axis, b2nd_array_t **array) {
+  BLOSC_ERROR(concatenate(ctx, srcs, nsrcs, axis, true, array));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
@@ -0,0 +1,521 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "schunk-private.h"
+#include "blosc2.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* The number of items evaluated at once, so that the stack stays in L1 */
+#define EXPR_STRIP 256
+
+typedef struct {
+  const b2nd_array_t *array;
+  b2nd_item_kind kind;
+  int32_t itemsize;
+  int32_t block_nbytes;
+  uint8_t *chunk;  // the current chunk (maybe lazy)
+  int32_t cbytes;
+  bool needs_free;
+  bool constant;  // all the items of the current chunk hold `value`
+  double value;
+  uint8_t *staged;  // the current chunk decompressed, when its blocks cannot be decoded alone
+  bool use_staged;
+} expr_operand;
+
+typedef struct {
+  b2nd_array_t *array;
+  b2nd_item_kind kind;
+  int32_t itemsize;
+  expr_operand *operands;
+  int32_t noperands;
+  const b2nd_expr_instr *program;
+  int32_t ninstrs;
+  int32_t depth;  // the maximum size of the stack
+  int nthreads;
+  blosc2_context **dctxs;  // a context per operand for every thread
+  uint8_t *blocks;  // a block per operand for every thread
+  int32_t blocks_nbytes;  // the size of the blocks of a thread
+  uint8_t **items;  // the items of every operand for every thread
+  double *stacks;  // a stack of strips for every thread
+} expr_job;
+
+
+/* Check the program and get the maximum size of its stack */
+static int check_program(const b2nd_expr_instr *program, int32_t ninstrs, int32_t noperands,
+                         int32_t *depth) {
+  int32_t size = 0;
+  *depth = 0;
+  for (int32_t i = 0; i < ninstrs; ++i) {
+    switch (program[i].opcode) {
+      case B2ND_EXPR_OPERAND:
+        if (program[i].operand < 0 || program[i].operand >= noperands) {
+          BLOSC_TRACE_ERROR("Instruction %d pushes a non-existent operand (%d)", i, program[i].operand);
+          return BLOSC2_ERROR_INVALID_PARAM;
+        }
+        size++;
+        break;
+      case B2ND_EXPR_CONSTANT:
+        size++;
+        break;
+      case B2ND_EXPR_ADD:
+      case B2ND_EXPR_SUB:
+      case B2ND_EXPR_MUL:
+      case B2ND_EXPR_DIV:
+        if (size < 2) {
+          BLOSC_TRACE_ERROR("Instruction %d needs two values in the stack", i);
+          return BLOSC2_ERROR_INVALID_PARAM;
+        }
+        size--;
+        break;
+      case B2ND_EXPR_NEG:
+        if (size < 1) {
+          BLOSC_TRACE_ERROR("Instruction %d needs a value in the stack", i);
+          return BLOSC2_ERROR_INVALID_PARAM;
+        }
+        break;
+      default:
+        BLOSC_TRACE_ERROR("Unknown opcode (%d) in instruction %d", program[i].opcode, i);
+        return BLOSC2_ERROR_INVALID_PARAM;
+    }
+    *depth = size > *depth ? size : *depth;
+  }
+  if (size != 1) {
+    BLOSC_TRACE_ERROR("The expression leaves %d values in the stack instead of one", size);
+    return BLOSC2_ERROR_INVALID_PARAM;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static inline void fill_strip(double *strip, double value, int64_t nitems) {
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    strip[nitem] = value;
+  }
+}
+
+
+/* Evaluate `nitems` items starting at `start` into the first strip of `stack`.  The items of the
+ * operands that are not constant are in `items`. */
+static void eval_strip(const expr_job *job, double *stack, uint8_t *const *items, int64_t start,
+                       int64_t nitems) {
+  int32_t size = 0;
+  for (int32_t i = 0; i < job->ninstrs; ++i) {
+    const b2nd_expr_instr *instr = &job->program[i];
+    double *a = &stack[(size - 2) * EXPR_STRIP];
+    double *b = &stack[(size - 1) * EXPR_STRIP];
+    switch (instr->opcode) {
+      case B2ND_EXPR_OPERAND: {
+        const expr_operand *operand = &job->operands[instr->operand];
+        double *top = &stack[size++ * EXPR_STRIP];
+        if (operand->constant) {
+          fill_strip(top, operand->value, nitems);
+        } else {
+          b2nd_items_to_doubles(operand->kind, operand->itemsize,
+                                &items[instr->operand][start * operand->itemsize], nitems, top);
+        }
+        break;
+      }
+      case B2ND_EXPR_CONSTANT:
+        fill_strip(&stack[size++ * EXPR_STRIP], instr->value, nitems);
+        break;
+      case B2ND_EXPR_ADD:
+        for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+          a[nitem] += b[nitem];
+        }
+        size--;
+        break;
+      case B2ND_EXPR_SUB:
+        for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+          a[nitem] -= b[nitem];
+        }
+        size--;
+        break;
+      case B2ND_EXPR_MUL:
+        for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+          a[nitem] *= b[nitem];
+        }
+        size--;
+        break;
+      case B2ND_EXPR_DIV:
+        for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+          a[nitem] /= b[nitem];
+        }
+        size--;
+        break;
+      default:
+        for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+          b[nitem] = -b[nitem];
+        }
+    }
+  }
+}
+
+
+/* Evaluate a block of the current chunk with the scratch of thread `tid` */
+static int eval_block(expr_job *job, int tid, int32_t nblock, uint8_t *output) {
+  const b2nd_array_t *array = job->array;
+  int32_t blocknitems = (int32_t) array->blocknitems;
+  uint8_t **items = &job->items[tid * job->noperands];
+
+  // Decompress the block of every operand on its own
+  int rc = BLOSC2_ERROR_SUCCESS;
+  uint8_t *block = &job->blocks[tid * job->blocks_nbytes];
+  for (int32_t i = 0; i < job->noperands && rc >= 0; ++i) {
+    expr_operand *operand = &job->operands[i];
+    if (operand->constant) {
+      items[i] = NULL;
+    } else if (operand->use_staged) {
+      items[i] = &operand->staged[nblock * operand->block_nbytes];
+    } else {
+      rc = blosc2_getitem_ctx(job->dctxs[tid * job->noperands + i], operand->chunk, operand->cbytes,
+                              nblock * blocknitems, blocknitems, block, operand->block_nbytes);
+      items[i] = block;
+    }
+    block += operand->block_nbytes;
+  }
+
+  if (rc >= 0) {
+    double *stack = &job->stacks[tid * job->depth * EXPR_STRIP];
+    for (int64_t start = 0; start < blocknitems; start += EXPR_STRIP) {
+      int64_t nitems = blocknitems - start < EXPR_STRIP ? blocknitems - start : EXPR_STRIP;
+      eval_strip(job, stack, items, start, nitems);
+      b2nd_doubles_to_items(job->kind, job->itemsize, stack, nitems, &output[start * job->itemsize]);
+    }
+  }
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error decompressing a block of an operand");
+    return rc;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static int eval_prefilter(blosc2_prefilter_params *params) {
+  expr_job *job = (expr_job *) params->user_data;
+  return eval_block(job, params->tid, params->nblock, params->output) < 0 ? -1 : 0;
+}
+
+
+static void operand_release_chunk(expr_operand *operand) {
+  if (operand->needs_free) {
+    free(operand->chunk);
+  }
+  operand->chunk = NULL;
+  operand->needs_free = false;
+}
+
+
+/* Decompress the whole chunk `nchunk` of an operand into its staging buffer */
+static int operand_stage_chunk(expr_operand *operand, int64_t nchunk) {
+  const b2nd_array_t *array = operand->array;
+  int32_t chunk_nbytes = (int32_t) array->extchunknitems * operand->itemsize;
+  if (operand->staged == NULL) {
+    // Only postfilters and the delta filter need it, so it is allocated on demand
+    operand->staged = malloc(chunk_nbytes);
+    BLOSC_ERROR_NULL(operand->staged, BLOSC2_ERROR_MEMORY_ALLOC);
+  }
+  operand->use_staged = true;
+  int rc;
+  if (operand->chunk != NULL) {
+    rc = blosc2_decompress_ctx(array->sc->dctx, operand->chunk, operand->cbytes, operand->staged,
+                               chunk_nbytes);
+  } else {
+    rc = blosc2_schunk_decompress_chunk(array->sc, nchunk, operand->staged, chunk_nbytes);
+  }
+  return rc < 0 ? rc : BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Get the chunk `nchunk` of an operand, finding out whether it is a constant one */
+static int operand_get_chunk(expr_operand *operand, int64_t nchunk) {
+  const b2nd_array_t *array = operand->array;
+  operand->constant = false;
+  operand->use_staged = false;
+  if (array->sc->dctx->postfilter != NULL) {
+    // The items have to go through the postfilter of the array first
+    return operand_stage_chunk(operand, nchunk);
+  }
+
+  operand->cbytes = blosc2_schunk_get_lazychunk(array->sc, nchunk, &operand->chunk, &operand->needs_free);
+  if (operand->cbytes < 0) {
+    return operand->cbytes;
+  }
+  if (operand->cbytes < BLOSC_EXTENDED_HEADER_LENGTH) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  switch ((operand->chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK) {
+    case BLOSC2_SPECIAL_ZERO:
+    case BLOSC2_SPECIAL_UNINIT:
+      // Uninitialized items are taken as zeros
+      operand->constant = true;
+      operand->value = 0;
+      return BLOSC2_ERROR_SUCCESS;
+    case BLOSC2_SPECIAL_NAN:
+      operand->constant = true;
+      operand->value = NAN;
+      return BLOSC2_ERROR_SUCCESS;
+    case BLOSC2_SPECIAL_VALUE:
+      if (operand->cbytes >= BLOSC_EXTENDED_HEADER_LENGTH + operand->itemsize) {
+        operand->constant = true;
+        b2nd_items_to_doubles(operand->kind, operand->itemsize, &operand->chunk[BLOSC_EXTENDED_HEADER_LENGTH],
+                              1, &operand->value);
+        return BLOSC2_ERROR_SUCCESS;
+      }
+      break;
+    default:
+      break;
+  }
+  if (schunk_chunk_uses_delta(operand->chunk)) {
+    // The delta filter decodes every block against the first one in the destination
+    return operand_stage_chunk(operand, nchunk);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Build the chunk of the result where every operand is constant */
+static int eval_constant_chunk(expr_job *job, const blosc2_cparams *cparams, uint8_t **chunk) {
+  double *value = job->stacks;
+  eval_strip(job, value, NULL, 0, 1);
+  uint8_t item[sizeof(double)] = {0};
+  b2nd_doubles_to_items(job->kind, job->itemsize, value, 1, item);
+
+  int32_t chunk_nbytes = (int32_t) job->array->extchunknitems * job->itemsize;
+  int32_t chunk_size = BLOSC_EXTENDED_HEADER_LENGTH + job->itemsize;
+  *chunk = malloc(chunk_size);
+  BLOSC_ERROR_NULL(*chunk, BLOSC2_ERROR_MEMORY_ALLOC);
+  bool zero = true;
+  for (int32_t i = 0; i < job->itemsize; ++i) {
+    zero &= item[i] == 0;
+  }
+  int rc;
+  if (zero) {
+    rc = blosc2_chunk_zeros(*cparams, chunk_nbytes, *chunk, chunk_size);
+  } else if (job->kind == B2ND_ITEM_FLOAT && isnan(*value)) {
+    rc = blosc2_chunk_nans(*cparams, chunk_nbytes, *chunk, chunk_size);
+  } else {
+    rc = blosc2_chunk_repeatval(*cparams, chunk_nbytes, *chunk, chunk_size, item);
+  }
+  if (rc < 0) {
+    free(*chunk);
+    *chunk = NULL;
+    return rc;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Evaluate a chunk of the result.  When `staged`, its blocks are evaluated into `data`, which is
+ * compressed afterwards; otherwise `data` is only the source handed to the prefilter of `cctx`. */
+static int eval_chunk(expr_job *job, blosc2_context *cctx, const blosc2_cparams *cparams,
+                      int64_t nchunk, uint8_t *data, bool staged) {
+  b2nd_array_t *array = job->array;
+  bool constant = true;
+  int rc = BLOSC2_ERROR_SUCCESS;
+  for (int32_t i = 0; i < job->noperands && rc >= 0; ++i) {
+    rc = operand_get_chunk(&job->operands[i], nchunk);
+    constant &= job->operands[i].constant;
+  }
+
+  uint8_t *chunk = NULL;
+  int32_t data_nbytes = (int32_t) array->extchunknitems * job->itemsize;
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error getting a chunk of an operand");
+  } else if (constant) {
+    rc = eval_constant_chunk(job, cparams, &chunk);
+  } else {
+    int32_t chunk_nbytes = data_nbytes + BLOSC2_MAX_OVERHEAD;
+    chunk = malloc(chunk_nbytes);
+    if (chunk == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    } else if (staged) {
+      // Evaluate all the blocks first, as the delta filter needs the whole chunk
+      int32_t block_nbytes = (int32_t) array->blocknitems * job->itemsize;
+      for (int32_t nblock = 0; nblock < data_nbytes / block_nbytes && rc >= 0; ++nblock) {
+        rc = eval_block(job, 0, nblock, &data[nblock * block_nbytes]);
+      }
+      if (rc >= 0) {
+        rc = blosc2_compress_ctx(array->sc->cctx, data, data_nbytes, chunk, chunk_nbytes);
+      }
+    } else {
+      // The prefilter writes every block, so the source is never read
+      rc = blosc2_compress_ctx(cctx, data, data_nbytes, chunk, chunk_nbytes);
+    }
+    if (rc < 0) {
+      BLOSC_TRACE_ERROR("Error evaluating a chunk");
+    }
+  }
+  for (int32_t i = 0; i < job->noperands; ++i) {
+    operand_release_chunk(&job->operands[i]);
+  }
+
+  if (rc >= 0) {
+    // The super-chunk takes ownership of the chunk
+    int64_t rc_ = blosc2_schunk_update_chunk(array->sc, nchunk, chunk, false);
+    if (rc_ < 0) {
+      BLOSC_TRACE_ERROR("Error updating a chunk of the result");
+      return (int) rc_;
+    }
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  free(chunk);
+  return rc;
+}
+
+
+int b2nd_eval(b2nd_context_t *ctx, b2nd_array_t **array, b2nd_array_t **operands,
+              int32_t noperands, const b2nd_expr_instr *program, int32_t ninstrs) {
+  BLOSC_ERROR_NULL(ctx, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(program, BLOSC2_ERROR_NULL_POINTER);
+  if (noperands > 0) {
+    BLOSC_ERROR_NULL(operands, BLOSC2_ERROR_NULL_POINTER);
+  }
+
+  expr_job job = {0};
+  job.program = program;
+  job.ninstrs = ninstrs;
+  job.noperands = noperands;
+  BLOSC_ERROR(check_program(program, ninstrs, noperands, &job.depth));
+  for (int32_t i = 0; i < noperands; ++i) {
+    const b2nd_array_t *operand = operands[i];
+    BLOSC_ERROR_NULL(operand, BLOSC2_ERROR_NULL_POINTER);
+    bool same = operand->ndim == ctx->ndim;
+    for (int j = 0; j < ctx->ndim && same; ++j) {
+      same = operand->shape[j] == ctx->shape[j] && operand->chunkshape[j] == ctx->chunkshape[j] &&
+             operand->blockshape[j] == ctx->blockshape[j];
+    }
+    if (!same) {
+      BLOSC_TRACE_ERROR("The shape, chunkshape and blockshape of operand %d must be the ones of the result", i);
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
+  }
+
+  job.operands = calloc(noperands > 0 ? noperands : 1, sizeof(expr_operand));
+  BLOSC_ERROR_NULL(job.operands, BLOSC2_ERROR_MEMORY_ALLOC);
+  int rc = BLOSC2_ERROR_SUCCESS;
+  for (int32_t i = 0; i < noperands && rc >= 0; ++i) {
+    expr_operand *operand = &job.operands[i];
+    operand->array = operands[i];
+    rc = b2nd_get_item_kind(operand->array, &operand->kind, &operand->itemsize);
+    operand->block_nbytes = (int32_t) operand->array->blocknitems * operand->itemsize;
+    job.blocks_nbytes += operand->block_nbytes;
+  }
+  if (rc < 0) {
+    free(job.operands);
+    BLOSC_ERROR(rc);
+  }
+
+  rc = b2nd_uninit(ctx, &job.array);
+  if (rc < 0) {
+    free(job.operands);
+    BLOSC_ERROR(rc);
+  }
+  blosc2_cparams cparams;
+  blosc2_context *cctx = NULL;
+  uint8_t *data = NULL;
+  rc = b2nd_get_item_kind(job.array, &job.kind, &job.itemsize);
+  if (rc < 0 || job.array->nitems == 0) {
+    goto out;
+  }
+
+  // Every block of the result is evaluated in the prefilter of its compression
+  blosc2_ctx_get_cparams(job.array->sc->cctx, &cparams);
+  blosc2_cparams eval_cparams = cparams;
+  blosc2_prefilter_params preparams = {0};
+  preparams.user_data = &job;
+  eval_cparams.prefilter = eval_prefilter;
+  eval_cparams.preparams = &preparams;
+  cctx = blosc2_create_cctx(eval_cparams);
+  if (cctx == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto out;
+  }
+  job.nthreads = cctx->nthreads;
+  bool staged = false;
+  for (int i = 0; i < BLOSC2_MAX_FILTERS; ++i) {
+    if (cparams.filters[i] == BLOSC_DELTA) {
+      // The delta filter encodes every block against the first one in the source
+      job.nthreads = 1;
+      staged = true;
+      break;
+    }
+  }
+  // Without staging, the source is never read, but it must not overlap the destination either
+  // (calloc() maps zeroed pages that are left untouched then)
+  size_t data_nbytes = (size_t) job.array->extchunknitems * job.itemsize;
+  data = staged ? malloc(data_nbytes) : calloc(data_nbytes, 1);
+  if (data == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto out;
+  }
+
+  job.dctxs = calloc(job.nthreads * (noperands > 0 ? noperands : 1), sizeof(blosc2_context *));
+  job.blocks = malloc(job.nthreads * (job.blocks_nbytes > 0 ? job.blocks_nbytes : 1));
+  job.items = malloc(job.nthreads * (noperands > 0 ? noperands : 1) * sizeof(uint8_t *));
+  job.stacks = malloc(job.nthreads * job.depth * EXPR_STRIP * sizeof(double));
+  if (job.dctxs == NULL || job.blocks == NULL || job.items == NULL || job.stacks == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto out;
+  }
+  for (int32_t i = 0; i < noperands; ++i) {
+    expr_operand *operand = &job.operands[i];
+    blosc2_dparams dparams;
+    blosc2_ctx_get_dparams(operand->array->sc->dctx, &dparams);
+    dparams.nthreads = 1;
+    dparams.postfilter = NULL;
+    for (int tid = 0; tid < job.nthreads; ++tid) {
+      job.dctxs[tid * noperands + i] = blosc2_create_dctx(dparams);
+      if (job.dctxs[tid * noperands + i] == NULL) {
+        rc = BLOSC2_ERROR_MEMORY_ALLOC;
+        goto out;
+      }
+    }
+  }
+
+  for (int64_t nchunk = 0; nchunk < job.array->sc->nchunks && rc >= 0; ++nchunk) {
+    rc = eval_chunk(&job, cctx, &cparams, nchunk, data, staged);
+  }
+
+  out:
+  for (int32_t i = 0; i < noperands; ++i) {
+    free(job.operands[i].staged);
+  }
+  if (job.dctxs != NULL) {
+    for (int i = 0; i < job.nthreads * noperands; ++i) {
+      if (job.dctxs[i] != NULL) {
+        blosc2_free_ctx(job.dctxs[i]);
+      }
+    }
+  }
+  free(job.dctxs);
+  free(job.blocks);
+  free(job.items);
+  free(job.stacks);
+  free(job.operands);
+  free(data);
+  if (cctx != NULL) {
+    blosc2_free_ctx(cctx);
+  }
+  if (rc < 0) {
+    b2nd_free(job.array);
+    BLOSC_ERROR(rc);
+  }
+  *array = job.array;
+  return BLOSC2_ERROR_SUCCESS;
+}
@@ -0,0 +1,483 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "schunk-private.h"
+#include "blosc2/blosc2-common.h"
+#include "blosc2.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* Where a selected item lives in the array, and where it goes in the buffer */
+typedef struct {
+  int64_t nchunk;
+  int32_t nblock;
+  int32_t nitem;  // inside the block
+  int64_t index;  // inside the buffer
+} points_entry;
+
+
+/* The state of gathering a selection, shared by the workers when chunks go in parallel */
+typedef struct {
+  b2nd_array_t *array;
+  uint8_t *buffer;
+  points_entry *entries;   // sorted by chunk, block and item
+  int64_t *groups;         // the first entry of every chunk (plus the number of entries)
+  int64_t ngroups;
+  bool parallel;           // the super-chunk is shared by several workers
+  blosc2_dparams dparams;  // params for the worker contexts
+  int64_t next;            // next chunk to be processed by a worker
+  int error;
+  pthread_mutex_t mutex;   // serializes the accesses to the super-chunk
+} points_job;
+
+
+/* The contexts and scratch of a worker */
+typedef struct {
+  points_job *job;
+  blosc2_context *dctx;         // runs points_postfilter() on every block
+  int64_t group;                // the chunk being decompressed by `dctx`
+  uint8_t *data;                // a chunk (only written when the blocks are not gathered as decompressed)
+} points_worker;
+
+
+static int compare_entries(const void *a, const void *b) {
+  const points_entry *ea = (const points_entry *) a;
+  const points_entry *eb = (const points_entry *) b;
+  if (ea->nchunk != eb->nchunk) {
+    return ea->nchunk < eb->nchunk ? -1 : 1;
+  }
+  if (ea->nblock != eb->nblock) {
+    return ea->nblock < eb->nblock ? -1 : 1;
+  }
+  if (ea->nitem != eb->nitem) {
+    return ea->nitem < eb->nitem ? -1 : 1;
+  }
+  return ea->index < eb->index ? -1 : (ea->index > eb->index);
+}
+
+
+/* Compute the chunk, the block and the item of the coordinates of an item */
+static void points_locate(const b2nd_array_t *array, const int64_t *coords, int64_t index,
+                          points_entry *entry) {
+  int64_t nchunk = 0;
+  int64_t nblock = 0;
+  int64_t nitem = 0;
+  for (int i = 0; i < array->ndim; ++i) {
+    int64_t chunk_coord = coords[i] % array->chunkshape[i];
+    nchunk = nchunk * (array->extshape[i] / array->chunkshape[i]) + coords[i] / array->chunkshape[i];
+    nblock = nblock * (array->extchunkshape[i] / array->blockshape[i]) + chunk_coord / array->blockshape[i];
+    nitem = nitem * array->blockshape[i] + chunk_coord % array->blockshape[i];
+  }
+  entry->nchunk = nchunk;
+  entry->nblock = (int32_t) nblock;
+  entry->nitem = (int32_t) nitem;
+  entry->index = index;
+}
+
+
+static void points_lock(points_job *job) {
+  if (job->parallel) {
+    pthread_mutex_lock(&job->mutex);
+  }
+}
+
+static void points_unlock(points_job *job) {
+  if (job->parallel) {
+    pthread_mutex_unlock(&job->mutex);
+  }
+}
+
+
+/* Copy the items of a chunk group that lie in a block (or in every block if `nblock` < 0) */
+static void points_copy(points_job *job, int64_t group, int32_t nblock, const uint8_t *data) {
+  int32_t typesize = job->array->sc->typesize;
+  int64_t first = job->groups[group];
+  int64_t last = job->groups[group + 1];
+  if (nblock >= 0) {
+    // Entries are sorted by block, so look for the first one of the block
+    int64_t lo = first;
+    int64_t hi = last;
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      if (job->entries[mid].nblock < nblock) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    first = lo;
+  }
+  int64_t block_nbytes = job->array->blocknitems * typesize;
+  for (int64_t i = first; i < last; ++i) {
+    const points_entry *entry = &job->entries[i];
+    if (nblock >= 0 && entry->nblock != nblock) {
+      break;
+    }
+    const uint8_t *src = nblock >= 0 ? &data[entry->nitem * typesize] :
+                         &data[entry->nblock * block_nbytes + entry->nitem * typesize];
+    memcpy(&job->buffer[entry->index * typesize], src, typesize);
+  }
+}
+
+
+/* Different blocks hold different entries, and so they write disjoint items of the buffer */
+static int points_postfilter(blosc2_postfilter_params *params) {
+  points_worker *worker = (points_worker *) params->user_data;
+  points_copy(worker->job, worker->group, params->nblock, params->input);
+  return 0;
+}
+
+
+/* Copy the item at `value` (or zeros if it is NULL) to the items of a chunk group */
+static void points_fill(points_job *job, int64_t group, const uint8_t *value) {
+  int32_t typesize = job->array->sc->typesize;
+  for (int64_t i = job->groups[group]; i < job->groups[group + 1]; ++i) {
+    uint8_t *dest = &job->buffer[job->entries[i].index * typesize];
+    if (value == NULL) {
+      memset(dest, 0, typesize);
+    } else {
+      memcpy(dest, value, typesize);
+    }
+  }
+}
+
+
+/* Get the items of a special chunk (zeros, NaNs, a repeated value or uninitialized data) straight
+ * from its header.  Returns false if the chunk has to be decompressed instead. */
+static bool points_get_special(points_job *job, int64_t group, const uint8_t *chunk, int32_t cbytes) {
+  if (cbytes < BLOSC_EXTENDED_HEADER_LENGTH) {
+    return false;
+  }
+  int32_t typesize = job->array->sc->typesize;
+  uint8_t nan_value[sizeof(double)];
+  switch ((chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK) {
+    case BLOSC2_SPECIAL_ZERO:
+      points_fill(job, group, NULL);
+      return true;
+    case BLOSC2_SPECIAL_NAN:
+      if (typesize == sizeof(float)) {
+        float value = nanf("");
+        memcpy(nan_value, &value, sizeof(value));
+      } else if (typesize == sizeof(double)) {
+        double value = nan("");
+        memcpy(nan_value, &value, sizeof(value));
+      } else {
+        return false;
+      }
+      points_fill(job, group, nan_value);
+      return true;
+    case BLOSC2_SPECIAL_VALUE:
+      if (cbytes < BLOSC_EXTENDED_HEADER_LENGTH + typesize) {
+        return false;
+      }
+      points_fill(job, group, &chunk[BLOSC_EXTENDED_HEADER_LENGTH]);
+      return true;
+    case BLOSC2_SPECIAL_UNINIT:
+      // The contents are undefined, so leave the buffer alone
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+/* Gather the items of a chunk group, decompressing only the blocks that hold some of them.
+ * `dctx` decompresses into `worker->data` when the blocks cannot be gathered as decompressed. */
+static int points_gather_chunk(points_worker *worker, int64_t group, blosc2_context *dctx) {
+  points_job *job = worker->job;
+  b2nd_array_t *array = job->array;
+  int64_t nchunk = job->entries[job->groups[group]].nchunk;
+
+  uint8_t *chunk;
+  bool chunk_needs_free;
+  points_lock(job);
+  // Lazy chunks only read the blocks that are not masked out
+  int cbytes = blosc2_schunk_get_lazychunk(array->sc, nchunk, &chunk, &chunk_needs_free);
+  points_unlock(job);
+  if (cbytes < 0) {
+    BLOSC_TRACE_ERROR("Error getting chunk");
+    BLOSC_ERROR(cbytes);
+  }
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  // Special chunks hold no data (unless a postfilter of the array has to process them), and the
+  // delta filter decodes every block against the first one in the destination
+  bool direct = worker->dctx != NULL;
+  if (direct && points_get_special(job, group, chunk, cbytes)) {
+    goto out;
+  }
+  direct &= !schunk_chunk_uses_delta(chunk);
+  // The destination is not written when the blocks are gathered as decompressed, but it still has
+  // to be large enough for a chunk
+  int32_t data_nbytes = (int32_t) array->extchunknitems * array->sc->typesize;
+  if (worker->data == NULL) {
+    worker->data = malloc(data_nbytes);
+    if (worker->data == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+      goto out;
+    }
+  }
+  if (direct) {
+    dctx = worker->dctx;
+    worker->group = group;
+  }
+
+  int32_t nblocks = (int32_t) (array->extchunknitems / array->blocknitems);
+  bool *block_maskout = malloc(nblocks);
+  if (block_maskout == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto out;
+  }
+  for (int32_t nblock = 0; nblock < nblocks; ++nblock) {
+    block_maskout[nblock] = true;
+  }
+  for (int64_t i = job->groups[group]; i < job->groups[group + 1]; ++i) {
+    block_maskout[job->entries[i].nblock] = false;
+  }
+  rc = schunk_set_chunk_maskout(dctx, chunk, block_maskout, nblocks);
+  free(block_maskout);
+  if (rc != BLOSC2_ERROR_SUCCESS) {
+    BLOSC_TRACE_ERROR("Error setting the maskout");
+    rc = BLOSC2_ERROR_FAILURE;
+    goto out;
+  }
+
+  // Update current_chunk in case a postfilter is applied
+  if (!job->parallel) {
+    array->sc->current_nchunk = nchunk;
+  }
+  if (blosc2_decompress_ctx(dctx, chunk, cbytes, worker->data, data_nbytes) < 0) {
+    BLOSC_TRACE_ERROR("Error decompressing chunk");
+    rc = BLOSC2_ERROR_FAILURE;
+    goto out;
+  }
+  if (!direct) {
+    points_copy(job, group, -1, worker->data);
+  }
+
+  out:
+  if (chunk_needs_free) {
+    free(chunk);
+  }
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static int points_worker_init(points_worker *worker, points_job *job, blosc2_dparams dparams) {
+  blosc2_postfilter_params postparams = {0};
+  postparams.user_data = worker;
+  dparams.postfilter = points_postfilter;
+  dparams.postparams = &postparams;
+  worker->job = job;
+  worker->dctx = blosc2_create_dctx(dparams);
+  BLOSC_ERROR_NULL(worker->dctx, BLOSC2_ERROR_MEMORY_ALLOC);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static void points_worker_free(points_worker *worker) {
+  if (worker->dctx != NULL) {
+    blosc2_free_ctx(worker->dctx);
+  }
+  free(worker->data);
+}
+
+
+static void *points_gather_worker(void *arg) {
+  points_job *job = (points_job *) arg;
+  points_worker worker = {0};
+  int rc = points_worker_init(&worker, job, job->dparams);
+  blosc2_context *dctx = blosc2_create_dctx(job->dparams);
+
+  pthread_mutex_lock(&job->mutex);
+  if (rc < 0 || dctx == NULL) {
+    job->error = BLOSC2_ERROR_FAILURE;
+  }
+  while (job->error == 0 && job->next < job->ngroups) {
+    int64_t group = job->next++;
+    pthread_mutex_unlock(&job->mutex);
+    rc = points_gather_chunk(&worker, group, dctx);
+    pthread_mutex_lock(&job->mutex);
+    if (rc < 0 && job->error == 0) {
+      job->error = rc;
+    }
+  }
+  pthread_mutex_unlock(&job->mutex);
+
+  points_worker_free(&worker);
+  if (dctx != NULL) {
+    blosc2_free_ctx(dctx);
+  }
+  return NULL;
+}
+
+
+/* Sort the entries and gather them chunk by chunk.  Several chunks go in parallel when the array
+ * has more threads than needed for decompressing one. */
+static int points_gather(b2nd_array_t *array, points_entry *entries, int64_t nentries, uint8_t *buffer) {
+  if (nentries == 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  qsort(entries, nentries, sizeof(points_entry), compare_entries);
+
+  points_job job = {0};
+  job.array = array;
+  job.buffer = buffer;
+  job.entries = entries;
+  job.groups = malloc((nentries + 1) * sizeof(int64_t));
+  BLOSC_ERROR_NULL(job.groups, BLOSC2_ERROR_MEMORY_ALLOC);
+  for (int64_t i = 0; i < nentries; ++i) {
+    if (i == 0 || entries[i].nchunk != entries[i - 1].nchunk) {
+      job.groups[job.ngroups++] = i;
+    }
+  }
+  job.groups[job.ngroups] = nentries;
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  // Pre- and postfilters may depend on the state of the super-chunk, so they keep the serial path
+  int nthreads = array->sc->dctx->nthreads;
+  int nworkers = job.ngroups < nthreads ? (int) job.ngroups : nthreads;
+  if (nworkers > 1 && array->sc->dctx->postfilter == NULL) {
+    blosc2_ctx_get_dparams(array->sc->dctx, &job.dparams);
+    job.dparams.nthreads = (int16_t) (nthreads / nworkers);
+    job.parallel = true;
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_t *threads = malloc(nworkers * sizeof(pthread_t));
+    int nstarted = 0;
+    if (threads == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    }
+    for (; threads != NULL && nstarted < nworkers; nstarted++) {
+      if (pthread_create(&threads[nstarted], NULL, points_gather_worker, &job) != 0) {
+        BLOSC_TRACE_ERROR("Cannot create a gather thread.");
+        rc = BLOSC2_ERROR_THREAD_CREATE;
+        pthread_mutex_lock(&job.mutex);
+        job.error = rc;
+        pthread_mutex_unlock(&job.mutex);
+        break;
+      }
+    }
+    for (int i = 0; i < nstarted; i++) {
+      pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&job.mutex);
+    rc = job.error < 0 ? job.error : rc;
+  }
+  else {
+    // A postfilter of the array needs the whole chunk in the destination
+    points_worker worker = {0};
+    worker.job = &job;
+    if (array->sc->dctx->postfilter == NULL) {
+      blosc2_dparams dparams;
+      blosc2_ctx_get_dparams(array->sc->dctx, &dparams);
+      rc = points_worker_init(&worker, &job, dparams);
+    }
+    for (int64_t group = 0; group < job.ngroups && rc >= 0; ++group) {
+      rc = points_gather_chunk(&worker, group, array->sc->dctx);
+    }
+    points_worker_free(&worker);
+  }
+  free(job.groups);
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_get_point_selection(const b2nd_array_t *array, const int64_t *points, int64_t npoints,
+                             void *buffer, int64_t buffersize) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  if (npoints < 0) {
+    BLOSC_TRACE_ERROR("The number of points cannot be negative");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (npoints > 0) {
+    BLOSC_ERROR_NULL(points, BLOSC2_ERROR_NULL_POINTER);
+  }
+  if (buffersize < npoints * array->sc->typesize) {
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  int8_t ndim = array->ndim;
+  points_entry *entries = malloc((npoints > 0 ? npoints : 1) * sizeof(points_entry));
+  BLOSC_ERROR_NULL(entries, BLOSC2_ERROR_MEMORY_ALLOC);
+  for (int64_t i = 0; i < npoints; ++i) {
+    const int64_t *coords = &points[i * ndim];
+    for (int j = 0; j < ndim; ++j) {
+      if (coords[j] < 0 || coords[j] >= array->shape[j]) {
+        free(entries);
+        BLOSC_TRACE_ERROR("Point %" PRId64 " is out of the array", i);
+        BLOSC_ERROR(BLOSC2_ERROR_INVALID_INDEX);
+      }
+    }
+    points_locate(array, coords, i, &entries[i]);
+  }
+
+  int rc = points_gather((b2nd_array_t *) array, entries, npoints, buffer);
+  free(entries);
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_get_mask_selection(const b2nd_array_t *array, const bool *mask, void *buffer,
+                            int64_t buffersize, int64_t *nselected) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(mask, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+
+  int64_t nentries = 0;
+  for (int64_t nitem = 0; nitem < array->nitems; ++nitem) {
+    nentries += mask[nitem];
+  }
+  if (nselected != NULL) {
+    *nselected = nentries;
+  }
+  if (buffersize < nentries * array->sc->typesize) {
+    BLOSC_TRACE_ERROR("The buffer cannot hold the %" PRId64 " selected items", nentries);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  points_entry *entries = malloc((nentries > 0 ? nentries : 1) * sizeof(points_entry));
+  BLOSC_ERROR_NULL(entries, BLOSC2_ERROR_MEMORY_ALLOC);
+  int64_t coords[B2ND_MAX_DIM] = {0};
+  int64_t nentry = 0;
+  for (int64_t nitem = 0; nitem < array->nitems; ++nitem) {
+    if (mask[nitem]) {
+      points_locate(array, coords, nentry, &entries[nentry]);
+      nentry++;
+    }
+    // Move to the next item in C order
+    for (int i = array->ndim - 1; i >= 0; --i) {
+      if (++coords[i] < array->shape[i]) {
+        break;
+      }
+      coords[i] = 0;
+    }
+  }
+
+  int rc = points_gather((b2nd_array_t *) array, entries, nentries, buffer);
+  free(entries);
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
@@ -0,0 +1,722 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "blosc2.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PYRAMID_VERSION 0
+
+/* The levels of pyramids are kept either next to the array, or in its vlmetalayers */
+#define PYRAMID_LEVELS_FILES 0
+#define PYRAMID_LEVELS_VLMETA 1
+
+
+/* The description of a pyramid, as kept in the `b2nd_pyramid` vlmetalayer */
+typedef struct {
+  b2nd_pyramid_op op;
+  int8_t nlevels;
+  int32_t factor;
+  uint8_t storage;             // where the levels are kept
+  bool stale;                  // whether the array has changed its shape since the pyramid was built
+} pyramid_meta;
+
+
+static int32_t pyramid_meta_nbytes(int8_t ndim) {
+  return 1 + 1 + 1 + sizeof(int32_t) + 1 + 1 + ndim * (int32_t) sizeof(int64_t);
+}
+
+
+static int pyramid_meta_save(b2nd_array_t *array, const pyramid_meta *meta) {
+  int8_t ndim = array->ndim;
+  int32_t content_len = pyramid_meta_nbytes(ndim);
+  uint8_t content[1 + 1 + 1 + sizeof(int32_t) + 1 + 1 + B2ND_MAX_DIM * sizeof(int64_t)];
+  uint8_t *pcontent = content;
+  *pcontent++ = PYRAMID_VERSION;
+  *pcontent++ = (uint8_t) meta->op;
+  *pcontent++ = (uint8_t) meta->nlevels;
+  swap_store(pcontent, &meta->factor, sizeof(int32_t));
+  pcontent += sizeof(int32_t);
+  *pcontent++ = meta->storage;
+  *pcontent++ = (uint8_t) ndim;
+  for (int i = 0; i < ndim; ++i) {
+    swap_store(pcontent, &array->shape[i], sizeof(int64_t));
+    pcontent += sizeof(int64_t);
+  }
+
+  int rc;
+  if (blosc2_vlmeta_exists(array->sc, B2ND_PYRAMID_NAME) < 0) {
+    rc = blosc2_vlmeta_add(array->sc, B2ND_PYRAMID_NAME, content, content_len, NULL);
+  } else {
+    rc = blosc2_vlmeta_update(array->sc, B2ND_PYRAMID_NAME, content, content_len, NULL);
+  }
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error storing the pyramid");
+    BLOSC_ERROR(rc);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Load the description of the pyramid of an array, if any (`found` tells) */
+static int pyramid_meta_load(const b2nd_array_t *array, pyramid_meta *meta, bool *found) {
+  *found = false;
+  if (array->sc == NULL || blosc2_vlmeta_exists(array->sc, B2ND_PYRAMID_NAME) < 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  uint8_t *content;
+  int32_t content_len;
+  BLOSC_ERROR(blosc2_vlmeta_get(array->sc, B2ND_PYRAMID_NAME, &content, &content_len));
+  if (content_len < pyramid_meta_nbytes(0) || content[0] != PYRAMID_VERSION) {
+    free(content);
+    BLOSC_TRACE_ERROR("The pyramid of the array is not supported");
+    BLOSC_ERROR(BLOSC2_ERROR_VERSION_SUPPORT);
+  }
+  uint8_t *pcontent = &content[1];
+  meta->op = (b2nd_pyramid_op) *pcontent++;
+  meta->nlevels = (int8_t) *pcontent++;
+  swap_store(&meta->factor, pcontent, sizeof(int32_t));
+  pcontent += sizeof(int32_t);
+  meta->storage = *pcontent++;
+  int8_t ndim = (int8_t) *pcontent++;
+
+  // Pyramids of arrays that have changed their shape are stale
+  meta->stale = ndim != array->ndim || content_len != pyramid_meta_nbytes(ndim);
+  for (int i = 0; !meta->stale && i < ndim; ++i) {
+    int64_t shape;
+    swap_store(&shape, pcontent, sizeof(int64_t));
+    pcontent += sizeof(int64_t);
+    meta->stale = shape != array->shape[i];
+  }
+  free(content);
+  *found = true;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* The path of a level kept next to the array (it must be freed), or NULL if the array is not on disk */
+static char *level_urlpath(const b2nd_array_t *array, int8_t level) {
+  const char *urlpath = array->sc->storage->urlpath;
+  if (urlpath == NULL) {
+    return NULL;
+  }
+  size_t len = strlen(urlpath) + 16;
+  char *path = malloc(len);
+  if (path != NULL) {
+    snprintf(path, len, "%s.level%d", urlpath, level);
+  }
+  return path;
+}
+
+
+static void level_vlmeta_name(int8_t level, char *name) {
+  snprintf(name, BLOSC2_VLMETALAYERS_NAME_MAXLEN + 1, "%s_%d", B2ND_PYRAMID_NAME, level);
+}
+
+
+/* Open a level kept next to the array, or a copy of one kept in its vlmetalayers */
+static int level_open(const b2nd_array_t *array, const pyramid_meta *meta, int8_t level,
+                      b2nd_array_t **larray) {
+  if (meta->storage == PYRAMID_LEVELS_FILES) {
+    char *path = level_urlpath(array, level);
+    if (path == NULL) {
+      BLOSC_TRACE_ERROR("The levels of the pyramid are kept next to the array, which is not on disk");
+      BLOSC_ERROR(BLOSC2_ERROR_NOT_FOUND);
+    }
+    int rc = b2nd_open(path, larray);
+    free(path);
+    if (rc < 0) {
+      BLOSC_TRACE_ERROR("Cannot open the level %d of the pyramid", level);
+      BLOSC_ERROR(rc);
+    }
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  // The levels kept in memory are more recent than the stored ones
+  b2nd_pyramid_levels *levels = array->pyramid_levels;
+  if (levels != NULL && level <= levels->nlevels && levels->levels[level - 1] != NULL) {
+    uint8_t *cframe;
+    int64_t cframe_len;
+    bool needs_free;
+    BLOSC_ERROR(b2nd_to_cframe(levels->levels[level - 1], &cframe, &cframe_len, &needs_free));
+    int rc = b2nd_from_cframe(cframe, cframe_len, true, larray);
+    if (needs_free) {
+      free(cframe);
+    }
+    BLOSC_ERROR(rc);
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  char name[BLOSC2_VLMETALAYERS_NAME_MAXLEN + 1];
+  level_vlmeta_name(level, name);
+  uint8_t *cframe;
+  int32_t cframe_len;
+  if (blosc2_vlmeta_get(array->sc, name, &cframe, &cframe_len) < 0) {
+    BLOSC_TRACE_ERROR("Cannot find the level %d of the pyramid", level);
+    BLOSC_ERROR(BLOSC2_ERROR_NOT_FOUND);
+  }
+  int rc = b2nd_from_cframe(cframe, cframe_len, true, larray);
+  free(cframe);
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static b2nd_pyramid_levels *levels_new(int8_t nlevels) {
+  b2nd_pyramid_levels *levels = malloc(sizeof(b2nd_pyramid_levels));
+  if (levels == NULL) {
+    return NULL;
+  }
+  levels->nlevels = nlevels;
+  levels->levels = calloc(nlevels, sizeof(b2nd_array_t *));
+  levels->dirty = false;
+  if (levels->levels == NULL) {
+    free(levels);
+    return NULL;
+  }
+  return levels;
+}
+
+
+void b2nd_pyramid_levels_free(b2nd_pyramid_levels *levels) {
+  if (levels != NULL) {
+    for (int8_t nlevel = 0; nlevel < levels->nlevels; ++nlevel) {
+      if (levels->levels[nlevel] != NULL) {
+        b2nd_free(levels->levels[nlevel]);
+      }
+    }
+    free(levels->levels);
+    free(levels);
+  }
+}
+
+
+/* Get a level for updating it.  The levels of in-memory arrays are loaded into them the first time,
+ * and they stay there (see level_release()). */
+static int level_get(b2nd_array_t *array, const pyramid_meta *meta, int8_t level, b2nd_array_t **larray) {
+  if (meta->storage == PYRAMID_LEVELS_FILES) {
+    BLOSC_ERROR(level_open(array, meta, level, larray));
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  if (array->pyramid_levels == NULL) {
+    array->pyramid_levels = levels_new(meta->nlevels);
+    BLOSC_ERROR_NULL(array->pyramid_levels, BLOSC2_ERROR_MEMORY_ALLOC);
+  }
+  b2nd_pyramid_levels *levels = array->pyramid_levels;
+  if (levels->levels[level - 1] == NULL) {
+    BLOSC_ERROR(level_open(array, meta, level, &levels->levels[level - 1]));
+  }
+  *larray = levels->levels[level - 1];
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Release a level got with level_get() or created with level_create() */
+static int level_release(const pyramid_meta *meta, b2nd_array_t *larray) {
+  if (meta->storage == PYRAMID_LEVELS_FILES) {
+    BLOSC_ERROR(b2nd_free(larray));
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_pyramid_flush(const b2nd_array_t *array) {
+  b2nd_pyramid_levels *levels = array->pyramid_levels;
+  if (levels == NULL || !levels->dirty) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  pyramid_meta meta;
+  bool found;
+  BLOSC_ERROR(pyramid_meta_load(array, &meta, &found));
+  if (!found || meta.stale) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  for (int8_t level = 1; level <= levels->nlevels; ++level) {
+    b2nd_array_t *larray = levels->levels[level - 1];
+    if (larray == NULL) {
+      // Never loaded, so the stored one is up to date
+      continue;
+    }
+    char name[BLOSC2_VLMETALAYERS_NAME_MAXLEN + 1];
+    level_vlmeta_name(level, name);
+    uint8_t *cframe;
+    int64_t cframe_len;
+    bool needs_free = false;
+    int rc = b2nd_to_cframe(larray, &cframe, &cframe_len, &needs_free);
+    if (rc >= 0 && cframe_len > INT32_MAX - BLOSC2_MAX_OVERHEAD) {
+      BLOSC_TRACE_ERROR("The level %d of the pyramid is too large for a vlmetalayer", level);
+      rc = BLOSC2_ERROR_MAX_BUFSIZE_EXCEEDED;
+    }
+    if (rc >= 0) {
+      if (blosc2_vlmeta_exists(array->sc, name) < 0) {
+        rc = blosc2_vlmeta_add(array->sc, name, cframe, (int32_t) cframe_len, NULL);
+      } else {
+        rc = blosc2_vlmeta_update(array->sc, name, cframe, (int32_t) cframe_len, NULL);
+      }
+    }
+    if (needs_free) {
+      free(cframe);
+    }
+    BLOSC_ERROR(rc);
+  }
+  levels->dirty = false;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static int level_remove(b2nd_array_t *array, const pyramid_meta *meta, int8_t level) {
+  if (meta->storage == PYRAMID_LEVELS_FILES) {
+    char *path = level_urlpath(array, level);
+    if (path != NULL) {
+      blosc2_remove_urlpath(path);
+      free(path);
+    }
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  char name[BLOSC2_VLMETALAYERS_NAME_MAXLEN + 1];
+  level_vlmeta_name(level, name);
+  if (blosc2_vlmeta_exists(array->sc, name) >= 0) {
+    BLOSC_ERROR(blosc2_vlmeta_delete(array->sc, name));
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Create a level out of the previous one, with the same dtype and compression params as the array */
+static int level_create(const b2nd_array_t *array, const pyramid_meta *meta, int8_t level,
+                        const b2nd_array_t *prev, b2nd_array_t **larray) {
+  int8_t ndim = array->ndim;
+  int64_t shape[B2ND_MAX_DIM];
+  int32_t chunkshape[B2ND_MAX_DIM];
+  int32_t blockshape[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    shape[i] = (prev->shape[i] + meta->factor - 1) / meta->factor;
+    chunkshape[i] = array->chunkshape[i];
+    if (shape[i] > 0 && chunkshape[i] > shape[i]) {
+      chunkshape[i] = (int32_t) shape[i];
+    }
+    blockshape[i] = array->blockshape[i] < chunkshape[i] ? array->blockshape[i] : chunkshape[i];
+  }
+
+  blosc2_cparams *cparams;
+  BLOSC_ERROR(blosc2_schunk_get_cparams(array->sc, &cparams));
+  cparams->prefilter = NULL;
+  cparams->preparams = NULL;
+  blosc2_dparams *dparams;
+  int rc = blosc2_schunk_get_dparams(array->sc, &dparams);
+  if (rc < 0) {
+    free(cparams);
+    BLOSC_ERROR(rc);
+  }
+  dparams->postfilter = NULL;
+  dparams->postparams = NULL;
+  blosc2_storage b2_storage = {.cparams=cparams, .dparams=dparams,
+                               .contiguous=array->sc->storage->contiguous};
+  char *path = NULL;
+  if (meta->storage == PYRAMID_LEVELS_FILES) {
+    path = level_urlpath(array, level);
+    if (path == NULL) {
+      free(dparams);
+      free(cparams);
+      BLOSC_ERROR(BLOSC2_ERROR_MEMORY_ALLOC);
+    }
+    blosc2_remove_urlpath(path);
+    b2_storage.urlpath = path;
+  }
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, ndim, shape, chunkshape, blockshape,
+                                        array->dtype, array->dtype_format, NULL, 0);
+  rc = ctx != NULL ? b2nd_zeros(ctx, larray) : BLOSC2_ERROR_FAILURE;
+  if (ctx != NULL) {
+    b2nd_free_ctx(ctx);
+  }
+  free(path);
+  free(dparams);
+  free(cparams);
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* The buffers for downsampling the tiles of a level, one level chunk at a time */
+typedef struct {
+  const pyramid_meta *meta;
+  b2nd_item_kind kind;
+  int32_t itemsize;
+  uint8_t *src;      // the region of the previous level that the tile covers
+  uint8_t *dest;     // the tile
+  double *acc;       // the sum or maximum of the items of every window of the tile
+  double *counts;    // the number of items of every window of the tile
+  double *row;       // a row of the region converted to doubles
+} downsample_job;
+
+
+/* Downsample a region of the previous level (with shape `src_shape`) into a tile */
+static void downsample_tile(downsample_job *job, int8_t ndim, const int64_t *src_shape,
+                            const int64_t *dest_shape) {
+  int32_t factor = job->meta->factor;
+  int32_t itemsize = job->itemsize;
+  int64_t dest_strides[B2ND_MAX_DIM];
+  int64_t src_strides[B2ND_MAX_DIM];
+  dest_strides[ndim - 1] = 1;
+  src_strides[ndim - 1] = 1;
+  for (int i = ndim - 2; i >= 0; --i) {
+    dest_strides[i] = dest_strides[i + 1] * dest_shape[i + 1];
+    src_strides[i] = src_strides[i + 1] * src_shape[i + 1];
+  }
+  int64_t dest_nitems = dest_strides[0] * dest_shape[0];
+  int64_t src_nitems = src_strides[0] * src_shape[0];
+
+  if (job->meta->op == B2ND_PYRAMID_STRIDE) {
+    // Keep the first item of every window
+    int64_t dest_row_nitems = dest_shape[ndim - 1];
+    int64_t index[B2ND_MAX_DIM] = {0};
+    for (int64_t nitem = 0; nitem < dest_nitems; nitem += dest_row_nitems) {
+      int64_t src_nitem = 0;
+      for (int i = 0; i < ndim - 1; ++i) {
+        src_nitem += index[i] * factor * src_strides[i];
+      }
+      for (int64_t j = 0; j < dest_row_nitems; ++j) {
+        memcpy(&job->dest[(nitem + j) * itemsize], &job->src[(src_nitem + j * factor) * itemsize], itemsize);
+      }
+      for (int i = ndim - 2; i >= 0; --i) {
+        if (++index[i] < dest_shape[i]) {
+          break;
+        }
+        index[i] = 0;
+      }
+    }
+    return;
+  }
+
+  bool max = job->meta->op == B2ND_PYRAMID_MAX;
+  for (int64_t nitem = 0; nitem < dest_nitems; ++nitem) {
+    job->acc[nitem] = max ? -INFINITY : 0;
+    job->counts[nitem] = 0;
+  }
+  // Go through the rows of the region, accumulating every item into its window
+  int64_t src_row_nitems = src_shape[ndim - 1];
+  int64_t index[B2ND_MAX_DIM] = {0};
+  for (int64_t nitem = 0; nitem < src_nitems; nitem += src_row_nitems) {
+    int64_t dest_nitem = 0;
+    for (int i = 0; i < ndim - 1; ++i) {
+      dest_nitem += index[i] / factor * dest_strides[i];
+    }
+    b2nd_items_to_doubles(job->kind, itemsize, &job->src[nitem * itemsize], src_row_nitems, job->row);
+    double *acc = &job->acc[dest_nitem];
+    if (max) {
+      // NaNs win, like in NumPy
+      for (int64_t j = 0; j < src_row_nitems; ++j) {
+        double value = job->row[j];
+        if (value > acc[j / factor] || isnan(value)) {
+          acc[j / factor] = value;
+        }
+      }
+    } else {
+      double *counts = &job->counts[dest_nitem];
+      for (int64_t j = 0; j < src_row_nitems; ++j) {
+        acc[j / factor] += job->row[j];
+        counts[j / factor] += 1;
+      }
+    }
+    for (int i = ndim - 2; i >= 0; --i) {
+      if (++index[i] < src_shape[i]) {
+        break;
+      }
+      index[i] = 0;
+    }
+  }
+  if (!max) {
+    for (int64_t nitem = 0; nitem < dest_nitems; ++nitem) {
+      job->acc[nitem] /= job->counts[nitem];
+      if (job->kind != B2ND_ITEM_FLOAT) {
+        job->acc[nitem] = round(job->acc[nitem]);
+      }
+    }
+  }
+  b2nd_doubles_to_items(job->kind, itemsize, job->acc, dest_nitems, job->dest);
+}
+
+
+/* Compute the region [start, stop) of a level out of the previous one, one level chunk at a time */
+static int downsample(const pyramid_meta *meta, const b2nd_array_t *prev, b2nd_array_t *level,
+                      const int64_t *start, const int64_t *stop) {
+  int8_t ndim = level->ndim;
+  int32_t factor = meta->factor;
+  int64_t first[B2ND_MAX_DIM];
+  int64_t nchunks[B2ND_MAX_DIM];
+  int64_t src_nitems = 1;
+  for (int i = 0; i < ndim; ++i) {
+    if (start[i] >= stop[i]) {
+      return BLOSC2_ERROR_SUCCESS;
+    }
+    first[i] = start[i] / level->chunkshape[i];
+    nchunks[i] = (stop[i] - 1) / level->chunkshape[i] + 1 - first[i];
+    int64_t src_len = (int64_t) level->chunkshape[i] * factor;
+    src_nitems *= src_len < prev->shape[i] ? src_len : prev->shape[i];
+  }
+
+  downsample_job job = {.meta=meta, .itemsize=level->sc->typesize};
+  if (meta->op != B2ND_PYRAMID_STRIDE) {
+    BLOSC_ERROR(b2nd_get_item_kind(level, &job.kind, &job.itemsize));
+  }
+  int64_t dest_nitems = level->chunknitems;
+  job.src = malloc(src_nitems * job.itemsize);
+  job.dest = malloc(dest_nitems * job.itemsize);
+  job.acc = malloc(dest_nitems * sizeof(double));
+  job.counts = malloc(dest_nitems * sizeof(double));
+  job.row = malloc(prev->shape[ndim - 1] * sizeof(double));
+  int rc = BLOSC2_ERROR_SUCCESS;
+  if (job.src == NULL || job.dest == NULL || job.acc == NULL || job.counts == NULL || job.row == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+  }
+
+  int64_t index[B2ND_MAX_DIM] = {0};
+  bool done = rc < 0;
+  while (!done) {
+    int64_t tile_start[B2ND_MAX_DIM];
+    int64_t tile_stop[B2ND_MAX_DIM];
+    int64_t tile_shape[B2ND_MAX_DIM];
+    int64_t src_start[B2ND_MAX_DIM];
+    int64_t src_stop[B2ND_MAX_DIM];
+    int64_t src_shape[B2ND_MAX_DIM];
+    int64_t src_size = job.itemsize;
+    int64_t tile_size = job.itemsize;
+    for (int i = 0; i < ndim; ++i) {
+      int64_t chunk_start = (first[i] + index[i]) * level->chunkshape[i];
+      tile_start[i] = start[i] > chunk_start ? start[i] : chunk_start;
+      tile_stop[i] = chunk_start + level->chunkshape[i];
+      tile_stop[i] = stop[i] < tile_stop[i] ? stop[i] : tile_stop[i];
+      tile_shape[i] = tile_stop[i] - tile_start[i];
+      tile_size *= tile_shape[i];
+      src_start[i] = tile_start[i] * factor;
+      src_stop[i] = tile_stop[i] * factor;
+      src_stop[i] = prev->shape[i] < src_stop[i] ? prev->shape[i] : src_stop[i];
+      src_shape[i] = src_stop[i] - src_start[i];
+      src_size *= src_shape[i];
+    }
+    rc = b2nd_get_slice_cbuffer(prev, src_start, src_stop, job.src, src_shape, src_size);
+    if (rc < 0) {
+      break;
+    }
+    downsample_tile(&job, ndim, src_shape, tile_shape);
+    rc = b2nd_set_slice_cbuffer(job.dest, tile_shape, tile_size, tile_start, tile_stop, level);
+    if (rc < 0) {
+      break;
+    }
+
+    done = true;
+    for (int i = ndim - 1; i >= 0; --i) {
+      if (++index[i] < nchunks[i]) {
+        done = false;
+        break;
+      }
+      index[i] = 0;
+    }
+  }
+
+  free(job.row);
+  free(job.counts);
+  free(job.acc);
+  free(job.dest);
+  free(job.src);
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_pyramid_build(b2nd_array_t *array, int8_t nlevels, int32_t factor, b2nd_pyramid_op op) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+
+  if (array->ndim == 0) {
+    BLOSC_TRACE_ERROR("Pyramids need arrays with one dimension at least");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (nlevels < 1 || factor < 2) {
+    BLOSC_TRACE_ERROR("Pyramids need one level at least, and a factor of 2 at least");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (op != B2ND_PYRAMID_MEAN && op != B2ND_PYRAMID_MAX && op != B2ND_PYRAMID_STRIDE) {
+    BLOSC_TRACE_ERROR("Unknown pyramid operation: %d", op);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (op != B2ND_PYRAMID_STRIDE) {
+    b2nd_item_kind kind;
+    int32_t itemsize;
+    BLOSC_ERROR(b2nd_get_item_kind(array, &kind, &itemsize));
+  }
+  BLOSC_ERROR(b2nd_pyramid_drop(array));
+
+  pyramid_meta meta = {.op=op, .nlevels=nlevels, .factor=factor, .stale=false,
+                       .storage=array->sc->storage->urlpath != NULL ? PYRAMID_LEVELS_FILES :
+                                PYRAMID_LEVELS_VLMETA};
+  // The levels of in-memory arrays are kept in them, and stored when the array is serialized
+  int rc = BLOSC2_ERROR_SUCCESS;
+  if (meta.storage == PYRAMID_LEVELS_VLMETA) {
+    array->pyramid_levels = levels_new(nlevels);
+    rc = array->pyramid_levels == NULL ? BLOSC2_ERROR_MEMORY_ALLOC : BLOSC2_ERROR_SUCCESS;
+  }
+  int64_t start[B2ND_MAX_DIM] = {0};
+  b2nd_array_t *prev = array;
+  int8_t prev_level = 0;
+  for (int8_t level = 1; level <= nlevels && rc >= 0; ++level) {
+    b2nd_array_t *larray;
+    rc = level_create(array, &meta, level, prev, &larray);
+    if (rc < 0) {
+      break;
+    }
+    if (array->pyramid_levels != NULL) {
+      array->pyramid_levels->levels[level - 1] = larray;
+    }
+    rc = downsample(&meta, prev, larray, start, larray->shape);
+    if (prev_level > 0) {
+      int release_rc = level_release(&meta, prev);
+      rc = rc < 0 ? rc : release_rc;
+    }
+    prev = larray;
+    prev_level = level;
+  }
+  if (prev_level > 0) {
+    int release_rc = level_release(&meta, prev);
+    rc = rc < 0 ? rc : release_rc;
+  }
+  if (rc >= 0) {
+    rc = pyramid_meta_save(array, &meta);
+  }
+  if (rc < 0) {
+    for (int8_t nlevel = 1; nlevel <= nlevels; ++nlevel) {
+      level_remove(array, &meta, nlevel);
+    }
+    b2nd_pyramid_levels_free(array->pyramid_levels);
+    array->pyramid_levels = NULL;
+    BLOSC_ERROR(rc);
+  }
+  if (array->pyramid_levels != NULL) {
+    array->pyramid_levels->dirty = true;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_pyramid_nlevels(const b2nd_array_t *array, int8_t *nlevels) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(nlevels, BLOSC2_ERROR_NULL_POINTER);
+
+  pyramid_meta meta;
+  bool found;
+  BLOSC_ERROR(pyramid_meta_load(array, &meta, &found));
+  *nlevels = found && !meta.stale ? meta.nlevels : 0;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_pyramid_open_level(const b2nd_array_t *array, int8_t level, b2nd_array_t **larray) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(larray, BLOSC2_ERROR_NULL_POINTER);
+
+  pyramid_meta meta;
+  bool found;
+  BLOSC_ERROR(pyramid_meta_load(array, &meta, &found));
+  if (!found || meta.stale) {
+    BLOSC_TRACE_ERROR("The array has no pyramid, or it is stale");
+    BLOSC_ERROR(BLOSC2_ERROR_NOT_FOUND);
+  }
+  if (level < 1 || level > meta.nlevels) {
+    BLOSC_TRACE_ERROR("The level must be between 1 and %d", meta.nlevels);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  BLOSC_ERROR(level_open(array, &meta, level, larray));
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_pyramid_update(b2nd_array_t *array, const int64_t *start, const int64_t *stop) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(start, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(stop, BLOSC2_ERROR_NULL_POINTER);
+
+  pyramid_meta meta;
+  bool found;
+  BLOSC_ERROR(pyramid_meta_load(array, &meta, &found));
+  if (!found || meta.stale) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  int8_t ndim = array->ndim;
+  int64_t level_start[B2ND_MAX_DIM];
+  int64_t level_stop[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    if (start[i] < 0 || start[i] > stop[i] || stop[i] > array->shape[i]) {
+      BLOSC_TRACE_ERROR("The region to update must be inside the array");
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_INDEX);
+    }
+    if (start[i] == stop[i]) {
+      return BLOSC2_ERROR_SUCCESS;
+    }
+    level_start[i] = start[i];
+    level_stop[i] = stop[i];
+  }
+
+  // Every level is computed out of the windows of the previous one that cover the region
+  b2nd_array_t *prev = array;
+  int8_t prev_level = 0;
+  int rc = BLOSC2_ERROR_SUCCESS;
+  for (int8_t level = 1; level <= meta.nlevels && rc >= 0; ++level) {
+    for (int i = 0; i < ndim; ++i) {
+      level_start[i] /= meta.factor;
+      level_stop[i] = (level_stop[i] + meta.factor - 1) / meta.factor;
+    }
+    b2nd_array_t *larray;
+    rc = level_get(array, &meta, level, &larray);
+    if (rc < 0) {
+      break;
+    }
+    rc = downsample(&meta, prev, larray, level_start, level_stop);
+    if (prev_level > 0) {
+      int release_rc = level_release(&meta, prev);
+      rc = rc < 0 ? rc : release_rc;
+    }
+    prev = larray;
+    prev_level = level;
+  }
+  if (prev_level > 0) {
+    int release_rc = level_release(&meta, prev);
+    rc = rc < 0 ? rc : release_rc;
+  }
+  if (array->pyramid_levels != NULL) {
+    array->pyramid_levels->dirty = true;
+  }
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_pyramid_drop(b2nd_array_t *array) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+
+  b2nd_pyramid_levels_free(array->pyramid_levels);
+  array->pyramid_levels = NULL;
+  pyramid_meta meta;
+  bool found;
+  BLOSC_ERROR(pyramid_meta_load(array, &meta, &found));
+  if (!found) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  for (int8_t level = 1; level <= meta.nlevels; ++level) {
+    BLOSC_ERROR(level_remove(array, &meta, level));
+  }
+  BLOSC_ERROR(blosc2_vlmeta_delete(array->sc, B2ND_PYRAMID_NAME));
+  return BLOSC2_ERROR_SUCCESS;
+}
@@ -0,0 +1,756 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "blosc2.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ZONEMAP_VERSION 1
+
+
+static void zone_reset(b2nd_zone *zone) {
+  zone->min = INFINITY;
+  zone->max = -INFINITY;
+  zone->nitems = 0;
+  zone->nnans = 0;
+}
+
+
+/* Add `nitems` items holding `value` to a zone */
+static void zone_add_value(b2nd_zone *zone, double value, int64_t nitems) {
+  if (isnan(value)) {
+    zone->nnans += nitems;
+  } else if (nitems > 0) {
+    zone->min = value < zone->min ? value : zone->min;
+    zone->max = value > zone->max ? value : zone->max;
+  }
+  zone->nitems += nitems;
+}
+
+
+static void zone_merge(b2nd_zone *zone, const b2nd_zone *zone2) {
+  if (zone->nitems < 0 || zone2->nitems < 0) {
+    zone->nitems = -1;
+    return;
+  }
+  zone->min = zone2->min < zone->min ? zone2->min : zone->min;
+  zone->max = zone2->max > zone->max ? zone2->max : zone->max;
+  zone->nitems += zone2->nitems;
+  zone->nnans += zone2->nnans;
+}
+
+
+/* Whether no item in a zone can satisfy the predicate */
+static bool zone_excludes(const b2nd_zone *zone, b2nd_query_op op, double value) {
+  if (zone->nitems < 0) {
+    return false;
+  }
+  if (zone->nnans == zone->nitems) {
+    return true;
+  }
+  switch (op) {
+    case B2ND_QUERY_LT:
+      return zone->min >= value;
+    case B2ND_QUERY_LE:
+      return zone->min > value;
+    case B2ND_QUERY_GT:
+      return zone->max <= value;
+    case B2ND_QUERY_GE:
+      return zone->max < value;
+    default:
+      return value < zone->min || value > zone->max;
+  }
+}
+
+
+static bool item_matches(double item, b2nd_query_op op, double value) {
+  switch (op) {
+    case B2ND_QUERY_LT:
+      return item < value;
+    case B2ND_QUERY_LE:
+      return item <= value;
+    case B2ND_QUERY_GT:
+      return item > value;
+    case B2ND_QUERY_GE:
+      return item >= value;
+    default:
+      return item == value;
+  }
+}
+
+
+static b2nd_zone *chunk_zones(const b2nd_zonemap *zonemap, int64_t nchunk) {
+  return &zonemap->zones[nchunk * (zonemap->nblocks + 1)];
+}
+
+
+/* Compute the zone of a block of a chunk, using `row` as scratch */
+static void zone_block(const b2nd_array_t *array, const b2nd_zonemap *zonemap, const int64_t *chunk_start,
+                       int32_t nblock, const uint8_t *block, double *row, b2nd_zone *zone) {
+  int8_t ndim = array->ndim;
+  zone_reset(zone);
+  int64_t block_start[B2ND_MAX_DIM];
+  int64_t block_shape[B2ND_MAX_DIM];
+  int64_t nitems = b2nd_block_extent(array, chunk_start, nblock, block_start, block_shape);
+  if (nitems == 0) {
+    return;
+  }
+  int64_t row_nitems = block_shape[ndim - 1];
+  for (int64_t nrow = 0; nrow < nitems / row_nitems; ++nrow) {
+    int64_t row_start[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim((int8_t) (ndim - 1), block_shape, nrow, row_start);
+    int64_t offset = 0;
+    for (int i = 0; i < ndim - 1; ++i) {
+      offset += row_start[i] * array->item_block_strides[i];
+    }
+    b2nd_items_to_doubles(zonemap->kind, zonemap->itemsize, &block[offset * zonemap->itemsize], row_nitems,
+                          row);
+    for (int64_t nitem = 0; nitem < row_nitems; ++nitem) {
+      zone_add_value(zone, row[nitem], 1);
+    }
+  }
+}
+
+
+/* Compute the zone of a chunk from the zones of its blocks */
+static void zone_chunk(const b2nd_zonemap *zonemap, int64_t nchunk) {
+  b2nd_zone *zones = chunk_zones(zonemap, nchunk);
+  zone_reset(&zones[0]);
+  for (int32_t nblock = 0; nblock < zonemap->nblocks; ++nblock) {
+    zone_merge(&zones[0], &zones[1 + nblock]);
+  }
+}
+
+
+static void get_chunk_start(const b2nd_array_t *array, int64_t nchunk, int64_t *chunk_start) {
+  int64_t chunks_in_array[B2ND_MAX_DIM];
+  for (int i = 0; i < array->ndim; ++i) {
+    chunks_in_array[i] = array->extshape[i] / array->chunkshape[i];
+  }
+  blosc2_unidim_to_multidim(array->ndim, chunks_in_array, nchunk, chunk_start);
+  for (int i = 0; i < array->ndim; ++i) {
+    chunk_start[i] *= array->chunkshape[i];
+  }
+}
+
+
+/* FNV-1a */
+static uint64_t fingerprint_bytes(uint64_t hash, const uint8_t *bytes, int64_t nbytes) {
+  for (int64_t i = 0; i < nbytes; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+
+/* The fingerprint of a chunk: its header and the starts of its blocks, the whole of it when it is
+ * memcpyed, or what the header does not tell about a special chunk */
+static uint64_t chunk_fingerprint(const uint8_t *chunk) {
+  int32_t nbytes;
+  int32_t cbytes;
+  int32_t blocksize;
+  blosc2_cbuffer_sizes(chunk, &nbytes, &cbytes, &blocksize);
+  uint8_t header[BLOSC_EXTENDED_HEADER_LENGTH];
+  memcpy(header, chunk, BLOSC_EXTENDED_HEADER_LENGTH);
+  // Chunks read lazily are flagged as such
+  header[BLOSC2_CHUNK_BLOSC2_FLAGS] &= (uint8_t) ~0x08u;
+  int special_value = (header[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  switch (special_value) {
+    case 0:
+      hash = fingerprint_bytes(hash, header, BLOSC_EXTENDED_HEADER_LENGTH);
+      if (header[BLOSC2_CHUNK_FLAGS] & BLOSC_MEMCPYED) {
+        hash = fingerprint_bytes(hash, chunk + BLOSC_EXTENDED_HEADER_LENGTH,
+                                 cbytes - BLOSC_EXTENDED_HEADER_LENGTH);
+      } else if (blocksize > 0) {
+        int32_t nblocks = nbytes / blocksize + (nbytes % blocksize > 0 ? 1 : 0);
+        hash = fingerprint_bytes(hash, chunk + BLOSC_EXTENDED_HEADER_LENGTH, nblocks * (int64_t) sizeof(int32_t));
+      }
+      break;
+    case BLOSC2_SPECIAL_VALUE:
+      hash = fingerprint_bytes(hash, header, BLOSC_EXTENDED_HEADER_LENGTH);
+      hash = fingerprint_bytes(hash, chunk + BLOSC_EXTENDED_HEADER_LENGTH, header[BLOSC2_CHUNK_TYPESIZE]);
+      break;
+    default:
+      // Frames rebuild the headers of these chunks
+      hash = fingerprint_bytes(hash, &header[BLOSC2_CHUNK_BLOSC2_FLAGS], 1);
+      hash = fingerprint_bytes(hash, (uint8_t *) &nbytes, sizeof(nbytes));
+      break;
+  }
+  return hash;
+}
+
+
+/* The fingerprint of a chunk of the array */
+static int get_chunk_fingerprint(const b2nd_array_t *array, int64_t nchunk, uint64_t *fingerprint) {
+  uint8_t *chunk;
+  bool needs_free;
+  BLOSC_ERROR(blosc2_schunk_get_lazychunk(array->sc, nchunk, &chunk, &needs_free));
+  // Lazy chunks do not have the data of memcpyed chunks
+  if ((chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] & 0x08u) && (chunk[BLOSC2_CHUNK_FLAGS] & BLOSC_MEMCPYED) &&
+      ((chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK) == 0) {
+    if (needs_free) {
+      free(chunk);
+    }
+    BLOSC_ERROR(blosc2_schunk_get_chunk(array->sc, nchunk, &chunk, &needs_free));
+  }
+  *fingerprint = chunk_fingerprint(chunk);
+  if (needs_free) {
+    free(chunk);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static b2nd_zonemap *zonemap_new(const b2nd_array_t *array) {
+  if (array->blocknitems == 0) {
+    return NULL;
+  }
+  b2nd_zonemap *zonemap = malloc(sizeof(b2nd_zonemap));
+  if (zonemap == NULL) {
+    return NULL;
+  }
+  if (b2nd_get_item_kind(array, &zonemap->kind, &zonemap->itemsize) < 0) {
+    free(zonemap);
+    return NULL;
+  }
+  zonemap->nchunks = array->sc->nchunks;
+  zonemap->nblocks = (int32_t) (array->extchunknitems / array->blocknitems);
+  zonemap->zones = malloc(zonemap->nchunks * (zonemap->nblocks + 1) * sizeof(b2nd_zone) + 1);
+  zonemap->fingerprints = malloc(zonemap->nchunks * sizeof(uint64_t) + 1);
+  zonemap->dirty = false;
+  if (zonemap->zones == NULL || zonemap->fingerprints == NULL) {
+    b2nd_zonemap_free(zonemap);
+    return NULL;
+  }
+  return zonemap;
+}
+
+
+void b2nd_zonemap_free(b2nd_zonemap *zonemap) {
+  if (zonemap != NULL) {
+    free(zonemap->zones);
+    free(zonemap->fingerprints);
+    free(zonemap);
+  }
+}
+
+
+/* The zone map is kept as the geometry of the array (to detect stale ones) followed by the zones
+ * and the fingerprints of the chunks */
+static int32_t zonemap_nbytes(int8_t ndim, int64_t nchunks, int32_t nblocks) {
+  int64_t nbytes = 1 + 1 + ndim * (sizeof(int64_t) + 2 * sizeof(int32_t)) + sizeof(int64_t) +
+                   sizeof(int32_t) + nchunks * ((nblocks + 1) * 4 * sizeof(int64_t) + sizeof(uint64_t));
+  return nbytes > INT32_MAX - BLOSC2_MAX_OVERHEAD ? -1 : (int32_t) nbytes;
+}
+
+
+int b2nd_zonemap_save(const b2nd_array_t *array, const b2nd_zonemap *zonemap) {
+  int8_t ndim = array->ndim;
+  int64_t nzones = zonemap->nchunks * (zonemap->nblocks + 1);
+  int32_t content_len = zonemap_nbytes(ndim, zonemap->nchunks, zonemap->nblocks);
+  if (content_len < 0) {
+    BLOSC_TRACE_ERROR("The zone map is too large");
+    BLOSC_ERROR(BLOSC2_ERROR_MAX_BUFSIZE_EXCEEDED);
+  }
+  uint8_t *content = malloc(content_len);
+  BLOSC_ERROR_NULL(content, BLOSC2_ERROR_MEMORY_ALLOC);
+  uint8_t *pcontent = content;
+  *pcontent++ = ZONEMAP_VERSION;
+  *pcontent++ = (uint8_t) ndim;
+  for (int i = 0; i < ndim; ++i) {
+    swap_store(pcontent, &array->shape[i], sizeof(int64_t));
+    pcontent += sizeof(int64_t);
+    swap_store(pcontent, &array->chunkshape[i], sizeof(int32_t));
+    pcontent += sizeof(int32_t);
+    swap_store(pcontent, &array->blockshape[i], sizeof(int32_t));
+    pcontent += sizeof(int32_t);
+  }
+  swap_store(pcontent, &zonemap->nchunks, sizeof(int64_t));
+  pcontent += sizeof(int64_t);
+  swap_store(pcontent, &zonemap->nblocks, sizeof(int32_t));
+  pcontent += sizeof(int32_t);
+  for (int64_t nzone = 0; nzone < nzones; ++nzone) {
+    b2nd_zone *zone = &zonemap->zones[nzone];
+    swap_store(pcontent, &zone->min, sizeof(double));
+    swap_store(pcontent + 8, &zone->max, sizeof(double));
+    swap_store(pcontent + 16, &zone->nitems, sizeof(int64_t));
+    swap_store(pcontent + 24, &zone->nnans, sizeof(int64_t));
+    pcontent += 4 * sizeof(int64_t);
+  }
+  for (int64_t nchunk = 0; nchunk < zonemap->nchunks; ++nchunk) {
+    swap_store(pcontent, &zonemap->fingerprints[nchunk], sizeof(uint64_t));
+    pcontent += sizeof(uint64_t);
+  }
+
+  int rc;
+  if (blosc2_vlmeta_exists(array->sc, B2ND_ZONEMAP_NAME) < 0) {
+    rc = blosc2_vlmeta_add(array->sc, B2ND_ZONEMAP_NAME, content, content_len, NULL);
+  } else {
+    rc = blosc2_vlmeta_update(array->sc, B2ND_ZONEMAP_NAME, content, content_len, NULL);
+  }
+  free(content);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error storing the zone map");
+    BLOSC_ERROR(rc);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_zonemap_load(const b2nd_array_t *array, b2nd_zonemap **zonemap) {
+  *zonemap = NULL;
+  if (array->sc == NULL || blosc2_vlmeta_exists(array->sc, B2ND_ZONEMAP_NAME) < 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  uint8_t *content;
+  int32_t content_len;
+  BLOSC_ERROR(blosc2_vlmeta_get(array->sc, B2ND_ZONEMAP_NAME, &content, &content_len));
+
+  // Zone maps that do not match the geometry of the array are stale
+  int8_t ndim = array->ndim;
+  bool valid = ndim > 0 && content_len >= zonemap_nbytes(ndim, 0, 0) &&
+               content[0] == ZONEMAP_VERSION && (int8_t) content[1] == ndim;
+  uint8_t *pcontent = &content[2];
+  for (int i = 0; valid && i < ndim; ++i) {
+    int64_t shape;
+    int32_t chunkshape;
+    int32_t blockshape;
+    swap_store(&shape, pcontent, sizeof(int64_t));
+    swap_store(&chunkshape, pcontent + 8, sizeof(int32_t));
+    swap_store(&blockshape, pcontent + 12, sizeof(int32_t));
+    pcontent += sizeof(int64_t) + 2 * sizeof(int32_t);
+    valid = shape == array->shape[i] && chunkshape == array->chunkshape[i] &&
+            blockshape == array->blockshape[i];
+  }
+  b2nd_zonemap *zonemap_ = valid ? zonemap_new(array) : NULL;
+  if (zonemap_ != NULL) {
+    int64_t nchunks;
+    int32_t nblocks;
+    swap_store(&nchunks, pcontent, sizeof(int64_t));
+    swap_store(&nblocks, pcontent + 8, sizeof(int32_t));
+    pcontent += sizeof(int64_t) + sizeof(int32_t);
+    valid = nchunks == zonemap_->nchunks && nblocks == zonemap_->nblocks &&
+            content_len == zonemap_nbytes(ndim, nchunks, nblocks);
+  }
+  if (zonemap_ != NULL && valid) {
+    for (int64_t nzone = 0; nzone < zonemap_->nchunks * (zonemap_->nblocks + 1); ++nzone) {
+      b2nd_zone *zone = &zonemap_->zones[nzone];
+      swap_store(&zone->min, pcontent, sizeof(double));
+      swap_store(&zone->max, pcontent + 8, sizeof(double));
+      swap_store(&zone->nitems, pcontent + 16, sizeof(int64_t));
+      swap_store(&zone->nnans, pcontent + 24, sizeof(int64_t));
+      pcontent += 4 * sizeof(int64_t);
+    }
+    for (int64_t nchunk = 0; nchunk < zonemap_->nchunks; ++nchunk) {
+      swap_store(&zonemap_->fingerprints[nchunk], pcontent, sizeof(uint64_t));
+      pcontent += sizeof(uint64_t);
+    }
+    *zonemap = zonemap_;
+  } else {
+    b2nd_zonemap_free(zonemap_);
+  }
+  free(content);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_zonemap_get(b2nd_array_t *array, b2nd_zonemap **zonemap) {
+  // Chunks may have been added or removed without the b2nd API
+  if (array->zonemap != NULL && array->zonemap->nchunks != array->sc->nchunks) {
+    BLOSC_ERROR(b2nd_zonemap_drop(array));
+  }
+  if (array->zonemap == NULL) {
+    BLOSC_ERROR(b2nd_zonemap_load(array, &array->zonemap));
+  }
+  *zonemap = array->zonemap;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_zonemap_flush(const b2nd_array_t *array) {
+  b2nd_zonemap *zonemap = array->zonemap;
+  if (zonemap == NULL || !zonemap->dirty || zonemap->nchunks != array->sc->nchunks) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  BLOSC_ERROR(b2nd_zonemap_save(array, zonemap));
+  zonemap->dirty = false;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_zonemap_drop(b2nd_array_t *array) {
+  b2nd_zonemap_free(array->zonemap);
+  array->zonemap = NULL;
+  if (blosc2_vlmeta_exists(array->sc, B2ND_ZONEMAP_NAME) >= 0) {
+    BLOSC_ERROR(blosc2_vlmeta_delete(array->sc, B2ND_ZONEMAP_NAME));
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_zonemap_update(const b2nd_array_t *array, b2nd_zonemap *zonemap, int64_t nchunk,
+                        const uint8_t *data, const bool *blocks) {
+  double *row = malloc(array->blockshape[array->ndim - 1] * sizeof(double));
+  BLOSC_ERROR_NULL(row, BLOSC2_ERROR_MEMORY_ALLOC);
+  int64_t chunk_start[B2ND_MAX_DIM];
+  get_chunk_start(array, nchunk, chunk_start);
+  b2nd_zone *zones = chunk_zones(zonemap, nchunk);
+  for (int32_t nblock = 0; nblock < zonemap->nblocks; ++nblock) {
+    if (blocks == NULL || blocks[nblock]) {
+      zone_block(array, zonemap, chunk_start, nblock, &data[nblock * array->blocknitems * zonemap->itemsize],
+                 row, &zones[1 + nblock]);
+    }
+  }
+  zone_chunk(zonemap, nchunk);
+  free(row);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+void b2nd_zonemap_set_chunk(b2nd_zonemap *zonemap, int64_t nchunk, const uint8_t *chunk) {
+  zonemap->fingerprints[nchunk] = chunk_fingerprint(chunk);
+}
+
+
+/* The state for building a zone map */
+typedef struct {
+  b2nd_zonemap *zonemap;
+  double *rows;  // a row of the block converted to doubles for every thread
+} zonemap_job;
+
+
+static void zonemap_scan_block(b2nd_scanner *scanner, int tid, int32_t nblock, const uint8_t *block) {
+  zonemap_job *job = (zonemap_job *) scanner->user_data;
+  const b2nd_array_t *array = scanner->array;
+  zone_block(array, job->zonemap, scanner->chunk_start, nblock, block,
+             &job->rows[tid * array->blockshape[array->ndim - 1]],
+             &chunk_zones(job->zonemap, scanner->nchunk)[1 + nblock]);
+}
+
+
+static bool zonemap_scan_special(b2nd_scanner *scanner, int special_type, const uint8_t *value) {
+  zonemap_job *job = (zonemap_job *) scanner->user_data;
+  b2nd_zone *zones = chunk_zones(job->zonemap, scanner->nchunk);
+  double value_ = 0;
+  switch (special_type) {
+    case BLOSC2_SPECIAL_VALUE:
+      b2nd_items_to_doubles(job->zonemap->kind, job->zonemap->itemsize, value, 1, &value_);
+      break;
+    case BLOSC2_SPECIAL_NAN:
+      value_ = NAN;
+      break;
+    default:
+      break;
+  }
+  for (int32_t nblock = 0; nblock < job->zonemap->nblocks; ++nblock) {
+    int64_t block_start[B2ND_MAX_DIM];
+    int64_t block_shape[B2ND_MAX_DIM];
+    int64_t nitems = b2nd_block_extent(scanner->array, scanner->chunk_start, nblock, block_start, block_shape);
+    zone_reset(&zones[1 + nblock]);
+    if (special_type == BLOSC2_SPECIAL_UNINIT) {
+      // The items can be anything
+      zones[1 + nblock].nitems = nitems > 0 ? -1 : 0;
+    } else {
+      zone_add_value(&zones[1 + nblock], value_, nitems);
+    }
+  }
+  return true;
+}
+
+
+int b2nd_build_zonemap(b2nd_array_t *array) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  if (array->ndim == 0 || array->nitems == 0) {
+    BLOSC_TRACE_ERROR("Zone maps are not supported for arrays without items or dimensions");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  b2nd_item_kind kind;
+  int32_t itemsize;
+  BLOSC_ERROR(b2nd_get_item_kind(array, &kind, &itemsize));
+
+  zonemap_job job = {0};
+  job.zonemap = zonemap_new(array);
+  BLOSC_ERROR_NULL(job.zonemap, BLOSC2_ERROR_MEMORY_ALLOC);
+  b2nd_scanner scanner = {0};
+  scanner.user_data = &job;
+  scanner.scan_block = zonemap_scan_block;
+  scanner.scan_special = zonemap_scan_special;
+  int rc = b2nd_scanner_init(&scanner, array);
+  if (rc >= 0) {
+    job.rows = malloc(scanner.nthreads * array->blockshape[array->ndim - 1] * sizeof(double));
+    rc = job.rows == NULL ? BLOSC2_ERROR_MEMORY_ALLOC : BLOSC2_ERROR_SUCCESS;
+  }
+  for (int64_t nchunk = 0; nchunk < job.zonemap->nchunks && rc >= 0; ++nchunk) {
+    // The blocks in the padding are not scanned
+    b2nd_zone *zones = chunk_zones(job.zonemap, nchunk);
+    for (int32_t nblock = 0; nblock < job.zonemap->nblocks; ++nblock) {
+      zone_reset(&zones[1 + nblock]);
+    }
+    rc = get_chunk_fingerprint(array, nchunk, &job.zonemap->fingerprints[nchunk]);
+    if (rc >= 0) {
+      rc = b2nd_scan_chunk(&scanner, nchunk, NULL);
+    }
+    zone_chunk(job.zonemap, nchunk);
+  }
+  if (rc >= 0) {
+    rc = b2nd_zonemap_save(array, job.zonemap);
+  }
+  free(job.rows);
+  b2nd_scanner_destroy(&scanner);
+  if (rc >= 0) {
+    // The array keeps the new zone map up to date from now on
+    b2nd_zonemap_free(array->zonemap);
+    array->zonemap = job.zonemap;
+  } else {
+    b2nd_zonemap_free(job.zonemap);
+  }
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* The indexes of the matching items found by a thread */
+typedef struct {
+  int64_t *indexes;
+  int64_t nindexes;
+  int64_t size;
+  bool error;
+} query_matches;
+
+
+static void matches_add(query_matches *matches, int64_t index) {
+  if (matches->nindexes == matches->size) {
+    int64_t size = matches->size > 0 ? 2 * matches->size : 1024;
+    int64_t *indexes = realloc(matches->indexes, size * sizeof(int64_t));
+    if (indexes == NULL) {
+      matches->error = true;
+      return;
+    }
+    matches->indexes = indexes;
+    matches->size = size;
+  }
+  matches->indexes[matches->nindexes++] = index;
+}
+
+
+/* The state of a query */
+typedef struct {
+  b2nd_query_op op;
+  double value;
+  b2nd_item_kind kind;
+  int32_t itemsize;
+  double *rows;  // a row of the block converted to doubles for every thread
+  query_matches *matches;  // for every thread
+} query_job;
+
+
+static void query_scan_block(b2nd_scanner *scanner, int tid, int32_t nblock, const uint8_t *block) {
+  query_job *job = (query_job *) scanner->user_data;
+  const b2nd_array_t *array = scanner->array;
+  int8_t ndim = array->ndim;
+  int64_t block_start[B2ND_MAX_DIM];
+  int64_t block_shape[B2ND_MAX_DIM];
+  int64_t nitems = b2nd_block_extent(array, scanner->chunk_start, nblock, block_start, block_shape);
+  if (nitems == 0) {
+    return;
+  }
+  double *row = &job->rows[tid * array->blockshape[ndim - 1]];
+  int64_t row_nitems = block_shape[ndim - 1];
+  for (int64_t nrow = 0; nrow < nitems / row_nitems; ++nrow) {
+    int64_t row_start[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim((int8_t) (ndim - 1), block_shape, nrow, row_start);
+    int64_t offset = 0;
+    int64_t index = block_start[ndim - 1];
+    for (int i = 0; i < ndim - 1; ++i) {
+      offset += row_start[i] * array->item_block_strides[i];
+      index += (block_start[i] + row_start[i]) * array->item_array_strides[i];
+    }
+    b2nd_items_to_doubles(job->kind, job->itemsize, &block[offset * job->itemsize], row_nitems, row);
+    for (int64_t nitem = 0; nitem < row_nitems; ++nitem) {
+      if (item_matches(row[nitem], job->op, job->value)) {
+        matches_add(&job->matches[tid], index + nitem);
+      }
+    }
+  }
+}
+
+
+static bool query_scan_special(b2nd_scanner *scanner, int special_type, const uint8_t *value) {
+  query_job *job = (query_job *) scanner->user_data;
+  const b2nd_array_t *array = scanner->array;
+  int8_t ndim = array->ndim;
+  double value_ = 0;
+  switch (special_type) {
+    case BLOSC2_SPECIAL_VALUE:
+      b2nd_items_to_doubles(job->kind, job->itemsize, value, 1, &value_);
+      break;
+    case BLOSC2_SPECIAL_ZERO:
+      break;
+    default:
+      // NaNs never match, and neither do uninitialized items
+      return true;
+  }
+  if (!item_matches(value_, job->op, job->value)) {
+    return true;
+  }
+  // All the items in the chunk match
+  int64_t chunk_shape[B2ND_MAX_DIM];
+  int64_t nrows = 1;
+  for (int i = 0; i < ndim; ++i) {
+    chunk_shape[i] = array->shape[i] - scanner->chunk_start[i];
+    if (chunk_shape[i] > array->chunkshape[i]) {
+      chunk_shape[i] = array->chunkshape[i];
+    }
+    nrows *= i < ndim - 1 ? chunk_shape[i] : 1;
+  }
+  for (int64_t nrow = 0; nrow < nrows; ++nrow) {
+    int64_t row_start[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim((int8_t) (ndim - 1), chunk_shape, nrow, row_start);
+    int64_t index = scanner->chunk_start[ndim - 1];
+    for (int i = 0; i < ndim - 1; ++i) {
+      index += (scanner->chunk_start[i] + row_start[i]) * array->item_array_strides[i];
+    }
+    for (int64_t nitem = 0; nitem < chunk_shape[ndim - 1]; ++nitem) {
+      matches_add(&job->matches[0], index + nitem);
+    }
+  }
+  return true;
+}
+
+
+static int compare_indexes(const void *a, const void *b) {
+  int64_t a_ = *(const int64_t *) a;
+  int64_t b_ = *(const int64_t *) b;
+  return (a_ > b_) - (a_ < b_);
+}
+
+
+int b2nd_query(const b2nd_array_t *array, b2nd_query_op op, double value,
+               int64_t **indexes, int64_t *nindexes) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(indexes, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(nindexes, BLOSC2_ERROR_NULL_POINTER);
+  if (op < B2ND_QUERY_LT || op > B2ND_QUERY_EQ) {
+    BLOSC_TRACE_ERROR("Unknown predicate (%d)", op);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  query_job job = {0};
+  job.op = op;
+  job.value = value;
+  BLOSC_ERROR(b2nd_get_item_kind(array, &job.kind, &job.itemsize));
+  // The zone map being written by the array is more recent than the stored one
+  b2nd_zonemap *zonemap = array->zonemap;
+  b2nd_zonemap *loaded_zonemap = NULL;
+  if (zonemap == NULL) {
+    BLOSC_ERROR(b2nd_zonemap_load(array, &loaded_zonemap));
+    zonemap = loaded_zonemap;
+  } else if (zonemap->nchunks != array->sc->nchunks) {
+    zonemap = NULL;
+  }
+
+  int8_t ndim = array->ndim;
+  b2nd_scanner scanner = {0};
+  scanner.user_data = &job;
+  scanner.scan_block = query_scan_block;
+  scanner.scan_special = query_scan_special;
+  int rc = b2nd_scanner_init(&scanner, array);
+  bool *skip = NULL;
+  if (rc >= 0) {
+    job.matches = calloc(scanner.nthreads, sizeof(query_matches));
+    job.rows = malloc(scanner.nthreads * (ndim > 0 ? array->blockshape[ndim - 1] : 1) * sizeof(double));
+    skip = malloc(scanner.nblocks > 0 ? scanner.nblocks : 1);
+    if (job.matches == NULL || job.rows == NULL || skip == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    }
+  }
+
+  if (rc < 0 || isnan(value)) {
+    // Nothing matches a NaN
+  } else if (ndim == 0) {
+    rc = blosc2_schunk_decompress_chunk(array->sc, 0, scanner.data, scanner.data_nbytes);
+    if (rc >= 0) {
+      double item;
+      b2nd_items_to_doubles(job.kind, job.itemsize, scanner.data, 1, &item);
+      if (item_matches(item, op, value)) {
+        matches_add(&job.matches[0], 0);
+      }
+    }
+  } else if (array->nitems > 0) {
+    for (int64_t nchunk = 0; nchunk < array->sc->nchunks && rc >= 0; ++nchunk) {
+      if (zonemap == NULL) {
+        rc = b2nd_scan_chunk(&scanner, nchunk, NULL);
+        continue;
+      }
+      // The zones of the chunks replaced without the zone map do not apply
+      uint64_t fingerprint;
+      rc = get_chunk_fingerprint(array, nchunk, &fingerprint);
+      if (rc >= 0 && fingerprint != zonemap->fingerprints[nchunk]) {
+        rc = b2nd_scan_chunk(&scanner, nchunk, NULL);
+        continue;
+      }
+      if (rc < 0) {
+        break;
+      }
+      // Skip the chunks and blocks whose zones rule out the predicate
+      b2nd_zone *zones = chunk_zones(zonemap, nchunk);
+      if (zone_excludes(&zones[0], op, value)) {
+        continue;
+      }
+      for (int32_t nblock = 0; nblock < zonemap->nblocks; ++nblock) {
+        skip[nblock] = zone_excludes(&zones[1 + nblock], op, value);
+      }
+      rc = b2nd_scan_chunk(&scanner, nchunk, skip);
+    }
+  }
+
+  // Gather the matches of all the threads
+  int64_t nmatches = 0;
+  for (int tid = 0; rc >= 0 && tid < scanner.nthreads; ++tid) {
+    if (job.matches[tid].error) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    }
+    nmatches += job.matches[tid].nindexes;
+  }
+  if (rc >= 0) {
+    *indexes = malloc(nmatches > 0 ? nmatches * sizeof(int64_t) : 1);
+    if (*indexes == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    }
+  }
+  if (rc >= 0) {
+    *nindexes = 0;
+    for (int tid = 0; tid < scanner.nthreads; ++tid) {
+      if (job.matches[tid].nindexes > 0) {
+        memcpy(&(*indexes)[*nindexes], job.matches[tid].indexes, job.matches[tid].nindexes * sizeof(int64_t));
+        *nindexes += job.matches[tid].nindexes;
+      }
+    }
+    qsort(*indexes, *nindexes, sizeof(int64_t), compare_indexes);
+  }
+
+  for (int tid = 0; job.matches != NULL && tid < scanner.nthreads; ++tid) {
+    free(job.matches[tid].indexes);
+  }
+  free(job.matches);
+  free(job.rows);
+  free(skip);
+  b2nd_scanner_destroy(&scanner);
+  b2nd_zonemap_free(loaded_zonemap);
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
@@ -0,0 +1,581 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "schunk-private.h"
+#include "blosc2.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* The partial reduction of some items */
+typedef struct {
+  double value;  // the sum, minimum or maximum of the items that are not NaN
+  int64_t count;  // the number of items that are not NaN
+} reduce_acc;
+
+typedef struct {
+  const b2nd_array_t *array;
+  b2nd_reduce_op op;
+  int8_t axis;
+  b2nd_item_kind kind;
+  int32_t itemsize;
+  int64_t out_nitems;
+  int64_t out_strides[B2ND_MAX_DIM];  // 0 for the reduced dimensions
+  reduce_acc *partials;  // out_nitems accumulators for every thread
+  double *rows;  // a row of the block converted to doubles for every thread
+} reduce_job;
+
+
+int b2nd_get_item_kind(const b2nd_array_t *array, b2nd_item_kind *kind, int32_t *itemsize) {
+  const char *dtype = array->dtype != NULL ? array->dtype : B2ND_DEFAULT_DTYPE;
+  if (array->dtype_format != DTYPE_NUMPY_FORMAT || strlen(dtype) < 3 ||
+      (dtype[0] != '<' && dtype[0] != '|' && dtype[0] != '=')) {
+    BLOSC_TRACE_ERROR("Only little-endian NumPy numeric dtypes are supported (not '%s')", dtype);
+    return BLOSC2_ERROR_INVALID_PARAM;
+  }
+  *itemsize = (int32_t) strtol(&dtype[2], NULL, 10);
+  switch (dtype[1]) {
+    case 'i':
+      *kind = B2ND_ITEM_INT;
+      break;
+    case 'u':
+    case 'b':
+      *kind = B2ND_ITEM_UINT;
+      break;
+    case 'f':
+      *kind = B2ND_ITEM_FLOAT;
+      break;
+    default:
+      *kind = B2ND_ITEM_UINT;
+      *itemsize = 0;
+  }
+  bool supported = (*kind == B2ND_ITEM_FLOAT) ? (*itemsize == 4 || *itemsize == 8) :
+                   (*itemsize == 1 || *itemsize == 2 || *itemsize == 4 || *itemsize == 8);
+  if (!supported || *itemsize != array->sc->typesize) {
+    BLOSC_TRACE_ERROR("The dtype '%s' is not supported", dtype);
+    return BLOSC2_ERROR_INVALID_PARAM;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+#define LOAD_ROW(type)                                  \
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {    \
+    type item;                                          \
+    memcpy(&item, &src[nitem * sizeof(type)], sizeof(type)); \
+    dest[nitem] = (double) item;                        \
+  }                                                     \
+  return
+
+void b2nd_items_to_doubles(b2nd_item_kind kind, int32_t itemsize, const uint8_t *src, int64_t nitems,
+                           double *dest) {
+  switch (kind) {
+    case B2ND_ITEM_FLOAT:
+      if (itemsize == 4) {
+        LOAD_ROW(float);
+      }
+      LOAD_ROW(double);
+    case B2ND_ITEM_INT:
+      switch (itemsize) {
+        case 1: LOAD_ROW(int8_t);
+        case 2: LOAD_ROW(int16_t);
+        case 4: LOAD_ROW(int32_t);
+        default: LOAD_ROW(int64_t);
+      }
+    default:
+      switch (itemsize) {
+        case 1: LOAD_ROW(uint8_t);
+        case 2: LOAD_ROW(uint16_t);
+        case 4: LOAD_ROW(uint32_t);
+        default: LOAD_ROW(uint64_t);
+      }
+  }
+}
+
+#undef LOAD_ROW
+
+
+#define STORE_ROW(type)                                 \
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {    \
+    type item = (type) src[nitem];                      \
+    memcpy(&dest[nitem * sizeof(type)], &item, sizeof(type)); \
+  }                                                     \
+  return
+
+/* Integers cannot hold NaNs, which are stored as zeros */
+#define STORE_INT_ROW(type)                             \
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {    \
+    type item = isnan(src[nitem]) ? 0 : (type) src[nitem]; \
+    memcpy(&dest[nitem * sizeof(type)], &item, sizeof(type)); \
+  }                                                     \
+  return
+
+void b2nd_doubles_to_items(b2nd_item_kind kind, int32_t itemsize, const double *src, int64_t nitems,
+                           uint8_t *dest) {
+  switch (kind) {
+    case B2ND_ITEM_FLOAT:
+      if (itemsize == 4) {
+        STORE_ROW(float);
+      }
+      STORE_ROW(double);
+    case B2ND_ITEM_INT:
+      switch (itemsize) {
+        case 1: STORE_INT_ROW(int8_t);
+        case 2: STORE_INT_ROW(int16_t);
+        case 4: STORE_INT_ROW(int32_t);
+        default: STORE_INT_ROW(int64_t);
+      }
+    default:
+      switch (itemsize) {
+        case 1: STORE_INT_ROW(uint8_t);
+        case 2: STORE_INT_ROW(uint16_t);
+        case 4: STORE_INT_ROW(uint32_t);
+        default: STORE_INT_ROW(uint64_t);
+      }
+  }
+}
+
+#undef STORE_INT_ROW
+#undef STORE_ROW
+
+
+/* Accumulate `nitems` items holding `value` */
+static inline void acc_value(reduce_acc *acc, b2nd_reduce_op op, double value, int64_t nitems) {
+  if (isnan(value) || nitems == 0) {
+    return;
+  }
+  switch (op) {
+    case B2ND_REDUCE_MIN:
+      acc->value = value < acc->value ? value : acc->value;
+      break;
+    case B2ND_REDUCE_MAX:
+      acc->value = value > acc->value ? value : acc->value;
+      break;
+    default:
+      acc->value += value * (double) nitems;
+  }
+  acc->count += nitems;
+}
+
+
+/* Accumulate a row of items into a single accumulator */
+static void acc_row(reduce_acc *acc, b2nd_reduce_op op, const double *row, int64_t nitems) {
+  double value = acc->value;
+  int64_t count = 0;
+  switch (op) {
+    case B2ND_REDUCE_MIN:
+      for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+        if (!isnan(row[nitem])) {
+          value = row[nitem] < value ? row[nitem] : value;
+          count++;
+        }
+      }
+      break;
+    case B2ND_REDUCE_MAX:
+      for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+        if (!isnan(row[nitem])) {
+          value = row[nitem] > value ? row[nitem] : value;
+          count++;
+        }
+      }
+      break;
+    default:
+      for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+        if (!isnan(row[nitem])) {
+          value += row[nitem];
+          count++;
+        }
+      }
+  }
+  acc->value = value;
+  acc->count += count;
+}
+
+
+/* Merge the partial reduction in `acc2` into `acc` */
+static void acc_merge(reduce_acc *acc, b2nd_reduce_op op, const reduce_acc *acc2) {
+  if (acc2->count == 0) {
+    return;
+  }
+  switch (op) {
+    case B2ND_REDUCE_MIN:
+      acc->value = acc2->value < acc->value ? acc2->value : acc->value;
+      break;
+    case B2ND_REDUCE_MAX:
+      acc->value = acc2->value > acc->value ? acc2->value : acc->value;
+      break;
+    default:
+      acc->value += acc2->value;
+  }
+  acc->count += acc2->count;
+}
+
+
+int64_t b2nd_block_extent(const b2nd_array_t *array, const int64_t *chunk_start, int32_t nblock,
+                          int64_t *block_start, int64_t *block_shape) {
+  int8_t ndim = array->ndim;
+  int64_t nblock_ndim[B2ND_MAX_DIM];
+  int64_t blocks_in_chunk[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    blocks_in_chunk[i] = array->extchunkshape[i] / array->blockshape[i];
+  }
+  blosc2_unidim_to_multidim(ndim, blocks_in_chunk, nblock, nblock_ndim);
+  int64_t nitems = 1;
+  for (int i = 0; i < ndim; ++i) {
+    block_start[i] = chunk_start[i] + nblock_ndim[i] * array->blockshape[i];
+    int64_t chunk_stop = chunk_start[i] + array->chunkshape[i];
+    block_shape[i] = (chunk_stop < array->shape[i] ? chunk_stop : array->shape[i]) - block_start[i];
+    if (block_shape[i] > array->blockshape[i]) {
+      block_shape[i] = array->blockshape[i];
+    }
+    if (block_shape[i] <= 0) {
+      return 0;
+    }
+    nitems *= block_shape[i];
+  }
+  return nitems;
+}
+
+
+/* Reduce a block of the current chunk into the partials of thread `tid` */
+static void reduce_block(b2nd_scanner *scanner, int tid, int32_t nblock, const uint8_t *block) {
+  reduce_job *job = (reduce_job *) scanner->user_data;
+  const b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+
+  int64_t block_start[B2ND_MAX_DIM];
+  int64_t block_shape[B2ND_MAX_DIM];
+  int64_t nitems = b2nd_block_extent(array, scanner->chunk_start, nblock, block_start, block_shape);
+  if (nitems == 0) {
+    return;
+  }
+  int64_t nrows = nitems / block_shape[ndim - 1];
+
+  reduce_acc *partials = &job->partials[tid * job->out_nitems];
+  double *row = &job->rows[tid * array->blockshape[ndim - 1]];
+  int64_t row_nitems = block_shape[ndim - 1];
+  for (int64_t nrow = 0; nrow < nrows; ++nrow) {
+    int64_t row_start[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim((int8_t) (ndim - 1), block_shape, nrow, row_start);
+    int64_t offset = 0;
+    int64_t out = block_start[ndim - 1] * job->out_strides[ndim - 1];
+    for (int i = 0; i < ndim - 1; ++i) {
+      offset += row_start[i] * array->item_block_strides[i];
+      out += (block_start[i] + row_start[i]) * job->out_strides[i];
+    }
+    b2nd_items_to_doubles(job->kind, job->itemsize, &block[offset * job->itemsize], row_nitems, row);
+    if (job->out_strides[ndim - 1] == 0) {
+      acc_row(&partials[out], job->op, row, row_nitems);
+    } else {
+      for (int64_t nitem = 0; nitem < row_nitems; ++nitem) {
+        acc_value(&partials[out + nitem], job->op, row[nitem], 1);
+      }
+    }
+  }
+}
+
+
+static int scan_postfilter(blosc2_postfilter_params *params) {
+  b2nd_scanner *scanner = (b2nd_scanner *) params->user_data;
+  scanner->scan_block(scanner, params->tid, params->nblock, params->input);
+  return 0;
+}
+
+
+int b2nd_scanner_init(b2nd_scanner *scanner, const b2nd_array_t *array) {
+  scanner->array = array;
+  scanner->nblocks = array->blocknitems > 0 ? (int32_t) (array->extchunknitems / array->blocknitems) : 0;
+  scanner->data_nbytes = (int32_t) array->extchunknitems * array->sc->typesize;
+
+  // Decompress the blocks with all the threads, scanning them as they come
+  blosc2_dparams dparams;
+  blosc2_ctx_get_dparams(array->sc->dctx, &dparams);
+  blosc2_postfilter_params postparams = {0};
+  postparams.user_data = scanner;
+  dparams.postfilter = scan_postfilter;
+  dparams.postparams = &postparams;
+  scanner->dctx = blosc2_create_dctx(dparams);
+  BLOSC_ERROR_NULL(scanner->dctx, BLOSC2_ERROR_MEMORY_ALLOC);
+  scanner->nthreads = scanner->dctx->nthreads;
+  scanner->data = malloc(scanner->data_nbytes > 0 ? scanner->data_nbytes : 1);
+  scanner->maskout = malloc(scanner->nblocks > 0 ? scanner->nblocks : 1);
+  if (scanner->data == NULL || scanner->maskout == NULL) {
+    b2nd_scanner_destroy(scanner);
+    BLOSC_ERROR(BLOSC2_ERROR_MEMORY_ALLOC);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+void b2nd_scanner_destroy(b2nd_scanner *scanner) {
+  if (scanner->dctx != NULL) {
+    blosc2_free_ctx(scanner->dctx);
+  }
+  free(scanner->data);
+  free(scanner->maskout);
+  scanner->dctx = NULL;
+  scanner->data = NULL;
+  scanner->maskout = NULL;
+}
+
+
+/* Scan the blocks of a chunk that has been decompressed into `data` */
+static void scan_blocks(b2nd_scanner *scanner, const bool *skip) {
+  const b2nd_array_t *array = scanner->array;
+  for (int32_t nblock = 0; nblock < scanner->nblocks; ++nblock) {
+    if (!scanner->maskout[nblock] && (skip == NULL || !skip[nblock])) {
+      scanner->scan_block(scanner, 0, nblock, &scanner->data[nblock * array->blocknitems * array->sc->typesize]);
+    }
+  }
+}
+
+
+int b2nd_scan_chunk(b2nd_scanner *scanner, int64_t nchunk, const bool *skip) {
+  const b2nd_array_t *array = scanner->array;
+  int8_t ndim = array->ndim;
+  int64_t chunks_in_array[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    chunks_in_array[i] = array->extshape[i] / array->chunkshape[i];
+  }
+  scanner->nchunk = nchunk;
+  blosc2_unidim_to_multidim(ndim, chunks_in_array, nchunk, scanner->chunk_start);
+  for (int i = 0; i < ndim; ++i) {
+    scanner->chunk_start[i] *= array->chunkshape[i];
+  }
+
+  // The blocks in the padding of the chunks at the edges of the array are never scanned
+  bool masked = false;
+  for (int32_t nblock = 0; nblock < scanner->nblocks; ++nblock) {
+    int64_t block_start[B2ND_MAX_DIM];
+    int64_t block_shape[B2ND_MAX_DIM];
+    scanner->maskout[nblock] = b2nd_block_extent(array, scanner->chunk_start, nblock, block_start,
+                                                 block_shape) == 0;
+    masked |= scanner->maskout[nblock];
+  }
+
+  if (array->sc->dctx->postfilter != NULL) {
+    // The items have to go through the postfilter of the array first
+    int rc = blosc2_schunk_decompress_chunk(array->sc, nchunk, scanner->data, scanner->data_nbytes);
+    if (rc < 0) {
+      BLOSC_TRACE_ERROR("Error decompressing chunk");
+      return rc;
+    }
+    scan_blocks(scanner, skip);
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  uint8_t *chunk;
+  bool needs_free;
+  int cbytes = blosc2_schunk_get_lazychunk(array->sc, nchunk, &chunk, &needs_free);
+  if (cbytes < 0) {
+    BLOSC_TRACE_ERROR("Error getting chunk");
+    return cbytes;
+  }
+  int rc = BLOSC2_ERROR_SUCCESS;
+  int special_type = cbytes < BLOSC_EXTENDED_HEADER_LENGTH ? 0 :
+                     (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+  if (special_type == BLOSC2_SPECIAL_VALUE && cbytes < BLOSC_EXTENDED_HEADER_LENGTH + array->sc->typesize) {
+    special_type = 0;
+  }
+  if (special_type != 0 && scanner->scan_special != NULL &&
+      scanner->scan_special(scanner, special_type, &chunk[BLOSC_EXTENDED_HEADER_LENGTH])) {
+    // Done
+  } else if (schunk_chunk_uses_delta(chunk)) {
+    // The delta filter decodes every block against the first one in the destination
+    rc = blosc2_decompress_ctx(array->sc->dctx, chunk, cbytes, scanner->data, scanner->data_nbytes);
+    if (rc >= 0) {
+      scan_blocks(scanner, skip);
+    }
+  } else {
+    if (skip != NULL) {
+      for (int32_t nblock = 0; nblock < scanner->nblocks; ++nblock) {
+        scanner->maskout[nblock] |= skip[nblock];
+        masked |= skip[nblock];
+      }
+    }
+    if (masked && blosc2_set_maskout(scanner->dctx, scanner->maskout, scanner->nblocks) != BLOSC2_ERROR_SUCCESS) {
+      rc = BLOSC2_ERROR_FAILURE;
+    }
+    if (rc >= 0) {
+      // `data` is not written, as the postfilter takes the blocks
+      rc = blosc2_decompress_ctx(scanner->dctx, chunk, cbytes, scanner->data, scanner->data_nbytes);
+    }
+  }
+  if (needs_free) {
+    free(chunk);
+  }
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error decompressing chunk");
+    return rc;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Reduce the current chunk when all its items hold `value` */
+static void reduce_constant(reduce_job *job, const int64_t *chunk_start, double value) {
+  const b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+
+  // The values along the reduced dimensions are accumulated at once
+  int64_t out_shape[B2ND_MAX_DIM];
+  int64_t out_nitems = 1;
+  int64_t nitems = 1;
+  for (int i = 0; i < ndim; ++i) {
+    int64_t extent = array->shape[i] - chunk_start[i];
+    if (extent > array->chunkshape[i]) {
+      extent = array->chunkshape[i];
+    }
+    out_shape[i] = job->out_strides[i] == 0 ? 1 : extent;
+    nitems *= job->out_strides[i] == 0 ? extent : 1;
+    out_nitems *= out_shape[i];
+  }
+  for (int64_t nout = 0; nout < out_nitems; ++nout) {
+    int64_t out_start[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(ndim, out_shape, nout, out_start);
+    int64_t out = 0;
+    for (int i = 0; i < ndim; ++i) {
+      out += (chunk_start[i] + out_start[i]) * job->out_strides[i];
+    }
+    acc_value(&job->partials[out], job->op, value, nitems);
+  }
+}
+
+
+static bool reduce_special(b2nd_scanner *scanner, int special_type, const uint8_t *value) {
+  reduce_job *job = (reduce_job *) scanner->user_data;
+  double value_;
+  switch (special_type) {
+    case BLOSC2_SPECIAL_ZERO:
+      reduce_constant(job, scanner->chunk_start, 0);
+      return true;
+    case BLOSC2_SPECIAL_VALUE:
+      b2nd_items_to_doubles(job->kind, job->itemsize, value, 1, &value_);
+      reduce_constant(job, scanner->chunk_start, value_);
+      return true;
+    case BLOSC2_SPECIAL_NAN:
+    case BLOSC2_SPECIAL_UNINIT:
+      // Nothing to count
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+int b2nd_reduce(const b2nd_array_t *array, b2nd_reduce_op op, int8_t axis,
+                double *buffer, int64_t buffersize) {
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(buffer, BLOSC2_ERROR_NULL_POINTER);
+  if (op < B2ND_REDUCE_SUM || op > B2ND_REDUCE_COUNT) {
+    BLOSC_TRACE_ERROR("Unknown reduction (%d)", op);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+  if (axis < -1 || axis >= array->ndim) {
+    BLOSC_TRACE_ERROR("axis (%d) must be -1 or lower than the number of dimensions", axis);
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  reduce_job job = {0};
+  job.array = array;
+  job.op = op;
+  job.axis = axis;
+  BLOSC_ERROR(b2nd_get_item_kind(array, &job.kind, &job.itemsize));
+
+  int8_t ndim = array->ndim;
+  job.out_nitems = 1;
+  for (int i = ndim - 1; i >= 0; --i) {
+    if (axis == -1 || i == axis) {
+      job.out_strides[i] = 0;
+    } else {
+      job.out_strides[i] = job.out_nitems;
+      job.out_nitems *= array->shape[i];
+    }
+  }
+  if (buffersize < job.out_nitems * (int64_t) sizeof(double)) {
+    BLOSC_TRACE_ERROR("buffersize is too small for the result");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  // Every thread reduces the blocks that it decompresses into its own partials
+  b2nd_scanner scanner = {0};
+  scanner.user_data = &job;
+  scanner.scan_block = reduce_block;
+  scanner.scan_special = reduce_special;
+  BLOSC_ERROR(b2nd_scanner_init(&scanner, array));
+  int nthreads = scanner.nthreads;
+
+  job.partials = malloc(nthreads * job.out_nitems * sizeof(reduce_acc));
+  job.rows = malloc(nthreads * (ndim > 0 ? array->blockshape[ndim - 1] : 1) * sizeof(double));
+  int rc = BLOSC2_ERROR_SUCCESS;
+  if (job.partials == NULL || job.rows == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto out;
+  }
+  double init = op == B2ND_REDUCE_MIN ? INFINITY : op == B2ND_REDUCE_MAX ? -INFINITY : 0;
+  for (int64_t i = 0; i < nthreads * job.out_nitems; ++i) {
+    job.partials[i].value = init;
+    job.partials[i].count = 0;
+  }
+
+  if (ndim == 0) {
+    // A single item
+    rc = blosc2_schunk_decompress_chunk(array->sc, 0, scanner.data, scanner.data_nbytes);
+    if (rc >= 0) {
+      double value;
+      b2nd_items_to_doubles(job.kind, job.itemsize, scanner.data, 1, &value);
+      acc_value(&job.partials[0], op, value, 1);
+    }
+  }
+  else if (array->nitems > 0) {
+    for (int64_t nchunk = 0; nchunk < array->sc->nchunks && rc >= 0; ++nchunk) {
+      rc = b2nd_scan_chunk(&scanner, nchunk, NULL);
+    }
+  }
+  if (rc < 0) {
+    goto out;
+  }
+
+  // Combine the partials of the threads
+  for (int tid = 1; tid < nthreads; ++tid) {
+    for (int64_t i = 0; i < job.out_nitems; ++i) {
+      acc_merge(&job.partials[i], op, &job.partials[tid * job.out_nitems + i]);
+    }
+  }
+  for (int64_t i = 0; i < job.out_nitems; ++i) {
+    reduce_acc *acc = &job.partials[i];
+    switch (op) {
+      case B2ND_REDUCE_COUNT:
+        buffer[i] = (double) acc->count;
+        break;
+      case B2ND_REDUCE_MEAN:
+        buffer[i] = acc->count > 0 ? acc->value / (double) acc->count : NAN;
+        break;
+      case B2ND_REDUCE_SUM:
+        buffer[i] = acc->value;
+        break;
+      default:
+        buffer[i] = acc->count > 0 ? acc->value : NAN;
+    }
+  }
+
+  out:
+  free(job.rows);
+  free(job.partials);
+  b2nd_scanner_destroy(&scanner);
+  BLOSC_ERROR(rc);
+  return BLOSC2_ERROR_SUCCESS;
+}
@@ -0,0 +1,531 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "b2nd.h"
+#include "b2nd-private.h"
+#include "context.h"
+#include "schunk-private.h"
+#include "blosc2/blosc2-common.h"
+#include "blosc2.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* The state of permuting the axes of an array, shared by the workers when chunks go in parallel */
+typedef struct {
+  const b2nd_array_t *src;
+  b2nd_array_t *array;
+  int8_t axes[B2ND_MAX_DIM];                // the axis of `src` for every axis of `array`
+  int64_t chunks_in_array[B2ND_MAX_DIM];    // of `array`
+  int64_t blocks_in_chunk[B2ND_MAX_DIM];    // of `array`
+  int64_t src_blocks_in_chunk[B2ND_MAX_DIM];
+  int64_t src_chunks_strides[B2ND_MAX_DIM];
+  int64_t nchunks;
+  bool parallel;           // the super-chunks are shared by several workers
+  blosc2_cparams cparams;  // params for the worker contexts
+  blosc2_dparams dparams;
+  int64_t next;            // next chunk of `array` to be processed by a worker
+  int error;
+  pthread_mutex_t mutex;   // serializes the accesses to the super-chunks
+} permute_job;
+
+
+/* The contexts and scratch of a worker, a few chunks in all */
+typedef struct {
+  blosc2_context *cctx;
+  blosc2_context *dctx;
+  uint8_t *src_data;   // a chunk of `src`, block after block
+  bool *maskout;       // the blocks of the chunk of `src` that are not needed
+  uint8_t *region;     // a chunk of `array`, in C order
+  uint8_t *data;       // a chunk of `array`, block after block
+} permute_scratch;
+
+
+static void permute_lock(permute_job *job) {
+  if (job->parallel) {
+    pthread_mutex_lock(&job->mutex);
+  }
+}
+
+static void permute_unlock(permute_job *job) {
+  if (job->parallel) {
+    pthread_mutex_unlock(&job->mutex);
+  }
+}
+
+
+/* Copy a box of items with shape `box_shape` (along the axes of `src`) into `dest`, where the
+ * axis k goes along the axis axes[k] of `src`.  Strides are in items.  Boxes are blocks at most,
+ * so the strided side stays in cache; the innermost axis of `dest` is written sequentially. */
+static void permute_copy(int8_t ndim, int32_t itemsize, const int8_t *axes, const int64_t *box_shape,
+                         const uint8_t *src, const int64_t *src_strides, uint8_t *dest,
+                         const int64_t *dest_strides) {
+  int64_t shape[B2ND_MAX_DIM];
+  int64_t strides[B2ND_MAX_DIM];  // the strides of `src` along the axes of `dest`
+  for (int k = 0; k < ndim; ++k) {
+    shape[k] = box_shape[axes[k]];
+    strides[k] = src_strides[axes[k]];
+  }
+  int64_t inner = shape[ndim - 1];
+  int64_t inner_stride = strides[ndim - 1];
+  int64_t index[B2ND_MAX_DIM] = {0};
+  while (true) {
+    int64_t src_offset = 0;
+    int64_t dest_offset = 0;
+    for (int k = 0; k < ndim - 1; ++k) {
+      src_offset += index[k] * strides[k];
+      dest_offset += index[k] * dest_strides[k];
+    }
+    const uint8_t *psrc = &src[src_offset * itemsize];
+    uint8_t *pdest = &dest[dest_offset * itemsize];
+    if (inner_stride == 1) {
+      memcpy(pdest, psrc, inner * itemsize);
+    } else {
+      switch (itemsize) {
+        case 1:
+          for (int64_t j = 0; j < inner; ++j) {
+            pdest[j] = psrc[j * inner_stride];
+          }
+          break;
+        case 2:
+          for (int64_t j = 0; j < inner; ++j) {
+            memcpy(&pdest[j * 2], &psrc[j * inner_stride * 2], 2);
+          }
+          break;
+        case 4:
+          for (int64_t j = 0; j < inner; ++j) {
+            memcpy(&pdest[j * 4], &psrc[j * inner_stride * 4], 4);
+          }
+          break;
+        case 8:
+          for (int64_t j = 0; j < inner; ++j) {
+            memcpy(&pdest[j * 8], &psrc[j * inner_stride * 8], 8);
+          }
+          break;
+        default:
+          for (int64_t j = 0; j < inner; ++j) {
+            memcpy(&pdest[j * itemsize], &psrc[j * inner_stride * itemsize], itemsize);
+          }
+      }
+    }
+
+    int k = ndim - 2;
+    for (; k >= 0; --k) {
+      if (++index[k] < shape[k]) {
+        break;
+      }
+      index[k] = 0;
+    }
+    if (k < 0) {
+      return;
+    }
+  }
+}
+
+
+static void c_strides(int8_t ndim, const int64_t *shape, int64_t *strides) {
+  strides[ndim - 1] = 1;
+  for (int i = ndim - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shape[i + 1];
+  }
+}
+
+
+/* Copy the part of a chunk of `src` that lies in [start, stop) (along the axes of `src`) into
+ * `region`, which starts at `region_start` (along the axes of `array`) */
+static int permute_src_chunk(permute_job *job, int64_t src_nchunk, const int64_t *start,
+                             const int64_t *stop, const int64_t *region_start,
+                             blosc2_context *dctx, permute_scratch *scratch) {
+  const b2nd_array_t *src = job->src;
+  int8_t ndim = src->ndim;
+  int32_t itemsize = src->sc->typesize;
+
+  int64_t src_nchunk_ndim[B2ND_MAX_DIM];
+  int64_t src_chunks_in_array[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    src_chunks_in_array[i] = src->extshape[i] / src->chunkshape[i];
+  }
+  blosc2_unidim_to_multidim(ndim, src_chunks_in_array, src_nchunk, src_nchunk_ndim);
+  int64_t chunk_start[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    chunk_start[i] = src_nchunk_ndim[i] * src->chunkshape[i];
+  }
+
+  // Only the blocks of the chunk that overlap the box are decompressed
+  int32_t nblocks = (int32_t) (src->extchunknitems / src->blocknitems);
+  for (int32_t nblock = 0; nblock < nblocks; ++nblock) {
+    int64_t nblock_ndim[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, job->src_blocks_in_chunk, nblock, nblock_ndim);
+    bool empty = false;
+    for (int i = 0; i < ndim; ++i) {
+      int64_t block_start = chunk_start[i] + nblock_ndim[i] * src->blockshape[i];
+      empty |= block_start >= stop[i] || block_start >= chunk_start[i] + src->chunkshape[i] ||
+               block_start + src->blockshape[i] <= start[i];
+    }
+    scratch->maskout[nblock] = empty;
+  }
+
+  uint8_t *chunk;
+  bool needs_free;
+  permute_lock(job);
+  int cbytes = blosc2_schunk_get_lazychunk(src->sc, src_nchunk, &chunk, &needs_free);
+  permute_unlock(job);
+  if (cbytes < 0) {
+    BLOSC_TRACE_ERROR("Error getting chunk");
+    BLOSC_ERROR(cbytes);
+  }
+  if (schunk_set_chunk_maskout(dctx, chunk, scratch->maskout, nblocks) != BLOSC2_ERROR_SUCCESS) {
+    if (needs_free) {
+      free(chunk);
+    }
+    BLOSC_TRACE_ERROR("Error setting the maskout");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+  if (!job->parallel) {
+    src->sc->current_nchunk = src_nchunk;
+  }
+  int rc = blosc2_decompress_ctx(dctx, chunk, cbytes, scratch->src_data,
+                                 (int32_t) src->extchunknitems * itemsize);
+  if (needs_free) {
+    free(chunk);
+  }
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Error decompressing chunk");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+
+  // Permute the part of every block in the box into the region
+  int64_t block_strides[B2ND_MAX_DIM];
+  int64_t blockshape[B2ND_MAX_DIM];
+  int64_t region_strides[B2ND_MAX_DIM];
+  int64_t extchunkshape[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    blockshape[i] = src->blockshape[i];
+    extchunkshape[i] = job->array->extchunkshape[i];
+  }
+  c_strides(ndim, blockshape, block_strides);
+  c_strides(ndim, extchunkshape, region_strides);
+  for (int32_t nblock = 0; nblock < nblocks; ++nblock) {
+    if (scratch->maskout[nblock]) {
+      continue;
+    }
+    int64_t nblock_ndim[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, job->src_blocks_in_chunk, nblock, nblock_ndim);
+    int64_t box_shape[B2ND_MAX_DIM];
+    int64_t src_offset = 0;
+    int64_t box_start[B2ND_MAX_DIM];
+    for (int i = 0; i < ndim; ++i) {
+      int64_t block_start = chunk_start[i] + nblock_ndim[i] * src->blockshape[i];
+      int64_t block_stop = block_start + src->blockshape[i];
+      // The padding of the chunk overlaps the next one
+      if (block_stop > chunk_start[i] + src->chunkshape[i]) {
+        block_stop = chunk_start[i] + src->chunkshape[i];
+      }
+      box_start[i] = start[i] > block_start ? start[i] : block_start;
+      int64_t box_stop = stop[i] < block_stop ? stop[i] : block_stop;
+      box_shape[i] = box_stop - box_start[i];
+      src_offset += (box_start[i] - block_start) * block_strides[i];
+    }
+    int64_t region_offset = 0;
+    for (int k = 0; k < ndim; ++k) {
+      region_offset += (box_start[job->axes[k]] - region_start[k]) * region_strides[k];
+    }
+    permute_copy(ndim, itemsize, job->axes, box_shape,
+                 &scratch->src_data[(nblock * src->blocknitems + src_offset) * itemsize],
+                 block_strides, &scratch->region[region_offset * itemsize], region_strides);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+/* Build a chunk of `array` out of the chunks of `src` that it overlaps, and compress it */
+static int permute_chunk(permute_job *job, int64_t nchunk, blosc2_context *cctx, blosc2_context *dctx,
+                         permute_scratch *scratch) {
+  const b2nd_array_t *src = job->src;
+  b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+  int32_t itemsize = array->sc->typesize;
+
+  int64_t nchunk_ndim[B2ND_MAX_DIM];
+  blosc2_unidim_to_multidim(ndim, job->chunks_in_array, nchunk, nchunk_ndim);
+  int64_t region_start[B2ND_MAX_DIM];
+  int64_t start[B2ND_MAX_DIM];  // the box of the chunk, along the axes of `src`
+  int64_t stop[B2ND_MAX_DIM];
+  bool edge = false;
+  for (int k = 0; k < ndim; ++k) {
+    region_start[k] = nchunk_ndim[k] * array->chunkshape[k];
+    int64_t region_stop = region_start[k] + array->chunkshape[k];
+    if (region_stop > array->shape[k]) {
+      region_stop = array->shape[k];
+    }
+    edge |= region_stop - region_start[k] < array->extchunkshape[k];
+    start[job->axes[k]] = region_start[k];
+    stop[job->axes[k]] = region_stop;
+  }
+  // The padding is zeroed, like the one of the chunks set through slices
+  if (edge) {
+    memset(scratch->region, 0, array->extchunknitems * itemsize);
+  }
+
+  int64_t first[B2ND_MAX_DIM];
+  int64_t nchunks[B2ND_MAX_DIM];
+  int64_t src_nchunks = 1;
+  for (int i = 0; i < ndim; ++i) {
+    first[i] = start[i] / src->chunkshape[i];
+    nchunks[i] = (stop[i] - 1) / src->chunkshape[i] + 1 - first[i];
+    src_nchunks *= nchunks[i];
+  }
+  for (int64_t n = 0; n < src_nchunks; ++n) {
+    int64_t index[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, nchunks, n, index);
+    int64_t src_nchunk = 0;
+    for (int i = 0; i < ndim; ++i) {
+      src_nchunk += (first[i] + index[i]) * job->src_chunks_strides[i];
+    }
+    BLOSC_ERROR(permute_src_chunk(job, src_nchunk, start, stop, region_start, dctx, scratch));
+  }
+
+  // Lay the chunk out block after block
+  int64_t extchunkshape[B2ND_MAX_DIM];
+  int64_t blockshape[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    extchunkshape[i] = array->extchunkshape[i];
+    blockshape[i] = array->blockshape[i];
+  }
+  int32_t nblocks = (int32_t) (array->extchunknitems / array->blocknitems);
+  for (int32_t nblock = 0; nblock < nblocks; ++nblock) {
+    int64_t nblock_ndim[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, job->blocks_in_chunk, nblock, nblock_ndim);
+    int64_t block_start[B2ND_MAX_DIM];
+    int64_t block_stop[B2ND_MAX_DIM];
+    int64_t zeros[B2ND_MAX_DIM] = {0};
+    for (int i = 0; i < ndim; ++i) {
+      block_start[i] = nblock_ndim[i] * array->blockshape[i];
+      block_stop[i] = block_start[i] + array->blockshape[i];
+    }
+    b2nd_copy_buffer(ndim, (uint8_t) itemsize, scratch->region, extchunkshape, block_start, block_stop,
+                     &scratch->data[nblock * array->blocknitems * itemsize], blockshape, zeros);
+  }
+
+  int32_t data_nbytes = (int32_t) array->extchunknitems * itemsize;
+  int32_t chunk_nbytes = data_nbytes + BLOSC2_MAX_OVERHEAD;
+  uint8_t *chunk = malloc(chunk_nbytes);
+  BLOSC_ERROR_NULL(chunk, BLOSC2_ERROR_MEMORY_ALLOC);
+  if (!job->parallel) {
+    array->sc->current_nchunk = nchunk;
+  }
+  int csize = blosc2_compress_ctx(cctx, scratch->data, data_nbytes, chunk, chunk_nbytes);
+  if (csize < 0) {
+    free(chunk);
+    BLOSC_TRACE_ERROR("Blosc can not compress the data");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+  // The super-chunk takes ownership of the chunk
+  permute_lock(job);
+  int64_t rc = blosc2_schunk_update_chunk(array->sc, nchunk, chunk, false);
+  permute_unlock(job);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Blosc can not update the chunk");
+    BLOSC_ERROR(BLOSC2_ERROR_FAILURE);
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static int permute_scratch_init(permute_scratch *scratch, const permute_job *job) {
+  int32_t itemsize = job->array->sc->typesize;
+  scratch->src_data = malloc(job->src->extchunknitems * itemsize);
+  scratch->maskout = malloc(job->src->extchunknitems / job->src->blocknitems);
+  scratch->region = malloc(job->array->extchunknitems * itemsize);
+  scratch->data = malloc(job->array->extchunknitems * itemsize);
+  if (scratch->src_data == NULL || scratch->maskout == NULL || scratch->region == NULL ||
+      scratch->data == NULL) {
+    return BLOSC2_ERROR_MEMORY_ALLOC;
+  }
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+static void permute_scratch_free(permute_scratch *scratch) {
+  free(scratch->data);
+  free(scratch->region);
+  free(scratch->maskout);
+  free(scratch->src_data);
+  if (scratch->cctx != NULL) {
+    blosc2_free_ctx(scratch->cctx);
+  }
+  if (scratch->dctx != NULL) {
+    blosc2_free_ctx(scratch->dctx);
+  }
+}
+
+
+static void *permute_worker(void *arg) {
+  permute_job *job = (permute_job *) arg;
+  permute_scratch scratch = {0};
+  scratch.cctx = blosc2_create_cctx(job->cparams);
+  scratch.dctx = blosc2_create_dctx(job->dparams);
+  int scratch_rc = permute_scratch_init(&scratch, job);
+
+  pthread_mutex_lock(&job->mutex);
+  if (scratch.cctx == NULL || scratch.dctx == NULL || scratch_rc < 0) {
+    job->error = BLOSC2_ERROR_FAILURE;
+  }
+  while (job->error == 0 && job->next < job->nchunks) {
+    int64_t nchunk = job->next++;
+    pthread_mutex_unlock(&job->mutex);
+    int rc = permute_chunk(job, nchunk, scratch.cctx, scratch.dctx, &scratch);
+    pthread_mutex_lock(&job->mutex);
+    if (rc < 0 && job->error == 0) {
+      job->error = rc;
+    }
+  }
+  pthread_mutex_unlock(&job->mutex);
+
+  permute_scratch_free(&scratch);
+  return NULL;
+}
+
+
+/* Fill the chunks of `array` (with the same items as `src`, permuted) */
+static int permute_data(permute_job *job) {
+  const b2nd_array_t *src = job->src;
+  b2nd_array_t *array = job->array;
+  int8_t ndim = array->ndim;
+
+  job->nchunks = 1;
+  int64_t src_chunks_in_array[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    job->chunks_in_array[i] = array->extshape[i] / array->chunkshape[i];
+    job->blocks_in_chunk[i] = array->extchunkshape[i] / array->blockshape[i];
+    job->src_blocks_in_chunk[i] = src->extchunkshape[i] / src->blockshape[i];
+    src_chunks_in_array[i] = src->extshape[i] / src->chunkshape[i];
+    job->nchunks *= job->chunks_in_array[i];
+  }
+  c_strides(ndim, src_chunks_in_array, job->src_chunks_strides);
+
+  // Spread the threads over the chunks.  Pre- and postfilters may depend on the state of the
+  // super-chunks, so they keep the serial path.
+  int rc = BLOSC2_ERROR_SUCCESS;
+  int nthreads = src->sc->dctx->nthreads > array->sc->cctx->nthreads ?
+                 src->sc->dctx->nthreads : array->sc->cctx->nthreads;
+  int nworkers = job->nchunks < nthreads ? (int) job->nchunks : nthreads;
+  if (nworkers > 1 && src->sc->dctx->postfilter == NULL && array->sc->cctx->prefilter == NULL) {
+    blosc2_ctx_get_cparams(array->sc->cctx, &job->cparams);
+    blosc2_ctx_get_dparams(src->sc->dctx, &job->dparams);
+    job->cparams.nthreads = (int16_t) (nthreads / nworkers);
+    job->dparams.nthreads = (int16_t) (nthreads / nworkers);
+    job->parallel = true;
+    pthread_mutex_init(&job->mutex, NULL);
+    pthread_t *threads = malloc(nworkers * sizeof(pthread_t));
+    int nstarted = 0;
+    if (threads == NULL) {
+      rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    }
+    for (; threads != NULL && nstarted < nworkers; nstarted++) {
+      if (pthread_create(&threads[nstarted], NULL, permute_worker, job) != 0) {
+        BLOSC_TRACE_ERROR("Cannot create a transpose thread.");
+        rc = BLOSC2_ERROR_THREAD_CREATE;
+        pthread_mutex_lock(&job->mutex);
+        job->error = rc;
+        pthread_mutex_unlock(&job->mutex);
+        break;
+      }
+    }
+    for (int i = 0; i < nstarted; i++) {
+      pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&job->mutex);
+    rc = job->error < 0 ? job->error : rc;
+  }
+  else {
+    permute_scratch scratch = {0};
+    rc = permute_scratch_init(&scratch, job);
+    for (int64_t nchunk = 0; nchunk < job->nchunks && rc >= 0; ++nchunk) {
+      rc = permute_chunk(job, nchunk, array->sc->cctx, src->sc->dctx, &scratch);
+    }
+    permute_scratch_free(&scratch);
+  }
+  BLOSC_ERROR(rc);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_permute_axes(b2nd_context_t *ctx, const b2nd_array_t *src, const int8_t *axes,
+                      b2nd_array_t **array) {
+  BLOSC_ERROR_NULL(ctx, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(src, BLOSC2_ERROR_NULL_POINTER);
+  BLOSC_ERROR_NULL(array, BLOSC2_ERROR_NULL_POINTER);
+
+  int8_t ndim = src->ndim;
+  bool seen[B2ND_MAX_DIM] = {false};
+  for (int k = 0; k < ndim; ++k) {
+    if (axes == NULL || axes[k] < 0 || axes[k] >= ndim || seen[axes[k]]) {
+      BLOSC_TRACE_ERROR("The axes must be a permutation of the axes of the array");
+      BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+    }
+    seen[axes[k]] = true;
+  }
+  if (ctx->b2_storage->cparams->typesize != src->sc->typesize) {
+    BLOSC_TRACE_ERROR("The typesize of the new array must be the one of the source");
+    BLOSC_ERROR(BLOSC2_ERROR_INVALID_PARAM);
+  }
+
+  ctx->ndim = ndim;
+  for (int k = 0; k < ndim; ++k) {
+    ctx->shape[k] = src->shape[axes[k]];
+  }
+  BLOSC_ERROR(b2nd_empty(ctx, array));
+  if (src->nitems == 0) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  int rc;
+  if (ndim == 0) {
+    uint8_t item[BLOSC_MAX_TYPESIZE];
+    int64_t none[1] = {0};
+    rc = b2nd_get_slice_cbuffer(src, none, none, item, none, src->sc->typesize);
+    if (rc >= 0) {
+      rc = b2nd_set_slice_cbuffer(item, none, src->sc->typesize, none, none, *array);
+    }
+  } else {
+    permute_job job = {0};
+    job.src = src;
+    job.array = *array;
+    for (int k = 0; k < ndim; ++k) {
+      job.axes[k] = axes[k];
+    }
+    rc = permute_data(&job);
+  }
+  if (rc < 0) {
+    b2nd_free(*array);
+    *array = NULL;
+    BLOSC_ERROR(rc);
+  }
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
+int b2nd_transpose(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array) {
+  BLOSC_ERROR_NULL(src, BLOSC2_ERROR_NULL_POINTER);
+
+  int8_t axes[B2ND_MAX_DIM];
+  for (int k = 0; k < src->ndim; ++k) {
+    axes[k] = (int8_t) (src->ndim - 1 - k);
+  }
+  BLOSC_ERROR(b2nd_permute_axes(ctx, src, axes, array));
+
+  return BLOSC2_ERROR_SUCCESS;
+}
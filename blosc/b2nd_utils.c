@@ -9,10 +9,40 @@
 **********************************************************************/
 
 #include "b2nd.h"
+#include "b2nd-private.h"
 
 #include <stdint.h>
 #include <string.h>
 
+// Copy `nrows` rows of `row_nbytes` bytes between buffers with the given row strides (in bytes).
+// Narrow rows are common in 3D blocks, and a memcpy call per row would dominate there, so the
+// usual sizes get a memcpy with a constant size that the compiler turns into (SIMD) loads/stores.
+#define COPY_ROWS(nbytes)                                                   \
+  for (int64_t row = 0; row < nrows; ++row) {                               \
+    memcpy(&bdst[row * dst_stride], &bsrc[row * src_stride], (nbytes));     \
+  }                                                                         \
+  break
+
+static inline void copy_rows(int64_t nrows, int64_t row_nbytes,
+                             const uint8_t *bsrc, int64_t src_stride,
+                             uint8_t *bdst, int64_t dst_stride) {
+  switch (row_nbytes) {
+    case 1: COPY_ROWS(1);
+    case 2: COPY_ROWS(2);
+    case 4: COPY_ROWS(4);
+    case 8: COPY_ROWS(8);
+    case 12: COPY_ROWS(12);
+    case 16: COPY_ROWS(16);
+    case 24: COPY_ROWS(24);
+    case 32: COPY_ROWS(32);
+    case 48: COPY_ROWS(48);
+    case 64: COPY_ROWS(64);
+    default: COPY_ROWS((size_t) row_nbytes);
+  }
+}
+
+#undef COPY_ROWS
+
 // copyNdim where N = {2-8} - specializations of copy loops to be used by b2nd_copy_buffer
 // since we don't have c++ templates, substitute manual specializations for up to known B2ND_MAX_DIM (8)
 // it's not pretty, but it substantially reduces overhead vs. the generic method
@@ -21,48 +51,6 @@ void copy8dim(const uint8_t itemsize,
               const uint8_t *bsrc, const int64_t *src_strides,
               uint8_t *bdst, const int64_t *dst_strides) {
   int64_t copy_nbytes = copy_shape[7] * itemsize;
-  int64_t copy_start[7] = {0};
-  do {
-    do {
-      do {
-        do {
-          do {
-            do {
-              do {
-                int64_t src_copy_start = 0;
-                int64_t dst_copy_start = 0;
-                for (int j = 0; j < 7; ++j) {
-                  src_copy_start += copy_start[j] * src_strides[j];
-                  dst_copy_start += copy_start[j] * dst_strides[j];
-                }
-                memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
-                ++copy_start[6];
-              } while (copy_start[6] < copy_shape[6]);
-              ++copy_start[5];
-              copy_start[6] = 0;
-            } while (copy_start[5] < copy_shape[5]);
-            ++copy_start[4];
-            copy_start[5] = 0;
-          } while (copy_start[4] < copy_shape[4]);
-          ++copy_start[3];
-          copy_start[4] = 0;
-        } while (copy_start[3] < copy_shape[3]);
-        ++copy_start[2];
-        copy_start[3] = 0;
-      } while (copy_start[2] < copy_shape[2]);
-      ++copy_start[1];
-      copy_start[2] = 0;
-    } while (copy_start[1] < copy_shape[1]);
-    ++copy_start[0];
-    copy_start[1] = 0;
-  } while (copy_start[0] < copy_shape[0]);
-}
-
-void copy7dim(const uint8_t itemsize,
-              const int64_t *copy_shape,
-              const uint8_t *bsrc, const int64_t *src_strides,
-              uint8_t *bdst, const int64_t *dst_strides) {
-  int64_t copy_nbytes = copy_shape[6] * itemsize;
   int64_t copy_start[6] = {0};
   do {
     do {
@@ -76,7 +64,9 @@ void copy7dim(const uint8_t itemsize,
                 src_copy_start += copy_start[j] * src_strides[j];
                 dst_copy_start += copy_start[j] * dst_strides[j];
               }
-              memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
+              copy_rows(copy_shape[6], copy_nbytes,
+                        &bsrc[src_copy_start * itemsize], src_strides[6] * itemsize,
+                        &bdst[dst_copy_start * itemsize], dst_strides[6] * itemsize);
               ++copy_start[5];
             } while (copy_start[5] < copy_shape[5]);
             ++copy_start[4];
@@ -96,11 +86,11 @@ void copy7dim(const uint8_t itemsize,
   } while (copy_start[0] < copy_shape[0]);
 }
 
-void copy6dim(const uint8_t itemsize,
+void copy7dim(const uint8_t itemsize,
               const int64_t *copy_shape,
               const uint8_t *bsrc, const int64_t *src_strides,
               uint8_t *bdst, const int64_t *dst_strides) {
-  int64_t copy_nbytes = copy_shape[5] * itemsize;
+  int64_t copy_nbytes = copy_shape[6] * itemsize;
   int64_t copy_start[5] = {0};
   do {
     do {
@@ -113,7 +103,9 @@ void copy6dim(const uint8_t itemsize,
               src_copy_start += copy_start[j] * src_strides[j];
               dst_copy_start += copy_start[j] * dst_strides[j];
             }
-            memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
+            copy_rows(copy_shape[5], copy_nbytes,
+                      &bsrc[src_copy_start * itemsize], src_strides[5] * itemsize,
+                      &bdst[dst_copy_start * itemsize], dst_strides[5] * itemsize);
             ++copy_start[4];
           } while (copy_start[4] < copy_shape[4]);
           ++copy_start[3];
@@ -130,11 +122,11 @@ void copy6dim(const uint8_t itemsize,
   } while (copy_start[0] < copy_shape[0]);
 }
 
-void copy5dim(const uint8_t itemsize,
+void copy6dim(const uint8_t itemsize,
               const int64_t *copy_shape,
               const uint8_t *bsrc, const int64_t *src_strides,
               uint8_t *bdst, const int64_t *dst_strides) {
-  int64_t copy_nbytes = copy_shape[4] * itemsize;
+  int64_t copy_nbytes = copy_shape[5] * itemsize;
   int64_t copy_start[4] = {0};
   do {
     do {
@@ -146,7 +138,9 @@ void copy5dim(const uint8_t itemsize,
             src_copy_start += copy_start[j] * src_strides[j];
             dst_copy_start += copy_start[j] * dst_strides[j];
           }
-          memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
+          copy_rows(copy_shape[4], copy_nbytes,
+                    &bsrc[src_copy_start * itemsize], src_strides[4] * itemsize,
+                    &bdst[dst_copy_start * itemsize], dst_strides[4] * itemsize);
           ++copy_start[3];
         } while (copy_start[3] < copy_shape[3]);
         ++copy_start[2];
@@ -160,11 +154,11 @@ void copy5dim(const uint8_t itemsize,
   } while (copy_start[0] < copy_shape[0]);
 }
 
-void copy4dim(const uint8_t itemsize,
+void copy5dim(const uint8_t itemsize,
               const int64_t *copy_shape,
               const uint8_t *bsrc, const int64_t *src_strides,
               uint8_t *bdst, const int64_t *dst_strides) {
-  int64_t copy_nbytes = copy_shape[3] * itemsize;
+  int64_t copy_nbytes = copy_shape[4] * itemsize;
   int64_t copy_start[3] = {0};
   do {
     do {
@@ -175,7 +169,9 @@ void copy4dim(const uint8_t itemsize,
           src_copy_start += copy_start[j] * src_strides[j];
           dst_copy_start += copy_start[j] * dst_strides[j];
         }
-        memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
+        copy_rows(copy_shape[3], copy_nbytes,
+                  &bsrc[src_copy_start * itemsize], src_strides[3] * itemsize,
+                  &bdst[dst_copy_start * itemsize], dst_strides[3] * itemsize);
         ++copy_start[2];
       } while (copy_start[2] < copy_shape[2]);
       ++copy_start[1];
@@ -186,11 +182,11 @@ void copy4dim(const uint8_t itemsize,
   } while (copy_start[0] < copy_shape[0]);
 }
 
-void copy3dim(const uint8_t itemsize,
+void copy4dim(const uint8_t itemsize,
               const int64_t *copy_shape,
               const uint8_t *bsrc, const int64_t *src_strides,
               uint8_t *bdst, const int64_t *dst_strides) {
-  int64_t copy_nbytes = copy_shape[2] * itemsize;
+  int64_t copy_nbytes = copy_shape[3] * itemsize;
   int64_t copy_start[2] = {0};
   do {
     do {
@@ -200,7 +196,9 @@ void copy3dim(const uint8_t itemsize,
         src_copy_start += copy_start[j] * src_strides[j];
         dst_copy_start += copy_start[j] * dst_strides[j];
       }
-      memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
+      copy_rows(copy_shape[2], copy_nbytes,
+                &bsrc[src_copy_start * itemsize], src_strides[2] * itemsize,
+                &bdst[dst_copy_start * itemsize], dst_strides[2] * itemsize);
       ++copy_start[1];
     } while (copy_start[1] < copy_shape[1]);
     ++copy_start[0];
@@ -208,20 +206,29 @@ void copy3dim(const uint8_t itemsize,
   } while (copy_start[0] < copy_shape[0]);
 }
 
-void copy2dim(const uint8_t itemsize,
+void copy3dim(const uint8_t itemsize,
               const int64_t *copy_shape,
               const uint8_t *bsrc, const int64_t *src_strides,
               uint8_t *bdst, const int64_t *dst_strides) {
-  int64_t copy_nbytes = copy_shape[1] * itemsize;
+  int64_t copy_nbytes = copy_shape[2] * itemsize;
   int64_t copy_start = 0;
   do {
     int64_t src_copy_start = copy_start * src_strides[0];
     int64_t dst_copy_start = copy_start * dst_strides[0];
-    memcpy(&bdst[dst_copy_start * itemsize], &bsrc[src_copy_start * itemsize], copy_nbytes);
+    copy_rows(copy_shape[1], copy_nbytes,
+              &bsrc[src_copy_start * itemsize], src_strides[1] * itemsize,
+              &bdst[dst_copy_start * itemsize], dst_strides[1] * itemsize);
     ++copy_start;
   } while (copy_start < copy_shape[0]);
 }
 
+void copy2dim(const uint8_t itemsize,
+              const int64_t *copy_shape,
+              const uint8_t *bsrc, const int64_t *src_strides,
+              uint8_t *bdst, const int64_t *dst_strides) {
+  int64_t copy_nbytes = copy_shape[1] * itemsize;
+  copy_rows(copy_shape[0], copy_nbytes, bsrc, src_strides[0] * itemsize, bdst, dst_strides[0] * itemsize);
+}
 
 void copy_ndim_fallback(const int8_t ndim,
                         const uint8_t itemsize,
@@ -233,7 +240,7 @@ void copy_ndim_fallback(const int8_t ndim,
   for (int i = 0; i < ndim - 1; ++i) {
     number_of_copies *= copy_shape[i];
   }
-  for (int ncopy = 0; ncopy < number_of_copies; ++ncopy) {
+  for (int64_t ncopy = 0; ncopy < number_of_copies; ++ncopy) {
     // Compute the start of the copy
     int64_t copy_start[B2ND_MAX_DIM] = {0};
     blosc2_unidim_to_multidim((int8_t) (ndim - 1), copy_shape, ncopy, copy_start);
@@ -253,75 +260,124 @@ void copy_ndim_fallback(const int8_t ndim,
   }
 }
 
-int b2nd_copy_buffer(int8_t ndim,
-                     uint8_t itemsize,
-                     const void *src, const int64_t *src_pad_shape,
-                     const int64_t *src_start, const int64_t *src_stop,
-                     void *dst, const int64_t *dst_pad_shape,
-                     const int64_t *dst_start) {
-  // Compute the shape of the copy
-  int64_t copy_shape[B2ND_MAX_DIM] = {0};
+int b2nd_copy_strided(int8_t ndim, uint8_t itemsize, const int64_t *copy_shape,
+                      const void *src, const int64_t *src_strides,
+                      void *dst, const int64_t *dst_strides) {
   for (int i = 0; i < ndim; ++i) {
-    copy_shape[i] = src_stop[i] - src_start[i];
     if (copy_shape[i] == 0) {
       return BLOSC2_ERROR_SUCCESS;
     }
   }
 
-  // Compute the strides
-  int64_t src_strides[B2ND_MAX_DIM];
-  src_strides[ndim - 1] = 1;
-  for (int i = ndim - 2; i >= 0; --i) {
-    src_strides[i] = src_strides[i + 1] * src_pad_shape[i + 1];
+  // The bytes of the items go along an extra innermost dimension, so the kernels copy rows of
+  // bytes: whole rows of items when these are contiguous in both buffers, or single items
+  // (gathered or scattered) when they are not.
+  //
+  // Merge the dimensions that are contiguous in both buffers, and skip the ones of length 1, so
+  // that the rows are as long and the loops as shallow as possible.  The innermost dimension is
+  // always kept (with unit strides) because the kernels copy rows out of it.
+  int64_t merged_shape[B2ND_MAX_DIM + 1];  // from the innermost dimension outwards
+  int64_t merged_src_strides[B2ND_MAX_DIM + 1];
+  int64_t merged_dst_strides[B2ND_MAX_DIM + 1];
+  merged_shape[0] = itemsize;
+  merged_src_strides[0] = 1;
+  merged_dst_strides[0] = 1;
+  int8_t merged_ndim = 1;
+  for (int i = ndim - 1; i >= 0; --i) {
+    if (copy_shape[i] == 1) {
+      continue;
+    }
+    int j = merged_ndim - 1;
+    if (src_strides[i] == merged_shape[j] * merged_src_strides[j] &&
+        dst_strides[i] == merged_shape[j] * merged_dst_strides[j]) {
+      merged_shape[j] *= copy_shape[i];
+    } else {
+      merged_shape[merged_ndim] = copy_shape[i];
+      merged_src_strides[merged_ndim] = src_strides[i];
+      merged_dst_strides[merged_ndim] = dst_strides[i];
+      merged_ndim++;
+    }
   }
-
-  int64_t dst_strides[B2ND_MAX_DIM];
-  dst_strides[ndim - 1] = 1;
-  for (int i = ndim - 2; i >= 0; --i) {
-    dst_strides[i] = dst_strides[i + 1] * dst_pad_shape[i + 1];
+  int64_t shape[B2ND_MAX_DIM + 1];
+  int64_t bsrc_strides[B2ND_MAX_DIM + 1];
+  int64_t bdst_strides[B2ND_MAX_DIM + 1];
+  for (int i = 0; i < merged_ndim; ++i) {
+    shape[i] = merged_shape[merged_ndim - 1 - i];
+    bsrc_strides[i] = merged_src_strides[merged_ndim - 1 - i];
+    bdst_strides[i] = merged_dst_strides[merged_ndim - 1 - i];
   }
 
-  // Align the buffers removing unnecessary data
-  int64_t src_start_n;
-  blosc2_multidim_to_unidim(src_start, ndim, src_strides, &src_start_n);
-  uint8_t *bsrc = (uint8_t *) src;
-  bsrc = &bsrc[src_start_n * itemsize];
-
-  int64_t dst_start_n;
-  blosc2_multidim_to_unidim(dst_start, ndim, dst_strides, &dst_start_n);
+  const uint8_t *bsrc = (const uint8_t *) src;
   uint8_t *bdst = (uint8_t *) dst;
-  bdst = &bdst[dst_start_n * itemsize];
-
-  switch (ndim) {
+  switch (merged_ndim) {
     case 1:
-      memcpy(&bdst[0], &bsrc[0], copy_shape[0] * itemsize);
+      memcpy(&bdst[0], &bsrc[0], shape[0]);
       break;
     case 2:
-      copy2dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy2dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     case 3:
-      copy3dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy3dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     case 4:
-      copy4dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy4dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     case 5:
-      copy5dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy5dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     case 6:
-      copy6dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy6dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     case 7:
-      copy7dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy7dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     case 8:
-      copy8dim(itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      copy8dim(1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
     default:
-      // guard against potential future increase to B2ND_MAX_DIM
-      copy_ndim_fallback(ndim, itemsize, copy_shape, bsrc, src_strides, bdst, dst_strides);
+      // items scattered along all the B2ND_MAX_DIM dimensions (or a future increase of it)
+      copy_ndim_fallback(merged_ndim, 1, shape, bsrc, bsrc_strides, bdst, bdst_strides);
       break;
   }
 
   return BLOSC2_ERROR_SUCCESS;
 }
+
+int b2nd_copy_buffer(int8_t ndim,
+                     uint8_t itemsize,
+                     const void *src, const int64_t *src_pad_shape,
+                     const int64_t *src_start, const int64_t *src_stop,
+                     void *dst, const int64_t *dst_pad_shape,
+                     const int64_t *dst_start) {
+  // Compute the shape of the copy
+  int64_t copy_shape[B2ND_MAX_DIM] = {0};
+  for (int i = 0; i < ndim; ++i) {
+    copy_shape[i] = src_stop[i] - src_start[i];
+    if (copy_shape[i] == 0) {
+      return BLOSC2_ERROR_SUCCESS;
+    }
+  }
+
+  // Compute the strides (in bytes)
+  int64_t src_strides[B2ND_MAX_DIM];
+  int64_t dst_strides[B2ND_MAX_DIM];
+  if (ndim > 0) {
+    src_strides[ndim - 1] = itemsize;
+    dst_strides[ndim - 1] = itemsize;
+  }
+  for (int i = ndim - 2; i >= 0; --i) {
+    src_strides[i] = src_strides[i + 1] * src_pad_shape[i + 1];
+    dst_strides[i] = dst_strides[i + 1] * dst_pad_shape[i + 1];
+  }
+
+  // Align the buffers removing unnecessary data
+  int64_t src_start_n = 0;
+  int64_t dst_start_n = 0;
+  for (int i = 0; i < ndim; ++i) {
+    src_start_n += src_start[i] * src_strides[i];
+    dst_start_n += dst_start[i] * dst_strides[i];
+  }
+
+  return b2nd_copy_strided(ndim, itemsize, copy_shape, &((const uint8_t *) src)[src_start_n], src_strides,
+                           &((uint8_t *) dst)[dst_start_n], dst_strides);
+}
@@ -23,6 +23,7 @@
 
 #include "shuffle.h"
 #include "delta.h"
+#include "crc32c.h"
 #include "trunc-prec.h"
 #include "blosclz.h"
 #include "stune.h"
@@ -664,7 +665,7 @@ typedef struct blosc_header_s {
   uint8_t udcompcode;
   uint8_t compcode_meta;
   uint8_t filters_meta[BLOSC2_MAX_FILTERS];
-  uint8_t reserved2;
+  uint8_t blosc2_flags2;
   uint8_t blosc2_flags;
 } blosc_header;
 
@@ -723,6 +724,12 @@ int read_chunk_header(const uint8_t* src, int32_t srcsize, bool extended_header,
     memcpy((uint8_t *)header + BLOSC_MIN_HEADER_LENGTH, src + BLOSC_MIN_HEADER_LENGTH,
       BLOSC_EXTENDED_HEADER_LENGTH - BLOSC_MIN_HEADER_LENGTH);
 
+    if ((header->blosc2_flags2 & BLOSC2_CHECKSUM_MASK) != BLOSC2_CHECKSUM_NONE &&
+        header->version < BLOSC2_VERSION_FORMAT_CHECKSUMS) {
+      BLOSC_TRACE_ERROR("Checksums are not supported in chunk format version %d", header->version);
+      return BLOSC2_ERROR_INVALID_HEADER;
+    }
+
     int32_t special_type = (header->blosc2_flags >> 4) & BLOSC2_SPECIAL_MASK;
     if (special_type != 0) {
       if (header->nbytes % header->typesize != 0) {
@@ -877,7 +884,8 @@ int fill_tuner(blosc2_tuner *tuner) {
 static int blosc2_intialize_header_from_context(blosc2_context* context, blosc_header* header, bool extended_header) {
   memset(header, 0, sizeof(blosc_header));
 
-  header->version = BLOSC2_VERSION_FORMAT;
+  // Only chunks with checksums need the newer format (see blosc_compress_context)
+  header->version = BLOSC2_VERSION_FORMAT_STABLE;
   header->versionlz = compcode_to_compversion(context->compcode);
   header->flags = context->header_flags;
   header->typesize = (uint8_t)context->typesize;
@@ -1548,6 +1556,100 @@ static int32_t set_values(int32_t typesize, const uint8_t* src, uint8_t* dest, i
 }
 
 
+/* Store the checksum of a compressed block (if checksums are wanted) */
+static void set_block_checksum(blosc2_context* context, int32_t nblock,
+                               const uint8_t* block, int32_t len) {
+  if (context->checksum == BLOSC2_CHECKSUM_NONE || context->block_checksums == NULL) {
+    return;
+  }
+  context->block_checksums[nblock] = crc32c(block, (size_t)len);
+}
+
+/* The number of bytes taken by the block checksums at the end of a chunk */
+static int32_t get_checksums_len(uint8_t blosc2_flags2, int32_t header_overhead,
+                                 int32_t special_type, int32_t nblocks) {
+  if (header_overhead != BLOSC_EXTENDED_HEADER_LENGTH || special_type != BLOSC2_NO_SPECIAL ||
+      (blosc2_flags2 & BLOSC2_CHECKSUM_MASK) == BLOSC2_CHECKSUM_NONE) {
+    return 0;
+  }
+  return nblocks * (int32_t)sizeof(uint32_t);
+}
+
+static int compare_block_starts(const void* a, const void* b) {
+  int64_t start_a = *(const int64_t*)a;
+  int64_t start_b = *(const int64_t*)b;
+  return (start_a > start_b) - (start_a < start_b);
+}
+
+/* Get the length of the compressed streams of every block.  It is the distance from its start to
+ * the next block start in the chunk (blocks are not always stored in order) or to the end of the
+ * streams, so that it only depends on `bstarts` and `cbytes`, and not on the sizes of the streams,
+ * which the checksums have to cover.  Blocks that cannot have any length get an error instead. */
+static int get_block_spans(const uint8_t* bstarts, int32_t nblocks, int32_t streams_end,
+                           int32_t* spans) {
+  // The starts, along with their block, in the order they are in the chunk
+  int64_t* order = malloc(nblocks * sizeof(int64_t));
+  BLOSC_ERROR_NULL(order, BLOSC2_ERROR_MEMORY_ALLOC);
+  bool sorted = true;
+  for (int32_t j = 0; j < nblocks; j++) {
+    int32_t start = sw32_(bstarts + j * sizeof(int32_t));
+    // Negative starts are wrong anyway, and blosc_d() reports them
+    order[j] = ((int64_t)(start > 0 ? start : 0) << 32) | j;
+    if (j > 0 && order[j] < order[j - 1]) {
+      sorted = false;
+    }
+  }
+  if (!sorted) {
+    // Threads store the blocks in the order they finish
+    qsort(order, nblocks, sizeof(int64_t), compare_block_starts);
+  }
+
+  int32_t block_end = streams_end;
+  int32_t next_start = streams_end;
+  for (int32_t k = nblocks - 1; k >= 0; k--) {
+    int32_t start = (int32_t)(order[k] >> 32);
+    int32_t nblock = (int32_t)(order[k] & 0xFFFFFFFF);
+    if (start < next_start) {
+      block_end = next_start;
+      next_start = start;
+    }
+    spans[nblock] = block_end > start ? block_end - start : BLOSC2_ERROR_READ_BUFFER;
+  }
+  free(order);
+  return 0;
+}
+
+/* Set the lengths of the blocks of a chunk in the context, if their checksums are to be verified */
+static int set_block_spans(blosc2_context* context, const blosc_header* header, const uint8_t* src) {
+  bool memcpyed = header->flags & (uint8_t)BLOSC_MEMCPYED;
+  bool is_lazy = ((context->header_overhead == BLOSC_EXTENDED_HEADER_LENGTH) &&
+                  (context->blosc2_flags & 0x08u) && !context->special_type);
+  int32_t checksums_len = get_checksums_len(header->blosc2_flags2, context->header_overhead,
+                                            context->special_type, context->nblocks);
+  // Memcpyed blocks have a known length, and lazy ones have it in the trailer
+  if (!context->verify_checksums || checksums_len == 0 || memcpyed || is_lazy) {
+    return 0;
+  }
+  if (context->block_spans_nitems < context->nblocks) {
+    free(context->block_spans);
+    context->block_spans = malloc(context->nblocks * sizeof(int32_t));
+    BLOSC_ERROR_NULL(context->block_spans, BLOSC2_ERROR_MEMORY_ALLOC);
+    context->block_spans_nitems = context->nblocks;
+  }
+  return get_block_spans(src + context->header_overhead, context->nblocks,
+                         header->cbytes - checksums_len, context->block_spans);
+}
+
+static int verify_block_checksum(const uint8_t* block, int32_t len, const uint8_t* checksums,
+                                 int32_t nblock) {
+  if (crc32c(block, (size_t)len) != (uint32_t)sw32_(checksums + nblock * sizeof(uint32_t))) {
+    BLOSC_TRACE_ERROR("Checksum mismatch in block %d.", nblock);
+    return BLOSC2_ERROR_CHECKSUM;
+  }
+  return 0;
+}
+
+
 /* Decompress & unshuffle a single block */
 static int blosc_d(
     struct thread_context* thread_context, int32_t bsize,
@@ -1581,6 +1683,9 @@ static int blosc_d(
   if (rc < 0) {
     return rc;
   }
+  int32_t checksums_len = get_checksums_len(src[BLOSC2_CHUNK_BLOSC2_FLAGS2], context->header_overhead,
+                                            context->special_type, context->nblocks);
+  const uint8_t* checksums = NULL;
 
   // In some situations (lazychunks) the context can arrive uninitialized
   // (but BITSHUFFLE needs it for accessing the format of the chunk)
@@ -1612,6 +1717,10 @@ static int blosc_d(
     // Get the csize of the nblock
     int32_t *block_csizes = (int32_t *)(src + trailer_offset + sizeof(int32_t) + sizeof(int64_t));
     int32_t block_csize = block_csizes[nblock];
+    if (checksums_len > 0) {
+      // The checksums come after the csizes
+      checksums = (uint8_t *)(block_csizes + context->nblocks);
+    }
     // Read the lazy block on disk
     void* fp = NULL;
     blosc2_io_cb *io_cb = blosc2_get_io_cb(context->schunk->storage->io->id);
@@ -1648,12 +1757,21 @@ static int blosc_d(
     src_offset = 0;
     srcsize = block_csize;
   }
+  else if (checksums_len > 0) {
+    if (chunk_cbytes > srcsize) {
+      return BLOSC2_ERROR_READ_BUFFER;
+    }
+    checksums = src + chunk_cbytes - checksums_len;
+  }
+  if (!context->verify_checksums) {
+    checksums = NULL;
+  }
 
   // If the chunk is memcpyed, we just have to copy the block to dest and return
   if (memcpyed) {
     int bsize_ = leftoverblock ? chunk_nbytes % context->blocksize : bsize;
     if (!context->special_type) {
-      if (chunk_nbytes + context->header_overhead != chunk_cbytes) {
+      if (chunk_nbytes + context->header_overhead + checksums_len != chunk_cbytes) {
         return BLOSC2_ERROR_WRITE_BUFFER;
       }
       if (chunk_cbytes < context->header_overhead + (nblock * context->blocksize) + bsize_) {
@@ -1664,6 +1782,12 @@ static int blosc_d(
     if (!is_lazy) {
       src += context->header_overhead + nblock * context->blocksize;
     }
+    if (checksums != NULL) {
+      rc = verify_block_checksum(src, bsize_, checksums, nblock);
+      if (rc < 0) {
+        return rc;
+      }
+    }
     _dest = dest + dest_offset;
     if (context->postfilter != NULL) {
       // We are making use of a postfilter, so use a temp for destination
@@ -1727,6 +1851,15 @@ static int blosc_d(
     return BLOSC2_ERROR_DATA;
   }
 
+  int32_t checksum_span = 0;
+  if (checksums != NULL) {
+    // Lazy blocks are read with the size in the index of the frame
+    checksum_span = is_lazy ? srcsize : context->block_spans[nblock];
+    if (checksum_span < 0) {
+      return checksum_span;
+    }
+  }
+
   src += src_offset;
   srcsize -= src_offset;
 
@@ -1759,6 +1892,13 @@ static int blosc_d(
     /* Not enough space to output bytes */
     BLOSC_ERROR(BLOSC2_ERROR_WRITE_BUFFER);
   }
+  if (checksums != NULL) {
+    // Check the compressed block before handing it to the codecs
+    rc = verify_block_checksum(src, checksum_span, checksums, nblock);
+    if (rc < 0) {
+      return rc;
+    }
+  }
   for (int j = 0; j < nstreams; j++) {
     if (srcsize < (signed)sizeof(int32_t)) {
       /* Not enough input to read compressed size */
@@ -1959,6 +2099,9 @@ static int serial_blosc(struct thread_context* thread_context) {
           break;
         }
       }
+      if (cbytes > 0) {
+        set_block_checksum(context, j, context->dest + ntbytes, cbytes);
+      }
     }
     else {
       /* Regular decompression */
@@ -2268,6 +2411,29 @@ static int initialize_context_compression(
 }
 
 
+/* Get the bytes of the destination that a decompression writes, which do not go past the last
+ * block that is not masked out. */
+static int32_t get_decompressed_extent(blosc2_context* context, blosc_header* header) {
+  if (context->block_maskout == NULL) {
+    return header->nbytes;
+  }
+  int32_t nblocks = header->nbytes / header->blocksize;
+  if (header->nbytes % header->blocksize > 0) {
+    nblocks++;
+  }
+  if (context->block_maskout_nitems != nblocks) {
+    // The mismatch is reported when initializing the context
+    return header->nbytes;
+  }
+  int32_t nblock = nblocks;
+  while (nblock > 0 && context->block_maskout[nblock - 1]) {
+    nblock--;
+  }
+  int64_t extent = (int64_t)nblock * header->blocksize;
+  return extent < header->nbytes ? (int32_t)extent : header->nbytes;
+}
+
+
 static int initialize_context_decompression(blosc2_context* context, blosc_header* header, const void* src,
                                             int32_t srcsize, void* dest, int32_t destsize) {
   int32_t bstarts_end;
@@ -2286,7 +2452,7 @@ static int initialize_context_decompression(blosc2_context* context, blosc_heade
   }
 
   /* Check that we have enough space to decompress */
-  if (context->sourcesize > (int32_t)context->destsize) {
+  if (get_decompressed_extent(context, header) > (int32_t)context->destsize) {
     return BLOSC2_ERROR_WRITE_BUFFER;
   }
 
@@ -2304,8 +2470,15 @@ static int initialize_context_decompression(blosc2_context* context, blosc_heade
     return BLOSC2_ERROR_DATA;
   }
 
+  if ((header->blosc2_flags2 & BLOSC2_CHECKSUM_MASK) > BLOSC2_CHECKSUM_CRC32C) {
+    BLOSC_TRACE_ERROR("Unknown checksum ID (%d) ", header->blosc2_flags2 & BLOSC2_CHECKSUM_MASK);
+    return BLOSC2_ERROR_DATA;
+  }
+  int32_t checksums_len = get_checksums_len(header->blosc2_flags2, context->header_overhead,
+                                            context->special_type, context->nblocks);
+
   int memcpyed = (context->header_flags & (uint8_t) BLOSC_MEMCPYED);
-  if (memcpyed && (header->cbytes != header->nbytes + context->header_overhead)) {
+  if (memcpyed && (header->cbytes != header->nbytes + context->header_overhead + checksums_len)) {
     BLOSC_TRACE_ERROR("Wrong header info for this memcpyed chunk");
     return BLOSC2_ERROR_DATA;
   }
@@ -2329,6 +2502,11 @@ static int initialize_context_decompression(blosc2_context* context, blosc_heade
   }
   srcsize -= bstarts_end;
 
+  rc = set_block_spans(context, header, context->src);
+  if (rc < 0) {
+    return rc;
+  }
+
   /* Read optional dictionary if flag set */
   if (context->blosc2_flags & BLOSC2_USEDICT) {
 #if defined(HAVE_ZSTD)
@@ -2448,6 +2626,21 @@ static int blosc_compress_context(blosc2_context* context) {
 
   blosc_set_timestamp(&last);
 
+  // Make room for the block checksums at the end of the chunk
+  int32_t checksums_len = 0;
+  if (context->checksum != BLOSC2_CHECKSUM_NONE &&
+      context->header_overhead == BLOSC_EXTENDED_HEADER_LENGTH &&
+      !(context->blosc2_flags & BLOSC2_INSTR_CODEC)) {
+    if (context->block_checksums_nitems < context->nblocks) {
+      free(context->block_checksums);
+      context->block_checksums = malloc(context->nblocks * sizeof(uint32_t));
+      BLOSC_ERROR_NULL(context->block_checksums, BLOSC2_ERROR_MEMORY_ALLOC);
+      context->block_checksums_nitems = context->nblocks;
+    }
+    checksums_len = context->nblocks * (int32_t)sizeof(uint32_t);
+    context->destsize -= checksums_len;
+  }
+
   if (!memcpyed) {
     /* Do the actual compression */
     ntbytes = do_job(context);
@@ -2474,6 +2667,11 @@ static int blosc_compress_context(blosc2_context* context) {
   }
 
   if (memcpyed) {
+    if (checksums_len > 0 && context->sourcesize + context->header_overhead > context->destsize) {
+      // There is no room for the checksums, so store the chunk without them
+      context->destsize += checksums_len;
+      checksums_len = 0;
+    }
     if (context->sourcesize + context->header_overhead > context->destsize) {
       /* We are exceeding maximum output size */
       ntbytes = 0;
@@ -2498,7 +2696,19 @@ static int blosc_compress_context(blosc2_context* context) {
       context->dest[BLOSC2_CHUNK_BLOSC2_FLAGS] |= BLOSC2_SPECIAL_ZERO << 4;
       // ...and assign the new chunk length
       ntbytes = context->header_overhead;
+      checksums_len = 0;
+    }
+  }
+
+  if (ntbytes > 0 && checksums_len > 0) {
+    // Append the block checksums and flag them in the header
+    for (int i = 0; i < context->nblocks; i++) {
+      _sw32(context->dest + ntbytes + i * sizeof(uint32_t), (int32_t)context->block_checksums[i]);
     }
+    ntbytes += checksums_len;
+    context->dest[BLOSC2_CHUNK_BLOSC2_FLAGS2] |= context->checksum & BLOSC2_CHECKSUM_MASK;
+    // Older libraries ignore the flags above, so make them refuse the chunk instead
+    context->dest[BLOSC2_CHUNK_VERSION] = BLOSC2_VERSION_FORMAT_CHECKSUMS;
   }
 
   /* Set the number of compressed bytes in header */
@@ -2903,7 +3113,7 @@ static int blosc_run_decompression_with_context(blosc2_context* context, const v
     return rc;
   }
 
-  if (header.nbytes > destsize) {
+  if (get_decompressed_extent(context, &header) > destsize) {
     // Not enough space for writing into the destination
     return BLOSC2_ERROR_WRITE_BUFFER;
   }
@@ -2919,7 +3129,8 @@ static int blosc_run_decompression_with_context(blosc2_context* context, const v
     return ntbytes;
   }
 
-  assert(ntbytes <= (int32_t)destsize);
+  // Blocks masked out count as decompressed, even past the end of the destination
+  assert(ntbytes <= (int32_t)destsize || context->block_maskout != NULL);
   return ntbytes;
 }
 
@@ -3048,6 +3259,10 @@ int _blosc_getitem(blosc2_context* context, blosc_header* header, const void* sr
     BLOSC_TRACE_ERROR("`bstarts` out of bounds.");
     return BLOSC2_ERROR_READ_BUFFER;
   }
+  rc = set_block_spans(context, header, _src);
+  if (rc < 0) {
+    return rc;
+  }
 
   bool memcpyed = header->flags & (uint8_t)BLOSC_MEMCPYED;
   if (context->special_type) {
@@ -3057,7 +3272,10 @@ int _blosc_getitem(blosc2_context* context, blosc_header* header, const void* sr
 
   bool is_lazy = ((context->header_overhead == BLOSC_EXTENDED_HEADER_LENGTH) &&
                   (context->blosc2_flags & 0x08u) && !context->special_type);
-  if (memcpyed && !is_lazy && !context->postfilter) {
+  bool verify = context->verify_checksums &&
+                get_checksums_len(header->blosc2_flags2, context->header_overhead,
+                                  context->special_type, context->nblocks) > 0;
+  if (memcpyed && !is_lazy && !context->postfilter && !verify) {
     // Short-circuit for (non-lazy) memcpyed or special values
     ntbytes = nitems * header->typesize;
     switch (context->special_type) {
@@ -3340,11 +3558,17 @@ static void t_blosc_do_job(void *ctxt)
                            dest + context->header_overhead + nblock_ * blocksize,
                            tmp, tmp3);
         }
+        if (cbytes > 0) {
+          set_block_checksum(context, nblock_, dest + context->header_overhead + nblock_ * blocksize, cbytes);
+        }
       }
       else {
         /* Regular compression */
         cbytes = blosc_c(thcontext, bsize, leftoverblock, 0,
                           ebsize, src, nblock_ * blocksize, tmp2, tmp, tmp3);
+        if (cbytes > 0) {
+          set_block_checksum(context, nblock_, tmp2, cbytes);
+        }
       }
     }
     else {
@@ -3711,6 +3935,92 @@ int blosc1_cbuffer_validate(const void* cbuffer, size_t cbytes, size_t* nbytes)
   return 0;
 }
 
+int blosc2_chunk_verify(const void* src, int32_t srcsize) {
+  const uint8_t* _src = (const uint8_t*)src;
+  blosc_header header;
+  int rc = read_chunk_header(_src, srcsize, true, &header);
+  if (rc < 0) {
+    return rc;
+  }
+  if (!((header.flags & BLOSC_DOSHUFFLE) && (header.flags & BLOSC_DOBITSHUFFLE))) {
+    // Regular headers have no room for checksums
+    return 0;
+  }
+  if (header.blosc2_flags & 0x08u) {
+    BLOSC_TRACE_ERROR("Lazy chunks cannot be verified.");
+    return BLOSC2_ERROR_INVALID_PARAM;
+  }
+  if ((header.blosc2_flags2 & BLOSC2_CHECKSUM_MASK) > BLOSC2_CHECKSUM_CRC32C) {
+    BLOSC_TRACE_ERROR("Unknown checksum ID (%d) ", header.blosc2_flags2 & BLOSC2_CHECKSUM_MASK);
+    return BLOSC2_ERROR_DATA;
+  }
+
+  int32_t nblocks = header.nbytes / header.blocksize;
+  int32_t leftover = header.nbytes % header.blocksize;
+  nblocks = (leftover > 0) ? nblocks + 1 : nblocks;
+  int32_t special_type = (header.blosc2_flags >> 4) & BLOSC2_SPECIAL_MASK;
+  int32_t checksums_len = get_checksums_len(header.blosc2_flags2, BLOSC_EXTENDED_HEADER_LENGTH,
+                                            special_type, nblocks);
+  if (checksums_len == 0) {
+    return 0;
+  }
+  if (header.cbytes > srcsize) {
+    BLOSC_TRACE_ERROR("`cbytes` exceeds length of source buffer.");
+    return BLOSC2_ERROR_READ_BUFFER;
+  }
+  int32_t streams_end = header.cbytes - checksums_len;
+  const uint8_t* checksums = _src + streams_end;
+  bool memcpyed = header.flags & (uint8_t)BLOSC_MEMCPYED;
+  int32_t bstarts_end = BLOSC_EXTENDED_HEADER_LENGTH + nblocks * (int32_t)sizeof(int32_t);
+  if (!memcpyed && streams_end < bstarts_end) {
+    BLOSC_TRACE_ERROR("`bstarts` exceeds length of source buffer.");
+    return BLOSC2_ERROR_READ_BUFFER;
+  }
+  int32_t* spans = NULL;
+  if (!memcpyed) {
+    spans = malloc(nblocks * sizeof(int32_t));
+    BLOSC_ERROR_NULL(spans, BLOSC2_ERROR_MEMORY_ALLOC);
+    rc = get_block_spans(_src + BLOSC_EXTENDED_HEADER_LENGTH, nblocks, streams_end, spans);
+    if (rc < 0) {
+      free(spans);
+      return rc;
+    }
+  }
+
+  for (int32_t j = 0; j < nblocks; j++) {
+    bool leftoverblock = (j == nblocks - 1) && (leftover > 0);
+    int32_t block_start;
+    int32_t span;
+    if (memcpyed) {
+      block_start = BLOSC_EXTENDED_HEADER_LENGTH + j * header.blocksize;
+      span = leftoverblock ? leftover : header.blocksize;
+      if (block_start + span > streams_end) {
+        rc = BLOSC2_ERROR_READ_BUFFER;
+        break;
+      }
+    }
+    else {
+      block_start = sw32_(_src + BLOSC_EXTENDED_HEADER_LENGTH + j * sizeof(int32_t));
+      if (block_start < bstarts_end || block_start >= streams_end) {
+        rc = BLOSC2_ERROR_DATA;
+        break;
+      }
+      span = spans[j];
+      if (span < 0) {
+        rc = span;
+        break;
+      }
+    }
+    rc = verify_block_checksum(_src + block_start, span, checksums, j);
+    if (rc < 0) {
+      break;
+    }
+  }
+  free(spans);
+
+  return rc < 0 ? rc : nblocks;
+}
+
 /* Return `typesize` and `flags` from a compressed buffer. */
 void blosc1_cbuffer_metainfo(const void* cbuffer, size_t* typesize, int* flags) {
   blosc_header header;
@@ -4115,6 +4425,13 @@ blosc2_context* blosc2_create_cctx(blosc2_cparams cparams) {
   context->codec_params = cparams.codec_params;
   memcpy(context->filter_params, cparams.filter_params, BLOSC2_MAX_FILTERS * sizeof(void*));
 
+  if (cparams.checksum > BLOSC2_CHECKSUM_CRC32C) {
+    BLOSC_TRACE_ERROR("Unknown checksum ID (%d).", cparams.checksum);
+    blosc2_free_ctx(context);
+    return NULL;
+  }
+  context->checksum = cparams.checksum;
+
   return context;
 }
 
@@ -4148,6 +4465,7 @@ blosc2_context* blosc2_create_dctx(blosc2_dparams dparams) {
     BLOSC_ERROR_NULL(context->postparams, NULL);
     memcpy(context->postparams, dparams.postparams, sizeof(blosc2_postfilter_params));
   }
+  context->verify_checksums = dparams.verify_checksums;
 
   return context;
 }
@@ -4204,6 +4522,8 @@ void blosc2_free_ctx(blosc2_context* context) {
   if (context->block_maskout != NULL) {
     free(context->block_maskout);
   }
+  free(context->block_checksums);
+  free(context->block_spans);
   my_free(context);
 }
 
@@ -4227,6 +4547,7 @@ int blosc2_ctx_get_cparams(blosc2_context *ctx, blosc2_cparams *cparams) {
   cparams->preparams = ctx->preparams;
   cparams->tuner_id = ctx->tuner_id;
   cparams->codec_params = ctx->codec_params;
+  cparams->checksum = ctx->checksum;
 
   return BLOSC2_ERROR_SUCCESS;
 }
@@ -4237,6 +4558,7 @@ int blosc2_ctx_get_dparams(blosc2_context *ctx, blosc2_dparams *dparams) {
   dparams->schunk = ctx->schunk;
   dparams->postfilter = ctx->postfilter;
   dparams->postparams = ctx->postparams;
+  dparams->verify_checksums = ctx->verify_checksums;
 
   return BLOSC2_ERROR_SUCCESS;
 }
@@ -4291,7 +4613,7 @@ int blosc2_chunk_zeros(blosc2_cparams cparams, const int32_t nbytes, void* dest,
   }
 
   memset(&header, 0, sizeof(header));
-  header.version = BLOSC2_VERSION_FORMAT;
+  header.version = BLOSC2_VERSION_FORMAT_STABLE;
   header.versionlz = BLOSC_BLOSCLZ_VERSION_FORMAT;
   header.flags = BLOSC_DOSHUFFLE | BLOSC_DOBITSHUFFLE;  // extended header
   header.typesize = context->typesize;
@@ -4337,7 +4659,7 @@ int blosc2_chunk_uninit(blosc2_cparams cparams, const int32_t nbytes, void* dest
   }
 
   memset(&header, 0, sizeof(header));
-  header.version = BLOSC2_VERSION_FORMAT;
+  header.version = BLOSC2_VERSION_FORMAT_STABLE;
   header.versionlz = BLOSC_BLOSCLZ_VERSION_FORMAT;
   header.flags = BLOSC_DOSHUFFLE | BLOSC_DOBITSHUFFLE;  // extended header
   header.typesize = context->typesize;
@@ -4384,7 +4706,7 @@ int blosc2_chunk_nans(blosc2_cparams cparams, const int32_t nbytes, void* dest,
   }
 
   memset(&header, 0, sizeof(header));
-  header.version = BLOSC2_VERSION_FORMAT;
+  header.version = BLOSC2_VERSION_FORMAT_STABLE;
   header.versionlz = BLOSC_BLOSCLZ_VERSION_FORMAT;
   header.flags = BLOSC_DOSHUFFLE | BLOSC_DOBITSHUFFLE;  // extended header
   header.typesize = context->typesize;
@@ -4433,7 +4755,7 @@ int blosc2_chunk_repeatval(blosc2_cparams cparams, const int32_t nbytes,
   }
 
   memset(&header, 0, sizeof(header));
-  header.version = BLOSC2_VERSION_FORMAT;
+  header.version = BLOSC2_VERSION_FORMAT_STABLE;
   header.versionlz = BLOSC_BLOSCLZ_VERSION_FORMAT;
   header.flags = BLOSC_DOSHUFFLE | BLOSC_DOBITSHUFFLE;  // extended header
   header.typesize = (uint8_t)typesize;
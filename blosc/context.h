@@ -106,6 +106,12 @@ struct blosc2_context_s {
   int dref_not_init;  /* data ref in delta not initialized */
   pthread_mutex_t delta_mutex;
   pthread_cond_t delta_cv;
+  uint8_t checksum;  /* The kind of block checksums to store when compressing */
+  bool verify_checksums;  /* Whether to verify the block checksums when decompressing */
+  uint32_t* block_checksums;  /* The checksums of the blocks being compressed */
+  int32_t block_checksums_nitems;  /* The number of items in block_checksums */
+  int32_t* block_spans;  /* The compressed length of every block, for verifying its checksum */
+  int32_t block_spans_nitems;  /* The number of items allocated in block_spans */
   // Add new fields here to avoid breaking the ABI.
 };
 
@@ -0,0 +1,21 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#ifndef BLOSC_CRC32C_H
+#define BLOSC_CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRC-32C (Castagnoli) of `len` bytes in `data`.  The hardware CRC instructions
+   are used when the processor has them (SSE4.2 in x86, CRC32 in ARMv8). */
+uint32_t crc32c(const uint8_t* data, size_t len);
+
+#endif /* BLOSC_CRC32C_H */
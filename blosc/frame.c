@@ -46,6 +46,23 @@ blosc2_frame_s* frame_new(const char* urlpath) {
 }
 
 
+/* Get `len` bytes at `offset` of an on-disk frame if they were read when opening it; else NULL */
+static uint8_t* get_prefetched(blosc2_frame_s* frame, int64_t offset, int64_t len) {
+  if (frame->prefetch == NULL) {
+    return NULL;
+  }
+  int64_t head_len = frame->prefetch_head_len;
+  int64_t tail_offset = frame->prefetch_tail_offset;
+  if (offset + len <= head_len || (tail_offset == head_len && offset + len <= frame->len)) {
+    return frame->prefetch + offset;
+  }
+  if (offset >= tail_offset && offset + len <= frame->len) {
+    return frame->prefetch + head_len + (offset - tail_offset);
+  }
+  return NULL;
+}
+
+
 /* Free memory from a frame. */
 int frame_free(blosc2_frame_s* frame) {
 
@@ -57,6 +74,9 @@ int frame_free(blosc2_frame_s* frame) {
     free(frame->coffsets);
   }
 
+  free(frame->vlmeta_offsets);
+  free(frame->prefetch);
+
   if (frame->urlpath != NULL) {
     free(frame->urlpath);
   }
@@ -138,8 +158,8 @@ void *new_header_frame(blosc2_schunk *schunk, blosc2_frame_s *frame) {
     return NULL;
   }
 
-  // Other flags
-  *h2p = schunk->splitmode - 1;
+  // Other flags: the splitmode and the kind of block checksums of the chunks
+  *h2p = (uint8_t) ((schunk->splitmode - 1) | (schunk->cctx->checksum << 2u));
   h2p += 1;
   if (h2p - h2 >= FRAME_HEADER_MINLEN) {
     return NULL;
@@ -357,7 +377,7 @@ void *new_header_frame(blosc2_schunk *schunk, blosc2_frame_s *frame) {
 int get_header_info(blosc2_frame_s *frame, int32_t *header_len, int64_t *frame_len, int64_t *nbytes, int64_t *cbytes,
                     int32_t *blocksize, int32_t *chunksize, int64_t *nchunks, int32_t *typesize, uint8_t *compcode,
                     uint8_t *compcode_meta, uint8_t *clevel, uint8_t *filters, uint8_t *filters_meta,
-                    uint8_t *splitmode, const blosc2_io *io) {
+                    uint8_t *splitmode, uint8_t *checksum, const blosc2_io *io) {
   uint8_t* framep = frame->cframe;
   uint8_t header[FRAME_HEADER_MINLEN];
 
@@ -372,6 +392,9 @@ int get_header_info(blosc2_frame_s *frame, int32_t *header_len, int64_t *frame_l
   }
 
   if (frame->cframe == NULL) {
+    framep = get_prefetched(frame, 0, FRAME_HEADER_MINLEN);
+  }
+  if (framep == NULL) {
     int64_t rbytes = 0;
     void* fp = NULL;
     if (frame->sframe) {
@@ -415,16 +438,38 @@ int get_header_info(blosc2_frame_s *frame, int32_t *header_len, int64_t *frame_l
     BLOSC_TRACE_ERROR("Header length is zero or smaller than min allowed.");
     return BLOSC2_ERROR_INVALID_HEADER;
   }
-  from_big(frame_len, framep + FRAME_LEN, sizeof(*frame_len));
+  bool streamed = framep[FRAME_FLAGS] & FRAME_STREAMED;
+  if (streamed && !frame->streamed) {
+    BLOSC_TRACE_ERROR("The footer of the streamed frame has not been read.");
+    return BLOSC2_ERROR_INVALID_HEADER;
+  }
+  if (streamed) {
+    // The sizes in the header of a streamed frame are placeholders; the actual ones are in its footer
+    *frame_len = frame->len;
+  }
+  else {
+    from_big(frame_len, framep + FRAME_LEN, sizeof(*frame_len));
+  }
   if (*header_len > *frame_len) {
     BLOSC_TRACE_ERROR("Header length exceeds length of the frame.");
     return BLOSC2_ERROR_INVALID_HEADER;
   }
-  from_big(nbytes, framep + FRAME_NBYTES, sizeof(*nbytes));
-  from_big(cbytes, framep + FRAME_CBYTES, sizeof(*cbytes));
+  if (streamed) {
+    *nbytes = frame->footer_nbytes;
+    *cbytes = frame->footer_cbytes;
+  }
+  else {
+    from_big(nbytes, framep + FRAME_NBYTES, sizeof(*nbytes));
+    from_big(cbytes, framep + FRAME_CBYTES, sizeof(*cbytes));
+  }
   from_big(blocksize, framep + FRAME_BLOCKSIZE, sizeof(*blocksize));
   if (chunksize != NULL) {
-    from_big(chunksize, framep + FRAME_CHUNKSIZE, sizeof(*chunksize));
+    if (streamed) {
+      *chunksize = frame->footer_chunksize;
+    }
+    else {
+      from_big(chunksize, framep + FRAME_CHUNKSIZE, sizeof(*chunksize));
+    }
   }
   if (typesize != NULL) {
     from_big(typesize, framep + FRAME_TYPESIZE, sizeof(*typesize));
@@ -449,9 +494,10 @@ int get_header_info(blosc2_frame_s *frame, int32_t *header_len, int64_t *frame_l
   // Other flags
   uint8_t other_flags = framep[FRAME_OTHER_FLAGS];
   if (splitmode != NULL) {
-    *splitmode = other_flags & 0x4u;
-    from_big(splitmode, framep + FRAME_OTHER_FLAGS, sizeof(*splitmode));
-    *splitmode += 1;
+    *splitmode = (other_flags & 0x3u) + 1;
+  }
+  if (checksum != NULL) {
+    *checksum = (other_flags >> 2u) & BLOSC2_CHECKSUM_MASK;
   }
 
   if (compcode_meta != NULL) {
@@ -545,11 +591,8 @@ int update_frame_len(blosc2_frame_s* frame, int64_t len) {
 }
 
 
-int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
-  if (frame != NULL && frame->len == 0) {
-    BLOSC_TRACE_ERROR("The trailer cannot be updated on empty frames.");
-  }
-
+/* Build the trailer of a frame out of the vlmetalayers of a super-chunk */
+static uint8_t* new_trailer_frame(blosc2_schunk* schunk, int64_t* trailer_lenp) {
   // Create the trailer in msgpack (see the frame format document)
   int64_t trailer_len = FRAME_TRAILER_MINLEN;
   uint8_t* trailer = (uint8_t*)calloc((size_t)trailer_len, 1);
@@ -565,7 +608,8 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   // Now, deal with variable-length metalayers
   int16_t nvlmetalayers = schunk->nvlmetalayers;
   if (nvlmetalayers < 0 || nvlmetalayers > BLOSC2_MAX_METALAYERS) {
-    return -1;
+    free(trailer);
+    return NULL;
   }
 
   // Make space for the header of metalayers (array marker, size, map of offsets)
@@ -590,9 +634,6 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   current_trailer_len = (int32_t)(ptrailer - trailer);
   int32_t *offtodata = malloc(nvlmetalayers * sizeof(int32_t));
   for (int nvlmetalayer = 0; nvlmetalayer < nvlmetalayers; nvlmetalayer++) {
-    if (frame == NULL) {
-      return -1;
-    }
     blosc2_metalayer *vlmetalayer = schunk->vlmetalayers[nvlmetalayer];
     uint8_t name_len = (uint8_t) strlen(vlmetalayer->name);
     trailer = realloc(trailer, (size_t)current_trailer_len + 1 + name_len + 1 + 4);
@@ -600,7 +641,8 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
     // Store the vlmetalayer
     if (name_len >= (1U << 5U)) {  // metalayer strings cannot be longer than 32 bytes
       free(offtodata);
-      return -1;
+      free(trailer);
+      return NULL;
     }
     *ptrailer = (uint8_t)0xa0 + name_len;  // str
     ptrailer += 1;
@@ -615,12 +657,12 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   }
   int32_t tsize2 = (int32_t)(ptrailer - trailer);
   if (tsize2 != current_trailer_len) {  // sanity check
-    return -1;
+    return NULL;
   }
 
   // Map size + int16 size
   if ((uint32_t) (tsize2 - tsize) >= (1U << 16U)) {
-    return -1;
+    return NULL;
   }
   uint16_t map_size = (uint16_t) (tsize2 - tsize);
   to_big(trailer + 4, &map_size, sizeof(map_size));
@@ -637,9 +679,6 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   ptrailer += sizeof(nvlmetalayers);
   current_trailer_len = (int32_t)(ptrailer - trailer);
   for (int nvlmetalayer = 0; nvlmetalayer < nvlmetalayers; nvlmetalayer++) {
-    if (frame == NULL) {
-      return -1;
-    }
     blosc2_metalayer *vlmetalayer = schunk->vlmetalayers[nvlmetalayer];
     trailer = realloc(trailer, (size_t)current_trailer_len + 1 + 4 + vlmetalayer->content_len);
     ptrailer = trailer + current_trailer_len;
@@ -657,7 +696,7 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   free(offtodata);
   tsize = (int32_t)(ptrailer - trailer);
   if (tsize != current_trailer_len) {  // sanity check
-    return -1;
+    return NULL;
   }
 
   trailer = realloc(trailer, (size_t)current_trailer_len + 23);
@@ -684,6 +723,24 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
 
   // Sanity check
   if (ptrailer - trailer != trailer_len) {
+    free(trailer);
+    return NULL;
+  }
+
+  *trailer_lenp = trailer_len;
+  return trailer;
+}
+
+
+
+int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
+  if (frame != NULL && frame->len == 0) {
+    BLOSC_TRACE_ERROR("The trailer cannot be updated on empty frames.");
+  }
+
+  int64_t trailer_len;
+  uint8_t* trailer = new_trailer_frame(schunk, &trailer_len);
+  if (trailer == NULL) {
     return BLOSC2_ERROR_DATA;
   }
 
@@ -697,7 +754,7 @@ int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   int ret = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                             &blocksize, &chunksize, &nchunks,
                             NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                            frame->schunk->storage->io);
+                            NULL, frame->schunk->storage->io);
   if (ret < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return ret;
@@ -780,12 +837,30 @@ static char* normalize_urlpath(const char* urlpath) {
 }
 
 
+/* Get the sizes of a streamed frame out of its footer (the last `len` bytes of the frame are available) */
+static int read_footer(blosc2_frame_s* frame, const uint8_t* footer, int64_t len) {
+  if (footer[0] != 0x90 + 5 || footer[FRAME_FOOTER_MAGIC - 1] != 0xa0 + 8 ||
+      memcmp(footer + FRAME_FOOTER_MAGIC, "b2footer", 8) != 0) {
+    BLOSC_TRACE_ERROR("The footer of the streamed frame is missing or corrupted.");
+    return BLOSC2_ERROR_INVALID_HEADER;
+  }
+  int64_t frame_len;
+  from_big(&frame_len, footer + FRAME_FOOTER_FRAME_LEN, sizeof(frame_len));
+  if (frame_len < FRAME_HEADER_MINLEN + FRAME_TRAILER_MINLEN || frame_len + FRAME_FOOTER_LEN != len) {
+    BLOSC_TRACE_ERROR("The length in the footer of the streamed frame does not match its size.");
+    return BLOSC2_ERROR_INVALID_HEADER;
+  }
+  frame->len = frame_len;
+  frame->streamed = true;
+  from_big(&frame->footer_nbytes, footer + FRAME_FOOTER_NBYTES, sizeof(frame->footer_nbytes));
+  from_big(&frame->footer_cbytes, footer + FRAME_FOOTER_CBYTES, sizeof(frame->footer_cbytes));
+  from_big(&frame->footer_chunksize, footer + FRAME_FOOTER_CHUNKSIZE, sizeof(frame->footer_chunksize));
+  return 0;
+}
+
+
 /* Initialize a frame out of a file */
 blosc2_frame_s* frame_from_file_offset(const char* urlpath, const blosc2_io *io, int64_t offset) {
-    // Get the length of the frame
-    uint8_t header[FRAME_HEADER_MINLEN];
-    uint8_t trailer[FRAME_TRAILER_MINLEN];
-
     void* fp = NULL;
     bool sframe = false;
     struct stat path_stat;
@@ -826,40 +901,80 @@ blosc2_frame_s* frame_from_file_offset(const char* urlpath, const blosc2_io *io,
       return NULL;
     }
     io_cb->seek(fp, offset, SEEK_SET);
-    int64_t rbytes = io_cb->read(header, 1, FRAME_HEADER_MINLEN, fp);
-    if (rbytes != FRAME_HEADER_MINLEN) {
+
+    // Read the start of the frame (header) and its end (trailer) at once, so that opening it
+    // does not need to go to the file again; for small frames the first read gets everything
+    uint8_t* prefetch = malloc(2 * FRAME_OPEN_PREFETCH);
+    int64_t rbytes = io_cb->read(prefetch, 1, FRAME_OPEN_PREFETCH, fp);
+    if (rbytes < FRAME_HEADER_MINLEN) {
         BLOSC_TRACE_ERROR("Cannot read from file '%s'.", urlpath);
         io_cb->close(fp);
+        free(prefetch);
         free(urlpath_cpy);
         return NULL;
     }
     int64_t frame_len;
-    to_big(&frame_len, header + FRAME_LEN, sizeof(frame_len));
+    from_big(&frame_len, prefetch + FRAME_LEN, sizeof(frame_len));
+    bool streamed = !sframe && (prefetch[FRAME_FLAGS] & FRAME_STREAMED);
+    if (streamed) {
+        // The length of a streamed frame is only known by its footer, at the end of the file
+        io_cb->seek(fp, 0, SEEK_END);
+        frame_len = io_cb->tell(fp) - offset;
+    }
+    if (frame_len < FRAME_HEADER_MINLEN + FRAME_TRAILER_MINLEN + (streamed ? FRAME_FOOTER_LEN : 0)) {
+        BLOSC_TRACE_ERROR("The frame in file '%s' is too short.", urlpath);
+        io_cb->close(fp);
+        free(prefetch);
+        free(urlpath_cpy);
+        return NULL;
+    }
+    int64_t head_len = rbytes < frame_len ? rbytes : frame_len;
+    int64_t tail_offset = frame_len - FRAME_OPEN_PREFETCH;
+    if (tail_offset < head_len) {
+        tail_offset = head_len;
+    }
+    if (tail_offset < frame_len) {
+        io_cb->seek(fp, offset + tail_offset, SEEK_SET);
+        rbytes = io_cb->read(prefetch + head_len, 1, frame_len - tail_offset, fp);
+    }
+    else {
+        rbytes = 0;
+    }
+    io_cb->close(fp);
+    if (rbytes != frame_len - tail_offset) {
+        BLOSC_TRACE_ERROR("Cannot read from file '%s'.", urlpath);
+        free(prefetch);
+        free(urlpath_cpy);
+        return NULL;
+    }
 
     blosc2_frame_s* frame = calloc(1, sizeof(blosc2_frame_s));
     frame->urlpath = urlpath_cpy;
     frame->len = frame_len;
     frame->sframe = sframe;
     frame->file_offset = offset;
+    frame->prefetch = prefetch;
+    frame->prefetch_head_len = head_len;
+    frame->prefetch_tail_offset = tail_offset;
+
+    if (streamed) {
+        const uint8_t* footer = get_prefetched(frame, frame_len - FRAME_FOOTER_LEN, FRAME_FOOTER_LEN);
+        if (read_footer(frame, footer, frame_len) < 0) {
+            frame_free(frame);
+            return NULL;
+        }
+        frame_len = frame->len;
+    }
 
     // Now, the trailer length
-    io_cb->seek(fp, offset + frame_len - FRAME_TRAILER_MINLEN, SEEK_SET);
-    rbytes = io_cb->read(trailer, 1, FRAME_TRAILER_MINLEN, fp);
-    io_cb->close(fp);
-    if (rbytes != FRAME_TRAILER_MINLEN) {
-        BLOSC_TRACE_ERROR("Cannot read from file '%s'.", urlpath);
-        free(urlpath_cpy);
-        free(frame);
-        return NULL;
-    }
+    const uint8_t* trailer = get_prefetched(frame, frame_len - FRAME_TRAILER_MINLEN, FRAME_TRAILER_MINLEN);
     int trailer_offset = FRAME_TRAILER_MINLEN - FRAME_TRAILER_LEN_OFFSET;
     if (trailer[trailer_offset - 1] != 0xce) {
-        free(urlpath_cpy);
-        free(frame);
+        frame_free(frame);
         return NULL;
     }
     uint32_t trailer_len;
-    to_big(&trailer_len, trailer + trailer_offset, sizeof(trailer_len));
+    from_big(&trailer_len, trailer + trailer_offset, sizeof(trailer_len));
     frame->trailer_len = trailer_len;
 
     return frame;
@@ -875,13 +990,22 @@ blosc2_frame_s* frame_from_cframe(uint8_t *cframe, int64_t len, bool copy) {
     return NULL;
   }
 
-  from_big(&frame_len, header + FRAME_LEN, sizeof(frame_len));
-  if (frame_len != len) {   // sanity check
-    return NULL;
-  }
-
   blosc2_frame_s* frame = calloc(1, sizeof(blosc2_frame_s));
-  frame->len = frame_len;
+  if (header[FRAME_FLAGS] & FRAME_STREAMED) {
+    if (len < FRAME_FOOTER_LEN || read_footer(frame, cframe + len - FRAME_FOOTER_LEN, len) < 0) {
+      free(frame);
+      return NULL;
+    }
+    frame_len = frame->len;
+  }
+  else {
+    from_big(&frame_len, header + FRAME_LEN, sizeof(frame_len));
+    if (frame_len != len) {   // sanity check
+      free(frame);
+      return NULL;
+    }
+    frame->len = frame_len;
+  }
   frame->file_offset = 0;
 
   // Now, the trailer length
@@ -1055,6 +1179,216 @@ int64_t frame_from_schunk(blosc2_schunk *schunk, blosc2_frame_s *frame) {
 }
 
 
+/* Write `len` bytes into the stream of a frame writer */
+static int writer_write(blosc2_frame_writer* writer, const void* buf, int64_t len) {
+  if (len == 0) {
+    return 0;
+  }
+  int64_t wbytes = writer->io_cb->write(buf, 1, len, writer->fp);
+  if (wbytes != len) {
+    BLOSC_TRACE_ERROR("Cannot write into the streamed frame.");
+    return BLOSC2_ERROR_FILE_WRITE;
+  }
+  return 0;
+}
+
+
+/* Release the resources of a frame writer */
+static void writer_free(blosc2_frame_writer* writer) {
+  if (writer->fp != NULL) {
+    writer->io_cb->close(writer->fp);
+  }
+  free(writer->offsets);
+  free(writer);
+}
+
+
+/* Start writing a streamed frame */
+blosc2_frame_writer* blosc2_frame_writer_new(blosc2_schunk* schunk, const char* urlpath, const blosc2_io* io) {
+  if (schunk == NULL || urlpath == NULL) {
+    BLOSC_TRACE_ERROR("A super-chunk and a path are needed for writing a streamed frame.");
+    return NULL;
+  }
+  if (io == NULL) {
+    io = &BLOSC2_IO_DEFAULTS;
+  }
+  blosc2_io_cb *io_cb = blosc2_get_io_cb(io->id);
+  if (io_cb == NULL) {
+    BLOSC_TRACE_ERROR("Error getting the input/output API");
+    return NULL;
+  }
+
+  // The header of the streamed frame; its sizes are placeholders, as they are only known at the end
+  blosc2_frame_s frame = {0};
+  uint8_t* h2 = new_header_frame(schunk, &frame);
+  if (h2 == NULL) {
+    BLOSC_TRACE_ERROR("Cannot create the header of the streamed frame.");
+    return NULL;
+  }
+  int64_t zero = 0;
+  int32_t zero32 = 0;
+  to_big(h2 + FRAME_LEN, &zero, sizeof(zero));
+  to_big(h2 + FRAME_NBYTES, &zero, sizeof(zero));
+  to_big(h2 + FRAME_CBYTES, &zero, sizeof(zero));
+  to_big(h2 + FRAME_CHUNKSIZE, &zero32, sizeof(zero32));
+  h2[FRAME_FLAGS] |= FRAME_STREAMED;
+  int32_t h2len;
+  from_big(&h2len, h2 + FRAME_HEADER_LEN, sizeof(h2len));
+
+  blosc2_frame_writer* writer = calloc(1, sizeof(blosc2_frame_writer));
+  writer->schunk = schunk;
+  writer->io_cb = io_cb;
+  writer->header_len = h2len;
+  writer->fp = io_cb->open(normalize_urlpath(urlpath), "wb", io->params);
+  if (writer->fp == NULL) {
+    BLOSC_TRACE_ERROR("Error creating file in: %s", urlpath);
+    free(h2);
+    writer_free(writer);
+    return NULL;
+  }
+  int rc = writer_write(writer, h2, h2len);
+  free(h2);
+  if (rc < 0) {
+    writer_free(writer);
+    return NULL;
+  }
+
+  return writer;
+}
+
+
+/* Append an existing chunk to a streamed frame */
+int64_t blosc2_frame_writer_append_chunk(blosc2_frame_writer* writer, const uint8_t* chunk) {
+  int32_t chunk_nbytes;
+  int32_t chunk_cbytes;
+  int rc = blosc2_cbuffer_sizes(chunk, &chunk_nbytes, &chunk_cbytes, NULL);
+  if (rc < 0) {
+    return rc;
+  }
+  if (writer->nchunks == 0) {
+    writer->chunksize = chunk_nbytes;
+  }
+  else if (writer->last_nbytes < writer->chunksize || chunk_nbytes > writer->chunksize) {
+    BLOSC_TRACE_ERROR("Only the last chunk of a streamed frame can be smaller than its chunksize (%d).",
+                      writer->chunksize);
+    return BLOSC2_ERROR_CHUNK_APPEND;
+  }
+
+  if (writer->nchunks == writer->offsets_maxlen) {
+    writer->offsets_maxlen = writer->offsets_maxlen == 0 ? 64 : 2 * writer->offsets_maxlen;
+    writer->offsets = realloc(writer->offsets, writer->offsets_maxlen * sizeof(int64_t));
+    if (writer->offsets == NULL) {
+      BLOSC_TRACE_ERROR("Cannot grow the offsets of the streamed frame.");
+      return BLOSC2_ERROR_MEMORY_ALLOC;
+    }
+  }
+  BLOSC_ERROR(writer_write(writer, chunk, chunk_cbytes));
+
+  writer->offsets[writer->nchunks] = writer->cbytes;
+  writer->nchunks++;
+  writer->nbytes += chunk_nbytes;
+  writer->cbytes += chunk_cbytes;
+  writer->last_nbytes = chunk_nbytes;
+
+  return writer->nchunks;
+}
+
+
+/* Compress a buffer and append it to a streamed frame */
+int64_t blosc2_frame_writer_append_buffer(blosc2_frame_writer* writer, const void* src, int32_t nbytes) {
+  int32_t chunk_maxlen = nbytes + BLOSC2_MAX_OVERHEAD;
+  uint8_t* chunk = malloc(chunk_maxlen);
+  int cbytes = blosc2_compress_ctx(writer->schunk->cctx, src, nbytes, chunk, chunk_maxlen);
+  if (cbytes < 0) {
+    free(chunk);
+    return cbytes;
+  }
+  int64_t nchunks = blosc2_frame_writer_append_chunk(writer, chunk);
+  free(chunk);
+  return nchunks;
+}
+
+
+/* Write the index, the trailer and the footer of a streamed frame */
+int64_t blosc2_frame_writer_close(blosc2_frame_writer* writer) {
+  blosc2_schunk* schunk = writer->schunk;
+  int64_t rc;
+
+  // The chunk of offsets
+  int32_t off_nbytes = (int32_t) (writer->nchunks * sizeof(int64_t));
+  int32_t off_cbytes = 0;
+  uint8_t* off_chunk = NULL;
+  if (writer->nchunks > 0) {
+    off_chunk = malloc(off_nbytes + BLOSC2_MAX_OVERHEAD);
+    blosc2_context *cctx = blosc2_create_cctx(BLOSC2_CPARAMS_DEFAULTS);
+    if (cctx == NULL) {
+      BLOSC_TRACE_ERROR("Error while creating the compression context");
+      free(off_chunk);
+      writer_free(writer);
+      return BLOSC2_ERROR_NULL_POINTER;
+    }
+    cctx->typesize = sizeof(int64_t);
+    off_cbytes = blosc2_compress_ctx(cctx, writer->offsets, off_nbytes, off_chunk,
+                                     off_nbytes + BLOSC2_MAX_OVERHEAD);
+    blosc2_free_ctx(cctx);
+    if (off_cbytes < 0) {
+      free(off_chunk);
+      writer_free(writer);
+      return off_cbytes;
+    }
+  }
+  rc = writer_write(writer, off_chunk, off_cbytes);
+  free(off_chunk);
+  if (rc < 0) {
+    writer_free(writer);
+    return rc;
+  }
+
+  // The trailer, with the vlmetalayers of the super-chunk
+  if (schunk->frame != NULL) {
+    rc = frame_load_vlmetalayers((blosc2_frame_s*)schunk->frame, schunk);
+    if (rc < 0) {
+      writer_free(writer);
+      return rc;
+    }
+  }
+  int64_t trailer_len;
+  uint8_t* trailer = new_trailer_frame(schunk, &trailer_len);
+  if (trailer == NULL) {
+    writer_free(writer);
+    return BLOSC2_ERROR_DATA;
+  }
+  rc = writer_write(writer, trailer, trailer_len);
+  free(trailer);
+  if (rc < 0) {
+    writer_free(writer);
+    return rc;
+  }
+
+  // The footer, with the sizes that were unknown when writing the header
+  uint8_t footer[FRAME_FOOTER_LEN];
+  int64_t frame_len = writer->header_len + writer->cbytes + off_cbytes + trailer_len;
+  footer[0] = 0x90 + 5;  // fixarray with 5 elements
+  footer[FRAME_FOOTER_MAGIC - 1] = 0xa0 + 8;  // str with 8 elements
+  memcpy(footer + FRAME_FOOTER_MAGIC, "b2footer", 8);
+  footer[FRAME_FOOTER_FRAME_LEN - 1] = 0xd3;  // int64
+  to_big(footer + FRAME_FOOTER_FRAME_LEN, &frame_len, sizeof(frame_len));
+  footer[FRAME_FOOTER_NBYTES - 1] = 0xd3;  // int64
+  to_big(footer + FRAME_FOOTER_NBYTES, &writer->nbytes, sizeof(writer->nbytes));
+  footer[FRAME_FOOTER_CBYTES - 1] = 0xd3;  // int64
+  to_big(footer + FRAME_FOOTER_CBYTES, &writer->cbytes, sizeof(writer->cbytes));
+  footer[FRAME_FOOTER_CHUNKSIZE - 1] = 0xd2;  // int32
+  to_big(footer + FRAME_FOOTER_CHUNKSIZE, &writer->chunksize, sizeof(writer->chunksize));
+  rc = writer_write(writer, footer, FRAME_FOOTER_LEN);
+  writer_free(writer);
+  if (rc < 0) {
+    return rc;
+  }
+
+  return frame_len + FRAME_FOOTER_LEN;
+}
+
+
 // Get the compressed data offsets
 uint8_t* get_coffsets(blosc2_frame_s *frame, int32_t header_len, int64_t cbytes,
                       int64_t nchunks, int32_t *off_cbytes) {
@@ -1181,7 +1515,7 @@ int64_t* blosc2_frame_get_offsets(blosc2_schunk *schunk) {
   int ret = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                             &blocksize, &chunksize, &nchunks,
                             NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                            frame->schunk->storage->io);
+                            NULL, frame->schunk->storage->io);
   if (ret < 0) {
     BLOSC_TRACE_ERROR("Cannot get the header info for the frame.");
     return NULL;
@@ -1312,7 +1646,6 @@ int frame_update_header(blosc2_frame_s* frame, blosc2_schunk* schunk, bool new)
 
 static int get_meta_from_header(blosc2_frame_s* frame, blosc2_schunk* schunk, uint8_t* header,
                                 int32_t header_len) {
-  BLOSC_UNUSED_PARAM(frame);
   int64_t header_pos = FRAME_IDX_SIZE;
 
   // Get the size for the index of metalayers
@@ -1412,6 +1745,11 @@ static int get_meta_from_header(blosc2_frame_s* frame, blosc2_schunk* schunk, ui
     if (header_len < offset + 1 + 4 + content_len) {
       return BLOSC2_ERROR_READ_BUFFER;
     }
+    if (frame->view) {
+      // Borrow the content from the frame
+      metalayer->content = content_marker + 1 + 4;
+      continue;
+    }
     char* content = malloc((size_t)content_len);
     memcpy(content, content_marker + 1 + 4, (size_t)content_len);
     metalayer->content = (uint8_t*)content;
@@ -1431,7 +1769,7 @@ int frame_get_metalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   int ret = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                             &blocksize, &chunksize, &nchunks,
                             NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                            schunk->storage->io);
+                            NULL, schunk->storage->io);
   if (ret < 0) {
     BLOSC_TRACE_ERROR("Unable to get the header info from frame.");
     return ret;
@@ -1439,10 +1777,15 @@ int frame_get_metalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
 
   // Get the header
   uint8_t* header = NULL;
+  bool needs_free = false;
   if (frame->cframe != NULL) {
     header = frame->cframe;
   } else {
+    header = get_prefetched(frame, 0, header_len);
+  }
+  if (header == NULL) {
     int64_t rbytes = 0;
+    needs_free = true;
     header = malloc(header_len);
     blosc2_io_cb *io_cb = blosc2_get_io_cb(frame->schunk->storage->io->id);
     if (io_cb == NULL) {
@@ -1480,23 +1823,33 @@ int frame_get_metalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
 
   ret = get_meta_from_header(frame, schunk, header, header_len);
 
-  if (frame->cframe == NULL) {
+  if (needs_free) {
     free(header);
   }
 
   return ret;
 }
 
+/* Remember where the content of a vlmetalayer is, so that it can be read when needed */
+static void defer_vlmetalayer(blosc2_frame_s* frame, int16_t nvlmetalayers, int nvlmetalayer, int32_t offset) {
+  if (frame->vlmeta_offsets == NULL) {
+    frame->vlmeta_offsets = calloc(nvlmetalayers, sizeof(int32_t));
+  }
+  frame->vlmeta_offsets[nvlmetalayer] = offset;
+}
+
+
+/* Parse the vlmetalayers out of the first `avail_len` bytes of a trailer of `trailer_len` bytes.
+ * The contents that are not in those bytes are just indexed, to be read by frame_load_vlmetalayer(). */
 static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk, uint8_t* trailer,
-                                   int32_t trailer_len) {
+                                   int32_t trailer_len, int32_t avail_len) {
 
-  BLOSC_UNUSED_PARAM(frame);
   int64_t trailer_pos = FRAME_TRAILER_VLMETALAYERS + 2;
   uint8_t* idxp = trailer + trailer_pos;
 
   // Get the size for the index of metalayers
   trailer_pos += 2;
-  if (trailer_len < trailer_pos) {
+  if (avail_len < trailer_pos) {
     return BLOSC2_ERROR_READ_BUFFER;
   }
   uint16_t idx_size;
@@ -1505,7 +1858,7 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
 
   trailer_pos += 1;
   // Get the actual index of metalayers
-  if (trailer_len < trailer_pos) {
+  if (avail_len < trailer_pos) {
     return BLOSC2_ERROR_READ_BUFFER;
   }
   if (idxp[0] != 0xde) {   // sanity check
@@ -1515,7 +1868,7 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
 
   int16_t nmetalayers;
   trailer_pos += sizeof(nmetalayers);
-  if (trailer_len < trailer_pos) {
+  if (avail_len < trailer_pos) {
     return BLOSC2_ERROR_READ_BUFFER;
   }
   from_big(&nmetalayers, idxp, sizeof(uint16_t));
@@ -1528,7 +1881,7 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
   // Populate the metalayers and its serialized values
   for (int nmetalayer = 0; nmetalayer < nmetalayers; nmetalayer++) {
     trailer_pos += 1;
-    if (trailer_len < trailer_pos) {
+    if (avail_len < trailer_pos) {
       return BLOSC2_ERROR_READ_BUFFER;
     }
     if ((*idxp & 0xe0u) != 0xa0u) {   // sanity check
@@ -1541,7 +1894,7 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
     uint8_t nslen = *idxp & (uint8_t)0x1F;
     idxp += 1;
     trailer_pos += nslen;
-    if (trailer_len < trailer_pos) {
+    if (avail_len < trailer_pos) {
       return BLOSC2_ERROR_READ_BUFFER;
     }
     char* ns = malloc((size_t)nslen + 1);
@@ -1553,7 +1906,7 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
     // Populate the serialized value for this metalayer
     // Get the offset
     trailer_pos += 1;
-    if (trailer_len < trailer_pos) {
+    if (avail_len < trailer_pos) {
       return BLOSC2_ERROR_READ_BUFFER;
     }
     if ((*idxp & 0xffu) != 0xd2u) {   // sanity check
@@ -1562,7 +1915,7 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
     idxp += 1;
     int32_t offset;
     trailer_pos += sizeof(offset);
-    if (trailer_len < trailer_pos) {
+    if (avail_len < trailer_pos) {
       return BLOSC2_ERROR_READ_BUFFER;
     }
     from_big(&offset, idxp, sizeof(offset));
@@ -1571,11 +1924,13 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
       // Offset is less than zero or exceeds trailer length
       return BLOSC2_ERROR_DATA;
     }
+    if (avail_len < offset + 1 + 4) {
+      // Content not read yet
+      defer_vlmetalayer(frame, nmetalayers, nmetalayer, offset);
+      continue;
+    }
     // Go to offset and see if we have the correct marker
     uint8_t* content_marker = trailer + offset;
-    if (trailer_len < offset + 1 + 4) {
-      return BLOSC2_ERROR_READ_BUFFER;
-    }
     if (*content_marker != 0xc6) {
       return BLOSC2_ERROR_DATA;
     }
@@ -1586,12 +1941,21 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
     if (content_len < 0) {
       return BLOSC2_ERROR_DATA;
     }
-    metalayer->content_len = content_len;
 
     // Finally, read the content
     if (trailer_len < offset + 1 + 4 + content_len) {
       return BLOSC2_ERROR_READ_BUFFER;
     }
+    if (avail_len < offset + 1 + 4 + content_len) {
+      defer_vlmetalayer(frame, nmetalayers, nmetalayer, offset);
+      continue;
+    }
+    metalayer->content_len = content_len;
+    if (frame->view) {
+      // Borrow the (compressed) content from the frame
+      metalayer->content = content_marker + 1 + 4;
+      continue;
+    }
     char* content = malloc((size_t)content_len);
     memcpy(content, content_marker + 1 + 4, (size_t)content_len);
     metalayer->content = (uint8_t*)content;
@@ -1599,7 +1963,35 @@ static int get_vlmeta_from_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk,
   return 1;
 }
 
-int frame_get_vlmetalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
+/* Open the file holding the trailer of an on-disk frame and seek to `trailer_offset + pos` */
+static void* open_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk, blosc2_io_cb *io_cb, int64_t trailer_offset, int64_t pos) {
+  void* fp = NULL;
+  if (frame->sframe) {
+    char* eframe_name = malloc(strlen(frame->urlpath) + strlen("/chunks.b2frame") + 1);
+    sprintf(eframe_name, "%s/chunks.b2frame", frame->urlpath);
+    fp = io_cb->open(eframe_name, "rb", schunk->storage->io->params);
+    if (fp == NULL) {
+      BLOSC_TRACE_ERROR("Error opening file in: %s", eframe_name);
+      free(eframe_name);
+      return NULL;
+    }
+    free(eframe_name);
+    io_cb->seek(fp, trailer_offset + pos, SEEK_SET);
+  }
+  else {
+    fp = io_cb->open(frame->urlpath, "rb", schunk->storage->io->params);
+    if (fp == NULL) {
+      BLOSC_TRACE_ERROR("Error opening file in: %s", frame->urlpath);
+      return NULL;
+    }
+    io_cb->seek(fp, frame->file_offset + trailer_offset + pos, SEEK_SET);
+  }
+  return fp;
+}
+
+
+/* Get the offset of the trailer of a frame */
+static int64_t get_trailer_offset_info(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   int32_t header_len;
   int64_t frame_len;
   int64_t nbytes;
@@ -1610,69 +2002,80 @@ int frame_get_vlmetalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
   int ret = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                             &blocksize, &chunksize, &nchunks,
                             NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                            schunk->storage->io);
+                            NULL, schunk->storage->io);
   if (ret < 0) {
     BLOSC_TRACE_ERROR("Unable to get the trailer info from frame.");
     return ret;
   }
 
   int64_t trailer_offset = get_trailer_offset(frame, header_len, nbytes > 0);
-  int32_t trailer_len = (int32_t) frame->trailer_len;
-
-  if (trailer_offset < BLOSC_EXTENDED_HEADER_LENGTH || trailer_offset + trailer_len > frame->len) {
+  if (trailer_offset < BLOSC_EXTENDED_HEADER_LENGTH || trailer_offset + frame->trailer_len > frame->len) {
     BLOSC_TRACE_ERROR("Cannot access the trailer out of the frame.");
     return BLOSC2_ERROR_READ_BUFFER;
   }
+  return trailer_offset;
+}
+
+
+int frame_get_vlmetalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
+  int64_t trailer_offset = get_trailer_offset_info(frame, schunk);
+  if (trailer_offset < 0) {
+    return (int) trailer_offset;
+  }
+  int32_t trailer_len = (int32_t) frame->trailer_len;
 
   // Get the trailer
   uint8_t* trailer = NULL;
+  bool needs_free = false;
+  int32_t avail_len = trailer_len;
   if (frame->cframe != NULL) {
     trailer = frame->cframe + trailer_offset;
   } else {
-    int64_t rbytes = 0;
+    trailer = get_prefetched(frame, trailer_offset, trailer_len);
+  }
+  if (trailer == NULL) {
+    needs_free = true;
+    // Frames attached to the super-chunk just read the index of the vlmetalayers (and whatever
+    // fits in FRAME_TRAILER_PREFETCH); the rest is read by frame_load_vlmetalayer() when needed
+    if (schunk->frame == (blosc2_frame*) frame && trailer_len > FRAME_TRAILER_PREFETCH) {
+      avail_len = FRAME_TRAILER_PREFETCH;
+    }
     trailer = malloc(trailer_len);
 
-    blosc2_io_cb *io_cb = blosc2_get_io_cb(frame->schunk->storage->io->id);
+    blosc2_io_cb *io_cb = blosc2_get_io_cb(schunk->storage->io->id);
     if (io_cb == NULL) {
       BLOSC_TRACE_ERROR("Error getting the input/output API");
+      free(trailer);
       return BLOSC2_ERROR_PLUGIN_IO;
     }
 
-    void* fp = NULL;
-    if (frame->sframe) {
-      char* eframe_name = malloc(strlen(frame->urlpath) + strlen("/chunks.b2frame") + 1);
-      sprintf(eframe_name, "%s/chunks.b2frame", frame->urlpath);
-      fp = io_cb->open(eframe_name, "rb", frame->schunk->storage->io->params);
-      if (fp == NULL) {
-        BLOSC_TRACE_ERROR("Error opening file in: %s", eframe_name);
-        free(eframe_name);
-        return BLOSC2_ERROR_FILE_OPEN;
-      }
-      free(eframe_name);
-      io_cb->seek(fp, trailer_offset, SEEK_SET);
+    void* fp = open_trailer(frame, schunk, io_cb, trailer_offset, 0);
+    if (fp == NULL) {
+      free(trailer);
+      return BLOSC2_ERROR_FILE_OPEN;
     }
-    else {
-      fp = io_cb->open(frame->urlpath, "rb", frame->schunk->storage->io->params);
-      if (fp == NULL) {
-        BLOSC_TRACE_ERROR("Error opening file in: %s", frame->urlpath);
-        return BLOSC2_ERROR_FILE_OPEN;
+    int64_t rbytes = io_cb->read(trailer, 1, avail_len, fp);
+    if (rbytes == avail_len && avail_len < trailer_len) {
+      // Make sure that the whole index is there
+      uint16_t idx_size;
+      from_big(&idx_size, trailer + FRAME_TRAILER_VLMETALAYERS + 2, sizeof(idx_size));
+      int32_t idx_len = FRAME_TRAILER_VLMETALAYERS + 1 + idx_size;
+      if (idx_len > avail_len && idx_len <= trailer_len) {
+        rbytes += io_cb->read(trailer + avail_len, 1, idx_len - avail_len, fp);
+        avail_len = idx_len;
       }
-      io_cb->seek(fp, frame->file_offset + trailer_offset, SEEK_SET);
     }
-    if (fp != NULL) {
-      rbytes = io_cb->read(trailer, 1, trailer_len, fp);
-      io_cb->close(fp);
-    }
-    if (rbytes != trailer_len) {
+    io_cb->close(fp);
+    if (rbytes != avail_len) {
       BLOSC_TRACE_ERROR("Cannot access the trailer out of the fileframe.");
       free(trailer);
       return BLOSC2_ERROR_FILE_READ;
     }
   }
 
-  ret = get_vlmeta_from_trailer(frame, schunk, trailer, trailer_len);
+  int ret = get_vlmeta_from_trailer(frame, schunk, trailer, trailer_len, avail_len);
 
-  if (frame->cframe == NULL) {
+  if (needs_free) {
     free(trailer);
   }
 
@@ -1680,6 +2083,73 @@ int frame_get_vlmetalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
 }
 
 
+/* Read the content of a vlmetalayer that was only indexed when the frame was opened */
+int frame_load_vlmetalayer(blosc2_frame_s* frame, blosc2_schunk* schunk, int nvlmetalayer) {
+  blosc2_metalayer* metalayer = schunk->vlmetalayers[nvlmetalayer];
+  if (frame->vlmeta_offsets == NULL || metalayer->content != NULL) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  int32_t offset = frame->vlmeta_offsets[nvlmetalayer];
+  int64_t trailer_offset = get_trailer_offset_info(frame, schunk);
+  if (trailer_offset < 0) {
+    return (int) trailer_offset;
+  }
+  blosc2_io_cb *io_cb = blosc2_get_io_cb(schunk->storage->io->id);
+  if (io_cb == NULL) {
+    BLOSC_TRACE_ERROR("Error getting the input/output API");
+    return BLOSC2_ERROR_PLUGIN_IO;
+  }
+  void* fp = open_trailer(frame, schunk, io_cb, trailer_offset, offset);
+  if (fp == NULL) {
+    return BLOSC2_ERROR_FILE_OPEN;
+  }
+
+  int rc = BLOSC2_ERROR_SUCCESS;
+  uint8_t content_marker[1 + 4];
+  int32_t content_len = 0;
+  uint8_t* content = NULL;
+  if (io_cb->read(content_marker, 1, sizeof(content_marker), fp) != sizeof(content_marker) ||
+      content_marker[0] != 0xc6) {
+    rc = BLOSC2_ERROR_DATA;
+    goto end;
+  }
+  from_big(&content_len, content_marker + 1, sizeof(content_len));
+  if (content_len < 0 || offset + 1 + 4 + (int64_t) content_len > frame->trailer_len) {
+    rc = BLOSC2_ERROR_DATA;
+    goto end;
+  }
+  content = malloc((size_t) content_len);
+  if (io_cb->read(content, 1, content_len, fp) != content_len) {
+    free(content);
+    rc = BLOSC2_ERROR_FILE_READ;
+    goto end;
+  }
+  metalayer->content = content;
+  metalayer->content_len = content_len;
+
+  end:
+  io_cb->close(fp);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Cannot read the vlmetalayer \"%s\" out of the frame.", metalayer->name);
+  }
+  return rc;
+}
+
+
+/* Read all the vlmetalayers that have not been loaded yet */
+int frame_load_vlmetalayers(blosc2_frame_s* frame, blosc2_schunk* schunk) {
+  if (frame->vlmeta_offsets == NULL) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  for (int nvlmetalayer = 0; nvlmetalayer < schunk->nvlmetalayers; nvlmetalayer++) {
+    BLOSC_ERROR(frame_load_vlmetalayer(frame, schunk, nvlmetalayer));
+  }
+  free(frame->vlmeta_offsets);
+  frame->vlmeta_offsets = NULL;
+  return BLOSC2_ERROR_SUCCESS;
+}
+
+
 blosc2_storage* get_new_storage(const blosc2_storage* storage,
                                 const blosc2_cparams* cdefaults,
                                 const blosc2_dparams* ddefaults,
@@ -1731,6 +2201,7 @@ blosc2_schunk* frame_to_schunk(blosc2_frame_s* frame, bool copy, const blosc2_io
   int32_t header_len;
   int64_t frame_len;
   int rc;
+  uint8_t checksum;
   blosc2_schunk* schunk = calloc(1, sizeof(blosc2_schunk));
   schunk->frame = (blosc2_frame*)frame;
   frame->schunk = schunk;
@@ -1739,7 +2210,7 @@ blosc2_schunk* frame_to_schunk(blosc2_frame_s* frame, bool copy, const blosc2_io
                        &schunk->cbytes, &schunk->blocksize,
                        &schunk->chunksize, &schunk->nchunks, &schunk->typesize,
                        &schunk->compcode, &schunk->compcode_meta, &schunk->clevel, schunk->filters,
-                       schunk->filters_meta, &schunk->splitmode, udio);
+                       schunk->filters_meta, &schunk->splitmode, &checksum, udio);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     blosc2_schunk_free(schunk);
@@ -1753,6 +2224,7 @@ blosc2_schunk* frame_to_schunk(blosc2_frame_s* frame, bool copy, const blosc2_io
   // Compression and decompression contexts
   blosc2_cparams *cparams;
   blosc2_schunk_get_cparams(schunk, &cparams);
+  cparams->checksum = checksum;
   schunk->cctx = blosc2_create_cctx(*cparams);
   if (schunk->cctx == NULL) {
     BLOSC_TRACE_ERROR("Error while creating the compression context");
@@ -1854,6 +2326,7 @@ blosc2_schunk* frame_to_schunk(blosc2_frame_s* frame, bool copy, const blosc2_io
       }
       else {
        data_chunk = frame->cframe + header_len + offsets[i];
+       needs_free = false;
       }
       rc = blosc2_cbuffer_sizes(data_chunk, NULL, &chunk_cbytes, NULL);
       if (rc < 0) {
@@ -1963,6 +2436,10 @@ blosc2_schunk* frame_to_schunk(blosc2_frame_s* frame, bool copy, const blosc2_io
     return NULL;
   }
 
+  // The bytes read when opening the frame will be stale as soon as it is modified
+  free(frame->prefetch);
+  frame->prefetch = NULL;
+
   return schunk;
 }
 
@@ -2084,7 +2561,7 @@ int frame_get_chunk(blosc2_frame_s *frame, int64_t nchunk, uint8_t **chunk, bool
   rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                        &blocksize, &chunksize, &nchunks,
                        &typesize, NULL, NULL, NULL, NULL, NULL, NULL,
-                       frame->schunk->storage->io);
+                       NULL, frame->schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return rc;
@@ -2201,7 +2678,7 @@ int frame_get_lazychunk(blosc2_frame_s *frame, int64_t nchunk, uint8_t **chunk,
   int rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                            &blocksize, &chunksize, &nchunks,
                            &typesize, NULL, NULL, NULL, NULL, NULL, NULL,
-                           frame->schunk->storage->io);
+                           NULL, frame->schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return rc;
@@ -2282,6 +2759,12 @@ int frame_get_lazychunk(blosc2_frame_s *frame, int64_t nchunk, uint8_t **chunk,
     int32_t special_type = (header[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
     int memcpyed = header[BLOSC2_CHUNK_FLAGS] & (uint8_t) BLOSC_MEMCPYED;
 
+    int32_t checksums_len = 0;
+    if (special_type == 0 &&
+        (header[BLOSC2_CHUNK_BLOSC2_FLAGS2] & BLOSC2_CHECKSUM_MASK) != BLOSC2_CHECKSUM_NONE) {
+      checksums_len = (int32_t) (nblocks * sizeof(uint32_t));
+    }
+
     int32_t trailer_offset = BLOSC_EXTENDED_HEADER_LENGTH;
     size_t streams_offset = BLOSC_EXTENDED_HEADER_LENGTH;
     if (special_type == 0) {
@@ -2293,6 +2776,7 @@ int frame_get_lazychunk(blosc2_frame_s *frame, int64_t nchunk, uint8_t **chunk,
         streams_offset += nblocks * sizeof(int32_t);
       }
       trailer_len = (int32_t) (sizeof(int32_t) + sizeof(int64_t) + nblocks * sizeof(int32_t));
+      trailer_len += checksums_len;
       lazychunk_cbytes = trailer_offset + trailer_len;
     }
     else if (special_type == BLOSC2_SPECIAL_VALUE) {
@@ -2331,7 +2815,7 @@ int frame_get_lazychunk(blosc2_frame_s *frame, int64_t nchunk, uint8_t **chunk,
     uint8_t* blosc2_flags = *chunk + BLOSC2_CHUNK_BLOSC2_FLAGS;
     *blosc2_flags |= 0x08U;
 
-    // Add the trailer (currently, nchunk + offset + block_csizes)
+    // Add the trailer (currently, nchunk + offset + block_csizes + block checksums)
     if (frame->sframe) {
       *(int32_t*)(*chunk + trailer_offset) = (int32_t)offset;   // offset is nchunk for sframes
       *(int64_t*)(*chunk + trailer_offset + sizeof(int32_t)) = offset;
@@ -2370,13 +2854,29 @@ int frame_get_lazychunk(blosc2_frame_s *frame, int64_t nchunk, uint8_t **chunk,
         block_csizes[idx] = csize_idx[n + 1].val - csize_idx[n].val;
       }
       idx = csize_idx[nblocks - 1].idx;
-      block_csizes[idx] = (int)chunk_cbytes - csize_idx[nblocks - 1].val;
+      block_csizes[idx] = (int)chunk_cbytes - checksums_len - csize_idx[nblocks - 1].val;
       free(csize_idx);
     }
     // Copy the csizes at the end of the trailer
-    void *trailer_csizes = *chunk + lazychunk_cbytes - nblocks * sizeof(int32_t);
+    uint8_t *trailer_csizes = *chunk + trailer_offset + sizeof(int32_t) + sizeof(int64_t);
     memcpy(trailer_csizes, block_csizes, nblocks * sizeof(int32_t));
     free(block_csizes);
+
+    if (checksums_len > 0) {
+      // The block checksums are at the end of the chunk
+      if (frame->sframe) {
+        io_cb->seek(fp, chunk_cbytes - checksums_len, SEEK_SET);
+      }
+      else {
+        io_cb->seek(fp, frame->file_offset + header_len + offset + chunk_cbytes - checksums_len, SEEK_SET);
+      }
+      rbytes = io_cb->read(trailer_csizes + nblocks * sizeof(int32_t), 1, checksums_len, fp);
+      if (rbytes != checksums_len) {
+        BLOSC_TRACE_ERROR("Cannot read the block checksums out of the frame.");
+        rc = BLOSC2_ERROR_FILE_READ;
+        goto end;
+      }
+    }
   } else {
     // The chunk is in memory and just one pointer away
     int64_t chunk_header_offset = header_len + offset;
@@ -2426,7 +2926,7 @@ int64_t frame_fill_special(blosc2_frame_s* frame, int64_t nitems, int special_va
 
   int rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes, &blocksize, NULL,
                            &nchunks, &typesize, NULL, NULL, NULL, NULL, NULL, NULL,
-                           schunk->storage->io);
+                           NULL, schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return BLOSC2_ERROR_DATA;
@@ -2586,7 +3086,7 @@ void* frame_append_chunk(blosc2_frame_s* frame, void* chunk, blosc2_schunk* schu
   int64_t nchunks;
   int rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes, &blocksize, &chunksize,
                            &nchunks, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                           frame->schunk->storage->io);
+                           NULL, frame->schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return NULL;
@@ -2833,7 +3333,7 @@ void* frame_insert_chunk(blosc2_frame_s* frame, int64_t nchunk, void* chunk, blo
   int rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                            &blocksize, &chunksize, &nchunks,
                            NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                           frame->schunk->storage->io);
+                           NULL, frame->schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return NULL;
@@ -3051,7 +3551,7 @@ void* frame_update_chunk(blosc2_frame_s* frame, int64_t nchunk, void* chunk, blo
   int rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                            &blocksize, &chunksize, &nchunks,
                            NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                           frame->schunk->storage->io);
+                           NULL, frame->schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return NULL;
@@ -3304,7 +3804,7 @@ void* frame_delete_chunk(blosc2_frame_s* frame, int64_t nchunk, blosc2_schunk* s
   int64_t nchunks;
   int rc = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                            &blocksize, &chunksize,  &nchunks,
-                           NULL, NULL, NULL, NULL, NULL, NULL, NULL, frame->schunk->storage->io);
+                           NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, frame->schunk->storage->io);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Unable to get meta info from frame.");
     return NULL;
@@ -3472,7 +3972,7 @@ int frame_reorder_offsets(blosc2_frame_s* frame, const int64_t* offsets_order, b
   int ret = get_header_info(frame, &header_len, &frame_len, &nbytes, &cbytes,
                             &blocksize, &chunksize, &nchunks,
                             NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                            frame->schunk->storage->io);
+                            NULL, frame->schunk->storage->io);
   if (ret < 0) {
       BLOSC_TRACE_ERROR("Cannot get the header info for the frame.");
       return ret;
@@ -52,6 +52,18 @@
 #define FRAME_TRAILER_MINLEN (25)  // minimum length for the trailer (msgpack overhead)
 #define FRAME_TRAILER_LEN_OFFSET (22)  // offset to trailer length (counting from the end)
 #define FRAME_TRAILER_VLMETALAYERS (2)
+#define FRAME_STREAMED (0x80U)  // general flag for frames whose sizes are in the footer, not in the header
+
+// Constants for the footer of streamed frames
+#define FRAME_FOOTER_MAGIC 2
+#define FRAME_FOOTER_FRAME_LEN (FRAME_FOOTER_MAGIC + 8 + 1)  // 11
+#define FRAME_FOOTER_NBYTES (FRAME_FOOTER_FRAME_LEN + 8 + 1)  // 20
+#define FRAME_FOOTER_CBYTES (FRAME_FOOTER_NBYTES + 8 + 1)  // 29
+#define FRAME_FOOTER_CHUNKSIZE (FRAME_FOOTER_CBYTES + 8 + 1)  // 38
+#define FRAME_FOOTER_LEN (FRAME_FOOTER_CHUNKSIZE + 4)  // 42
+
+#define FRAME_OPEN_PREFETCH (4 * 1024)  // bytes read from each end of an on-disk frame when opening it
+#define FRAME_TRAILER_PREFETCH (4 * 1024)  // trailer bytes read on open; vlmetalayers beyond are read on demand
 
 
 typedef struct {
@@ -65,8 +77,31 @@ typedef struct {
   bool sframe;              //!< Whether the frame is sparse (true) or not
   blosc2_schunk *schunk;    //!< The schunk associated
   int64_t file_offset;      //!< The offset where the frame starts inside the file
+  bool view;                //!< Whether this is a read-only view of an external cframe (nothing is copied)
+  int32_t *vlmeta_offsets;  //!< Trailer offsets of the vlmetalayer contents not read yet; NULL if all are read
+  uint8_t* prefetch;        //!< The start and the end of an on-disk frame, read when opening it; NULL once open
+  int64_t prefetch_head_len;     //!< The number of bytes from the start of the frame in `prefetch`
+  int64_t prefetch_tail_offset;  //!< The frame offset of the bytes following the head in `prefetch`
+  bool streamed;            //!< Whether the sizes of the frame are in its footer (streamed frames are read-only)
+  int64_t footer_nbytes;    //!< The uncompressed size of a streamed frame
+  int64_t footer_cbytes;    //!< The compressed size of a streamed frame
+  int32_t footer_chunksize; //!< The chunksize of a streamed frame
 } blosc2_frame_s;
 
+struct blosc2_frame_writer_s {
+  blosc2_schunk* schunk;    //!< The super-chunk providing the parameters, metalayers and vlmetalayers
+  blosc2_io_cb* io_cb;      //!< The input/output backend
+  void* fp;                 //!< The stream where the frame is written
+  int32_t header_len;       //!< The length of the frame header
+  int64_t nbytes;           //!< The uncompressed size of the chunks written so far
+  int64_t cbytes;           //!< The compressed size of the chunks written so far
+  int32_t chunksize;        //!< The uncompressed size of the first chunk
+  int32_t last_nbytes;      //!< The uncompressed size of the last chunk
+  int64_t nchunks;          //!< The number of chunks written so far
+  int64_t* offsets;         //!< The offsets of the chunks written so far
+  int64_t offsets_maxlen;   //!< The capacity of `offsets`
+};
+
 
 /*********************************************************************
   Frame struct related functions.
@@ -165,6 +200,8 @@ int frame_decompress_chunk(blosc2_context* dctx, blosc2_frame_s* frame, int64_t
 
 int frame_update_header(blosc2_frame_s* frame, blosc2_schunk* schunk, bool new);
 int frame_update_trailer(blosc2_frame_s* frame, blosc2_schunk* schunk);
+int frame_load_vlmetalayer(blosc2_frame_s* frame, blosc2_schunk* schunk, int nvlmetalayer);
+int frame_load_vlmetalayers(blosc2_frame_s* frame, blosc2_schunk* schunk);
 
 int64_t frame_fill_special(blosc2_frame_s* frame, int64_t nitems, int special_value,
                        int32_t chunksize, blosc2_schunk* schunk);
@@ -37,4 +37,102 @@
  * detected, a negative code is returned instead.
  */
 int schunk_get_slice_nchunks(blosc2_schunk *schunk, int64_t start, int64_t stop, int64_t **chunks_idx);
+
+/**
+ * @brief Check whether a chunk uses the delta filter.
+ *
+ * The blocks of such chunks need the first one as a reference, so they cannot be decoded on
+ * their own.
+ *
+ * @param chunk The chunk (lazy chunks are fine too).
+ *
+ * @return Whether the filter pipeline of @p chunk contains BLOSC_DELTA.
+ */
+bool schunk_chunk_uses_delta(const uint8_t *chunk);
+
+/**
+ * @brief Check whether a regular chunk is already encoded as some cparams ask.
+ *
+ * The header of the chunk does not record the clevel, nor how an automatic splitmode was
+ * decided, so the caller has to trust the source of the chunk for those.
+ *
+ * @param chunk The (non-special) chunk.
+ * @param cparams The compression parameters.
+ *
+ * @return Whether @p chunk can be stored as it is where @p cparams are used.
+ */
+bool schunk_chunk_matches_cparams(const uint8_t *chunk, const blosc2_cparams *cparams);
+
+/**
+ * @brief Set the blocks of a chunk that the next decompression of @p dctx skips.
+ *
+ * Same as blosc2_set_maskout(), but the first block is always decoded for chunks using the
+ * delta filter, as the rest of them are decoded against it. @p maskout is left untouched, so
+ * the caller can still tell the blocks it asked for.
+ *
+ * @param dctx The decompression context.
+ * @param chunk The chunk to be decompressed (lazy chunks are fine too).
+ * @param maskout The blocks to skip.
+ * @param nblocks The number of blocks in @p maskout.
+ *
+ * @return 0 if succeeds. Else a negative code is returned.
+ */
+int schunk_set_chunk_maskout(blosc2_context *dctx, const uint8_t *chunk, bool *maskout, int32_t nblocks);
+
+/**
+ * @brief Check whether the blocks of a chunk can be recompressed independently.
+ *
+ * This is not the case for special, memcpyed, lazy or dict-compressed chunks, chunks using the
+ * delta filter or super-chunks with a prefilter.
+ *
+ * @param schunk The super-chunk.
+ * @param chunk The (non-lazy) chunk.
+ * @param cbytes The compressed size of @p chunk.
+ *
+ * @return Whether schunk_update_chunk_blocks() can reuse the untouched blocks of @p chunk.
+ */
+bool schunk_chunk_blocks_updatable(blosc2_schunk *schunk, const uint8_t *chunk, int32_t cbytes);
+
+/**
+ * @brief Build a new version of a chunk recompressing only some of its blocks.
+ *
+ * Same as schunk_update_chunk_blocks(), but using the given contexts and returning the new
+ * chunk instead of updating the super-chunk, so that it can run in parallel for different chunks.
+ *
+ * @param schunk The super-chunk.
+ * @param cctx The compression context (its parameters must match the ones of @p schunk).
+ * @param dctx The decompression context.
+ * @param nchunk The chunk to update.
+ * @param chunk The current (non-lazy) contents of the chunk.
+ * @param cbytes The compressed size of @p chunk.
+ * @param data A buffer of the uncompressed chunk size with the new contents of the touched blocks.
+ * @param touched The blocks that have been modified.
+ * @param new_chunk The address of the new chunk (output), to be freed by the caller.
+ *
+ * @return The compressed size of @p new_chunk. If some problem is
+ * detected, a negative code is returned instead.
+ */
+int32_t schunk_build_chunk_blocks(blosc2_schunk *schunk, blosc2_context *cctx, blosc2_context *dctx,
+                                  int64_t nchunk, const uint8_t *chunk, int32_t cbytes, uint8_t *data,
+                                  const bool *touched, uint8_t **new_chunk);
+
+/**
+ * @brief Update a chunk recompressing only some of its blocks.
+ *
+ * The compressed streams of the blocks not flagged in @p touched are copied verbatim from
+ * @p chunk. If that is not possible, the remaining blocks are decompressed into @p data and
+ * the whole chunk is recompressed.
+ *
+ * @param schunk The super-chunk.
+ * @param nchunk The chunk to update.
+ * @param chunk The current (non-lazy) contents of the chunk.
+ * @param cbytes The compressed size of @p chunk.
+ * @param data A buffer of the uncompressed chunk size with the new contents of the touched blocks.
+ * @param touched The blocks that have been modified.
+ *
+ * @return The number of chunks in the super-chunk. If some problem is
+ * detected, a negative code is returned instead.
+ */
+int64_t schunk_update_chunk_blocks(blosc2_schunk *schunk, int64_t nchunk, const uint8_t *chunk,
+                                   int32_t cbytes, uint8_t *data, const bool *touched);
 #endif /* BLOSC_SCHUNK_PRIVATE_H */
@@ -8,7 +8,12 @@
   See LICENSE.txt for details about copyright and rights to use.
 **********************************************************************/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE  /* for copy_file_range() */
+#endif
+
 #include "frame.h"
+#include "schunk-private.h"
 #include "stune.h"
 #include "blosc-private.h"
 #include "blosc2/tuners-registry.h"
@@ -23,6 +28,17 @@
 
 #include <sys/stat.h>
 
+#if defined(USING_CMAKE)
+  #include "config.h"
+#endif /*  USING_CMAKE */
+#if defined(HAVE_COPY_FILE_RANGE) || defined(HAVE_SENDFILE)
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+#if defined(HAVE_SENDFILE)
+  #include <sys/sendfile.h>
+#endif
+
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -35,6 +51,29 @@
 #endif
 
 
+/* Check that the super-chunk can be modified and get it ready for that.
+ * Views of external frame buffers and streamed frames cannot be modified, and the vlmetalayers
+ * that were not read when opening the frame must be loaded before its trailer is rewritten. */
+static int prepare_write(blosc2_schunk *schunk) {
+  blosc2_frame_s *frame = (blosc2_frame_s *) schunk->frame;
+  if (frame == NULL) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+  if (frame->view || frame->streamed) {
+    return BLOSC2_ERROR_READ_ONLY;
+  }
+  return frame_load_vlmetalayers(frame, schunk);
+}
+
+
+/* Whether the super-chunk is backed by a streamed frame (whose bytes cannot be copied verbatim
+ * into a regular frame, as its sizes are in the footer) */
+static bool is_streamed(blosc2_schunk *schunk) {
+  blosc2_frame_s *frame = (blosc2_frame_s *) schunk->frame;
+  return frame != NULL && frame->streamed;
+}
+
+
 /* Get the cparams associated with a super-chunk */
 int blosc2_schunk_get_cparams(blosc2_schunk *schunk, blosc2_cparams **cparams) {
   *cparams = calloc(1, sizeof(blosc2_cparams));
@@ -54,6 +93,7 @@ int blosc2_schunk_get_cparams(blosc2_schunk *schunk, blosc2_cparams **cparams) {
   }
   else {
     (*cparams)->nthreads = (int16_t)schunk->cctx->nthreads;
+    (*cparams)->checksum = schunk->cctx->checksum;
   }
   return 0;
 }
@@ -197,6 +237,401 @@ blosc2_schunk* blosc2_schunk_new(blosc2_storage *storage) {
 }
 
 
+/* Copy the metalayers of `schunk` into `new_schunk` */
+static int copy_metalayers(blosc2_schunk *schunk, blosc2_schunk *new_schunk) {
+  for (int nmeta = 0; nmeta < schunk->nmetalayers; ++nmeta) {
+    blosc2_metalayer *meta = schunk->metalayers[nmeta];
+    if (blosc2_meta_add(new_schunk, meta->name, meta->content, meta->content_len) < 0) {
+      BLOSC_TRACE_ERROR("Can not add %s `metalayer`.", meta->name);
+      return BLOSC2_ERROR_FAILURE;
+    }
+  }
+  return 0;
+}
+
+
+/* Copy the variable-length metalayers of `schunk` into `new_schunk` */
+static int copy_vlmetalayers(blosc2_schunk *schunk, blosc2_schunk *new_schunk) {
+  for (int nmeta = 0; nmeta < schunk->nvlmetalayers; ++nmeta) {
+    uint8_t *content;
+    int32_t content_len;
+    char* name = schunk->vlmetalayers[nmeta]->name;
+    if (blosc2_vlmeta_get(schunk, name, &content, &content_len) < 0) {
+      BLOSC_TRACE_ERROR("Can not get %s `vlmetalayer`.", name);
+      return BLOSC2_ERROR_FAILURE;
+    }
+    if (blosc2_vlmeta_add(new_schunk, name, content, content_len, NULL) < 0) {
+      BLOSC_TRACE_ERROR("Can not add %s `vlmetalayer`.", name);
+      free(content);
+      return BLOSC2_ERROR_FAILURE;
+    }
+    free(content);
+  }
+  return 0;
+}
+
+
+/* A transcoded chunk waiting to be appended to the new super-chunk */
+typedef struct {
+  uint8_t *chunk;
+  int32_t cbytes;          // or a negative error code
+  bool ready;
+} recompress_slot;
+
+typedef struct {
+  blosc2_schunk *schunk;
+  blosc2_schunk *new_schunk;
+  blosc2_cparams cparams;  // target params for the worker contexts (nthreads == 1)
+  blosc2_dparams dparams;
+  bool same_codec;         // source and target share clevel (and automatic splitmodes)
+  bool passthrough_all;    // source and target share all the cparams; just move the chunks
+  int nslots;
+  recompress_slot *slots;  // chunk i goes to slots[i % nslots]
+  int64_t nchunks;
+  int64_t next;            // next chunk to be fetched by a worker
+  int64_t written;         // chunks already appended to the new super-chunk
+  int error;
+  pthread_mutex_t mutex;
+  pthread_cond_t cv;
+} recompress_job;
+
+
+/* The codec and its meta in the extended header of a chunk */
+#define CHUNK_COMPCODE (BLOSC2_CHUNK_FILTER_CODES + BLOSC2_MAX_FILTERS)
+#define CHUNK_COMPCODE_META (CHUNK_COMPCODE + 1)
+
+/* The format that the flags of a chunk header record for a codec */
+static int compcode_to_compformat(int compcode) {
+  switch (compcode) {
+    case BLOSC_BLOSCLZ: return BLOSC_BLOSCLZ_FORMAT;
+    case BLOSC_LZ4:     return BLOSC_LZ4_FORMAT;
+    case BLOSC_LZ4HC:   return BLOSC_LZ4HC_FORMAT;
+    case BLOSC_ZLIB:    return BLOSC_ZLIB_FORMAT;
+    case BLOSC_ZSTD:    return BLOSC_ZSTD_FORMAT;
+    default:            return BLOSC_UDCODEC_FORMAT;
+  }
+}
+
+/* Whether the header of a regular chunk says it is already encoded as `cparams` asks
+ * (but for the clevel, which is not recorded) */
+bool schunk_chunk_matches_cparams(const uint8_t *chunk, const blosc2_cparams *cparams) {
+  if (chunk[BLOSC2_CHUNK_TYPESIZE] != cparams->typesize) {
+    return false;
+  }
+  // Super-chunks may hold chunks compressed with other codecs than their own
+  if ((chunk[BLOSC2_CHUNK_FLAGS] >> 5) != compcode_to_compformat(cparams->compcode) ||
+      chunk[CHUNK_COMPCODE] != cparams->compcode ||
+      chunk[CHUNK_COMPCODE_META] != cparams->compcode_meta) {
+    return false;
+  }
+  bool split = !(chunk[BLOSC2_CHUNK_FLAGS] & 0x10);
+  if ((cparams->splitmode == BLOSC_ALWAYS_SPLIT && !split) ||
+      (cparams->splitmode == BLOSC_NEVER_SPLIT && split)) {
+    return false;
+  }
+  if (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] & (BLOSC2_USEDICT | 0x08 | BLOSC2_INSTR_CODEC)) {
+    // Dictionaries, lazy chunks and instrumented codecs are always transcoded
+    return false;
+  }
+  if (cparams->blocksize != 0 && sw32_(chunk + BLOSC2_CHUNK_BLOCKSIZE) != cparams->blocksize) {
+    return false;
+  }
+  if ((chunk[BLOSC2_CHUNK_BLOSC2_FLAGS2] & BLOSC2_CHECKSUM_MASK) != cparams->checksum) {
+    return false;
+  }
+  for (int i = 0; i < BLOSC2_MAX_FILTERS; ++i) {
+    if (chunk[BLOSC2_CHUNK_FILTER_CODES + i] != cparams->filters[i] ||
+        chunk[BLOSC2_CHUNK_FILTER_META + i] != cparams->filters_meta[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* Bring a chunk of the source to the target encoding.  The result is a new allocation,
+ * except for chunks passed through when `needs_free` is true: those are handed over as is. */
+static int32_t recompress_chunk(recompress_job *job, blosc2_context *cctx, blosc2_context *dctx,
+                                uint8_t *chunk, int32_t cbytes, bool needs_free, uint8_t **buffer,
+                                int32_t *buffer_size, uint8_t **dest) {
+  int32_t nbytes;
+  int rc = blosc2_cbuffer_sizes(chunk, &nbytes, NULL, NULL);
+  if (rc < 0) {
+    return rc;
+  }
+  int special_value = (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+  bool passthrough;
+  if (job->passthrough_all && (special_value != 0 ||
+      (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS2] & BLOSC2_CHECKSUM_MASK) == job->cparams.checksum)) {
+    // A super-chunk may hold chunks with another kind of checksums (e.g. inserted ones)
+    passthrough = true;
+  }
+  else if (special_value != 0) {
+    // Special chunks carry no data; they only need the right typesize
+    passthrough = chunk[BLOSC2_CHUNK_TYPESIZE] == job->cparams.typesize;
+  }
+  else {
+    passthrough = job->same_codec && schunk_chunk_matches_cparams(chunk, &job->cparams);
+  }
+  if (passthrough) {
+    if (needs_free) {
+      *dest = chunk;
+      return cbytes;
+    }
+    *dest = malloc(cbytes);
+    BLOSC_ERROR_NULL(*dest, BLOSC2_ERROR_MEMORY_ALLOC);
+    memcpy(*dest, chunk, cbytes);
+    return cbytes;
+  }
+
+  if (nbytes > *buffer_size) {
+    free(*buffer);
+    *buffer = malloc(nbytes);
+    BLOSC_ERROR_NULL(*buffer, BLOSC2_ERROR_MEMORY_ALLOC);
+    *buffer_size = nbytes;
+  }
+  rc = blosc2_decompress_ctx(dctx, chunk, cbytes, *buffer, nbytes);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Cannot decompress the chunk.");
+    return rc;
+  }
+  *dest = malloc(nbytes + BLOSC2_MAX_OVERHEAD);
+  BLOSC_ERROR_NULL(*dest, BLOSC2_ERROR_MEMORY_ALLOC);
+  rc = blosc2_compress_ctx(cctx, *buffer, nbytes, *dest, nbytes + BLOSC2_MAX_OVERHEAD);
+  if (rc <= 0) {
+    BLOSC_TRACE_ERROR("Cannot compress the chunk.");
+    free(*dest);
+    *dest = NULL;
+    return rc < 0 ? rc : BLOSC2_ERROR_FAILURE;
+  }
+  uint8_t *shrunk = realloc(*dest, rc);
+  if (shrunk != NULL) {
+    *dest = shrunk;
+  }
+  return rc;
+}
+
+
+static void *recompress_worker(void *arg) {
+  recompress_job *job = (recompress_job *) arg;
+  blosc2_context *cctx = blosc2_create_cctx(job->cparams);
+  blosc2_context *dctx = blosc2_create_dctx(job->dparams);
+  uint8_t *buffer = NULL;
+  int32_t buffer_size = 0;
+
+  pthread_mutex_lock(&job->mutex);
+  if (cctx == NULL || dctx == NULL) {
+    job->error = BLOSC2_ERROR_FAILURE;
+    pthread_cond_broadcast(&job->cv);
+  }
+  while (true) {
+    // Never get more than nslots chunks ahead of the writer
+    while (job->error == 0 && job->next < job->nchunks &&
+           job->next >= job->written + job->nslots) {
+      pthread_cond_wait(&job->cv, &job->mutex);
+    }
+    if (job->error != 0 || job->next >= job->nchunks) {
+      break;
+    }
+    int64_t nchunk = job->next++;
+    // Fetching goes through the frame layer, which is not reentrant
+    uint8_t *chunk;
+    bool needs_free;
+    int32_t cbytes = blosc2_schunk_get_chunk(job->schunk, nchunk, &chunk, &needs_free);
+    pthread_mutex_unlock(&job->mutex);
+
+    uint8_t *dest = NULL;
+    int32_t rc = cbytes;
+    if (cbytes < 0) {
+      BLOSC_TRACE_ERROR("Cannot get chunk ('%" PRId64 "').", nchunk);
+    }
+    else {
+      rc = recompress_chunk(job, cctx, dctx, chunk, cbytes, needs_free, &buffer, &buffer_size, &dest);
+      if (needs_free && dest != chunk) {
+        free(chunk);
+      }
+    }
+
+    pthread_mutex_lock(&job->mutex);
+    recompress_slot *slot = &job->slots[nchunk % job->nslots];
+    slot->chunk = dest;
+    slot->cbytes = rc;
+    slot->ready = true;
+    if (rc < 0 && job->error == 0) {
+      job->error = rc;
+    }
+    pthread_cond_broadcast(&job->cv);
+  }
+  pthread_mutex_unlock(&job->mutex);
+
+  free(buffer);
+  if (cctx != NULL) {
+    blosc2_free_ctx(cctx);
+  }
+  if (dctx != NULL) {
+    blosc2_free_ctx(dctx);
+  }
+  return NULL;
+}
+
+
+/* Append the chunks of `job` in order, as soon as the workers transcode them */
+static int recompress_parallel(recompress_job *job, int nworkers) {
+  int rc = 0;
+  pthread_t *threads = malloc(nworkers * sizeof(pthread_t));
+  BLOSC_ERROR_NULL(threads, BLOSC2_ERROR_MEMORY_ALLOC);
+  int nstarted = 0;
+  for (; nstarted < nworkers; nstarted++) {
+    if (pthread_create(&threads[nstarted], NULL, recompress_worker, job) != 0) {
+      BLOSC_TRACE_ERROR("Cannot create a recompression thread.");
+      rc = BLOSC2_ERROR_THREAD_CREATE;
+      break;
+    }
+  }
+
+  for (int64_t nchunk = 0; nstarted > 0 && nchunk < job->nchunks; nchunk++) {
+    recompress_slot *slot = &job->slots[nchunk % job->nslots];
+    pthread_mutex_lock(&job->mutex);
+    while (!slot->ready && job->error == 0 && rc == 0) {
+      pthread_cond_wait(&job->cv, &job->mutex);
+    }
+    bool ready = slot->ready;
+    if (job->error != 0) {
+      rc = job->error;
+    }
+    pthread_mutex_unlock(&job->mutex);
+    if (!ready || rc < 0) {
+      break;
+    }
+
+    // The new super-chunk takes ownership of the transcoded chunk
+    uint8_t *chunk = slot->chunk;
+    slot->chunk = NULL;
+    slot->ready = false;
+    if (blosc2_schunk_append_chunk(job->new_schunk, chunk, false) < 0) {
+      BLOSC_TRACE_ERROR("Cannot append chunk ('%" PRId64 "') to the new super-chunk.", nchunk);
+      rc = BLOSC2_ERROR_CHUNK_APPEND;
+    }
+
+    pthread_mutex_lock(&job->mutex);
+    job->written = nchunk + 1;
+    if (rc < 0) {
+      job->error = rc;
+    }
+    pthread_cond_broadcast(&job->cv);
+    pthread_mutex_unlock(&job->mutex);
+    if (rc < 0) {
+      break;
+    }
+  }
+
+  pthread_mutex_lock(&job->mutex);
+  if (rc < 0 && job->error == 0) {
+    job->error = rc;
+  }
+  pthread_cond_broadcast(&job->cv);
+  pthread_mutex_unlock(&job->mutex);
+  for (int i = 0; i < nstarted; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+
+  return rc;
+}
+
+
+/* Same as above, but in the calling thread (needed when the target has a prefilter,
+ * which may look at the state of the new super-chunk) */
+static int recompress_serial(recompress_job *job) {
+  int rc = 0;
+  uint8_t *buffer = NULL;
+  int32_t buffer_size = 0;
+  for (int64_t nchunk = 0; nchunk < job->nchunks; nchunk++) {
+    uint8_t *chunk;
+    bool needs_free;
+    int32_t cbytes = blosc2_schunk_get_chunk(job->schunk, nchunk, &chunk, &needs_free);
+    if (cbytes < 0) {
+      BLOSC_TRACE_ERROR("Cannot get chunk ('%" PRId64 "').", nchunk);
+      rc = cbytes;
+      break;
+    }
+    uint8_t *dest = NULL;
+    rc = recompress_chunk(job, job->new_schunk->cctx, job->schunk->dctx, chunk, cbytes,
+                          needs_free, &buffer, &buffer_size, &dest);
+    if (needs_free && dest != chunk) {
+      free(chunk);
+    }
+    if (rc < 0) {
+      break;
+    }
+    if (blosc2_schunk_append_chunk(job->new_schunk, dest, false) < 0) {
+      BLOSC_TRACE_ERROR("Cannot append chunk ('%" PRId64 "') to the new super-chunk.", nchunk);
+      rc = BLOSC2_ERROR_CHUNK_APPEND;
+      break;
+    }
+    rc = 0;
+  }
+  free(buffer);
+
+  return rc;
+}
+
+
+/* Move all the chunks of `schunk` to the end of `new_schunk`, transcoding them to the
+ * cparams of the latter when needed.  Fetching, transcoding and appending are pipelined
+ * over `nthreads` workers so that reads and writes overlap. */
+static int transcode_chunks(blosc2_schunk *schunk, blosc2_schunk *new_schunk, bool passthrough_all,
+                            int nthreads) {
+  recompress_job job = {0};
+  job.schunk = schunk;
+  job.new_schunk = new_schunk;
+  job.nchunks = schunk->nchunks;
+  job.passthrough_all = passthrough_all;
+  blosc2_ctx_get_cparams(new_schunk->cctx, &job.cparams);
+  blosc2_ctx_get_dparams(schunk->dctx, &job.dparams);
+  job.cparams.nthreads = 1;
+  job.dparams.nthreads = 1;
+  // Chunk headers do not record the clevel, nor how an automatic splitmode was decided, so
+  // trust the source parameters for those
+  blosc2_context *src = schunk->cctx;
+  bool auto_split = job.cparams.splitmode != BLOSC_ALWAYS_SPLIT &&
+                    job.cparams.splitmode != BLOSC_NEVER_SPLIT;
+  job.same_codec = src->clevel == job.cparams.clevel &&
+                   (!auto_split || src->splitmode == job.cparams.splitmode) &&
+                   !job.cparams.use_dict &&
+                   src->prefilter == NULL && schunk->dctx->postfilter == NULL &&
+                   job.cparams.prefilter == NULL;
+  if (job.cparams.blocksize == 0 && src->blocksize != 0) {
+    // Automatic blocksizes only match automatic ones
+    job.same_codec = false;
+  }
+
+  int rc;
+  int nworkers = nthreads > 1 ? nthreads : 1;
+  if (job.cparams.prefilter != NULL || job.nchunks == 0) {
+    rc = recompress_serial(&job);
+  }
+  else {
+    // Every worker works on one chunk and at most nslots transcoded chunks wait to be
+    // written, so the memory footprint does not depend on the size of the super-chunk
+    job.nslots = 2 * nworkers;
+    job.slots = calloc(job.nslots, sizeof(recompress_slot));
+    BLOSC_ERROR_NULL(job.slots, BLOSC2_ERROR_MEMORY_ALLOC);
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.cv, NULL);
+    rc = recompress_parallel(&job, nworkers);
+    pthread_cond_destroy(&job.cv);
+    pthread_mutex_destroy(&job.mutex);
+    for (int i = 0; i < job.nslots; i++) {
+      free(job.slots[i].chunk);
+    }
+    free(job.slots);
+  }
+
+  return rc;
+}
+
+
 /* Create a copy of a super-chunk */
 blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_storage *storage) {
   if (schunk == NULL) {
@@ -206,6 +641,7 @@ blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_storage *storage
 
   // Check if cparams are equals
   bool cparams_equal = true;
+  int nthreads = storage->cparams != NULL ? storage->cparams->nthreads : 1;
   blosc2_cparams cparams = {0};
   if (storage->cparams == NULL) {
     // When cparams are not specified, just use the same of schunk
@@ -216,9 +652,11 @@ blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_storage *storage
     cparams.splitmode = schunk->cctx->splitmode;
     cparams.use_dict = schunk->cctx->use_dict;
     cparams.blocksize = schunk->cctx->blocksize;
+    cparams.checksum = schunk->cctx->checksum;
     memcpy(cparams.filters, schunk->cctx->filters, BLOSC2_MAX_FILTERS);
     memcpy(cparams.filters_meta, schunk->cctx->filters_meta, BLOSC2_MAX_FILTERS);
     storage->cparams = &cparams;
+    nthreads = schunk->cctx->nthreads;
   }
   else {
     cparams = *storage->cparams;
@@ -235,6 +673,7 @@ blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_storage *storage
       cparams.compcode != schunk->cctx->compcode ||
       cparams.use_dict != schunk->cctx->use_dict ||
       cparams.blocksize != schunk->cctx->blocksize ||
+      cparams.checksum != schunk->cctx->checksum ||
       // In case of prefilters or postfilters, force their execution.
       schunk->cctx->prefilter != NULL ||
       schunk->dctx->postfilter != NULL) {
@@ -254,58 +693,46 @@ blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_storage *storage
     return NULL;
   }
 
-  // Copy metalayers
-  for (int nmeta = 0; nmeta < schunk->nmetalayers; ++nmeta) {
-    blosc2_metalayer *meta = schunk->metalayers[nmeta];
-    if (blosc2_meta_add(new_schunk, meta->name, meta->content, meta->content_len) < 0) {
-      BLOSC_TRACE_ERROR("Can not add %s `metalayer`.", meta->name);
-      return NULL;
-    }
+  if (copy_metalayers(schunk, new_schunk) < 0) {
+    return NULL;
   }
 
   // Copy chunks
-  if (cparams_equal) {
-    for (int nchunk = 0; nchunk < schunk->nchunks; ++nchunk) {
-      uint8_t *chunk;
-      bool needs_free;
-      if (blosc2_schunk_get_chunk(schunk, nchunk, &chunk, &needs_free) < 0) {
-        BLOSC_TRACE_ERROR("Can not get the `chunk` %d.", nchunk);
-        return NULL;
-      }
-      if (blosc2_schunk_append_chunk(new_schunk, chunk, !needs_free) < 0) {
-        BLOSC_TRACE_ERROR("Can not append the `chunk` into super-chunk.");
-        return NULL;
-      }
-    }
-  } else {
-    int32_t chunksize = schunk->chunksize == -1 ? 0 : schunk->chunksize;
-    uint8_t *buffer = malloc(chunksize);
-    for (int nchunk = 0; nchunk < schunk->nchunks; ++nchunk) {
-      if (blosc2_schunk_decompress_chunk(schunk, nchunk, buffer, schunk->chunksize) < 0) {
-        BLOSC_TRACE_ERROR("Can not decompress the `chunk` %d.", nchunk);
-        return NULL;
-      }
-      if (blosc2_schunk_append_buffer(new_schunk, buffer, schunk->chunksize) < 0) {
-        BLOSC_TRACE_ERROR("Can not append the `buffer` into super-chunk.");
-        return NULL;
-      }
-    }
-    free(buffer);
+  if (transcode_chunks(schunk, new_schunk, cparams_equal, nthreads) < 0) {
+    BLOSC_TRACE_ERROR("Can not copy the chunks into the new super-chunk.");
+    blosc2_schunk_free(new_schunk);
+    return NULL;
   }
 
-  // Copy vlmetalayers
-  for (int nmeta = 0; nmeta < schunk->nvlmetalayers; ++nmeta) {
-    uint8_t *content;
-    int32_t content_len;
-    char* name = schunk->vlmetalayers[nmeta]->name;
-    if (blosc2_vlmeta_get(schunk, name, &content, &content_len) < 0) {
-      BLOSC_TRACE_ERROR("Can not get %s `vlmetalayer`.", name);
-    }
-    if (blosc2_vlmeta_add(new_schunk, name, content, content_len, NULL) < 0) {
-      BLOSC_TRACE_ERROR("Can not add %s `vlmetalayer`.", name);
-      return NULL;
-    }
-    free(content);
+  if (copy_vlmetalayers(schunk, new_schunk) < 0) {
+    return NULL;
+  }
+  return new_schunk;
+}
+
+
+/* Create a copy of a super-chunk with different compression parameters */
+blosc2_schunk* blosc2_schunk_recompress(blosc2_schunk *schunk, blosc2_storage *storage) {
+  if (schunk == NULL || storage == NULL || storage->cparams == NULL) {
+    BLOSC_TRACE_ERROR("Recompression needs a super-chunk and the target `cparams`.");
+    return NULL;
+  }
+
+  blosc2_schunk *new_schunk = blosc2_schunk_new(storage);
+  if (new_schunk == NULL) {
+    BLOSC_TRACE_ERROR("Can not create a new schunk");
+    return NULL;
+  }
+  if (copy_metalayers(schunk, new_schunk) < 0) {
+    blosc2_schunk_free(new_schunk);
+    return NULL;
+  }
+
+  int rc = transcode_chunks(schunk, new_schunk, false, new_schunk->cctx->nthreads);
+  if (rc < 0 || copy_vlmetalayers(schunk, new_schunk) < 0) {
+    BLOSC_TRACE_ERROR("Cannot recompress the super-chunk.");
+    blosc2_schunk_free(new_schunk);
+    return NULL;
   }
   return new_schunk;
 }
@@ -366,7 +793,7 @@ int64_t blosc2_schunk_to_buffer(blosc2_schunk* schunk, uint8_t** dest, bool* nee
   *dest = NULL;
   *needs_free = false;
 
-  if ((schunk->storage->contiguous == true) && (schunk->storage->urlpath == NULL)) {
+  if ((schunk->storage->contiguous == true) && (schunk->storage->urlpath == NULL) && !is_streamed(schunk)) {
     frame =  (blosc2_frame_s*)(schunk->frame);
     *dest = frame->cframe;
     cframe_len = frame->len;
@@ -393,6 +820,90 @@ int64_t blosc2_schunk_to_buffer(blosc2_schunk* schunk, uint8_t** dest, bool* nee
 }
 
 
+/* Copy `len` bytes of the local file `src_path`, starting at `offset`, to `dst_path`.
+ * When the platform allows it, the kernel does the copy without going through user space. */
+static int64_t copy_local_file(const char *src_path, int64_t offset, int64_t len, const char *dst_path) {
+#if defined(HAVE_COPY_FILE_RANGE) || defined(HAVE_SENDFILE)
+  int fd_in = open(src_path, O_RDONLY);
+  if (fd_in < 0) {
+    BLOSC_TRACE_ERROR("Cannot open file %s.", src_path);
+    return BLOSC2_ERROR_FILE_OPEN;
+  }
+  int fd_out = open(dst_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd_out < 0) {
+    BLOSC_TRACE_ERROR("Cannot open file %s.", dst_path);
+    close(fd_in);
+    return BLOSC2_ERROR_FILE_OPEN;
+  }
+  off_t off_in = (off_t) offset;
+  int64_t copied = 0;
+#if defined(HAVE_COPY_FILE_RANGE)
+  while (copied < len) {
+    // This fails when the files are in different filesystems on older kernels
+    ssize_t n = copy_file_range(fd_in, &off_in, fd_out, NULL, (size_t) (len - copied), 0);
+    if (n <= 0) {
+      break;
+    }
+    copied += n;
+  }
+#endif
+#if defined(HAVE_SENDFILE)
+  while (copied < len) {
+    ssize_t n = sendfile(fd_out, fd_in, &off_in, (size_t) (len - copied));
+    if (n <= 0) {
+      break;
+    }
+    copied += n;
+  }
+#endif
+  close(fd_in);
+  if (close(fd_out) == 0 && copied == len) {
+    return len;
+  }
+  // Start over with a plain copy
+#endif
+
+  blosc2_io_cb *io_cb = blosc2_get_io_cb(BLOSC2_IO_FILESYSTEM);
+  if (io_cb == NULL) {
+    BLOSC_TRACE_ERROR("Error getting the input/output API");
+    return BLOSC2_ERROR_PLUGIN_IO;
+  }
+  void *fp_in = io_cb->open(src_path, "rb", NULL);
+  if (fp_in == NULL) {
+    BLOSC_TRACE_ERROR("Cannot open file %s.", src_path);
+    return BLOSC2_ERROR_FILE_OPEN;
+  }
+  void *fp_out = io_cb->open(dst_path, "wb", NULL);
+  if (fp_out == NULL) {
+    BLOSC_TRACE_ERROR("Cannot open file %s.", dst_path);
+    io_cb->close(fp_in);
+    return BLOSC2_ERROR_FILE_OPEN;
+  }
+  int64_t rc = len;
+  int64_t bufsize = len < (1 << 22) ? len : (1 << 22);
+  uint8_t *buffer = malloc(bufsize > 0 ? bufsize : 1);
+  io_cb->seek(fp_in, offset, SEEK_SET);
+  for (int64_t done = 0; done < len; done += bufsize) {
+    int64_t nbytes = len - done < bufsize ? len - done : bufsize;
+    if (io_cb->read(buffer, 1, nbytes, fp_in) != nbytes) {
+      BLOSC_TRACE_ERROR("Cannot read from file %s.", src_path);
+      rc = BLOSC2_ERROR_FILE_READ;
+      break;
+    }
+    if (io_cb->write(buffer, 1, nbytes, fp_out) != nbytes) {
+      BLOSC_TRACE_ERROR("Cannot write to file %s.", dst_path);
+      rc = BLOSC2_ERROR_FILE_WRITE;
+      break;
+    }
+  }
+  free(buffer);
+  io_cb->close(fp_in);
+  io_cb->close(fp_out);
+
+  return rc;
+}
+
+
 /* Write an in-memory frame out to a file. */
 int64_t frame_to_file(blosc2_frame_s* frame, const char* urlpath) {
   blosc2_io_cb *io_cb = blosc2_get_io_cb(frame->schunk->storage->io->id);
@@ -430,15 +941,45 @@ int64_t append_frame_to_file(blosc2_frame_s* frame, const char* urlpath) {
 }
 
 
+/* Whether `path1` and `path2` name the same file, even through different paths or links. */
+static bool same_local_file(const char *path1, const char *path2) {
+  if (strcmp(path1, path2) == 0) {
+    return true;
+  }
+#if defined(_WIN32)
+  // There are no inode numbers here, so compare the absolute paths
+  char fullpath1[_MAX_PATH];
+  char fullpath2[_MAX_PATH];
+  if (_fullpath(fullpath1, path1, _MAX_PATH) != NULL && _fullpath(fullpath2, path2, _MAX_PATH) != NULL) {
+    return _stricmp(fullpath1, fullpath2) == 0;
+  }
+#else
+  struct stat stat1;
+  struct stat stat2;
+  if (stat(path1, &stat1) == 0 && stat(path2, &stat2) == 0) {
+    return stat1.st_dev == stat2.st_dev && stat1.st_ino == stat2.st_ino;
+  }
+#endif
+  return false;
+}
+
+
 /* Write super-chunk out to a file. */
 int64_t blosc2_schunk_to_file(blosc2_schunk* schunk, const char* urlpath) {
   if (urlpath == NULL) {
     BLOSC_TRACE_ERROR("urlpath cannot be NULL");
     return BLOSC2_ERROR_INVALID_PARAM;
   }
+  // Opening the destination would truncate the source before it is read
+  blosc2_frame_s* src_frame = (blosc2_frame_s*)(schunk->frame);
+  if (src_frame != NULL && src_frame->urlpath != NULL && schunk->storage->io->id == BLOSC2_IO_FILESYSTEM &&
+      same_local_file(src_frame->urlpath, urlpath)) {
+    BLOSC_TRACE_ERROR("Cannot write a super-chunk onto its own file %s.", urlpath);
+    return BLOSC2_ERROR_INVALID_PARAM;
+  }
 
   // Accelerated path for in-memory frames
-  if (schunk->storage->contiguous && schunk->storage->urlpath == NULL) {
+  if (schunk->storage->contiguous && schunk->storage->urlpath == NULL && !is_streamed(schunk)) {
     int64_t len = frame_to_file((blosc2_frame_s*)(schunk->frame), urlpath);
     if (len <= 0) {
       BLOSC_TRACE_ERROR("Error writing to file");
@@ -447,7 +988,13 @@ int64_t blosc2_schunk_to_file(blosc2_schunk* schunk, const char* urlpath) {
     return len;
   }
 
-  // Copy to a contiguous file
+  // Accelerated path for frames in local files: the frame is already in its final form
+  if (schunk->storage->contiguous && schunk->storage->io->id == BLOSC2_IO_FILESYSTEM && !is_streamed(schunk)) {
+    blosc2_frame_s* frame = (blosc2_frame_s*)(schunk->frame);
+    return copy_local_file(frame->urlpath, frame->file_offset, frame->len, urlpath);
+  }
+
+  // Copy to a contiguous file (the chunks are pipelined by blosc2_schunk_copy())
   blosc2_storage frame_storage = {.contiguous=true, .urlpath=(char*)urlpath};
   blosc2_schunk* schunk_copy = blosc2_schunk_copy(schunk, &frame_storage);
   if (schunk_copy == NULL) {
@@ -469,7 +1016,7 @@ int64_t blosc2_schunk_append_file(blosc2_schunk* schunk, const char* urlpath) {
     }
 
     // Accelerated path for in-memory frames
-    if (schunk->storage->contiguous && schunk->storage->urlpath == NULL) {
+    if (schunk->storage->contiguous && schunk->storage->urlpath == NULL && !is_streamed(schunk)) {
         int64_t offset = append_frame_to_file((blosc2_frame_s*)(schunk->frame), urlpath);
         if (offset <= 0) {
             BLOSC_TRACE_ERROR("Error writing to file");
@@ -494,6 +1041,8 @@ int64_t blosc2_schunk_append_file(blosc2_schunk* schunk, const char* urlpath) {
 
 /* Free all memory from a super-chunk. */
 int blosc2_schunk_free(blosc2_schunk *schunk) {
+  // The metalayers of views are borrowed from the frame buffer
+  bool view = schunk->frame != NULL && ((blosc2_frame_s *) schunk->frame)->view;
   if (schunk->data != NULL) {
     for (int i = 0; i < schunk->nchunks; i++) {
       free(schunk->data[i]);
@@ -512,7 +1061,7 @@ int blosc2_schunk_free(blosc2_schunk *schunk) {
       if (schunk->metalayers[i] != NULL) {
         if (schunk->metalayers[i]->name != NULL)
           free(schunk->metalayers[i]->name);
-        if (schunk->metalayers[i]->content != NULL)
+        if (schunk->metalayers[i]->content != NULL && !view)
           free(schunk->metalayers[i]->content);
         free(schunk->metalayers[i]);
       }
@@ -539,7 +1088,7 @@ int blosc2_schunk_free(blosc2_schunk *schunk) {
       if (schunk->vlmetalayers[i] != NULL) {
         if (schunk->vlmetalayers[i]->name != NULL)
           free(schunk->vlmetalayers[i]->name);
-        if (schunk->vlmetalayers[i]->content != NULL)
+        if (schunk->vlmetalayers[i]->content != NULL && !view)
           free(schunk->vlmetalayers[i]->content);
         free(schunk->vlmetalayers[i]);
       }
@@ -574,6 +1123,27 @@ blosc2_schunk* blosc2_schunk_from_buffer(uint8_t *cframe, int64_t len, bool copy
 }
 
 
+/* Create a read-only super-chunk that borrows everything from a contiguous frame buffer */
+blosc2_schunk* blosc2_schunk_from_buffer_view(const uint8_t *cframe, int64_t len) {
+  if (cframe == NULL || len < FRAME_HEADER_MINLEN) {
+    BLOSC_TRACE_ERROR("The buffer is not a contiguous frame.");
+    return NULL;
+  }
+  // Check that the buffer actually comes from a cframe
+  if (memcmp(cframe + FRAME_HEADER_MAGIC, "b2frame\0", 8) != 0) {
+    BLOSC_TRACE_ERROR("The buffer is not a contiguous frame.");
+    return NULL;
+  }
+  // The frame never writes to (nor frees) the buffer in view mode
+  blosc2_frame_s* frame = frame_from_cframe((uint8_t *) cframe, len, false);
+  if (frame == NULL) {
+    return NULL;
+  }
+  frame->view = true;
+  return frame_to_schunk(frame, false, &BLOSC2_IO_DEFAULTS);
+}
+
+
 /* Create a super-chunk out of a contiguous frame buffer */
 void blosc2_schunk_avoid_cframe_free(blosc2_schunk *schunk, bool avoid_cframe_free) {
   blosc2_frame_s* frame = (blosc2_frame_s*)schunk->frame;
@@ -584,6 +1154,7 @@ void blosc2_schunk_avoid_cframe_free(blosc2_schunk *schunk, bool avoid_cframe_fr
 /* Fill an empty frame with special values (fast path). */
 int64_t blosc2_schunk_fill_special(blosc2_schunk* schunk, int64_t nitems, int special_value,
                                int32_t chunksize) {
+  BLOSC_ERROR(prepare_write(schunk));
   if (nitems == 0) {
     return 0;
   }
@@ -676,6 +1247,7 @@ int64_t blosc2_schunk_fill_special(blosc2_schunk* schunk, int64_t nitems, int sp
 
 /* Append an existing chunk into a super-chunk. */
 int64_t blosc2_schunk_append_chunk(blosc2_schunk *schunk, uint8_t *chunk, bool copy) {
+  BLOSC_ERROR(prepare_write(schunk));
   int32_t chunk_nbytes;
   int32_t chunk_cbytes;
   int64_t nchunks = schunk->nchunks;
@@ -765,6 +1337,7 @@ int64_t blosc2_schunk_append_chunk(blosc2_schunk *schunk, uint8_t *chunk, bool c
 
 /* Insert an existing @p chunk in a specified position on a super-chunk */
 int64_t blosc2_schunk_insert_chunk(blosc2_schunk *schunk, int64_t nchunk, uint8_t *chunk, bool copy) {
+  BLOSC_ERROR(prepare_write(schunk));
   int32_t chunk_nbytes;
   int32_t chunk_cbytes;
   int64_t nchunks = schunk->nchunks;
@@ -860,6 +1433,7 @@ int64_t blosc2_schunk_insert_chunk(blosc2_schunk *schunk, int64_t nchunk, uint8_
 
 
 int64_t blosc2_schunk_update_chunk(blosc2_schunk *schunk, int64_t nchunk, uint8_t *chunk, bool copy) {
+  BLOSC_ERROR(prepare_write(schunk));
   int32_t chunk_nbytes;
   int32_t chunk_cbytes;
 
@@ -971,6 +1545,7 @@ int64_t blosc2_schunk_update_chunk(blosc2_schunk *schunk, int64_t nchunk, uint8_
 }
 
 int64_t blosc2_schunk_delete_chunk(blosc2_schunk *schunk, int64_t nchunk) {
+  BLOSC_ERROR(prepare_write(schunk));
   int rc;
   if (schunk->nchunks < nchunk) {
     BLOSC_TRACE_ERROR("The schunk has not enough chunks (%" PRId64 ")!", schunk->nchunks);
@@ -1200,6 +1775,90 @@ int blosc2_schunk_get_lazychunk(blosc2_schunk *schunk, int64_t nchunk, uint8_t *
 }
 
 
+/* Relative costs for choosing how to decode a partial chunk in a slice.
+ * Costs are expressed in bytes of decoded data; a plain memcpy is assumed
+ * to be SLICE_COPY_COST_RATIO times cheaper than decoding, and waking up
+ * the thread pool of the context is accounted as a fixed amount of work. */
+#define SLICE_COPY_COST_RATIO 8
+#define SLICE_THREADS_OVERHEAD (32 * 1024)
+
+typedef enum {
+  SLICE_DECODE_GETITEM,        // serial decoding of the touched blocks (via blosc2_getitem_ctx)
+  SLICE_DECODE_MASKOUT,        // (parallel) masked decoding into a staging buffer + memcpy
+  SLICE_DECODE_MASKOUT_DIRECT, // (parallel) masked decoding straight into the destination
+} slice_decode_strategy;
+
+bool schunk_chunk_uses_delta(const uint8_t *chunk) {
+  for (int i = 0; i < BLOSC2_MAX_FILTERS; i++) {
+    if (chunk[BLOSC2_CHUNK_FILTER_CODES + i] == BLOSC_DELTA) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int schunk_set_chunk_maskout(blosc2_context *dctx, const uint8_t *chunk, bool *maskout, int32_t nblocks) {
+  if (nblocks < 1 || !maskout[0] || !schunk_chunk_uses_delta(chunk)) {
+    return blosc2_set_maskout(dctx, maskout, nblocks);
+  }
+  // The delta filter uses the first block as reference
+  maskout[0] = false;
+  int rc = blosc2_set_maskout(dctx, maskout, nblocks);
+  maskout[0] = true;
+  return rc;
+}
+
+/* Choose the cheapest way to decode the [chunk_start, chunk_stop) bytes of a chunk */
+static slice_decode_strategy choose_slice_decode(const uint8_t *chunk, int32_t chunk_start,
+                                                 int32_t chunk_stop, int32_t blocksize, int nthreads) {
+  uint8_t special_value = (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+  bool memcpyed = chunk[BLOSC2_CHUNK_FLAGS] & (uint8_t)BLOSC_MEMCPYED;
+  bool lazy = chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] & 0x08u;
+  if (special_value != BLOSC2_NO_SPECIAL || (memcpyed && !lazy)) {
+    // getitem short-circuits these without decoding anything
+    return SLICE_DECODE_GETITEM;
+  }
+  if (nthreads < 1) {
+    nthreads = 1;
+  }
+
+  int32_t nblock_start = chunk_start / blocksize;
+  int32_t nblock_stop = (chunk_stop - 1) / blocksize;
+  int64_t ntouched = nblock_stop - nblock_start + 1;
+  // The delta filter needs the first block as a reference for the rest, and getitem
+  // cannot provide it, so only a full (masked) decompression works past block 0
+  bool delta = schunk_chunk_uses_delta(chunk);
+  if (ntouched <= 1 && (!delta || nblock_stop == 0)) {
+    return SLICE_DECODE_GETITEM;
+  }
+  int64_t nbytes = chunk_stop - chunk_start;
+  int64_t threads_overhead = nthreads > 1 ? SLICE_THREADS_OVERHEAD : 0;
+  int64_t nmasked_decode = ntouched + ((delta && nblock_start > 0) ? 1 : 0);
+
+  int64_t getitem_cost = delta ? INT64_MAX : ntouched * blocksize + nbytes / SLICE_COPY_COST_RATIO;
+  int64_t maskout_cost = (nmasked_decode + nthreads - 1) / nthreads * blocksize +
+                         nbytes / SLICE_COPY_COST_RATIO + threads_overhead;
+  int64_t direct_cost = INT64_MAX;
+  if (chunk_start == 0) {
+    // Only full blocks are decoded in place; a trailing partial block goes through getitem
+    int64_t nfull = chunk_stop / blocksize;
+    bool tail = (chunk_stop % blocksize) != 0;
+    if (nfull > 0 && !(delta && tail)) {
+      direct_cost = (nfull + nthreads - 1) / nthreads * blocksize + threads_overhead +
+                    (tail ? blocksize : 0);
+    }
+  }
+
+  if (direct_cost <= maskout_cost && direct_cost < getitem_cost) {
+    return SLICE_DECODE_MASKOUT_DIRECT;
+  }
+  if (maskout_cost < getitem_cost) {
+    return SLICE_DECODE_MASKOUT;
+  }
+  return SLICE_DECODE_GETITEM;
+}
+
+
 int blosc2_schunk_get_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t stop, void *buffer) {
   int64_t byte_start = start * schunk->typesize;
   int64_t byte_stop = stop * schunk->typesize;
@@ -1214,19 +1873,29 @@ int blosc2_schunk_get_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
   }
 
   uint8_t *dst_ptr = (uint8_t *) buffer;
-  bool needs_free;
-  uint8_t *chunk;
+  bool needs_free = false;
+  uint8_t *chunk = NULL;
   int32_t cbytes;
   int64_t nchunk = nchunk_start;
   int64_t nbytes_read = 0;
   int32_t nbytes;
   int32_t chunksize = schunk->chunksize;
+  // Scratch space for masked reads; allocated on first use and reused across chunks
+  uint8_t *data = NULL;
+  bool *block_maskout = NULL;
+  int32_t maskout_len = 0;
+  int rc = BLOSC2_ERROR_SUCCESS;
 
   while (nbytes_read < ((stop - start) * schunk->typesize)) {
+    // What is left of the buffer, as far as this chunk is concerned
+    int64_t dst_left = (stop - start) * schunk->typesize - nbytes_read;
+    int32_t dst_nbytes = dst_left < schunk->chunksize ? (int32_t) dst_left : schunk->chunksize;
     cbytes = blosc2_schunk_get_lazychunk(schunk, nchunk, &chunk, &needs_free);
     if (cbytes < 0) {
       BLOSC_TRACE_ERROR("Cannot get lazychunk ('%" PRId64 "').", nchunk);
-      return BLOSC2_ERROR_FAILURE;
+      needs_free = false;
+      rc = BLOSC2_ERROR_FAILURE;
+      goto end;
     }
     int32_t blocksize = sw32_(chunk + BLOSC2_CHUNK_BLOCKSIZE);
 
@@ -1242,47 +1911,93 @@ int blosc2_schunk_get_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
 
     if (chunk_start == 0 && chunk_stop == chunksize) {
       // Avoid memcpy
-      nbytes = blosc2_decompress_ctx(schunk->dctx, chunk, cbytes, dst_ptr, chunksize);
+      nbytes = blosc2_decompress_ctx(schunk->dctx, chunk, cbytes, dst_ptr, dst_nbytes);
       if (nbytes < 0) {
         BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
-        return BLOSC2_ERROR_FAILURE;
+        rc = BLOSC2_ERROR_FAILURE;
+        goto end;
       }
     }
     else {
-      // After extensive timing I have not been able to see lots of situations where
-      // a maskout read is better than a getitem one.  Disabling for now.
-      // if (nblock_start != nblock_stop) {
-      if (false) {
-        uint8_t *data = malloc(chunksize);
-        /* We have more than 1 block to read, so use a masked read */
-        bool *block_maskout = calloc(nblocks, 1);
+      slice_decode_strategy strategy = choose_slice_decode(chunk, chunk_start, chunk_stop, blocksize,
+                                                           schunk->dctx->nthreads);
+      if (strategy != SLICE_DECODE_GETITEM && nblocks > maskout_len) {
+        bool *new_maskout = realloc(block_maskout, nblocks);
+        if (new_maskout == NULL) {
+          BLOSC_TRACE_ERROR("Cannot allocate the maskout for chunk ('%" PRId64 "').", nchunk);
+          rc = BLOSC2_ERROR_MEMORY_ALLOC;
+          goto end;
+        }
+        block_maskout = new_maskout;
+        maskout_len = nblocks;
+      }
+
+      if (strategy == SLICE_DECODE_MASKOUT_DIRECT) {
+        /* Decode the full blocks straight into the destination (masked blocks are never written) */
+        int32_t nfull = chunk_stop / blocksize;
         for (int32_t nblock = 0; nblock < nblocks; nblock++) {
-          if ((nblock < nblock_start) || (nblock > nblock_stop)) {
-            block_maskout[nblock] = true;
-          }
+          block_maskout[nblock] = (nblock >= nfull);
         }
         if (blosc2_set_maskout(schunk->dctx, block_maskout, nblocks) < 0) {
           BLOSC_TRACE_ERROR("Cannot set maskout");
-          return BLOSC2_ERROR_FAILURE;
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
+        }
+        nbytes = blosc2_decompress_ctx(schunk->dctx, chunk, cbytes, dst_ptr, dst_nbytes);
+        if (nbytes < 0) {
+          BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
+        }
+        int32_t full_nbytes = nfull * blocksize;
+        if (chunk_stop > full_nbytes) {
+          nbytes = blosc2_getitem_ctx(schunk->dctx, chunk, cbytes, full_nbytes / schunk->typesize,
+                                      (chunk_stop - full_nbytes) / schunk->typesize,
+                                      dst_ptr + full_nbytes, dst_nbytes - full_nbytes);
+          if (nbytes < 0) {
+            BLOSC_TRACE_ERROR("Cannot get item from ('%" PRId64 "') chunk.", nchunk);
+            rc = BLOSC2_ERROR_FAILURE;
+            goto end;
+          }
+        }
+        nbytes = chunk_stop;
+      }
+      else if (strategy == SLICE_DECODE_MASKOUT) {
+        /* We have many blocks to read, so use a masked read */
+        if (data == NULL) {
+          data = malloc(schunk->chunksize);
+          if (data == NULL) {
+            BLOSC_TRACE_ERROR("Cannot allocate the staging buffer for chunk ('%" PRId64 "').", nchunk);
+            rc = BLOSC2_ERROR_MEMORY_ALLOC;
+            goto end;
+          }
+        }
+        for (int32_t nblock = 0; nblock < nblocks; nblock++) {
+          block_maskout[nblock] = (nblock < nblock_start) || (nblock > nblock_stop);
+        }
+        if (schunk_set_chunk_maskout(schunk->dctx, chunk, block_maskout, nblocks) < 0) {
+          BLOSC_TRACE_ERROR("Cannot set maskout");
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
         }
 
         nbytes = blosc2_decompress_ctx(schunk->dctx, chunk, cbytes, data, chunksize);
         if (nbytes < 0) {
           BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
-          return BLOSC2_ERROR_FAILURE;
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
         }
         nbytes = chunk_stop - chunk_start;
         memcpy(dst_ptr, &data[chunk_start], nbytes);
-        free(block_maskout);
-        free(data);
       }
       else {
-        /* Less than 1 block to read; use a getitem call */
+        /* Few blocks to read; use a getitem call */
         nbytes = blosc2_getitem_ctx(schunk->dctx, chunk, cbytes, (int32_t) (chunk_start / schunk->typesize),
-                                    (chunk_stop - chunk_start) / schunk->typesize, dst_ptr, chunksize);
+                                    (chunk_stop - chunk_start) / schunk->typesize, dst_ptr, dst_nbytes);
         if (nbytes < 0) {
           BLOSC_TRACE_ERROR("Cannot get item from ('%" PRId64 "') chunk.", nchunk);
-          return BLOSC2_ERROR_FAILURE;
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
         }
       }
     }
@@ -1293,6 +2008,7 @@ int blosc2_schunk_get_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
 
     if (needs_free) {
       free(chunk);
+      needs_free = false;
     }
     chunk_start = 0;
     if (byte_stop >= (nchunk + 1) * chunksize) {
@@ -1303,11 +2019,286 @@ int blosc2_schunk_get_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
     }
   }
 
+  end:
+  if (needs_free) {
+    free(chunk);
+  }
+  free(data);
+  free(block_maskout);
+
+  return rc;
+}
+
+
+/* Whether the blocks of a compressed chunk can be rewritten independently */
+bool schunk_chunk_blocks_updatable(blosc2_schunk *schunk, const uint8_t *chunk, int32_t cbytes) {
+  if (cbytes < BLOSC_EXTENDED_HEADER_LENGTH) {
+    return false;
+  }
+  uint8_t blosc2_flags = chunk[BLOSC2_CHUNK_BLOSC2_FLAGS];
+  if (((blosc2_flags >> 4) & BLOSC2_SPECIAL_MASK) != BLOSC2_NO_SPECIAL) {
+    return false;
+  }
+  // Lazy chunks do not carry the streams, and dicts are trained on the whole chunk
+  if (blosc2_flags & (0x08u | BLOSC2_USEDICT | BLOSC2_INSTR_CODEC)) {
+    return false;
+  }
+  if (chunk[BLOSC2_CHUNK_FLAGS] & (uint8_t) BLOSC_MEMCPYED) {
+    return false;
+  }
+  // The block checksums would go stale
+  if (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS2] & BLOSC2_CHECKSUM_MASK) {
+    return false;
+  }
+  // The delta filter encodes every block against the first one
+  if (schunk_chunk_uses_delta(chunk)) {
+    return false;
+  }
+  // A prefilter may depend on the whole chunk
+  if (schunk->cctx->prefilter != NULL) {
+    return false;
+  }
+  return true;
+}
+
+
+typedef struct {
+  int32_t start;
+  int32_t nblock;
+} block_start;
+
+static int compare_block_start(const void *a, const void *b) {
+  const block_start *ba = (const block_start *) a;
+  const block_start *bb = (const block_start *) b;
+  if (ba->start != bb->start) {
+    return ba->start < bb->start ? -1 : 1;
+  }
+  return ba->nblock < bb->nblock ? -1 : 1;
+}
+
+/* Compute where the streams of every block live in a chunk.
+   Blocks may be stored out of order (parallel compression), so sort the bstarts. */
+static int get_block_extents(const uint8_t *chunk, int32_t cbytes, int32_t nblocks,
+                             int32_t *bstarts, int32_t *bsizes) {
+  block_start *sorted = malloc(nblocks * sizeof(block_start));
+  BLOSC_ERROR_NULL(sorted, BLOSC2_ERROR_MEMORY_ALLOC);
+  for (int32_t i = 0; i < nblocks; i++) {
+    bstarts[i] = sw32_(chunk + BLOSC_EXTENDED_HEADER_LENGTH + i * sizeof(int32_t));
+    if (bstarts[i] < BLOSC_EXTENDED_HEADER_LENGTH + nblocks * (int32_t) sizeof(int32_t) || bstarts[i] > cbytes) {
+      BLOSC_TRACE_ERROR("bstarts of block %d is out of bounds.", i);
+      free(sorted);
+      return BLOSC2_ERROR_READ_BUFFER;
+    }
+    sorted[i].start = bstarts[i];
+    sorted[i].nblock = i;
+  }
+  qsort(sorted, nblocks, sizeof(block_start), compare_block_start);
+  for (int32_t i = 0; i < nblocks; i++) {
+    int32_t end = (i == nblocks - 1) ? cbytes : sorted[i + 1].start;
+    bsizes[sorted[i].nblock] = end - sorted[i].start;
+  }
+  free(sorted);
+
   return BLOSC2_ERROR_SUCCESS;
 }
 
 
+/* Build a chunk rewriting the blocks flagged in `touched` and reusing the streams of the rest verbatim */
+int32_t schunk_build_chunk_blocks(blosc2_schunk *schunk, blosc2_context *cctx, blosc2_context *dctx,
+                                  int64_t nchunk, const uint8_t *chunk, int32_t cbytes, uint8_t *data,
+                                  const bool *touched, uint8_t **new_chunk) {
+  int32_t nbytes = sw32_(chunk + BLOSC2_CHUNK_NBYTES);
+  int32_t blocksize = sw32_(chunk + BLOSC2_CHUNK_BLOCKSIZE);
+  if (blocksize <= 0) {
+    BLOSC_TRACE_ERROR("Invalid blocksize in chunk ('%" PRId64 "').", nchunk);
+    return BLOSC2_ERROR_INVALID_HEADER;
+  }
+  int32_t nblocks = nbytes / blocksize;
+  int32_t leftover = nbytes % blocksize;
+  if (leftover > 0) {
+    nblocks++;
+  }
+
+  int32_t rc;
+  *new_chunk = NULL;
+  bool *mask = malloc(nblocks);
+  BLOSC_ERROR_NULL(mask, BLOSC2_ERROR_MEMORY_ALLOC);
+  memcpy(mask, touched, nblocks);
+  int32_t *bstarts = NULL;
+  int32_t *bsizes = NULL;
+  int32_t *run_offsets = NULL;
+  uint8_t *tmp = NULL;
+  blosc2_context *run_cctx = NULL;
+  bool updatable = schunk_chunk_blocks_updatable(schunk, chunk, cbytes);
+
+  if (updatable && leftover > 0 && nblocks > 1 && mask[nblocks - 1] && !mask[nblocks - 2]) {
+    // A leftover block alone would be compressed with a different number of streams,
+    // so recompress it together with its predecessor
+    int32_t offset = (nblocks - 2) * blocksize;
+    rc = blosc2_getitem_ctx(dctx, chunk, cbytes, offset / schunk->typesize,
+                            blocksize / schunk->typesize, data + offset, blocksize);
+    if (rc < 0) {
+      BLOSC_TRACE_ERROR("Cannot get block %d of chunk ('%" PRId64 "').", nblocks - 2, nchunk);
+      goto end;
+    }
+    mask[nblocks - 2] = true;
+  }
+
+  int32_t ntouched = 0;
+  for (int32_t i = 0; i < nblocks; i++) {
+    ntouched += mask[i];
+  }
+  if (!updatable || ntouched == nblocks) {
+    goto full;
+  }
+
+  // Compress the touched runs with the same parameters than the original chunk
+  blosc2_cparams *cparams;
+  rc = blosc2_schunk_get_cparams(schunk, &cparams);
+  if (rc < 0) {
+    goto end;
+  }
+  cparams->blocksize = blocksize;
+  cparams->splitmode = (chunk[BLOSC2_CHUNK_FLAGS] & 0x10) ? BLOSC_NEVER_SPLIT : BLOSC_ALWAYS_SPLIT;
+  cparams->nthreads = cctx->nthreads;
+  run_cctx = blosc2_create_cctx(*cparams);
+  free(cparams);
+  if (run_cctx == NULL) {
+    BLOSC_TRACE_ERROR("Cannot create a compression context.");
+    rc = BLOSC2_ERROR_NULL_POINTER;
+    goto end;
+  }
+
+  bstarts = malloc(nblocks * sizeof(int32_t));
+  bsizes = malloc(nblocks * sizeof(int32_t));
+  run_offsets = malloc(nblocks * sizeof(int32_t));
+  int32_t tmp_size = ntouched * (blocksize + BLOSC2_MAX_OVERHEAD);
+  tmp = malloc(tmp_size);
+  if (bstarts == NULL || bsizes == NULL || run_offsets == NULL || tmp == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto end;
+  }
+  rc = get_block_extents(chunk, cbytes, nblocks, bstarts, bsizes);
+  if (rc < 0) {
+    goto end;
+  }
+
+  int32_t tmp_pos = 0;
+  int32_t new_cbytes = BLOSC_EXTENDED_HEADER_LENGTH + nblocks * (int32_t) sizeof(int32_t);
+  for (int32_t i = 0; i < nblocks; i++) {
+    if (!mask[i]) {
+      new_cbytes += bsizes[i];
+      continue;
+    }
+    int32_t run_start = i;
+    while (i < nblocks && mask[i]) {
+      i++;
+    }
+    int32_t run_nblocks = i - run_start;
+    int32_t run_nbytes = run_nblocks * blocksize;
+    if (run_start * blocksize + run_nbytes > nbytes) {
+      run_nbytes = nbytes - run_start * blocksize;
+    }
+    uint8_t *run_chunk = tmp + tmp_pos;
+    int csize = blosc2_compress_ctx(run_cctx, data + run_start * blocksize, run_nbytes,
+                                    run_chunk, tmp_size - tmp_pos);
+    if (csize <= 0) {
+      // Data is not compressible enough for fitting in tmp; resort to a full recompression
+      goto full;
+    }
+    // The run must share the layout of the original chunk for mixing their streams
+    if (run_chunk[BLOSC2_CHUNK_FLAGS] != chunk[BLOSC2_CHUNK_FLAGS] ||
+        run_chunk[BLOSC2_CHUNK_TYPESIZE] != chunk[BLOSC2_CHUNK_TYPESIZE] ||
+        sw32_(run_chunk + BLOSC2_CHUNK_BLOCKSIZE) != blocksize ||
+        memcmp(run_chunk + BLOSC2_CHUNK_FILTER_CODES, chunk + BLOSC2_CHUNK_FILTER_CODES,
+               BLOSC2_CHUNK_BLOSC2_FLAGS - BLOSC2_CHUNK_FILTER_CODES + 1) != 0) {
+      goto full;
+    }
+    rc = get_block_extents(run_chunk, csize, run_nblocks, bstarts + run_start, bsizes + run_start);
+    if (rc < 0) {
+      goto end;
+    }
+    for (int32_t j = run_start; j < run_start + run_nblocks; j++) {
+      run_offsets[j] = tmp_pos;
+      new_cbytes += bsizes[j];
+    }
+    tmp_pos += csize;
+    i--;
+  }
+
+  // Assemble the new chunk
+  *new_chunk = malloc(new_cbytes);
+  if (*new_chunk == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto end;
+  }
+  memcpy(*new_chunk, chunk, BLOSC_EXTENDED_HEADER_LENGTH);
+  _sw32(*new_chunk + BLOSC2_CHUNK_CBYTES, new_cbytes);
+  int32_t pos = BLOSC_EXTENDED_HEADER_LENGTH + nblocks * (int32_t) sizeof(int32_t);
+  for (int32_t i = 0; i < nblocks; i++) {
+    const uint8_t *streams = mask[i] ? tmp + run_offsets[i] + bstarts[i] : chunk + bstarts[i];
+    _sw32(*new_chunk + BLOSC_EXTENDED_HEADER_LENGTH + i * sizeof(int32_t), pos);
+    memcpy(*new_chunk + pos, streams, bsizes[i]);
+    pos += bsizes[i];
+  }
+  rc = new_cbytes;
+  goto end;
+
+  full:
+  // Decompress the blocks that have not been touched and recompress everything
+  if (blosc2_set_maskout(dctx, mask, nblocks) < 0) {
+    BLOSC_TRACE_ERROR("Cannot set maskout");
+    rc = BLOSC2_ERROR_FAILURE;
+    goto end;
+  }
+  rc = blosc2_decompress_ctx(dctx, chunk, cbytes, data, nbytes);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
+    goto end;
+  }
+  *new_chunk = malloc(nbytes + BLOSC2_MAX_OVERHEAD);
+  if (*new_chunk == NULL) {
+    rc = BLOSC2_ERROR_MEMORY_ALLOC;
+    goto end;
+  }
+  rc = blosc2_compress_ctx(cctx, data, nbytes, *new_chunk, nbytes + BLOSC2_MAX_OVERHEAD);
+  if (rc < 0) {
+    BLOSC_TRACE_ERROR("Cannot compress data of chunk ('%" PRId64 "').", nchunk);
+    free(*new_chunk);
+    *new_chunk = NULL;
+    goto end;
+  }
+
+  end:
+  if (run_cctx != NULL) {
+    blosc2_free_ctx(run_cctx);
+  }
+  free(tmp);
+  free(run_offsets);
+  free(bsizes);
+  free(bstarts);
+  free(mask);
+
+  return rc;
+}
+
+
+/* Rewrite the blocks flagged in `touched` and reuse the streams of the rest verbatim */
+int64_t schunk_update_chunk_blocks(blosc2_schunk *schunk, int64_t nchunk, const uint8_t *chunk,
+                                   int32_t cbytes, uint8_t *data, const bool *touched) {
+  uint8_t *new_chunk;
+  schunk->current_nchunk = nchunk;
+  int32_t rc = schunk_build_chunk_blocks(schunk, schunk->cctx, schunk->dctx, nchunk, chunk, cbytes,
+                                         data, touched, &new_chunk);
+  if (rc < 0) {
+    return rc;
+  }
+  return blosc2_schunk_update_chunk(schunk, nchunk, new_chunk, false);
+}
+
+
 int blosc2_schunk_set_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t stop, void *buffer) {
+  BLOSC_ERROR(prepare_write(schunk));
   int64_t byte_start = start * schunk->typesize;
   int64_t byte_stop = stop * schunk->typesize;
   int64_t nchunk_start = byte_start / schunk->chunksize;
@@ -1324,9 +2315,15 @@ int blosc2_schunk_set_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
   int64_t nchunk = nchunk_start;
   int64_t nbytes_written = 0;
   int32_t nbytes;
-  uint8_t *data = malloc(schunk->chunksize);
   int64_t nchunks;
   int32_t chunksize = schunk->chunksize;
+  int rc = BLOSC2_ERROR_SUCCESS;
+  uint8_t *chunk_old = NULL;
+  bool needs_free = false;
+  bool *touched = NULL;
+  bool *block_maskout = NULL;
+  uint8_t *data = malloc(schunk->chunksize);
+  BLOSC_ERROR_NULL(data, BLOSC2_ERROR_MEMORY_ALLOC);
 
   while (nbytes_written < ((stop - start) * schunk->typesize)) {
     if (chunk_start == 0 &&
@@ -1335,32 +2332,96 @@ int blosc2_schunk_set_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
         chunksize = chunk_stop;
       }
       uint8_t *chunk = malloc(chunksize + BLOSC2_MAX_OVERHEAD);
+      if (chunk == NULL) {
+        rc = BLOSC2_ERROR_MEMORY_ALLOC;
+        goto end;
+      }
       if (blosc2_compress_ctx(schunk->cctx, src_ptr, chunksize, chunk, chunksize + BLOSC2_MAX_OVERHEAD) < 0) {
+        free(chunk);
         BLOSC_TRACE_ERROR("Cannot compress data of chunk ('%" PRId64 "').", nchunk);
-        return BLOSC2_ERROR_FAILURE;
+        rc = BLOSC2_ERROR_FAILURE;
+        goto end;
       }
       nchunks = blosc2_schunk_update_chunk(schunk, nchunk, chunk, false);
       if (nchunks != schunk->nchunks) {
         BLOSC_TRACE_ERROR("Cannot update chunk ('%" PRId64 "').", nchunk);
-        return BLOSC2_ERROR_CHUNK_UPDATE;
+        rc = BLOSC2_ERROR_CHUNK_UPDATE;
+        goto end;
       }
     }
     else {
-      nbytes = blosc2_schunk_decompress_chunk(schunk, nchunk, data, schunk->chunksize);
-      if (nbytes < 0) {
-        BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
-        return BLOSC2_ERROR_FAILURE;
+      int32_t cbytes = blosc2_schunk_get_chunk(schunk, nchunk, &chunk_old, &needs_free);
+      if (cbytes < 0) {
+        BLOSC_TRACE_ERROR("Cannot get chunk ('%" PRId64 "').", nchunk);
+        rc = BLOSC2_ERROR_FAILURE;
+        goto end;
       }
-      memcpy(&data[chunk_start], src_ptr, chunk_stop - chunk_start);
-      uint8_t *chunk = malloc(nbytes + BLOSC2_MAX_OVERHEAD);
-      if (blosc2_compress_ctx(schunk->cctx, data, nbytes, chunk, nbytes + BLOSC2_MAX_OVERHEAD) < 0) {
-        BLOSC_TRACE_ERROR("Cannot compress data of chunk ('%" PRId64 "').", nchunk);
-        return BLOSC2_ERROR_FAILURE;
+      if (schunk_chunk_blocks_updatable(schunk, chunk_old, cbytes)) {
+        /* Only recompress the blocks overlapping the slice */
+        nbytes = sw32_(chunk_old + BLOSC2_CHUNK_NBYTES);
+        int32_t blocksize = sw32_(chunk_old + BLOSC2_CHUNK_BLOCKSIZE);
+        int32_t nblocks = nbytes / blocksize + (nbytes % blocksize != 0 ? 1 : 0);
+        touched = malloc(nblocks);
+        block_maskout = malloc(nblocks);
+        if (touched == NULL || block_maskout == NULL) {
+          rc = BLOSC2_ERROR_MEMORY_ALLOC;
+          goto end;
+        }
+        for (int32_t nblock = 0; nblock < nblocks; nblock++) {
+          int32_t block_start = nblock * blocksize;
+          int32_t block_stop = block_start + blocksize < nbytes ? block_start + blocksize : nbytes;
+          touched[nblock] = block_stop > chunk_start && block_start < chunk_stop;
+          // Blocks that are completely overwritten do not need to be decompressed
+          block_maskout[nblock] = !touched[nblock] || (block_start >= chunk_start && block_stop <= chunk_stop);
+        }
+        if (blosc2_set_maskout(schunk->dctx, block_maskout, nblocks) < 0) {
+          BLOSC_TRACE_ERROR("Cannot set maskout");
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
+        }
+        schunk->current_nchunk = nchunk;
+        if (blosc2_decompress_ctx(schunk->dctx, chunk_old, cbytes, data, schunk->chunksize) < 0) {
+          BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
+        }
+        memcpy(&data[chunk_start], src_ptr, chunk_stop - chunk_start);
+        nchunks = schunk_update_chunk_blocks(schunk, nchunk, chunk_old, cbytes, data, touched);
+        free(block_maskout);
+        block_maskout = NULL;
+        free(touched);
+        touched = NULL;
+      }
+      else {
+        schunk->current_nchunk = nchunk;
+        nbytes = blosc2_decompress_ctx(schunk->dctx, chunk_old, cbytes, data, schunk->chunksize);
+        if (nbytes < 0) {
+          BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
+        }
+        memcpy(&data[chunk_start], src_ptr, chunk_stop - chunk_start);
+        uint8_t *chunk = malloc(nbytes + BLOSC2_MAX_OVERHEAD);
+        if (chunk == NULL) {
+          rc = BLOSC2_ERROR_MEMORY_ALLOC;
+          goto end;
+        }
+        if (blosc2_compress_ctx(schunk->cctx, data, nbytes, chunk, nbytes + BLOSC2_MAX_OVERHEAD) < 0) {
+          free(chunk);
+          BLOSC_TRACE_ERROR("Cannot compress data of chunk ('%" PRId64 "').", nchunk);
+          rc = BLOSC2_ERROR_FAILURE;
+          goto end;
+        }
+        nchunks = blosc2_schunk_update_chunk(schunk, nchunk, chunk, false);
+      }
+      if (needs_free) {
+        free(chunk_old);
+        needs_free = false;
       }
-      nchunks = blosc2_schunk_update_chunk(schunk, nchunk, chunk, false);
       if (nchunks != schunk->nchunks) {
         BLOSC_TRACE_ERROR("Cannot update chunk ('%" PRId64 "').", nchunk);
-        return BLOSC2_ERROR_CHUNK_UPDATE;
+        rc = BLOSC2_ERROR_CHUNK_UPDATE;
+        goto end;
       }
     }
     nchunk++;
@@ -1374,9 +2435,16 @@ int blosc2_schunk_set_slice_buffer(blosc2_schunk *schunk, int64_t start, int64_t
       chunk_stop = (int32_t) (byte_stop % schunk->chunksize);
     }
   }
+
+  end:
+  free(block_maskout);
+  free(touched);
+  if (needs_free) {
+    free(chunk_old);
+  }
   free(data);
 
-  return BLOSC2_ERROR_SUCCESS;
+  return rc;
 }
 
 
@@ -1401,8 +2469,198 @@ int schunk_get_slice_nchunks(blosc2_schunk *schunk, int64_t start, int64_t stop,
   return nchunks;
 }
 
+/* An iterator decompressing the chunks of a super-chunk in the background */
+struct blosc2_schunk_iter_s {
+  blosc2_schunk *schunk;
+  blosc2_context *dctx;    // owned by the background thread
+  int nbuffers;
+  uint8_t **buffers;       // ring of decompressed chunks; chunk i goes to buffers[i % nbuffers]
+  int32_t *nbytes;         // decompressed size (or error code) of every buffer
+  int64_t nchunks;
+  int64_t produced;        // chunks already decompressed
+  int64_t released;        // chunks whose buffer has been handed back by the consumer
+  int64_t consumed;        // chunks handed out to the consumer
+  bool stop;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cv;
+};
+
+
+static void *schunk_iter_worker(void *arg) {
+  blosc2_schunk_iter *iter = (blosc2_schunk_iter *) arg;
+
+  for (int64_t nchunk = 0; nchunk < iter->nchunks; nchunk++) {
+    // Wait until the buffer for this chunk has been released
+    pthread_mutex_lock(&iter->mutex);
+    while (!iter->stop && nchunk >= iter->released + iter->nbuffers) {
+      pthread_cond_wait(&iter->cv, &iter->mutex);
+    }
+    bool stop = iter->stop;
+    pthread_mutex_unlock(&iter->mutex);
+    if (stop) {
+      break;
+    }
+
+    int slot = (int) (nchunk % iter->nbuffers);
+    uint8_t *chunk;
+    bool needs_free;
+    int32_t rc = blosc2_schunk_get_chunk(iter->schunk, nchunk, &chunk, &needs_free);
+    if (rc < 0) {
+      BLOSC_TRACE_ERROR("Cannot get chunk ('%" PRId64 "').", nchunk);
+    }
+    else {
+      rc = blosc2_decompress_ctx(iter->dctx, chunk, rc, iter->buffers[slot], iter->schunk->chunksize);
+      if (rc < 0) {
+        BLOSC_TRACE_ERROR("Cannot decompress chunk ('%" PRId64 "').", nchunk);
+      }
+      if (needs_free) {
+        free(chunk);
+      }
+    }
+
+    pthread_mutex_lock(&iter->mutex);
+    iter->nbytes[slot] = rc;
+    iter->produced = nchunk + 1;
+    pthread_cond_broadcast(&iter->cv);
+    pthread_mutex_unlock(&iter->mutex);
+    if (rc < 0) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+
+blosc2_schunk_iter *blosc2_schunk_iter_new(blosc2_schunk *schunk, int nbuffers) {
+  if (schunk == NULL) {
+    BLOSC_TRACE_ERROR("The super-chunk cannot be NULL.");
+    return NULL;
+  }
+  if (nbuffers < 2) {
+    BLOSC_TRACE_ERROR("The iterator needs at least 2 buffers (%d requested).", nbuffers);
+    return NULL;
+  }
+
+  blosc2_schunk_iter *iter = calloc(1, sizeof(blosc2_schunk_iter));
+  BLOSC_ERROR_NULL(iter, NULL);
+  iter->schunk = schunk;
+  iter->nchunks = schunk->nchunks;
+  iter->nbuffers = nbuffers;
+
+  blosc2_dparams *dparams;
+  blosc2_schunk_get_dparams(schunk, &dparams);
+  iter->dctx = blosc2_create_dctx(*dparams);
+  free(dparams);
+  iter->buffers = calloc(nbuffers, sizeof(uint8_t *));
+  iter->nbytes = calloc(nbuffers, sizeof(int32_t));
+  if (iter->dctx == NULL || iter->buffers == NULL || iter->nbytes == NULL) {
+    BLOSC_TRACE_ERROR("Cannot allocate the iterator resources.");
+    goto failed;
+  }
+  if (iter->nchunks > 0) {
+    for (int i = 0; i < nbuffers; i++) {
+      iter->buffers[i] = malloc(schunk->chunksize);
+      if (iter->buffers[i] == NULL) {
+        BLOSC_TRACE_ERROR("Cannot allocate the iterator buffers.");
+        goto failed;
+      }
+    }
+  }
+
+  pthread_mutex_init(&iter->mutex, NULL);
+  pthread_cond_init(&iter->cv, NULL);
+  if (pthread_create(&iter->thread, NULL, schunk_iter_worker, iter) != 0) {
+    BLOSC_TRACE_ERROR("Cannot create the iterator thread.");
+    pthread_cond_destroy(&iter->cv);
+    pthread_mutex_destroy(&iter->mutex);
+    goto failed;
+  }
+
+  return iter;
+
+  failed:
+  if (iter->buffers != NULL) {
+    for (int i = 0; i < nbuffers; i++) {
+      free(iter->buffers[i]);
+    }
+  }
+  free(iter->buffers);
+  free(iter->nbytes);
+  if (iter->dctx != NULL) {
+    blosc2_free_ctx(iter->dctx);
+  }
+  free(iter);
+  return NULL;
+}
+
+
+int blosc2_schunk_iter_next(blosc2_schunk_iter *iter, int64_t *nchunk, uint8_t **dest, int32_t *nbytes) {
+  BLOSC_ERROR_NULL(iter, BLOSC2_ERROR_NULL_POINTER);
+
+  pthread_mutex_lock(&iter->mutex);
+  // The buffer handed out in the previous call can be reused now
+  if (iter->released < iter->consumed) {
+    iter->released = iter->consumed;
+    pthread_cond_broadcast(&iter->cv);
+  }
+  if (iter->consumed == iter->nchunks) {
+    pthread_mutex_unlock(&iter->mutex);
+    return 0;
+  }
+  while (iter->produced <= iter->consumed) {
+    pthread_cond_wait(&iter->cv, &iter->mutex);
+  }
+  int slot = (int) (iter->consumed % iter->nbuffers);
+  int32_t rc = iter->nbytes[slot];
+  pthread_mutex_unlock(&iter->mutex);
+
+  if (rc < 0) {
+    return rc;
+  }
+  if (nchunk != NULL) {
+    *nchunk = iter->consumed;
+  }
+  if (dest != NULL) {
+    *dest = iter->buffers[slot];
+  }
+  if (nbytes != NULL) {
+    *nbytes = rc;
+  }
+  iter->consumed++;
+
+  return 1;
+}
+
+
+int blosc2_schunk_iter_free(blosc2_schunk_iter *iter) {
+  if (iter == NULL) {
+    return BLOSC2_ERROR_SUCCESS;
+  }
+
+  pthread_mutex_lock(&iter->mutex);
+  iter->stop = true;
+  pthread_cond_broadcast(&iter->cv);
+  pthread_mutex_unlock(&iter->mutex);
+  pthread_join(iter->thread, NULL);
+
+  pthread_cond_destroy(&iter->cv);
+  pthread_mutex_destroy(&iter->mutex);
+  for (int i = 0; i < iter->nbuffers; i++) {
+    free(iter->buffers[i]);
+  }
+  free(iter->buffers);
+  free(iter->nbytes);
+  blosc2_free_ctx(iter->dctx);
+  free(iter);
+
+  return BLOSC2_ERROR_SUCCESS;
+}
+
 /* Reorder the chunk offsets of an existing super-chunk. */
 int blosc2_schunk_reorder_offsets(blosc2_schunk *schunk, int64_t *offsets_order) {
+  BLOSC_ERROR(prepare_write(schunk));
   // Check that the offsets order are correct
   bool *index_check = (bool *) calloc(schunk->nchunks, sizeof(bool));
   for (int i = 0; i < schunk->nchunks; ++i) {
@@ -1494,6 +2752,7 @@ int metalayer_flush(blosc2_schunk* schunk) {
  * If successful, return the index of the new metalayer.  Else, return a negative value.
  */
 int blosc2_meta_add(blosc2_schunk *schunk, const char *name, uint8_t *content, int32_t content_len) {
+  BLOSC_ERROR(prepare_write(schunk));
   int nmetalayer = blosc2_meta_exists(schunk, name);
   if (nmetalayer >= 0) {
     BLOSC_TRACE_ERROR("Metalayer \"%s\" already exists.", name);
@@ -1526,6 +2785,7 @@ int blosc2_meta_add(blosc2_schunk *schunk, const char *name, uint8_t *content, i
  * If successful, return the index of the new metalayer.  Else, return a negative value.
  */
 int blosc2_meta_update(blosc2_schunk *schunk, const char *name, uint8_t *content, int32_t content_len) {
+  BLOSC_ERROR(prepare_write(schunk));
   int nmetalayer = blosc2_meta_exists(schunk, name);
   if (nmetalayer < 0) {
     BLOSC_TRACE_ERROR("Metalayer \"%s\" not found.", name);
@@ -1598,6 +2858,7 @@ int vlmetalayer_flush(blosc2_schunk* schunk) {
  */
 int blosc2_vlmeta_add(blosc2_schunk *schunk, const char *name, uint8_t *content, int32_t content_len,
                       blosc2_cparams *cparams) {
+  BLOSC_ERROR(prepare_write(schunk));
   int nvlmetalayer = blosc2_vlmeta_exists(schunk, name);
   if (nvlmetalayer >= 0) {
     BLOSC_TRACE_ERROR("Variable-length metalayer \"%s\" already exists.", name);
@@ -1650,6 +2911,9 @@ int blosc2_vlmeta_get(blosc2_schunk *schunk, const char *name, uint8_t **content
     BLOSC_TRACE_ERROR("User metalayer \"%s\" not found.", name);
     return nvlmetalayer;
   }
+  if (schunk->frame != NULL) {
+    BLOSC_ERROR(frame_load_vlmetalayer((blosc2_frame_s *) schunk->frame, schunk, nvlmetalayer));
+  }
   blosc2_metalayer *meta = schunk->vlmetalayers[nvlmetalayer];
   int32_t nbytes, cbytes;
   blosc2_cbuffer_sizes(meta->content, &nbytes, &cbytes, NULL);
@@ -1675,6 +2939,7 @@ int blosc2_vlmeta_get(blosc2_schunk *schunk, const char *name, uint8_t **content
 
 int blosc2_vlmeta_update(blosc2_schunk *schunk, const char *name, uint8_t *content, int32_t content_len,
                          blosc2_cparams *cparams) {
+  BLOSC_ERROR(prepare_write(schunk));
   int nvlmetalayer = blosc2_vlmeta_exists(schunk, name);
   if (nvlmetalayer < 0) {
     BLOSC_TRACE_ERROR("User vlmetalayer \"%s\" not found.", name);
@@ -1717,6 +2982,7 @@ int blosc2_vlmeta_update(blosc2_schunk *schunk, const char *name, uint8_t *conte
 }
 
 int blosc2_vlmeta_delete(blosc2_schunk *schunk, const char *name) {
+  BLOSC_ERROR(prepare_write(schunk));
   int nvlmetalayer = blosc2_vlmeta_exists(schunk, name);
   if (nvlmetalayer < 0) {
     BLOSC_TRACE_ERROR("User vlmetalayer \"%s\" not found.", name);
@@ -1734,6 +3000,11 @@ int blosc2_vlmeta_delete(blosc2_schunk *schunk, const char *name) {
   int rc = vlmetalayer_flush(schunk);
   if (rc < 0) {
     BLOSC_TRACE_ERROR("Can not propagate de `%s` variable-length metalayer to a frame.", name);
+  }
+  // `name` may be the one of the deleted metalayer, so free it only now
+  free(vlmetalayer->name);
+  free(vlmetalayer);
+  if (rc < 0) {
     return rc;
   }
 
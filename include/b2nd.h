@@ -50,6 +50,9 @@ extern "C" {
  */
 #define DTYPE_NUMPY_FORMAT 0
 
+/* The default memory budget (in bytes) for copies that change the chunkshape or blockshape */
+#define B2ND_RECHUNK_MEMORY (256 * 1024 * 1024)
+
 /* The default data type */
 #define B2ND_DEFAULT_DTYPE "|u1"
 /* The default data format */
@@ -73,6 +76,11 @@ struct chunk_cache_s {
  */
 typedef struct b2nd_context_s b2nd_context_t;   /* opaque type */
 
+/**
+ * @brief An append buffer for a b2nd array (see b2nd_appender_new()).
+ */
+typedef struct b2nd_appender_s b2nd_appender_t;   /* opaque type */
+
 /**
  * @brief A multidimensional array of data that can be compressed.
  */
@@ -119,6 +127,10 @@ typedef struct {
   //!< Data type. Different formats can be supported (see dtype_format).
   int8_t dtype_format;
   //!< The format of the data type.  Default is DTYPE_NUMPY_FORMAT.
+  struct b2nd_zonemap_s *zonemap;
+  //!< The zone map kept in memory while the array is written (see b2nd_build_zonemap()), or NULL.
+  struct b2nd_pyramid_levels_s *pyramid_levels;
+  //!< The levels of the pyramid of an in-memory array (see b2nd_pyramid_build()), or NULL.
 } b2nd_array_t;
 
 
@@ -304,6 +316,35 @@ BLOSC_EXPORT int b2nd_from_cbuffer(b2nd_context_t *ctx, b2nd_array_t **array, co
  */
 BLOSC_EXPORT int b2nd_to_cbuffer(const b2nd_array_t *array, void *buffer, int64_t buffersize);
 
+/**
+ * @brief Create a b2nd array from a buffer with arbitrary strides (e.g. in Fortran order, or a
+ * NumPy view), without making a C-contiguous copy of it first.
+ *
+ * @param ctx The b2nd context for the new array.
+ * @param array The memory pointer where the array will be created.
+ * @param buffer The buffer where source data is stored, pointing to its first item.
+ * @param bufferstrides The strides (in bytes, not negative) of the buffer for every dimension.
+ * @param buffersize The size (in bytes) of the buffer, from its first item.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_from_cbuffer_strided(b2nd_context_t *ctx, b2nd_array_t **array, const void *buffer,
+                                           const int64_t *bufferstrides, int64_t buffersize);
+
+/**
+ * @brief Extract the data from a b2nd array into a buffer with arbitrary strides (see
+ * b2nd_from_cbuffer_strided()).
+ *
+ * @param array The b2nd array.
+ * @param buffer The buffer where the data will be stored, pointing to its first item.
+ * @param bufferstrides The strides (in bytes, not negative) of the buffer for every dimension.
+ * @param buffersize The size (in bytes) of the buffer, from its first item.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_to_cbuffer_strided(const b2nd_array_t *array, void *buffer, const int64_t *bufferstrides,
+                                         int64_t buffersize);
+
 /**
  * @brief Get a slice from an array and store it into a new array.
  *
@@ -375,6 +416,45 @@ BLOSC_EXPORT int b2nd_get_slice_cbuffer(const b2nd_array_t *array, const int64_t
 BLOSC_EXPORT int b2nd_set_slice_cbuffer(const void *buffer, const int64_t *buffershape, int64_t buffersize,
                                         const int64_t *start, const int64_t *stop, b2nd_array_t *array);
 
+/**
+ * @brief Get a slice from an array and store it into a buffer with arbitrary strides (e.g. in
+ * Fortran order, or a NumPy view).
+ *
+ * The items are scattered into the buffer right from the decompressed blocks, so no
+ * C-contiguous copy of the slice is made.
+ *
+ * @param array The array from which the slice will be extracted.
+ * @param start The coordinates where the slice will begin.
+ * @param stop The coordinates where the slice will end.
+ * @param buffer The buffer where the data will be stored, pointing to the item at @p start.
+ * @param bufferstrides The strides (in bytes, not negative) of the buffer for every dimension.
+ * @param buffersize The size (in bytes) of the buffer, from the item at @p start.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_get_slice_cbuffer_strided(const b2nd_array_t *array, const int64_t *start,
+                                                const int64_t *stop, void *buffer,
+                                                const int64_t *bufferstrides, int64_t buffersize);
+
+/**
+ * @brief Set a slice in a b2nd array using a buffer with arbitrary strides (see
+ * b2nd_get_slice_cbuffer_strided()).
+ *
+ * The items are gathered from the buffer right into the blocks to be compressed.
+ *
+ * @param buffer The buffer where the slice data is, pointing to the item at @p start.
+ * @param bufferstrides The strides (in bytes, not negative) of the buffer for every dimension.
+ * @param buffersize The size (in bytes) of the buffer, from the item at @p start.
+ * @param start The coordinates where the slice will begin.
+ * @param stop The coordinates where the slice will end.
+ * @param array The b2nd array where the slice will be set
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_set_slice_cbuffer_strided(const void *buffer, const int64_t *bufferstrides,
+                                                int64_t buffersize, const int64_t *start,
+                                                const int64_t *stop, b2nd_array_t *array);
+
 /**
  * @brief Make a copy of the array data. The copy is done into a new b2nd array.
  *
@@ -389,6 +469,116 @@ BLOSC_EXPORT int b2nd_set_slice_cbuffer(const void *buffer, const int64_t *buffe
  */
 BLOSC_EXPORT int b2nd_copy(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array);
 
+/**
+ * @brief Make a copy of the array data with other chunkshape and blockshape (a rechunk).
+ *
+ * The copy goes in tiles made of whole chunks of the new array, so these are compressed once
+ * without reading them back, and aligned with the chunks of @p src when the budget allows, so
+ * these are decompressed once.  The chunks of every tile are read and written by all the
+ * threads of the arrays. Only a tile is kept in memory, so arrays on disk larger than the
+ * memory can be rechunked into new arrays on disk.
+ *
+ * @param ctx The b2nd context for the new array.
+ * @param src The array from which data is copied.
+ * @param max_memory The memory budget (in bytes), or 0 for #B2ND_RECHUNK_MEMORY. It includes
+ * the tile and a chunk buffer of every array for every thread. A tile holds at least a chunk of
+ * the new array, so the budget may be exceeded when it is smaller than that.
+ * @param array The memory pointer where the array will be created.
+ *
+ * @return An error code
+ *
+ * @note The ndim and shape in ctx will be overwritten by the src ctx.
+ *
+ */
+BLOSC_EXPORT int b2nd_rechunk(b2nd_context_t *ctx, const b2nd_array_t *src, int64_t max_memory,
+                              b2nd_array_t **array);
+
+/**
+ * @brief Make a copy of the array data with its axes permuted (like NumPy's `transpose(axes)`).
+ *
+ * The copy goes chunk by chunk of the new array: the blocks of the chunks of @p src that it
+ * overlaps are decompressed and permuted one at a time, and then the chunk is compressed once.
+ * Chunks are spread over the threads of the arrays, each one using a few chunks of memory. When
+ * the chunkshape of the new array is the one of @p src permuted, every chunk of @p src is
+ * decompressed once.
+ *
+ * @param ctx The b2nd context for the new array. Its typesize must be the one of @p src.
+ * @param src The array from which data is copied.
+ * @param axes The axis of @p src that every axis of the new array goes along.
+ * @param array The memory pointer where the array will be created.
+ *
+ * @return An error code
+ *
+ * @note The ndim and shape in ctx will be overwritten (with the permuted shape of src).
+ *
+ */
+BLOSC_EXPORT int b2nd_permute_axes(b2nd_context_t *ctx, const b2nd_array_t *src, const int8_t *axes,
+                                   b2nd_array_t **array);
+
+/**
+ * @brief Make a copy of the array data with its axes reversed (see b2nd_permute_axes()).
+ *
+ * @param ctx The b2nd context for the new array. Its typesize must be the one of @p src.
+ * @param src The array from which data is copied.
+ * @param array The memory pointer where the array will be created.
+ *
+ * @return An error code
+ *
+ * @note The ndim and shape in ctx will be overwritten (with the reversed shape of src).
+ *
+ */
+BLOSC_EXPORT int b2nd_transpose(b2nd_context_t *ctx, const b2nd_array_t *src, b2nd_array_t **array);
+
+/**
+ * @brief Make a new array out of several ones, one after the other along an axis (like
+ * NumPy's `concatenate`).
+ *
+ * The new array goes chunk by chunk. When an array has the chunkshape, blockshape and
+ * compression parameters of the new one, and it starts at a chunk boundary of it (e.g. along
+ * the first axis when the arrays before it fill whole chunks), its chunks are copied still
+ * compressed. Only the chunks of the new array that straddle several arrays, or that come from
+ * arrays laid out otherwise, are gathered and compressed again.
+ *
+ * @param ctx The b2nd context for the new array. Its typesize must be the one of @p srcs.
+ * @param srcs The arrays from which data is copied (not modified). They must have the same
+ * typesize and shape, but along @p axis.
+ * @param nsrcs The number of arrays in @p srcs.
+ * @param axis The axis along which the arrays are concatenated.
+ * @param array The memory pointer where the array will be created.
+ *
+ * @return An error code
+ *
+ * @note The ndim and shape in ctx will be overwritten (with the ones of the concatenation).
+ *
+ */
+BLOSC_EXPORT int b2nd_concatenate(b2nd_context_t *ctx, b2nd_array_t **srcs, int nsrcs, int8_t axis,
+                                  b2nd_array_t **array);
+
+/**
+ * @brief Make a new array out of several ones with the same shape, stacked along a new axis
+ * (like NumPy's `stack`).
+ *
+ * It works like b2nd_concatenate() on the arrays with a new axis of length 1. When the new
+ * array has chunks and blocks of length 1 along @p axis, and otherwise the chunkshape,
+ * blockshape and compression parameters of the arrays, all the chunks are copied still
+ * compressed.
+ *
+ * @param ctx The b2nd context for the new array, with a dimension more than @p srcs. Its
+ * typesize must be the one of @p srcs.
+ * @param srcs The arrays from which data is copied (not modified). They must have the same
+ * typesize and shape.
+ * @param nsrcs The number of arrays in @p srcs.
+ * @param axis The axis of the new array along which the arrays are stacked.
+ * @param array The memory pointer where the array will be created.
+ *
+ * @return An error code
+ *
+ * @note The ndim and shape in ctx will be overwritten (with the ones of the stack).
+ *
+ */
+BLOSC_EXPORT int b2nd_stack(b2nd_context_t *ctx, b2nd_array_t **srcs, int nsrcs, int8_t axis,
+                            b2nd_array_t **array);
+
 /**
  * @brief Print metalayer parameters.
  *
@@ -437,6 +627,80 @@ BLOSC_EXPORT int b2nd_insert(b2nd_array_t *array, const void *buffer, int64_t bu
 BLOSC_EXPORT int b2nd_append(b2nd_array_t *array, const void *buffer, int64_t buffersize,
                              int8_t axis);
 
+/**
+ * @brief Create an append buffer for adding rows (along axis 0) to an array a few at a time.
+ *
+ * The rows go to a buffer in memory for the trailing chunk row (the chunks with the same
+ * coordinate along axis 0). Every time that it gets full, its chunks are compressed once and
+ * appended to the super-chunk, which is much cheaper than resizing the array and setting a slice
+ * for every append. The rows in memory are written to the array by b2nd_appender_flush() and
+ * b2nd_appender_free(), and meanwhile b2nd_appender_get_slice_cbuffer() reads them too.
+ *
+ * @param array The array to append the rows to. It must not be modified by other means until the
+ * append buffer is freed, and its shape only includes the rows that have been written to it.
+ * @param appender The pointer where the append buffer will be created.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_appender_new(b2nd_array_t *array, b2nd_appender_t **appender);
+
+/**
+ * @brief Append some rows to an array through its append buffer.
+ *
+ * @param appender The append buffer.
+ * @param buffer The rows, in C order.
+ * @param buffersize The size (in bytes) of the buffer. It must be a multiple of the size of a row.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_appender_append(b2nd_appender_t *appender, const void *buffer,
+                                      int64_t buffersize);
+
+/**
+ * @brief Write the rows kept in memory by an append buffer to its array. They are still kept, so
+ * the trailing chunk row is compressed again when it gets full.
+ *
+ * @param appender The append buffer.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_appender_flush(b2nd_appender_t *appender);
+
+/**
+ * @brief Get the shape of an array including the rows appended through its append buffer.
+ *
+ * @param appender The append buffer.
+ * @param shape The buffer where the shape will be written.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_appender_get_shape(const b2nd_appender_t *appender, int64_t *shape);
+
+/**
+ * @brief Get a slice of an array including the rows appended through its append buffer.
+ *
+ * @param appender The append buffer.
+ * @param start The coordinates where the slice will begin.
+ * @param stop The coordinates where the slice will end.
+ * @param buffer The buffer for getting the data.
+ * @param buffershape The shape of the buffer.
+ * @param buffersize The size (in bytes) of the buffer.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_appender_get_slice_cbuffer(const b2nd_appender_t *appender, const int64_t *start,
+                                                 const int64_t *stop, void *buffer,
+                                                 const int64_t *buffershape, int64_t buffersize);
+
+/**
+ * @brief Flush and free an append buffer.
+ *
+ * @param appender The append buffer.
+ *
+ * @return An error code. The append buffer is freed anyway.
+ */
+BLOSC_EXPORT int b2nd_appender_free(b2nd_appender_t *appender);
+
 /**
  * @brief Delete shrinking the given axis delete_len items.
  *
@@ -492,6 +756,292 @@ BLOSC_EXPORT int b2nd_set_orthogonal_selection(b2nd_array_t *array, int64_t **se
                                                int64_t *selection_size, const void *buffer,
                                                int64_t *buffershape, int64_t buffersize);
 
+/**
+ * @brief Get the items at a list of coordinates of an array.
+ *
+ * The points are sorted by chunk and block, so every chunk is visited once and only the blocks
+ * holding some point are decompressed. The items are gathered as the blocks are decompressed,
+ * with several chunks going in parallel when the array has enough threads.
+ *
+ * @param array The array to get the data from.
+ * @param points The coordinates of the points, one after the other (`npoints` x `ndim` items).
+ * @param npoints The number of points.
+ * @param buffer The buffer for getting the items, in the order of the points.
+ * @param buffersize The buffer size (in bytes).
+ *
+ * @return An error code.
+ *
+ * @note See also b2nd_get_mask_selection.
+ */
+BLOSC_EXPORT int b2nd_get_point_selection(const b2nd_array_t *array, const int64_t *points,
+                                          int64_t npoints, void *buffer, int64_t buffersize);
+
+/**
+ * @brief Get the items of an array selected by a boolean mask.
+ *
+ * @param array The array to get the data from.
+ * @param mask The mask, with the shape of the array (in C order).
+ * @param buffer The buffer for getting the selected items, in C order.
+ * @param buffersize The buffer size (in bytes).
+ * @param nselected The pointer where the number of selected items will be written (if not NULL).
+ * It is written even if the buffer is too small.
+ *
+ * @return An error code.
+ *
+ * @note See also b2nd_get_point_selection.
+ */
+BLOSC_EXPORT int b2nd_get_mask_selection(const b2nd_array_t *array, const bool *mask, void *buffer,
+                                         int64_t buffersize, int64_t *nselected);
+
+
+// Reductions section
+
+/**
+ * @brief The reductions supported by b2nd_reduce().
+ */
+typedef enum {
+  B2ND_REDUCE_SUM,
+  //!< The sum of the items.
+  B2ND_REDUCE_MIN,
+  //!< The minimum of the items.
+  B2ND_REDUCE_MAX,
+  //!< The maximum of the items.
+  B2ND_REDUCE_MEAN,
+  //!< The mean of the items.
+  B2ND_REDUCE_COUNT,
+  //!< The number of items.
+} b2nd_reduce_op;
+
+/**
+ * @brief Reduce an array along an axis, or entirely.
+ *
+ * The blocks are reduced as they are decompressed (by all the threads of the decompression
+ * context), so the array is never materialized. Chunks of zeros, NaNs or a repeated value are
+ * reduced without decompressing them, and uninitialized chunks are skipped.
+ *
+ * NaNs are ignored, as in the nan* functions of NumPy: #B2ND_REDUCE_COUNT gives the number of
+ * items that are not NaN, and the minimum, maximum and mean of no items are NaN.
+ *
+ * @param array The array to reduce. Its dtype must be a NumPy one for (little-endian) integers,
+ * unsigned integers, floats or booleans.
+ * @param op The reduction.
+ * @param axis The axis to reduce, or -1 to reduce all the items into a single value.
+ * @param buffer The buffer for the result, with the shape of the array without @p axis.
+ * @param buffersize The buffer size (in bytes).
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_reduce(const b2nd_array_t *array, b2nd_reduce_op op, int8_t axis,
+                             double *buffer, int64_t buffersize);
+
+// Queries section
+
+/**
+ * @brief The predicates supported by b2nd_query().
+ */
+typedef enum {
+  B2ND_QUERY_LT,
+  //!< The items lower than the value.
+  B2ND_QUERY_LE,
+  //!< The items lower than or equal to the value.
+  B2ND_QUERY_GT,
+  //!< The items greater than the value.
+  B2ND_QUERY_GE,
+  //!< The items greater than or equal to the value.
+  B2ND_QUERY_EQ,
+  //!< The items equal to the value.
+} b2nd_query_op;
+
+/**
+ * @brief Build the zone map of an array.
+ *
+ * The zone map keeps the minimum, the maximum and the number of NaNs of every chunk and every
+ * block of the array, in the `b2nd_zonemap` vlmetalayer. b2nd_query() uses it to skip the chunks
+ * and blocks that cannot hold any matching item.
+ *
+ * Once built, the zone map is kept up to date in memory when setting slices or orthogonal
+ * selections, and it is stored again when the array is freed, serialized or copied. It is dropped
+ * when the shape of the array changes. Every chunk has a fingerprint in the zone map, so the
+ * chunks written without the b2nd API (e.g. updating the chunks of the super-chunk directly) are
+ * scanned in full by b2nd_query() until the zone map is built again.
+ *
+ * @param array The array. Its dtype must be a NumPy one for (little-endian) integers, unsigned
+ * integers, floats or booleans.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_build_zonemap(b2nd_array_t *array);
+
+/**
+ * @brief Find the items of an array that satisfy a predicate.
+ *
+ * The chunks and blocks that the zone map of the array (see b2nd_build_zonemap()) rules out are
+ * not decompressed, and the other blocks are scanned as they are decompressed. Items are
+ * compared as doubles, and NaNs never match.
+ *
+ * @param array The array.
+ * @param op The predicate.
+ * @param value The value to compare the items with.
+ * @param indexes The pointer where a malloc'ed buffer with the (C-order, sorted) indexes of the
+ * matching items will be written. It has to be freed by the caller.
+ * @param nindexes The number of matching items.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_query(const b2nd_array_t *array, b2nd_query_op op, double value,
+                            int64_t **indexes, int64_t *nindexes);
+
+// Expressions section
+
+/**
+ * @brief The instructions of the expressions evaluated by b2nd_eval().
+ */
+typedef enum {
+  B2ND_EXPR_OPERAND,
+  //!< Push the items of an operand.
+  B2ND_EXPR_CONSTANT,
+  //!< Push a constant.
+  B2ND_EXPR_ADD,
+  //!< Pop b and a, and push a + b.
+  B2ND_EXPR_SUB,
+  //!< Pop b and a, and push a - b.
+  B2ND_EXPR_MUL,
+  //!< Pop b and a, and push a * b.
+  B2ND_EXPR_DIV,
+  //!< Pop b and a, and push a / b.
+  B2ND_EXPR_NEG,
+  //!< Pop a, and push -a.
+} b2nd_expr_opcode;
+
+/**
+ * @brief An instruction of an expression, which is a program for a stack machine in postfix
+ * order (`a*b + c` is OPERAND 0, OPERAND 1, MUL, OPERAND 2, ADD).
+ */
+typedef struct {
+  b2nd_expr_opcode opcode;
+  //!< The operation.
+  int32_t operand;
+  //!< The index of the operand pushed by #B2ND_EXPR_OPERAND.
+  double value;
+  //!< The constant pushed by #B2ND_EXPR_CONSTANT.
+} b2nd_expr_instr;
+
+/**
+ * @brief Evaluate an element-wise expression over some arrays into a new array.
+ *
+ * The expression is fused: every block of the result is computed in the prefilter of the
+ * compression of its chunk (by all the threads of the compression context), out of the same
+ * block of every operand, which is decompressed on its own. So there are no temporaries with the
+ * size of the arrays, and the memory needed is a few blocks per thread. The chunks where all the
+ * operands are constant (zeros, NaNs or a repeated value) give constant chunks without
+ * evaluating any block.
+ *
+ * The items are computed as doubles, and then converted to the dtype of the result as C casts do.
+ *
+ * @param ctx The b2nd context for the result. Its shape, chunkshape and blockshape have to be
+ * the ones of all the operands.
+ * @param array The memory pointer where the result will be created.
+ * @param operands The operands. Their dtypes must be NumPy ones for (little-endian) integers,
+ * unsigned integers, floats or booleans, as well as the one of the result.
+ * @param noperands The number of operands.
+ * @param program The instructions of the expression. They must leave a single value in the
+ * stack.
+ * @param ninstrs The number of instructions.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_eval(b2nd_context_t *ctx, b2nd_array_t **array, b2nd_array_t **operands,
+                           int32_t noperands, const b2nd_expr_instr *program, int32_t ninstrs);
+
+// Pyramids section
+
+/**
+ * @brief The ways of downsampling the levels of a pyramid built by b2nd_pyramid_build().
+ */
+typedef enum {
+  B2ND_PYRAMID_MEAN,
+  //!< The mean of every window (rounded to the nearest integer for integer dtypes).
+  B2ND_PYRAMID_MAX,
+  //!< The maximum of every window (NaNs win, like in NumPy).
+  B2ND_PYRAMID_STRIDE,
+  //!< The first item of every window.
+} b2nd_pyramid_op;
+
+/**
+ * @brief Build a pyramid of downsampled levels of an array.
+ *
+ * Every level is computed out of the previous one (the first one, out of the array) by
+ * downsampling windows of @p factor items along every dimension, so its shape is the one of the
+ * previous level divided by @p factor (rounding up). The levels have the dtype, chunkshape,
+ * blockshape (clipped to their shape) and compression params of the array. They are kept next to
+ * persistent arrays (as `<urlpath>.level<n>`). In-memory arrays keep them as arrays of their own,
+ * and store them in their vlmetalayers when they are serialized (see b2nd_to_cframe()). The
+ * pyramid itself is described in the `b2nd_pyramid` vlmetalayer. An existing pyramid is replaced.
+ *
+ * Once built, the levels are updated incrementally when setting slices or orthogonal selections
+ * of the array (see b2nd_pyramid_update()). The pyramid goes stale when the shape of the array
+ * changes, and it has to be built again then.
+ *
+ * Every such write downsamples the windows it touches in every level. When writing an array with
+ * many small slices, it is cheaper to drop the pyramid (see b2nd_pyramid_drop()) and build it
+ * again afterwards.
+ *
+ * @param array The array.
+ * @param nlevels The number of levels.
+ * @param factor The downsampling factor (2 at least).
+ * @param op The way of downsampling. Averaging and taking maximums need a NumPy dtype for
+ * (little-endian) integers, unsigned integers, floats or booleans.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_pyramid_build(b2nd_array_t *array, int8_t nlevels, int32_t factor,
+                                    b2nd_pyramid_op op);
+
+/**
+ * @brief Get the number of levels of the pyramid of an array.
+ *
+ * @param array The array.
+ * @param nlevels The number of levels. It is 0 when the array has no pyramid, or when it is stale.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_pyramid_nlevels(const b2nd_array_t *array, int8_t *nlevels);
+
+/**
+ * @brief Open a level of the pyramid of an array.
+ *
+ * @param array The array.
+ * @param level The level, between 1 (the finest) and the number of levels.
+ * @param larray The memory pointer where the level will be opened. It has to be freed with
+ * b2nd_free(), and it is meant for reading only.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_pyramid_open_level(const b2nd_array_t *array, int8_t level,
+                                         b2nd_array_t **larray);
+
+/**
+ * @brief Compute again the windows of the levels of the pyramid of an array that cover a region.
+ *
+ * This is done when setting slices or orthogonal selections, so it is only needed after writing
+ * chunks without the b2nd API. It does nothing when the array has no pyramid, or when it is stale.
+ *
+ * @param array The array.
+ * @param start The start of the region that has changed.
+ * @param stop The stop of the region that has changed.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_pyramid_update(b2nd_array_t *array, const int64_t *start, const int64_t *stop);
+
+/**
+ * @brief Remove the pyramid of an array (if any), along with its levels.
+ *
+ * @param array The array.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int b2nd_pyramid_drop(b2nd_array_t *array);
 
 /**
  * @brief Create the metainfo for the b2nd metalayer.
@@ -137,13 +137,15 @@ enum {
      3 -> Blosc 2-alpha.x series
      4 -> Blosc 2.x beta.1 series
      5 -> Blosc 2.x stable series
+     6 -> Blosc 2.x stable series, with block checksums (only used by chunks carrying them)
      */
   BLOSC1_VERSION_FORMAT_PRE1 = 1,
   BLOSC1_VERSION_FORMAT = 2,
   BLOSC2_VERSION_FORMAT_ALPHA = 3,
   BLOSC2_VERSION_FORMAT_BETA1 = 4,
   BLOSC2_VERSION_FORMAT_STABLE = 5,
-  BLOSC2_VERSION_FORMAT = BLOSC2_VERSION_FORMAT_STABLE,
+  BLOSC2_VERSION_FORMAT_CHECKSUMS = 6,
+  BLOSC2_VERSION_FORMAT = BLOSC2_VERSION_FORMAT_CHECKSUMS,
 };
 
 
@@ -419,9 +421,22 @@ enum {
   BLOSC2_CHUNK_CBYTES = 0xc,        //!< (int32) compressed size of the buffer (including this header)
   BLOSC2_CHUNK_FILTER_CODES = 0x10, //!< the codecs for the filter pipeline (1 byte per code)
   BLOSC2_CHUNK_FILTER_META = 0x18,  //!< meta info for the filter pipeline (1 byte per code)
+  BLOSC2_CHUNK_BLOSC2_FLAGS2 = 0x1E,  //!< more flags specific for Blosc2 functionality
   BLOSC2_CHUNK_BLOSC2_FLAGS = 0x1F, //!< flags specific for Blosc2 functionality
 };
 
+/**
+ * @brief Checksums that can be stored for every block in a chunk.
+ *
+ * The kind of checksum is kept in the lower bits of the #BLOSC2_CHUNK_BLOSC2_FLAGS2
+ * header byte.
+ */
+enum {
+  BLOSC2_CHECKSUM_NONE = 0x0,    //!< no checksums
+  BLOSC2_CHECKSUM_CRC32C = 0x1,  //!< CRC-32C of the compressed bytes of every block
+  BLOSC2_CHECKSUM_MASK = 0x3     //!< checksum kind mask (prev IDs cannot be larger than this)
+};
+
 /**
  * @brief Run lengths for special values for chunks/frames
  */
@@ -478,6 +493,8 @@ enum {
   BLOSC2_ERROR_METALAYER_NOT_FOUND = -34,   //!< Metalayer has not been found
   BLOSC2_ERROR_MAX_BUFSIZE_EXCEEDED = -35,  //!< Max buffer size exceeded
   BLOSC2_ERROR_TUNER = -36,           //!< Tuner failure
+  BLOSC2_ERROR_READ_ONLY = -37,       //!< Write attempted on a read-only super-chunk
+  BLOSC2_ERROR_CHECKSUM = -38,        //!< Checksum mismatch
 };
 
 
@@ -560,6 +577,10 @@ static char *print_error(int rc) {
       return (char *) "Metalayer has not been found";
     case BLOSC2_ERROR_MAX_BUFSIZE_EXCEEDED:
       return (char *) "Maximum buffersize exceeded";
+    case BLOSC2_ERROR_READ_ONLY:
+      return (char *) "Write attempted on a read-only super-chunk";
+    case BLOSC2_ERROR_CHECKSUM:
+      return (char *) "Checksum mismatch";
     default:
       return (char *) "Unknown error";
   }
@@ -968,6 +989,21 @@ BLOSC_EXPORT int blosc2_cbuffer_sizes(const void* cbuffer, int32_t* nbytes,
 BLOSC_EXPORT int blosc1_cbuffer_validate(const void* cbuffer, size_t cbytes,
                                          size_t* nbytes);
 
+/**
+ * @brief Verify the block checksums stored in a chunk without decompressing it.
+ *
+ * Checksums are only stored when the chunk has been compressed with a
+ * blosc2_cparams.checksum different from #BLOSC2_CHECKSUM_NONE.
+ *
+ * @param src The chunk to be verified.
+ * @param srcsize The size (in bytes) of the @p src buffer.
+ *
+ * @return The number of blocks verified (0 if the chunk does not carry checksums).
+ * If the data of any block does not match its checksum, #BLOSC2_ERROR_CHECKSUM
+ * is returned.  Any other negative value means an invalid chunk.
+ */
+BLOSC_EXPORT int blosc2_chunk_verify(const void* src, int32_t srcsize);
+
 /**
  * @brief Get information about a compressed buffer, namely the type size
  * (@p typesize), as well as some internal @p flags.
@@ -1233,6 +1269,8 @@ typedef struct {
   //!< User defined parameters for the codec
   void *filter_params[BLOSC2_MAX_FILTERS];
   //!< User defined parameters for the filters
+  uint8_t checksum;
+  //!< The checksum to store for every block (#BLOSC2_CHECKSUM_NONE).
 } blosc2_cparams;
 
 /**
@@ -1244,7 +1282,8 @@ static const blosc2_cparams BLOSC2_CPARAMS_DEFAULTS = {
         {0, 0, 0, 0, 0, BLOSC_SHUFFLE},
         {0, 0, 0, 0, 0, 0},
         NULL, NULL, NULL, 0, 0,
-        NULL, {NULL, NULL, NULL, NULL, NULL, NULL}
+        NULL, {NULL, NULL, NULL, NULL, NULL, NULL},
+        BLOSC2_CHECKSUM_NONE
         };
 
 
@@ -1263,12 +1302,14 @@ typedef struct {
   //!< The postfilter function.
   blosc2_postfilter_params *postparams;
   //!< The postfilter parameters.
+  bool verify_checksums;
+  //!< Whether to verify the block checksums (if any) while decompressing (false).
 } blosc2_dparams;
 
 /**
  * @brief Default struct for decompression params meant for user initialization.
  */
-static const blosc2_dparams BLOSC2_DPARAMS_DEFAULTS = {1, NULL, NULL, NULL};
+static const blosc2_dparams BLOSC2_DPARAMS_DEFAULTS = {1, NULL, NULL, NULL, false};
 
 /**
  * @brief Create a context for @a *_ctx() compression functions.
@@ -1532,6 +1573,8 @@ BLOSC_EXPORT int blosc2_compress_ctx(
  * @p block_maskout parameter will be honored for just *one single* shot;
  * i.e. the maskout in context will be automatically reset to NULL, so
  * mask won't be used next time (unless #blosc2_set_maskout is called again).
+ * Masked out blocks are not written, so @p dest only needs to reach the end
+ * of the last block that is not masked out.
  *
  * @return The number of bytes decompressed (i.e. the maskout blocks are not
  * counted). If an error occurs, e.g. the compressed data is corrupted,
@@ -1770,6 +1813,23 @@ BLOSC_EXPORT blosc2_schunk* blosc2_schunk_new(blosc2_storage *storage);
  */
 BLOSC_EXPORT blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_storage *storage);
 
+/**
+ * @brief Create a copy of a super-chunk encoded with different compression parameters.
+ *
+ * The chunks are transcoded in parallel by `storage->cparams->nthreads` threads and
+ * appended in order to the new super-chunk.  At most twice as many transcoded chunks
+ * as threads are kept in memory at any time.  Special chunks (zeros, NaNs, uninit)
+ * and chunks that are already encoded with the target parameters are passed through
+ * without decompressing them.
+ *
+ * @param schunk The super-chunk to be recompressed.
+ * @param storage The storage properties of the new super-chunk.  `storage->cparams`
+ * cannot be NULL.
+ *
+ * @return The new super-chunk.  If an error occurs, NULL is returned.
+ */
+BLOSC_EXPORT blosc2_schunk* blosc2_schunk_recompress(blosc2_schunk *schunk, blosc2_storage *storage);
+
 /**
  * @brief Create a super-chunk out of a contiguous frame buffer.
  *
@@ -1789,6 +1849,27 @@ BLOSC_EXPORT blosc2_schunk* blosc2_schunk_copy(blosc2_schunk *schunk, blosc2_sto
  */
 BLOSC_EXPORT blosc2_schunk* blosc2_schunk_from_buffer(uint8_t *cframe, int64_t len, bool copy);
 
+/**
+ * @brief Create a read-only super-chunk that is a view of a contiguous frame buffer.
+ *
+ * Nothing is copied: chunks returned by #blosc2_schunk_get_chunk and the
+ * `content` of the metalayers and vlmetalayers in the super-chunk point
+ * straight into @p cframe (vlmetalayers are still compressed there, so
+ * #blosc2_vlmeta_get returns a decompressed copy as usual).  This is meant
+ * for frames mapped into memory with mmap() or similar, which can then be
+ * opened at almost no cost, regardless of their size.
+ *
+ * @param cframe The buffer of the in-memory frame.  It is not owned by the
+ * super-chunk and must outlive it.
+ * @param len The length of the buffer (in bytes).
+ *
+ * @remark Any operation that would modify the super-chunk fails with
+ * #BLOSC2_ERROR_READ_ONLY.
+ *
+ * @return The new super-chunk.  If an error occurs, NULL is returned.
+ */
+BLOSC_EXPORT blosc2_schunk* blosc2_schunk_from_buffer_view(const uint8_t *cframe, int64_t len);
+
 /**
  * @brief Set the private `avoid_cframe_free` field in a frame.
  *
@@ -1862,6 +1943,63 @@ BLOSC_EXPORT int64_t blosc2_schunk_to_file(blosc2_schunk* schunk, const char* ur
  */
 BLOSC_EXPORT int64_t blosc2_schunk_append_file(blosc2_schunk* schunk, const char* urlpath);
 
+/**
+ * @brief Writer of streamed frames (opaque type).
+ *
+ * A streamed frame is a contiguous frame whose chunks are written strictly
+ * append-only, with the index, the trailer and a fixed-size footer at the end,
+ * so that it can be produced without ever seeking back (e.g. into a socket or an
+ * object store).  For details see `README_CFRAME_FORMAT.rst`.
+ */
+typedef struct blosc2_frame_writer_s blosc2_frame_writer;
+
+/**
+ * @brief Start writing a streamed frame.
+ *
+ * @param schunk The super-chunk used as a template.  Its compression parameters, metalayers
+ * and variable-length metalayers are stored in the new frame.  The writer does not take
+ * ownership of it, and it must outlive the writer.
+ * @param urlpath The path where the frame will be written.
+ * @param io The input/output backend.  Only its `open`, `write` and `close` callbacks are used.
+ * If NULL, the default one is used.
+ *
+ * @return The new writer or NULL if some problem is detected.
+ */
+BLOSC_EXPORT blosc2_frame_writer* blosc2_frame_writer_new(blosc2_schunk* schunk, const char* urlpath,
+                                                          const blosc2_io* io);
+
+/**
+ * @brief Compress a buffer and append it as a new chunk of a streamed frame.
+ *
+ * @param writer The frame writer.
+ * @param src The buffer of data to compress.
+ * @param nbytes The size of the @p src buffer.
+ *
+ * @return The number of chunks in the frame. If some problem is detected, this number will be negative.
+ */
+BLOSC_EXPORT int64_t blosc2_frame_writer_append_buffer(blosc2_frame_writer* writer, const void* src,
+                                                       int32_t nbytes);
+
+/**
+ * @brief Append an existing @p chunk to a streamed frame.
+ *
+ * @param writer The frame writer.
+ * @param chunk The chunk to append.  Only the last chunk of a frame can be smaller than the
+ * chunksize of the frame.
+ *
+ * @return The number of chunks in the frame. If some problem is detected, this number will be negative.
+ */
+BLOSC_EXPORT int64_t blosc2_frame_writer_append_chunk(blosc2_frame_writer* writer, const uint8_t* chunk);
+
+/**
+ * @brief Write the index, the trailer and the footer of a streamed frame and free the writer.
+ *
+ * @param writer The frame writer.
+ *
+ * @return The total size of the streamed frame. If some problem is detected, a negative value.
+ */
+BLOSC_EXPORT int64_t blosc2_frame_writer_close(blosc2_frame_writer* writer);
+
 /**
  * @brief Release resources from a super-chunk.
  *
@@ -2006,6 +2144,55 @@ BLOSC_EXPORT int blosc2_schunk_get_chunk(blosc2_schunk *schunk, int64_t nchunk,
 BLOSC_EXPORT int blosc2_schunk_get_lazychunk(blosc2_schunk *schunk, int64_t nchunk, uint8_t **chunk,
                                              bool *needs_free);
 
+/**
+ * @brief Iterator over the decompressed chunks of a super-chunk (opaque type).
+ *
+ * The chunks are fetched and decompressed by a background thread into a small ring
+ * of buffers, so that the next chunks are ready while the current one is processed.
+ */
+typedef struct blosc2_schunk_iter_s blosc2_schunk_iter;
+
+/**
+ * @brief Create an iterator over the decompressed chunks of a super-chunk.
+ *
+ * Decompression uses a new context with the same parameters (and threads) than
+ * the decompression context of @p schunk.
+ *
+ * @param schunk The super-chunk to iterate over.
+ * @param nbuffers The number of chunks that can be decompressed in advance plus the one
+ * being processed by the caller (at least 2).
+ *
+ * @warning The super-chunk must not be modified nor used for reading chunks from
+ * other threads while the iterator is alive.
+ *
+ * @return The new iterator or NULL if some problem is detected.
+ */
+BLOSC_EXPORT blosc2_schunk_iter *blosc2_schunk_iter_new(blosc2_schunk *schunk, int nbuffers);
+
+/**
+ * @brief Get the next decompressed chunk of the iteration.
+ *
+ * @param iter The iterator.
+ * @param nchunk Pointer where the number of the chunk will be stored (can be NULL).
+ * @param dest Pointer where the decompressed data will be referenced. This buffer is owned by the
+ * iterator and it is only valid until the next call to this function.
+ * @param nbytes Pointer where the size of the decompressed chunk will be stored.
+ *
+ * @return 1 if a new chunk is available, 0 if the iteration is exhausted. If some problem is
+ * detected, a negative code is returned instead.
+ */
+BLOSC_EXPORT int blosc2_schunk_iter_next(blosc2_schunk_iter *iter, int64_t *nchunk, uint8_t **dest,
+                                         int32_t *nbytes);
+
+/**
+ * @brief Stop the background decompression and release the resources of an iterator.
+ *
+ * @param iter The iterator to free.
+ *
+ * @return An error code.
+ */
+BLOSC_EXPORT int blosc2_schunk_iter_free(blosc2_schunk_iter *iter);
+
 /**
  * @brief Fill buffer with a schunk slice.
  *
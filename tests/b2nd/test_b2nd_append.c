@@ -54,8 +54,7 @@ CUTEST_TEST_SETUP(append) {
       {2, {0, 6}, {6, 6}, {3, 6}, {6, 6}, 0},
       {2, {0, 6}, {6, 6}, {4, 6}, {6, 6}, 0},
       {2, {0, 6}, {6, 6}, {3, 6}, {13, 6}, 0},
-      // The one below is not supported yet
-      // {2, {0, 6}, {6, 6}, {4, 6}, {13, 6}, 0},
+      {2, {0, 6}, {6, 6}, {4, 6}, {13, 6}, 0},
   ));
 }
 
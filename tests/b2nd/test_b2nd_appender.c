@@ -0,0 +1,132 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+
+CUTEST_TEST_SETUP(appender) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {1, {0}, {10}, {3}},
+      {1, {7}, {10}, {10}},
+      {2, {0, 6}, {4, 6}, {4, 6}},
+      {2, {5, 10}, {4, 4}, {3, 2}},
+      {3, {3, 7, 5}, {6, 3, 5}, {4, 3, 2}},
+  ));
+  CUTEST_PARAMETRIZE(nrows, int64_t, CUTEST_DATA(1, 5, 17));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(appender) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(nrows, int64_t);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_appender.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  blosc2_storage b2_storage = {.cparams=&cparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, NULL, 0, NULL, 0);
+
+  int64_t row_nitems = 1;
+  for (int i = 1; i < shapes.ndim; ++i) {
+    row_nitems *= shapes.shape[i];
+  }
+  int64_t row_nbytes = row_nitems * typesize;
+
+  /* The expected contents: the original rows followed by 4 appends of nrows, nrows + 1, ... */
+  int64_t nappends = 4;
+  int64_t total_nrows = shapes.shape[0];
+  for (int64_t i = 0; i < nappends; ++i) {
+    total_nrows += nrows + i;
+  }
+  uint8_t *expected = malloc(total_nrows * row_nbytes);
+  CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(expected, typesize, total_nrows * row_nitems));
+
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, expected, shapes.shape[0] * row_nbytes));
+
+  b2nd_appender_t *appender;
+  B2ND_TEST_ASSERT(b2nd_appender_new(src, &appender));
+  int64_t nrows_appended = shapes.shape[0];
+  uint8_t *buffer = malloc(total_nrows * row_nbytes);
+  for (int64_t i = 0; i < nappends; ++i) {
+    int64_t nrows_append = nrows + i;
+    B2ND_TEST_ASSERT(b2nd_appender_append(appender, &expected[nrows_appended * row_nbytes],
+                                          nrows_append * row_nbytes));
+    nrows_appended += nrows_append;
+
+    /* The pending rows can be read back */
+    int64_t shape[B2ND_MAX_DIM];
+    B2ND_TEST_ASSERT(b2nd_appender_get_shape(appender, shape));
+    CUTEST_ASSERT("Wrong shape", shape[0] == nrows_appended);
+    int64_t start[B2ND_MAX_DIM] = {0};
+    start[0] = nrows_appended / 3;
+    int64_t buffershape[B2ND_MAX_DIM];
+    for (int j = 0; j < shapes.ndim; ++j) {
+      buffershape[j] = shape[j] - start[j];
+    }
+    int64_t buffersize = (nrows_appended - start[0]) * row_nbytes;
+    B2ND_TEST_ASSERT(b2nd_appender_get_slice_cbuffer(appender, start, shape, buffer, buffershape,
+                                                     buffersize));
+    for (int64_t j = 0; j < buffersize; ++j) {
+      CUTEST_ASSERT("Wrong pending item", buffer[j] == expected[start[0] * row_nbytes + j]);
+    }
+    if (i == 1) {
+      B2ND_TEST_ASSERT(b2nd_appender_flush(appender));
+      CUTEST_ASSERT("Wrong flushed shape", src->shape[0] == nrows_appended);
+    }
+  }
+  CUTEST_ASSERT("The buffer size must be valid", b2nd_appender_append(appender, expected, -row_nbytes) < 0);
+  B2ND_TEST_ASSERT(b2nd_appender_free(appender));
+
+  /* Check the array, reopening it when it is persistent */
+  if (backend.persistent) {
+    B2ND_TEST_ASSERT(b2nd_free(src));
+    B2ND_TEST_ASSERT(b2nd_open(urlpath, &src));
+  }
+  CUTEST_ASSERT("Wrong shape", src->shape[0] == total_nrows);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(src, buffer, total_nrows * row_nbytes));
+  for (int64_t i = 0; i < total_nrows * row_nbytes; ++i) {
+    CUTEST_ASSERT("Wrong item", buffer[i] == expected[i]);
+  }
+
+  /* Free mallocs */
+  free(buffer);
+  free(expected);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(appender) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(appender);
+}
@@ -0,0 +1,217 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+
+#define NSRCS 3
+
+typedef struct {
+  int8_t ndim;
+  int64_t shape[B2ND_MAX_DIM];  // of the arrays, but along `axis`
+  int64_t lengths[NSRCS];       // of the arrays along `axis` (the first one when stacking)
+  int32_t chunkshape[B2ND_MAX_DIM];
+  int32_t blockshape[B2ND_MAX_DIM];
+  int8_t axis;
+} _test_concat;
+
+
+/* Check that `array` holds the items of the `buffers` of the arrays, one after the other */
+static int check_concat(b2nd_array_t *array, uint8_t **buffers, int64_t (*shapes)[B2ND_MAX_DIM],
+                        int8_t axis, bool stack, uint8_t typesize) {
+  int8_t ndim = array->ndim;
+  uint8_t *result = malloc(array->nitems > 0 ? array->nitems * typesize : 1);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(array, result, array->nitems * typesize));
+  for (int64_t nitem = 0; nitem < array->nitems; ++nitem) {
+    int64_t index[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, array->shape, nitem, index);
+    int s = 0;
+    int64_t offset = 0;
+    while (index[axis] >= offset + (stack ? 1 : shapes[s][axis])) {
+      offset += stack ? 1 : shapes[s][axis];
+      s++;
+    }
+    int64_t src_nitem = 0;
+    int i = 0;
+    for (int k = 0; k < ndim; ++k) {
+      if (stack && k == axis) {
+        continue;
+      }
+      src_nitem = src_nitem * shapes[s][i] + (k == axis ? index[k] - offset : index[k]);
+      i++;
+    }
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong item", result[nitem * typesize + j] == buffers[s][src_nitem * typesize + j]);
+    }
+  }
+  free(result);
+  return 0;
+}
+
+
+CUTEST_TEST_SETUP(concatenate) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_concat, CUTEST_DATA(
+      {1, {0}, {20, 10, 7}, {10}, {5}, 0},
+      {2, {0, 11}, {12, 5, 9}, {4, 6}, {2, 3}, 0},
+      {3, {6, 0, 5}, {4, 8, 3}, {3, 4, 5}, {3, 2, 5}, 1},
+      {3, {5, 4, 0}, {3, 0, 6}, {2, 2, 4}, {2, 2, 2}, 2},
+  ));
+  CUTEST_PARAMETRIZE(stack, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(same_chunks, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(concatenate) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_concat);
+  CUTEST_GET_PARAMETER(stack, bool);
+  CUTEST_GET_PARAMETER(same_chunks, bool);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpaths[NSRCS] = {"test_concatenate0.b2frame", "test_concatenate1.b2frame",
+                           "test_concatenate2.b2frame"};
+  char *urlpath_dest = "test_concatenate_dest.b2frame";
+  blosc2_remove_urlpath(urlpath_dest);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+
+  b2nd_array_t *srcs[NSRCS];
+  uint8_t *buffers[NSRCS];
+  int64_t src_shapes[NSRCS][B2ND_MAX_DIM];
+  for (int s = 0; s < NSRCS; ++s) {
+    blosc2_remove_urlpath(urlpaths[s]);
+    blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+    if (backend.persistent) {
+      b2_storage.urlpath = urlpaths[s];
+    }
+    b2_storage.contiguous = backend.contiguous;
+    int64_t nitems = 1;
+    for (int i = 0; i < shapes.ndim; ++i) {
+      src_shapes[s][i] = i == shapes.axis ? shapes.lengths[stack ? 0 : s] : shapes.shape[i];
+      nitems *= src_shapes[s][i];
+    }
+    b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, src_shapes[s], shapes.chunkshape,
+                                          shapes.blockshape, NULL, 0, NULL, 0);
+    buffers[s] = malloc(nitems > 0 ? nitems * typesize : 1);
+    for (int64_t j = 0; j < nitems * typesize; ++j) {
+      buffers[s][j] = (uint8_t) (j / 16 + s * 31);
+    }
+    B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &srcs[s], buffers[s], nitems * typesize));
+    B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  }
+
+  /* The new array has the chunks of the arrays, or larger ones */
+  int8_t ndim = (int8_t) (stack ? shapes.ndim + 1 : shapes.ndim);
+  int32_t chunkshape[B2ND_MAX_DIM];
+  int32_t blockshape[B2ND_MAX_DIM];
+  for (int k = 0, i = 0; k < ndim; ++k) {
+    if (stack && k == shapes.axis) {
+      chunkshape[k] = same_chunks ? 1 : 2;
+      blockshape[k] = 1;
+      continue;
+    }
+    chunkshape[k] = same_chunks ? shapes.chunkshape[i] : shapes.chunkshape[i] + 3;
+    blockshape[k] = shapes.blockshape[i];
+    i++;
+  }
+  blosc2_storage dest_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    dest_storage.urlpath = urlpath_dest;
+  }
+  dest_storage.contiguous = backend.contiguous;
+  int64_t shape[B2ND_MAX_DIM] = {0};
+  b2nd_context_t *dest_ctx = b2nd_create_ctx(&dest_storage, ndim, shape, chunkshape, blockshape, NULL,
+                                             0, NULL, 0);
+  b2nd_array_t *dest;
+  if (stack) {
+    B2ND_TEST_ASSERT(b2nd_stack(dest_ctx, srcs, NSRCS, shapes.axis, &dest));
+  } else {
+    B2ND_TEST_ASSERT(b2nd_concatenate(dest_ctx, srcs, NSRCS, shapes.axis, &dest));
+  }
+  CUTEST_ASSERT("Wrong ndim", dest->ndim == ndim);
+  int64_t length = 0;
+  for (int s = 0; s < NSRCS; ++s) {
+    length += stack ? 1 : src_shapes[s][shapes.axis];
+  }
+  CUTEST_ASSERT("Wrong shape", dest->shape[shapes.axis] == length);
+  if (check_concat(dest, buffers, src_shapes, shapes.axis, stack, typesize) != 0) {
+    return 1;
+  }
+  B2ND_TEST_ASSERT(b2nd_free(dest));
+  blosc2_remove_urlpath(urlpath_dest);
+
+  /* The chunks copied as they are must be encoded as the new array asks too */
+  blosc2_cparams checksum_cparams = cparams;
+  checksum_cparams.checksum = BLOSC2_CHECKSUM_CRC32C;
+  dest_storage.cparams = &checksum_cparams;
+  b2nd_context_t *checksum_ctx = b2nd_create_ctx(&dest_storage, ndim, shape, chunkshape, blockshape,
+                                                 NULL, 0, NULL, 0);
+  if (stack) {
+    B2ND_TEST_ASSERT(b2nd_stack(checksum_ctx, srcs, NSRCS, shapes.axis, &dest));
+  } else {
+    B2ND_TEST_ASSERT(b2nd_concatenate(checksum_ctx, srcs, NSRCS, shapes.axis, &dest));
+  }
+  if (check_concat(dest, buffers, src_shapes, shapes.axis, stack, typesize) != 0) {
+    return 1;
+  }
+  for (int64_t nchunk = 0; nchunk < dest->sc->nchunks; ++nchunk) {
+    uint8_t *chunk;
+    bool needs_free;
+    int cbytes = blosc2_schunk_get_chunk(dest->sc, nchunk, &chunk, &needs_free);
+    CUTEST_ASSERT("Error getting chunk", cbytes >= 0);
+    int special_value = (chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+    // Memcpyed chunks of a super-chunk have no room for the checksums
+    bool memcpyed = chunk[BLOSC2_CHUNK_FLAGS] & BLOSC_MEMCPYED;
+    int nverified = blosc2_chunk_verify(chunk, cbytes);
+    if (needs_free) {
+      free(chunk);
+    }
+    CUTEST_ASSERT("The chunk has no checksums", special_value != 0 || memcpyed || nverified > 0);
+  }
+  B2ND_TEST_ASSERT(b2nd_free(dest));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(checksum_ctx));
+  blosc2_remove_urlpath(urlpath_dest);
+
+  /* The arrays must fit together */
+  int8_t wrong_axis = (int8_t) (shapes.axis + 1) % shapes.ndim;
+  if (!stack && shapes.ndim > 1 && shapes.lengths[0] != shapes.lengths[1] &&
+      shapes.shape[wrong_axis] != 0) {
+    CUTEST_ASSERT("The shapes must fit",
+                  b2nd_concatenate(dest_ctx, srcs, 2, wrong_axis, &dest) < 0);
+  }
+  CUTEST_ASSERT("The axis must exist", b2nd_concatenate(dest_ctx, srcs, NSRCS, ndim, &dest) < 0);
+
+  /* Free mallocs */
+  B2ND_TEST_ASSERT(b2nd_free_ctx(dest_ctx));
+  for (int s = 0; s < NSRCS; ++s) {
+    free(buffers[s]);
+    B2ND_TEST_ASSERT(b2nd_free(srcs[s]));
+    blosc2_remove_urlpath(urlpaths[s]);
+  }
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(concatenate) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(concatenate);
+}
@@ -20,6 +20,57 @@ const uint8_t result[] = {0, 1,
                           6, 7};
 
 
+typedef struct {
+  int8_t ndim;
+  uint8_t itemsize;
+  int64_t src_pad_shape[B2ND_MAX_DIM];
+  int64_t src_start[B2ND_MAX_DIM];
+  int64_t src_stop[B2ND_MAX_DIM];
+  int64_t dst_pad_shape[B2ND_MAX_DIM];
+  int64_t dst_start[B2ND_MAX_DIM];
+} test_copy_t;
+
+// Exercise the row kernels and the merging of contiguous dimensions
+const test_copy_t copies[] = {
+    {3, 1, {8, 8, 8}, {1, 2, 3}, {5, 6, 7}, {6, 6, 6}, {0, 1, 2}},
+    {3, 2, {8, 8, 8}, {1, 2, 3}, {5, 6, 7}, {6, 6, 6}, {0, 1, 2}},
+    {3, 4, {8, 8, 8}, {1, 2, 3}, {5, 6, 7}, {6, 6, 6}, {0, 1, 2}},
+    {3, 8, {8, 8, 8}, {1, 2, 3}, {5, 6, 7}, {6, 6, 6}, {0, 1, 2}},
+    {3, 3, {8, 8, 8}, {1, 2, 3}, {5, 6, 7}, {6, 6, 6}, {0, 1, 2}},
+    {3, 4, {8, 8, 16}, {0, 0, 0}, {8, 8, 16}, {8, 8, 16}, {0, 0, 0}},
+    {3, 4, {4, 5, 6}, {1, 0, 0}, {3, 5, 6}, {6, 5, 6}, {2, 0, 0}},
+    {3, 8, {5, 5, 1}, {1, 1, 0}, {4, 4, 1}, {3, 3, 2}, {0, 0, 1}},
+    {4, 4, {3, 4, 5, 6}, {0, 1, 0, 2}, {3, 3, 5, 6}, {3, 2, 5, 4}, {0, 0, 0, 0}},
+    {5, 2, {2, 3, 1, 4, 5}, {0, 1, 0, 1, 0}, {2, 3, 1, 3, 5}, {3, 2, 2, 2, 5}, {1, 0, 1, 0, 0}},
+};
+
+
+/* Copy item by item */
+static void copy_reference(const test_copy_t *copy, const uint8_t *src, uint8_t *dst) {
+  int64_t copy_shape[B2ND_MAX_DIM];
+  int64_t src_strides[B2ND_MAX_DIM];
+  int64_t dst_strides[B2ND_MAX_DIM];
+  int64_t nitems = 1;
+  for (int i = copy->ndim - 1; i >= 0; --i) {
+    copy_shape[i] = copy->src_stop[i] - copy->src_start[i];
+    src_strides[i] = i == copy->ndim - 1 ? 1 : src_strides[i + 1] * copy->src_pad_shape[i + 1];
+    dst_strides[i] = i == copy->ndim - 1 ? 1 : dst_strides[i + 1] * copy->dst_pad_shape[i + 1];
+    nitems *= copy_shape[i];
+  }
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    int64_t index[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(copy->ndim, copy_shape, nitem, index);
+    int64_t src_offset = 0;
+    int64_t dst_offset = 0;
+    for (int i = 0; i < copy->ndim; ++i) {
+      src_offset += (copy->src_start[i] + index[i]) * src_strides[i];
+      dst_offset += (copy->dst_start[i] + index[i]) * dst_strides[i];
+    }
+    memcpy(&dst[dst_offset * copy->itemsize], &src[src_offset * copy->itemsize], copy->itemsize);
+  }
+}
+
+
 CUTEST_TEST_SETUP(copy_buffer) {
   blosc2_init();
 }
@@ -64,6 +115,32 @@ CUTEST_TEST_TEST(copy_buffer) {
     CUTEST_ASSERT("Elements are not equal!", a == b);
   }
 
+  for (size_t ncopy = 0; ncopy < sizeof(copies) / sizeof(copies[0]); ++ncopy) {
+    const test_copy_t *copy = &copies[ncopy];
+    int64_t src_nbytes = copy->itemsize;
+    int64_t dst_nbytes = copy->itemsize;
+    for (int i = 0; i < copy->ndim; ++i) {
+      src_nbytes *= copy->src_pad_shape[i];
+      dst_nbytes *= copy->dst_pad_shape[i];
+    }
+    uint8_t *src = malloc(src_nbytes);
+    uint8_t *dst = malloc(dst_nbytes);
+    uint8_t *dst_ref = malloc(dst_nbytes);
+    CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(src, 1, src_nbytes));
+    memset(dst, 0xaa, dst_nbytes);
+    memset(dst_ref, 0xaa, dst_nbytes);
+
+    B2ND_TEST_ASSERT(b2nd_copy_buffer(copy->ndim, copy->itemsize,
+                                      src, copy->src_pad_shape, copy->src_start, copy->src_stop,
+                                      dst, copy->dst_pad_shape, copy->dst_start));
+    copy_reference(copy, src, dst_ref);
+    CUTEST_ASSERT("Copies are not equal!", memcmp(dst, dst_ref, dst_nbytes) == 0);
+
+    free(src);
+    free(dst);
+    free(dst_ref);
+  }
+
   return 0;
 }
 
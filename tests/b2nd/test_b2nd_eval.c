@@ -0,0 +1,199 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include <math.h>
+
+#include "test_common.h"
+
+
+#define NOPERANDS 3
+
+typedef struct {
+  char *dtype;
+  uint8_t typesize;
+} test_dtype;
+
+
+CUTEST_TEST_SETUP(eval) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(dtype, test_dtype, CUTEST_DATA(
+      {"<f8", 8},
+      {"<f4", 4},
+      {"<i4", 4},
+  ));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {1, {50}, {20}, {7}},
+      {2, {21, 17}, {10, 8}, {4, 3}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+      {3, {10, 0, 9}, {4, 0, 4}, {2, 0, 2}},
+  ));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 2));
+  CUTEST_PARAMETRIZE(delta, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+
+CUTEST_TEST_TEST(eval) {
+  CUTEST_GET_PARAMETER(dtype, test_dtype);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(delta, bool);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_eval.b2frame";
+  char *operand_urlpaths[NOPERANDS] = {"test_eval_a.b2frame", "test_eval_b.b2frame", "test_eval_c.b2frame"};
+  test_dtype operand_dtypes[NOPERANDS] = {{"<f8", 8}, {"<i4", 4}, {"|u1", 1}};
+  blosc2_remove_urlpath(urlpath);
+
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+
+  /* Create the operands, with some special chunks */
+  b2nd_array_t *operands[NOPERANDS];
+  uint8_t *buffers[NOPERANDS];
+  for (int i = 0; i < NOPERANDS; ++i) {
+    blosc2_remove_urlpath(operand_urlpaths[i]);
+    blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+    cparams.typesize = operand_dtypes[i].typesize;
+    cparams.nthreads = nthreads;
+    if (delta && i == 1) {
+      cparams.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+    }
+    blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+    dparams.nthreads = nthreads;
+    blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+    if (backend.persistent) {
+      b2_storage.urlpath = operand_urlpaths[i];
+    }
+    b2_storage.contiguous = backend.contiguous;
+    b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                          shapes.blockshape, operand_dtypes[i].dtype, DTYPE_NUMPY_FORMAT,
+                                          NULL, 0);
+
+    int64_t buffersize = nitems * operand_dtypes[i].typesize;
+    buffers[i] = malloc(buffersize > 0 ? buffersize : 1);
+    for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+      set_item(buffers[i], operand_dtypes[i].dtype, nitem, (double) (((nitem + i) * 37) % 101) / (i + 1));
+    }
+    B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &operands[i], buffers[i], buffersize));
+
+    // Chunk 1 is zeros in all the operands, and chunk 2 is constant only in the first one
+    int32_t chunk_nbytes = (int32_t) operands[i]->extchunknitems * operand_dtypes[i].typesize;
+    int32_t chunk_size = chunk_nbytes + BLOSC2_MAX_OVERHEAD;
+    uint8_t *chunk = malloc(chunk_size);
+    if (operands[i]->sc->nchunks > 1) {
+      CUTEST_ASSERT("Error creating chunk", blosc2_chunk_zeros(cparams, chunk_nbytes, chunk, chunk_size) > 0);
+      CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(operands[i]->sc, 1, chunk, true) >= 0);
+    }
+    if (operands[i]->sc->nchunks > 2 && i == 0) {
+      double value = 3.5;
+      CUTEST_ASSERT("Error creating chunk",
+                    blosc2_chunk_repeatval(cparams, chunk_nbytes, chunk, chunk_size, &value) > 0);
+      CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(operands[i]->sc, 2, chunk, true) >= 0);
+    }
+    free(chunk);
+    B2ND_TEST_ASSERT(b2nd_to_cbuffer(operands[i], buffers[i], buffersize));
+    B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  }
+
+  /* Evaluate -(a * b + c) / 4 - 1 */
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = dtype.typesize;
+  cparams.nthreads = nthreads;
+  if (delta) {
+    cparams.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+  }
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, dtype.dtype, DTYPE_NUMPY_FORMAT, NULL, 0);
+  b2nd_expr_instr program[] = {
+      {B2ND_EXPR_OPERAND, 0, 0},
+      {B2ND_EXPR_OPERAND, 1, 0},
+      {B2ND_EXPR_MUL, 0, 0},
+      {B2ND_EXPR_OPERAND, 2, 0},
+      {B2ND_EXPR_ADD, 0, 0},
+      {B2ND_EXPR_NEG, 0, 0},
+      {B2ND_EXPR_CONSTANT, 0, 4},
+      {B2ND_EXPR_DIV, 0, 0},
+      {B2ND_EXPR_CONSTANT, 0, 1},
+      {B2ND_EXPR_SUB, 0, 0},
+  };
+  int32_t ninstrs = sizeof(program) / sizeof(program[0]);
+  b2nd_array_t *array;
+  B2ND_TEST_ASSERT(b2nd_eval(ctx, &array, operands, NOPERANDS, program, ninstrs));
+
+  int64_t buffersize = nitems * dtype.typesize;
+  uint8_t *buffer = malloc(buffersize > 0 ? buffersize : 1);
+  uint8_t *expected = malloc(buffersize > 0 ? buffersize : 1);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(array, buffer, buffersize));
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    double a = get_item(buffers[0], operand_dtypes[0].dtype, nitem);
+    double b = get_item(buffers[1], operand_dtypes[1].dtype, nitem);
+    double c = get_item(buffers[2], operand_dtypes[2].dtype, nitem);
+    set_item(expected, dtype.dtype, nitem, -(a * b + c) / 4 - 1);
+    CUTEST_ASSERT("Wrong result",
+                  get_item(buffer, dtype.dtype, nitem) == get_item(expected, dtype.dtype, nitem));
+  }
+
+  /* The chunk where all the operands are zeros is a special one */
+  if (array->sc->nchunks > 1) {
+    uint8_t *chunk;
+    bool needs_free;
+    int cbytes = blosc2_schunk_get_lazychunk(array->sc, 1, &chunk, &needs_free);
+    CUTEST_ASSERT("Error getting chunk", cbytes >= BLOSC_EXTENDED_HEADER_LENGTH);
+    CUTEST_ASSERT("Expected a special chunk",
+                  ((chunk[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK) == BLOSC2_SPECIAL_VALUE);
+    if (needs_free) {
+      free(chunk);
+    }
+  }
+
+  /* Bad programs */
+  b2nd_array_t *bad;
+  b2nd_expr_instr bad_operand[] = {{B2ND_EXPR_OPERAND, NOPERANDS, 0}};
+  CUTEST_ASSERT("The operand must exist", b2nd_eval(ctx, &bad, operands, NOPERANDS, bad_operand, 1) < 0);
+  CUTEST_ASSERT("The stack must hold a value", b2nd_eval(ctx, &bad, operands, NOPERANDS, program, 2) < 0);
+  CUTEST_ASSERT("The stack must not underflow", b2nd_eval(ctx, &bad, operands, NOPERANDS, &program[1], 2) < 0);
+
+  /* Free mallocs */
+  free(expected);
+  free(buffer);
+  for (int i = 0; i < NOPERANDS; ++i) {
+    free(buffers[i]);
+    B2ND_TEST_ASSERT(b2nd_free(operands[i]));
+    blosc2_remove_urlpath(operand_urlpaths[i]);
+  }
+  B2ND_TEST_ASSERT(b2nd_free(array));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(eval) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(eval);
+}
@@ -29,6 +29,7 @@ uint64_t result3[1024] = {303, 304, 305, 306, 307, 308, 309, 313, 314, 315, 316,
                           563, 564, 565, 566, 567, 568, 569};
 uint64_t result4[1024] = {0};
 uint64_t result5[1024] = {0};
+uint64_t result6[1024] = {550, 551, 552, 553, 554, 555, 556, 557, 558, 559};
 
 typedef struct {
   int8_t ndim;
@@ -48,6 +49,8 @@ CUTEST_TEST_SETUP(get_slice_buffer) {
 
   // Add parametrizations
   CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(8));
+  // Blocks are copied straight into the buffer unless the delta filter needs the whole chunk
+  CUTEST_PARAMETRIZE(filter, uint8_t, CUTEST_DATA(BLOSC_NOFILTER, BLOSC_DELTA));
   CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
       {false, false},
       {true, false},
@@ -62,6 +65,7 @@ CUTEST_TEST_SETUP(get_slice_buffer) {
       {3, {10, 10, 10}, {3, 5, 9}, {3, 4, 4}, {3, 7, 7}, {2, 5, 5}, {3, 0, 3}, {6, 7, 10}, result3}, // general
       {2, {20, 0}, {7, 0}, {3, 0}, {5, 0}, {2, 0}, {2, 0}, {8, 0}, result4}, // 0-shape
       {2, {20, 10}, {7, 5}, {3, 5}, {5, 5}, {2, 2}, {2, 0}, {18, 0}, result5}, // 0-shape
+      {1, {1000}, {1000}, {100}, {1000}, {100}, {550}, {560}, result6}, // past the first block
   ));
 }
 
@@ -69,6 +73,7 @@ CUTEST_TEST_TEST(get_slice_buffer) {
   CUTEST_GET_PARAMETER(backend, _test_backend);
   CUTEST_GET_PARAMETER(shapes, test_shapes_t);
   CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(filter, uint8_t);
 
   char *urlpath = "test_get_slice_buffer.b2frame";
   blosc2_remove_urlpath(urlpath);
@@ -76,7 +81,11 @@ CUTEST_TEST_TEST(get_slice_buffer) {
   blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
   cparams.nthreads = 2;
   cparams.typesize = typesize;
-  blosc2_storage b2_storage = {.cparams=&cparams};
+  cparams.filters[BLOSC2_MAX_FILTERS - 2] = filter;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  // Slices spanning several chunks are decompressed in parallel
+  dparams.nthreads = 2;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
   if (backend.persistent) {
     b2_storage.urlpath = urlpath;
   }
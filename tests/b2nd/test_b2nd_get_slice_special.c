@@ -0,0 +1,179 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include <math.h>
+
+#include "test_common.h"
+
+
+#define NDIM 3
+#define FILL_VALUE (-7.5)
+
+enum {
+  CHUNK_ZEROS,
+  CHUNK_NANS,
+  CHUNK_VALUE,
+  CHUNK_DATA,
+  CHUNK_KINDS,
+};
+
+
+CUTEST_TEST_SETUP(get_slice_special) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(4, 8));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 2));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, false},
+      {true, true},
+      {false, true},
+  ));
+}
+
+
+static int64_t to_unidim(const int64_t *index, const int64_t *shape) {
+  int64_t strides[NDIM] = {shape[1] * shape[2], shape[2], 1};
+  int64_t nitem;
+  blosc2_multidim_to_unidim(index, NDIM, strides, &nitem);
+  return nitem;
+}
+
+
+CUTEST_TEST_TEST(get_slice_special) {
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  const char *dtype = typesize == sizeof(float) ? "<f4" : "<f8";
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+
+  char *urlpath = "test_get_slice_special.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  int64_t shape[NDIM] = {10, 12, 9};
+  int32_t chunkshape[NDIM] = {4, 6, 4};
+  int32_t blockshape[NDIM] = {2, 3, 2};
+  int64_t start[NDIM] = {1, 2, 1};
+  int64_t stop[NDIM] = {9, 11, 8};
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  cparams.nthreads = nthreads;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, NDIM, shape, chunkshape, blockshape,
+                                        NULL, 0, NULL, 0);
+  b2nd_array_t *array;
+  B2ND_TEST_ASSERT(b2nd_zeros(ctx, &array));
+
+  /* Mix special chunks of every kind with regular ones */
+  int32_t chunk_nitems = chunkshape[0] * chunkshape[1] * chunkshape[2];
+  int32_t chunk_nbytes = chunk_nitems * typesize;
+  int32_t chunk_size = chunk_nbytes + BLOSC2_MAX_OVERHEAD;
+  uint8_t *data = malloc(chunk_nbytes);
+  uint8_t *chunk = malloc(chunk_size);
+  uint8_t value[sizeof(double)];
+  set_item(value, dtype, 0, FILL_VALUE);
+  for (int64_t nchunk = 0; nchunk < array->sc->nchunks; ++nchunk) {
+    int csize = 0;
+    switch (nchunk % CHUNK_KINDS) {
+      case CHUNK_ZEROS:
+        continue;
+      case CHUNK_NANS:
+        csize = blosc2_chunk_nans(cparams, chunk_nbytes, chunk, chunk_size);
+        break;
+      case CHUNK_VALUE:
+        csize = blosc2_chunk_repeatval(cparams, chunk_nbytes, chunk, chunk_size, value);
+        break;
+      default:
+        for (int32_t nitem = 0; nitem < chunk_nitems; ++nitem) {
+          set_item(data, dtype, nitem, (double) (nchunk * 1000 + nitem));
+        }
+        csize = blosc2_compress_ctx(array->sc->cctx, data, chunk_nbytes, chunk, chunk_size);
+    }
+    CUTEST_ASSERT("Error creating chunk", csize > 0);
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(array->sc, nchunk, chunk, true) >= 0);
+  }
+
+  /* Get a slice across all the chunks */
+  int64_t buffershape[NDIM];
+  int64_t buffersize = typesize;
+  for (int i = 0; i < NDIM; ++i) {
+    buffershape[i] = stop[i] - start[i];
+    buffersize *= buffershape[i];
+  }
+  uint8_t *buffer = malloc(buffersize);
+  B2ND_TEST_ASSERT(b2nd_get_slice_cbuffer(array, start, stop, buffer, buffershape, buffersize));
+
+  int64_t chunks_in_array[NDIM];
+  int64_t blocks_in_chunk[NDIM];
+  int64_t blockshape_[NDIM];
+  for (int i = 0; i < NDIM; ++i) {
+    chunks_in_array[i] = array->extshape[i] / chunkshape[i];
+    blocks_in_chunk[i] = chunkshape[i] / blockshape[i];
+    blockshape_[i] = blockshape[i];
+  }
+  int64_t block_nitems = blockshape[0] * blockshape[1] * blockshape[2];
+  for (int64_t nitem = 0; nitem < buffersize / typesize; ++nitem) {
+    // Chunks keep their items block after block
+    int64_t index[NDIM];
+    int64_t chunk_index[NDIM];
+    int64_t block_index[NDIM];
+    int64_t index_in_block[NDIM];
+    blosc2_unidim_to_multidim(NDIM, buffershape, nitem, index);
+    for (int i = 0; i < NDIM; ++i) {
+      index[i] += start[i];
+      chunk_index[i] = index[i] / chunkshape[i];
+      block_index[i] = index[i] % chunkshape[i] / blockshape[i];
+      index_in_block[i] = index[i] % blockshape[i];
+    }
+    int64_t nchunk = to_unidim(chunk_index, chunks_in_array);
+    int64_t nitem_in_chunk = to_unidim(block_index, blocks_in_chunk) * block_nitems +
+                             to_unidim(index_in_block, blockshape_);
+    double item = get_item(buffer, dtype, nitem);
+    switch (nchunk % CHUNK_KINDS) {
+      case CHUNK_ZEROS:
+        CUTEST_ASSERT("Expected a zero", item == 0);
+        break;
+      case CHUNK_NANS:
+        CUTEST_ASSERT("Expected a NaN", isnan(item));
+        break;
+      case CHUNK_VALUE:
+        CUTEST_ASSERT("Expected the fill value", item == FILL_VALUE);
+        break;
+      default:
+        CUTEST_ASSERT("Wrong data", item == (double) (nchunk * 1000 + nitem_in_chunk));
+    }
+  }
+
+  /* Free mallocs */
+  free(buffer);
+  free(chunk);
+  free(data);
+  B2ND_TEST_ASSERT(b2nd_free(array));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(get_slice_special) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(get_slice_special);
+}
@@ -0,0 +1,179 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+
+CUTEST_TEST_SETUP(orthogonal_selection) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {0, {0}, {0}, {0}},
+      {1, {100}, {30}, {7}},
+      {2, {40, 33}, {20, 10}, {6, 4}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+  ));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 3));
+  CUTEST_PARAMETRIZE(delta, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(orthogonal_selection) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(delta, bool);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_orthogonal_selection.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  cparams.nthreads = nthreads;
+  if (delta) {
+    cparams.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+  }
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, NULL, 0, NULL, 0);
+
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t buffersize = nitems * typesize;
+  uint8_t *buffer = malloc(buffersize);
+  CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(buffer, typesize, nitems));
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, buffer, buffersize));
+
+  /* Select some items along every dimension, with repetitions and in no particular order */
+  int64_t *selection[B2ND_MAX_DIM];
+  int64_t selection_size[B2ND_MAX_DIM];
+  int64_t sel_nitems = 1;
+  uint64_t seed = 12345;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    selection_size[i] = shapes.shape[i] / 2 + 3;
+    selection[i] = malloc(selection_size[i] * sizeof(int64_t));
+    for (int64_t j = 0; j < selection_size[i]; ++j) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      selection[i][j] = (int64_t) ((seed >> 33) % shapes.shape[i]);
+    }
+    sel_nitems *= selection_size[i];
+  }
+  int64_t array_strides[B2ND_MAX_DIM];
+  array_strides[shapes.ndim > 0 ? shapes.ndim - 1 : 0] = 1;
+  for (int i = shapes.ndim - 2; i >= 0; --i) {
+    array_strides[i] = array_strides[i + 1] * shapes.shape[i + 1];
+  }
+
+  /* Get the selection */
+  int64_t sel_buffersize = sel_nitems * typesize;
+  uint8_t *sel_buffer = malloc(sel_buffersize);
+  B2ND_TEST_ASSERT(b2nd_get_orthogonal_selection(src, selection, selection_size, sel_buffer,
+                                                 selection_size, sel_buffersize));
+  for (int64_t nitem = 0; nitem < sel_nitems; ++nitem) {
+    int64_t sel_index[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(shapes.ndim, selection_size, nitem, sel_index);
+    int64_t array_nitem = 0;
+    for (int i = 0; i < shapes.ndim; ++i) {
+      array_nitem += selection[i][sel_index[i]] * array_strides[i];
+    }
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong item", sel_buffer[nitem * typesize + j] == buffer[array_nitem * typesize + j]);
+    }
+  }
+
+  /* Select an item of the first chunk, but not in its first block (which delta chunks decode anyway) */
+  if (shapes.ndim > 0) {
+    int64_t last_index[B2ND_MAX_DIM];
+    int64_t *last_selection[B2ND_MAX_DIM];
+    int64_t last_size[B2ND_MAX_DIM];
+    int64_t last_nitem = 0;
+    for (int i = 0; i < shapes.ndim; ++i) {
+      last_index[i] = (shapes.chunkshape[i] < shapes.shape[i] ? shapes.chunkshape[i] : shapes.shape[i]) - 1;
+      last_selection[i] = &last_index[i];
+      last_size[i] = 1;
+      last_nitem += last_index[i] * array_strides[i];
+    }
+    B2ND_TEST_ASSERT(b2nd_get_orthogonal_selection(src, last_selection, last_size, sel_buffer,
+                                                   last_size, typesize));
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong item", sel_buffer[j] == buffer[last_nitem * typesize + j]);
+    }
+  }
+
+  /* Set the selection (the last of repeated items wins) */
+  for (int64_t nitem = 0; nitem < sel_nitems; ++nitem) {
+    int64_t sel_index[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(shapes.ndim, selection_size, nitem, sel_index);
+    int64_t array_nitem = 0;
+    for (int i = 0; i < shapes.ndim; ++i) {
+      array_nitem += selection[i][sel_index[i]] * array_strides[i];
+    }
+    for (int j = 0; j < typesize; ++j) {
+      sel_buffer[nitem * typesize + j] = (uint8_t) (nitem * 31 + j);
+      buffer[array_nitem * typesize + j] = sel_buffer[nitem * typesize + j];
+    }
+  }
+  B2ND_TEST_ASSERT(b2nd_set_orthogonal_selection(src, selection, selection_size, sel_buffer,
+                                                 selection_size, sel_buffersize));
+  uint8_t *result = malloc(buffersize);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(src, result, buffersize));
+  for (int64_t i = 0; i < buffersize; ++i) {
+    CUTEST_ASSERT("Wrong item after setting", result[i] == buffer[i]);
+  }
+
+  /* Indexes out of the array and buffers too small */
+  if (shapes.ndim > 0) {
+    int64_t index = selection[0][0];
+    selection[0][0] = shapes.shape[0];
+    CUTEST_ASSERT("The index must be inside the array",
+                  b2nd_get_orthogonal_selection(src, selection, selection_size, sel_buffer,
+                                                selection_size, sel_buffersize) < 0);
+    selection[0][0] = index;
+    CUTEST_ASSERT("The buffer must hold the selection",
+                  b2nd_get_orthogonal_selection(src, selection, selection_size, sel_buffer,
+                                                selection_size, sel_buffersize - 1) < 0);
+  }
+
+  /* Free mallocs */
+  for (int i = 0; i < shapes.ndim; ++i) {
+    free(selection[i]);
+  }
+  free(result);
+  free(sel_buffer);
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(orthogonal_selection) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(orthogonal_selection);
+}
@@ -0,0 +1,180 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+
+#define NPOINTS 500
+
+
+CUTEST_TEST_SETUP(points) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {0, {0}, {0}, {0}},
+      {1, {100}, {30}, {7}},
+      {2, {40, 33}, {20, 10}, {6, 4}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+      {3, {10, 0, 9}, {4, 0, 4}, {2, 0, 2}},
+  ));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 3));
+  CUTEST_PARAMETRIZE(delta, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(points) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(delta, bool);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_points.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  cparams.nthreads = nthreads;
+  if (delta) {
+    cparams.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+  }
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, NULL, 0, NULL, 0);
+
+  /* Create the array, with some special chunks */
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t buffersize = nitems * typesize;
+  uint8_t *buffer = malloc(buffersize > 0 ? buffersize : 1);
+  CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(buffer, typesize, nitems));
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, buffer, buffersize));
+  int32_t chunk_nbytes = (int32_t) src->extchunknitems * typesize;
+  uint8_t chunk[BLOSC_EXTENDED_HEADER_LENGTH + 8];
+  if (src->sc->nchunks > 1) {
+    CUTEST_ASSERT("Error creating chunk",
+                  blosc2_chunk_zeros(cparams, chunk_nbytes, chunk, sizeof(chunk)) > 0);
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(src->sc, 1, chunk, true) >= 0);
+  }
+  if (src->sc->nchunks > 2) {
+    uint8_t value[8] = {7, 6, 5, 4, 3, 2, 1, 0};
+    CUTEST_ASSERT("Error creating chunk",
+                  blosc2_chunk_repeatval(cparams, chunk_nbytes, chunk, sizeof(chunk), value) > 0);
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(src->sc, 2, chunk, true) >= 0);
+  }
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(src, buffer, buffersize));
+
+  /* Get some points, with repetitions and in no particular order */
+  int64_t npoints = nitems > 0 ? NPOINTS : 0;
+  int64_t *points = malloc(NPOINTS * B2ND_MAX_DIM * sizeof(int64_t));
+  uint8_t *result = malloc(NPOINTS * typesize);
+  uint64_t seed = 12345;
+  for (int64_t i = 0; i < npoints; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    int64_t nitem = (int64_t) ((seed >> 33) % nitems);
+    blosc2_unidim_to_multidim(shapes.ndim, shapes.shape, nitem, &points[i * shapes.ndim]);
+  }
+  B2ND_TEST_ASSERT(b2nd_get_point_selection(src, points, npoints, result, npoints * typesize));
+  int64_t strides[B2ND_MAX_DIM];
+  strides[shapes.ndim > 0 ? shapes.ndim - 1 : 0] = 1;
+  for (int i = shapes.ndim - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shapes.shape[i + 1];
+  }
+  for (int64_t i = 0; i < npoints; ++i) {
+    int64_t nitem = 0;
+    for (int j = 0; j < shapes.ndim; ++j) {
+      nitem += points[i * shapes.ndim + j] * strides[j];
+    }
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong point", result[i * typesize + j] == buffer[nitem * typesize + j]);
+    }
+  }
+
+  /* Points in the first chunk, but not in its first block (which delta chunks decode anyway) */
+  if (shapes.ndim > 0 && nitems > 0) {
+    int64_t last_point[B2ND_MAX_DIM];
+    int64_t last_nitem = 0;
+    for (int j = 0; j < shapes.ndim; ++j) {
+      last_point[j] = (shapes.chunkshape[j] < shapes.shape[j] ? shapes.chunkshape[j] : shapes.shape[j]) - 1;
+      last_nitem += last_point[j] * strides[j];
+    }
+    B2ND_TEST_ASSERT(b2nd_get_point_selection(src, last_point, 1, result, typesize));
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong point", result[j] == buffer[last_nitem * typesize + j]);
+    }
+  }
+
+  /* Points out of the array */
+  if (shapes.ndim > 0 && nitems > 0) {
+    int64_t bad_point[B2ND_MAX_DIM] = {0};
+    bad_point[shapes.ndim - 1] = shapes.shape[shapes.ndim - 1];
+    CUTEST_ASSERT("The point must be inside the array",
+                  b2nd_get_point_selection(src, bad_point, 1, result, typesize) < 0);
+  }
+
+  /* Get the items selected by a mask */
+  bool *mask = malloc(nitems > 0 ? nitems : 1);
+  int64_t nexpected = 0;
+  for (int64_t i = 0; i < nitems; ++i) {
+    mask[i] = (i * 7) % 5 == 0;
+    nexpected += mask[i];
+  }
+  uint8_t *mask_result = malloc(nexpected > 0 ? nexpected * typesize : 1);
+  int64_t nselected;
+  B2ND_TEST_ASSERT(b2nd_get_mask_selection(src, mask, mask_result, nexpected * typesize, &nselected));
+  CUTEST_ASSERT("Wrong number of selected items", nselected == nexpected);
+  int64_t nselect = 0;
+  for (int64_t i = 0; i < nitems; ++i) {
+    if (mask[i]) {
+      for (int j = 0; j < typesize; ++j) {
+        CUTEST_ASSERT("Wrong selected item", mask_result[nselect * typesize + j] == buffer[i * typesize + j]);
+      }
+      nselect++;
+    }
+  }
+  if (nexpected > 0) {
+    CUTEST_ASSERT("The buffer must hold the selection",
+                  b2nd_get_mask_selection(src, mask, mask_result, nexpected * typesize - 1, NULL) < 0);
+  }
+
+  /* Free mallocs */
+  free(mask_result);
+  free(mask);
+  free(result);
+  free(points);
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(points) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(points);
+}
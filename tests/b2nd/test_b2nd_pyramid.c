@@ -0,0 +1,315 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include <math.h>
+
+#include "test_common.h"
+
+
+#define NLEVELS 2
+
+
+/* Read the items of an array as doubles */
+static int read_doubles(b2nd_array_t *array, double *items) {
+  int64_t nbytes = array->nitems * array->sc->typesize;
+  uint8_t *buffer = malloc(nbytes);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(array, buffer, nbytes));
+  for (int64_t i = 0; i < array->nitems; ++i) {
+    items[i] = array->sc->typesize == 8 ? ((double *) buffer)[i] : ((int16_t *) buffer)[i];
+  }
+  free(buffer);
+  return 0;
+}
+
+
+/* Downsample the items of a level into the next one, naively */
+static void downsample(int8_t ndim, const int64_t *shape, const double *items, int32_t factor,
+                       b2nd_pyramid_op op, bool integer, int64_t *dest_shape, double *dest) {
+  int64_t dest_nitems = 1;
+  for (int i = 0; i < ndim; ++i) {
+    dest_shape[i] = (shape[i] + factor - 1) / factor;
+    dest_nitems *= dest_shape[i];
+  }
+  for (int64_t nitem = 0; nitem < dest_nitems; ++nitem) {
+    int64_t index[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(ndim, dest_shape, nitem, index);
+    int64_t window_shape[B2ND_MAX_DIM];
+    int64_t window_nitems = 1;
+    for (int i = 0; i < ndim; ++i) {
+      int64_t stop = (index[i] + 1) * factor < shape[i] ? (index[i] + 1) * factor : shape[i];
+      window_shape[i] = stop - index[i] * factor;
+      window_nitems *= window_shape[i];
+    }
+    double sum = 0;
+    double max = -INFINITY;
+    double first = 0;
+    for (int64_t nwindow = 0; nwindow < window_nitems; ++nwindow) {
+      int64_t window_index[B2ND_MAX_DIM];
+      blosc2_unidim_to_multidim(ndim, window_shape, nwindow, window_index);
+      int64_t src_nitem = 0;
+      for (int i = 0; i < ndim; ++i) {
+        src_nitem = src_nitem * shape[i] + index[i] * factor + window_index[i];
+      }
+      double value = items[src_nitem];
+      if (nwindow == 0) {
+        first = value;
+      }
+      sum += value;
+      max = value > max ? value : max;
+    }
+    switch (op) {
+      case B2ND_PYRAMID_MEAN:
+        dest[nitem] = integer ? round(sum / window_nitems) : sum / window_nitems;
+        break;
+      case B2ND_PYRAMID_MAX:
+        dest[nitem] = max;
+        break;
+      default:
+        dest[nitem] = first;
+    }
+  }
+}
+
+
+/* Check every level of the pyramid of an array */
+static int check_levels(b2nd_array_t *array, int32_t factor, b2nd_pyramid_op op) {
+  int8_t nlevels;
+  B2ND_TEST_ASSERT(b2nd_pyramid_nlevels(array, &nlevels));
+  CUTEST_ASSERT("Wrong number of levels", nlevels == NLEVELS);
+
+  int8_t ndim = array->ndim;
+  int64_t shape[B2ND_MAX_DIM];
+  for (int i = 0; i < ndim; ++i) {
+    shape[i] = array->shape[i];
+  }
+  double *expected = malloc(array->nitems * sizeof(double));
+  double *next = malloc(array->nitems * sizeof(double));
+  double *items = malloc(array->nitems * sizeof(double));
+  if (read_doubles(array, expected) != 0) {
+    return 1;
+  }
+  for (int8_t level = 1; level <= nlevels; ++level) {
+    int64_t level_shape[B2ND_MAX_DIM];
+    downsample(ndim, shape, expected, factor, op, array->sc->typesize != 8, level_shape, next);
+    b2nd_array_t *larray;
+    B2ND_TEST_ASSERT(b2nd_pyramid_open_level(array, level, &larray));
+    for (int i = 0; i < ndim; ++i) {
+      CUTEST_ASSERT("Wrong level shape", larray->shape[i] == level_shape[i]);
+      shape[i] = level_shape[i];
+    }
+    if (read_doubles(larray, items) != 0) {
+      return 1;
+    }
+    for (int64_t i = 0; i < larray->nitems; ++i) {
+      CUTEST_ASSERT("Wrong level item", fabs(items[i] - next[i]) <= 1e-9 * fabs(next[i]));
+    }
+    B2ND_TEST_ASSERT(b2nd_free(larray));
+    double *aux = expected;
+    expected = next;
+    next = aux;
+  }
+  b2nd_array_t *larray;
+  CUTEST_ASSERT("The level must exist", b2nd_pyramid_open_level(array, nlevels + 1, &larray) < 0);
+
+  free(items);
+  free(next);
+  free(expected);
+  return 0;
+}
+
+
+CUTEST_TEST_SETUP(pyramid) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(2, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {1, {100}, {30}, {7}},
+      {2, {40, 33}, {20, 10}, {6, 4}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+  ));
+  CUTEST_PARAMETRIZE(factor, int32_t, CUTEST_DATA(2, 3));
+  CUTEST_PARAMETRIZE(op, b2nd_pyramid_op, CUTEST_DATA(B2ND_PYRAMID_MEAN, B2ND_PYRAMID_MAX,
+                                                      B2ND_PYRAMID_STRIDE));
+  CUTEST_PARAMETRIZE(delta, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(pyramid) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(factor, int32_t);
+  CUTEST_GET_PARAMETER(op, b2nd_pyramid_op);
+  CUTEST_GET_PARAMETER(delta, bool);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_pyramid.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  if (delta) {
+    cparams.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+  }
+  blosc2_storage b2_storage = {.cparams=&cparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, typesize == 8 ? "<f8" : "<i2", 0, NULL, 0);
+
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t buffersize = nitems * typesize;
+  uint8_t *buffer = malloc(buffersize);
+  for (int64_t i = 0; i < nitems; ++i) {
+    if (typesize == 8) {
+      ((double *) buffer)[i] = (double) ((i * 37) % 101) / 4;
+    } else {
+      ((int16_t *) buffer)[i] = (int16_t) ((i * 37) % 101 - 50);
+    }
+  }
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, buffer, buffersize));
+
+  /* Build the pyramid */
+  int8_t nlevels;
+  B2ND_TEST_ASSERT(b2nd_pyramid_nlevels(src, &nlevels));
+  CUTEST_ASSERT("The array has no pyramid yet", nlevels == 0);
+  CUTEST_ASSERT("The factor must be 2 at least", b2nd_pyramid_build(src, NLEVELS, 1, op) < 0);
+  B2ND_TEST_ASSERT(b2nd_pyramid_build(src, NLEVELS, factor, op));
+  if (check_levels(src, factor, op) != 0) {
+    return 1;
+  }
+
+  /* Copies do not carry the pyramid over */
+  blosc2_storage copy_storage = {.cparams=&cparams};
+  b2nd_context_t *copy_ctx = b2nd_create_ctx(&copy_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                             shapes.blockshape, NULL, 0, NULL, 0);
+  b2nd_array_t *copy;
+  B2ND_TEST_ASSERT(b2nd_copy(copy_ctx, src, &copy));
+  B2ND_TEST_ASSERT(b2nd_pyramid_nlevels(copy, &nlevels));
+  CUTEST_ASSERT("The copy has no pyramid", nlevels == 0);
+  B2ND_TEST_ASSERT(b2nd_free(copy));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(copy_ctx));
+
+  /* Setting a slice updates the levels */
+  int64_t start[B2ND_MAX_DIM];
+  int64_t stop[B2ND_MAX_DIM];
+  int64_t slice_shape[B2ND_MAX_DIM];
+  int64_t slice_nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    start[i] = shapes.shape[i] / 3;
+    stop[i] = shapes.shape[i] / 2 + 1;
+    slice_shape[i] = stop[i] - start[i];
+    slice_nitems *= slice_shape[i];
+  }
+  uint8_t *slice = malloc(slice_nitems * typesize);
+  for (int64_t i = 0; i < slice_nitems; ++i) {
+    if (typesize == 8) {
+      ((double *) slice)[i] = 1000 + i;
+    } else {
+      ((int16_t *) slice)[i] = (int16_t) (1000 + i);
+    }
+  }
+  B2ND_TEST_ASSERT(b2nd_set_slice_cbuffer(slice, slice_shape, slice_nitems * typesize, start, stop, src));
+  if (check_levels(src, factor, op) != 0) {
+    return 1;
+  }
+  // In-memory arrays keep their levels, and only store them when they are serialized
+  CUTEST_ASSERT("The levels should not be stored yet",
+                backend.persistent || blosc2_vlmeta_exists(src->sc, "b2nd_pyramid_1") < 0);
+
+  /* Setting an orthogonal selection updates the levels too */
+  int64_t selection_items[B2ND_MAX_DIM][2];
+  int64_t *selection[B2ND_MAX_DIM];
+  int64_t selection_size[B2ND_MAX_DIM];
+  for (int i = 0; i < shapes.ndim; ++i) {
+    selection_items[i][0] = shapes.shape[i] - 1;
+    selection_items[i][1] = 1;
+    selection[i] = selection_items[i];
+    selection_size[i] = 2;
+  }
+  B2ND_TEST_ASSERT(b2nd_set_orthogonal_selection(src, selection, selection_size, slice, selection_size,
+                                                 slice_nitems * typesize));
+  if (check_levels(src, factor, op) != 0) {
+    return 1;
+  }
+
+  /* The pyramid survives reopening persistent arrays, and serializing in-memory ones */
+  if (backend.persistent) {
+    B2ND_TEST_ASSERT(b2nd_free(src));
+    B2ND_TEST_ASSERT(b2nd_open(urlpath, &src));
+  } else {
+    uint8_t *cframe;
+    int64_t cframe_len;
+    bool cframe_needs_free;
+    B2ND_TEST_ASSERT(b2nd_to_cframe(src, &cframe, &cframe_len, &cframe_needs_free));
+    b2nd_array_t *serialized;
+    B2ND_TEST_ASSERT(b2nd_from_cframe(cframe, cframe_len, true, &serialized));
+    if (cframe_needs_free) {
+      free(cframe);
+    }
+    B2ND_TEST_ASSERT(b2nd_free(src));
+    src = serialized;
+  }
+  if (check_levels(src, factor, op) != 0) {
+    return 1;
+  }
+  // The levels are updated after that too
+  for (int64_t i = 0; i < slice_nitems; ++i) {
+    if (typesize == 8) {
+      ((double *) slice)[i] = -1000 - (double) i;
+    } else {
+      ((int16_t *) slice)[i] = (int16_t) (-1000 - i);
+    }
+  }
+  B2ND_TEST_ASSERT(b2nd_set_slice_cbuffer(slice, slice_shape, slice_nitems * typesize, start, stop, src));
+  if (check_levels(src, factor, op) != 0) {
+    return 1;
+  }
+
+  /* Changing the shape makes the pyramid stale */
+  int64_t new_shape[B2ND_MAX_DIM];
+  for (int i = 0; i < shapes.ndim; ++i) {
+    new_shape[i] = shapes.shape[i] + 1;
+  }
+  B2ND_TEST_ASSERT(b2nd_resize(src, new_shape, NULL));
+  B2ND_TEST_ASSERT(b2nd_pyramid_nlevels(src, &nlevels));
+  CUTEST_ASSERT("The pyramid must be stale", nlevels == 0);
+  b2nd_array_t *larray;
+  CUTEST_ASSERT("Stale levels cannot be opened", b2nd_pyramid_open_level(src, 1, &larray) < 0);
+  B2ND_TEST_ASSERT(b2nd_pyramid_drop(src));
+  CUTEST_ASSERT("The pyramid must be dropped", blosc2_vlmeta_exists(src->sc, "b2nd_pyramid") < 0);
+
+  /* Free mallocs */
+  free(slice);
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(pyramid) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(pyramid);
+}
@@ -0,0 +1,256 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include <math.h>
+
+#include "test_common.h"
+
+
+#define FILL_VALUE 7
+
+typedef struct {
+  char *dtype;
+  uint8_t typesize;
+} test_dtype;
+
+
+CUTEST_TEST_SETUP(query) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(dtype, test_dtype, CUTEST_DATA(
+      {"<f8", 8},
+      {"<i4", 4},
+      {"|u1", 1},
+  ));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {1, {50}, {20}, {7}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+  ));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 2));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+
+static bool matches(double item, b2nd_query_op op, double value) {
+  switch (op) {
+    case B2ND_QUERY_LT:
+      return item < value;
+    case B2ND_QUERY_LE:
+      return item <= value;
+    case B2ND_QUERY_GT:
+      return item > value;
+    case B2ND_QUERY_GE:
+      return item >= value;
+    default:
+      return item == value;
+  }
+}
+
+
+/* Check every predicate against the items of the array, one by one */
+static int check_queries(b2nd_array_t *array, uint8_t *buffer, int64_t buffersize) {
+  static const double values[] = {-50, -10.5, 0, FILL_VALUE, 25, 60, 200};
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(array, buffer, buffersize));
+  for (int op = B2ND_QUERY_LT; op <= B2ND_QUERY_EQ; ++op) {
+    for (size_t nvalue = 0; nvalue < sizeof(values) / sizeof(values[0]); ++nvalue) {
+      int64_t *indexes;
+      int64_t nindexes;
+      B2ND_TEST_ASSERT(b2nd_query(array, op, values[nvalue], &indexes, &nindexes));
+      int64_t nindex = 0;
+      for (int64_t nitem = 0; nitem < array->nitems; ++nitem) {
+        if (matches(get_item(buffer, array->dtype, nitem), op, values[nvalue])) {
+          CUTEST_ASSERT("Missing item", nindex < nindexes && indexes[nindex] == nitem);
+          nindex++;
+        }
+      }
+      CUTEST_ASSERT("Unexpected items", nindex == nindexes);
+      free(indexes);
+    }
+  }
+  return 0;
+}
+
+
+CUTEST_TEST_TEST(query) {
+  CUTEST_GET_PARAMETER(dtype, test_dtype);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_query.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = dtype.typesize;
+  cparams.nthreads = nthreads;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, dtype.dtype, DTYPE_NUMPY_FORMAT, NULL, 0);
+
+  /* Create the array with some NaNs for the floats */
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t buffersize = nitems * dtype.typesize;
+  uint8_t *buffer = malloc(buffersize);
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    double item = (double) ((nitem * 37) % 101) - 50;
+    if (dtype.dtype[1] == 'u') {
+      item += 50;
+    } else if (dtype.dtype[1] == 'f' && nitem % 13 == 0) {
+      item = NAN;
+    }
+    set_item(buffer, dtype.dtype, nitem, item);
+  }
+  b2nd_array_t *array;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &array, buffer, buffersize));
+
+  /* Replace some chunks with special ones */
+  int32_t chunk_nbytes = (int32_t) array->extchunknitems * dtype.typesize;
+  int32_t chunk_size = chunk_nbytes + BLOSC2_MAX_OVERHEAD;
+  uint8_t *chunk = malloc(chunk_size);
+  uint8_t value[sizeof(double)];
+  set_item(value, dtype.dtype, 0, FILL_VALUE);
+  for (int64_t nchunk = 1; nchunk < array->sc->nchunks; nchunk += 2) {
+    int csize;
+    if (nchunk % 3 == 0) {
+      csize = blosc2_chunk_zeros(cparams, chunk_nbytes, chunk, chunk_size);
+    } else if (nchunk % 3 == 1 || dtype.dtype[1] != 'f') {
+      csize = blosc2_chunk_repeatval(cparams, chunk_nbytes, chunk, chunk_size, value);
+    } else {
+      csize = blosc2_chunk_nans(cparams, chunk_nbytes, chunk, chunk_size);
+    }
+    CUTEST_ASSERT("Error creating chunk", csize > 0);
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(array->sc, nchunk, chunk, true) >= 0);
+  }
+
+  /* Queries without and with a zone map */
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+  B2ND_TEST_ASSERT(b2nd_build_zonemap(array));
+  CUTEST_ASSERT("Zone map not stored", blosc2_vlmeta_exists(array->sc, "b2nd_zonemap") >= 0);
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+
+  /* The zone map follows the slices that are set */
+  int64_t start[B2ND_MAX_DIM] = {0};
+  int64_t stop[B2ND_MAX_DIM];
+  int64_t slice_shape[B2ND_MAX_DIM];
+  int64_t slice_nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    start[i] = shapes.shape[i] / 3;
+    stop[i] = shapes.shape[i] - 1;
+    slice_shape[i] = stop[i] - start[i];
+    slice_nitems *= slice_shape[i];
+  }
+  uint8_t *slice = malloc(slice_nitems * dtype.typesize);
+  for (int64_t nitem = 0; nitem < slice_nitems; ++nitem) {
+    set_item(slice, dtype.dtype, nitem, (double) (100 + nitem % 50));
+  }
+  B2ND_TEST_ASSERT(b2nd_set_slice_cbuffer(slice, slice_shape, slice_nitems * dtype.typesize, start, stop,
+                                          array));
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+
+  /* The zone map is stored along with the array */
+  if (backend.persistent) {
+    B2ND_TEST_ASSERT(b2nd_free(array));
+    B2ND_TEST_ASSERT(b2nd_open(urlpath, &array));
+  } else {
+    uint8_t *cframe;
+    int64_t cframe_len;
+    bool cframe_needs_free;
+    B2ND_TEST_ASSERT(b2nd_to_cframe(array, &cframe, &cframe_len, &cframe_needs_free));
+    B2ND_TEST_ASSERT(b2nd_free(array));
+    B2ND_TEST_ASSERT(b2nd_from_cframe(cframe, cframe_len, true, &array));
+    if (cframe_needs_free) {
+      free(cframe);
+    }
+  }
+  CUTEST_ASSERT("Zone map not stored", blosc2_vlmeta_exists(array->sc, "b2nd_zonemap") >= 0);
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+
+  /* Chunks updated behind the back of b2nd (a memcpyed one and a compressed one) are not ruled
+   * out by their old zones */
+  uint8_t *data = malloc(chunk_nbytes);
+  for (int64_t nitem = 0; nitem < array->extchunknitems; ++nitem) {
+    set_item(data, dtype.dtype, nitem, (double) (222 + nitem % 5));
+  }
+  blosc2_cparams *chunk_cparams;
+  B2ND_TEST_ASSERT(blosc2_schunk_get_cparams(array->sc, &chunk_cparams));
+  chunk_cparams->blocksize = array->blocknitems * dtype.typesize;
+  for (int clevel = 0; clevel <= 5; clevel += 5) {
+    chunk_cparams->clevel = (uint8_t) clevel;
+    blosc2_context *cctx = blosc2_create_cctx(*chunk_cparams);
+    int csize = blosc2_compress_ctx(cctx, data, chunk_nbytes, chunk, chunk_size);
+    blosc2_free_ctx(cctx);
+    CUTEST_ASSERT("Error compressing chunk", csize > 0);
+    int64_t nchunk = clevel == 0 ? 0 : array->sc->nchunks - 1;
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(array->sc, nchunk, chunk, true) >= 0);
+  }
+  free(chunk_cparams);
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+  B2ND_TEST_ASSERT(b2nd_build_zonemap(array));
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+
+  /* Changing the shape drops the zone map */
+  int64_t new_shape[B2ND_MAX_DIM];
+  for (int i = 0; i < shapes.ndim; ++i) {
+    new_shape[i] = shapes.shape[i] + (i == 0 ? 3 : 0);
+  }
+  B2ND_TEST_ASSERT(b2nd_resize(array, new_shape, NULL));
+  CUTEST_ASSERT("Zone map not dropped", blosc2_vlmeta_exists(array->sc, "b2nd_zonemap") < 0);
+  free(buffer);
+  buffersize = array->nitems * dtype.typesize;
+  buffer = malloc(buffersize);
+  if (check_queries(array, buffer, buffersize) != 0) {
+    return 1;
+  }
+
+  /* Free mallocs */
+  free(data);
+  free(slice);
+  free(chunk);
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free(array));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(query) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(query);
+}
@@ -0,0 +1,128 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+typedef struct {
+  int8_t ndim;
+  int64_t shape[B2ND_MAX_DIM];
+  int32_t chunkshape[B2ND_MAX_DIM];
+  int32_t blockshape[B2ND_MAX_DIM];
+  int32_t chunkshape2[B2ND_MAX_DIM];
+  int32_t blockshape2[B2ND_MAX_DIM];
+} test_shapes_t;
+
+
+CUTEST_TEST_SETUP(rechunk) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, test_shapes_t, CUTEST_DATA(
+      {1, {1000}, {100}, {30}, {70}, {20}},
+      {2, {100, 70}, {100, 7}, {20, 7}, {6, 70}, {3, 35}},
+      {3, {40, 15, 23}, {31, 5, 22}, {4, 4, 4}, {30, 5, 20}, {10, 4, 4}},
+      {3, {40, 0, 12}, {31, 0, 12}, {10, 0, 12}, {20, 0, 12}, {25, 0, 6}},
+      {0, {0}, {0}, {0}, {0}, {0}},
+  ));
+  CUTEST_PARAMETRIZE(max_memory, int64_t, CUTEST_DATA(0, 1, 20000));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 3));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(rechunk) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, test_shapes_t);
+  CUTEST_GET_PARAMETER(max_memory, int64_t);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_rechunk.b2frame";
+  char *urlpath2 = "test_rechunk2.b2frame";
+  blosc2_remove_urlpath(urlpath);
+  blosc2_remove_urlpath(urlpath2);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.nthreads = nthreads;
+  cparams.typesize = typesize;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, NULL, 0, NULL, 0);
+
+  /* Create the source array, with a special chunk */
+  int64_t buffersize = typesize;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    buffersize *= shapes.shape[i];
+  }
+  uint8_t *buffer = malloc(buffersize > 0 ? buffersize : 1);
+  CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(buffer, typesize, buffersize / typesize));
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, buffer, buffersize));
+  if (src->sc->nchunks > 1) {
+    int32_t chunk_nbytes = (int32_t) src->extchunknitems * typesize;
+    uint8_t chunk[BLOSC_EXTENDED_HEADER_LENGTH];
+    CUTEST_ASSERT("Error creating chunk",
+                  blosc2_chunk_zeros(cparams, chunk_nbytes, chunk, BLOSC_EXTENDED_HEADER_LENGTH) > 0);
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(src->sc, 1, chunk, true) >= 0);
+    B2ND_TEST_ASSERT(b2nd_to_cbuffer(src, buffer, buffersize));
+  }
+
+  /* Rechunk it */
+  blosc2_storage b2_storage2 = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage2.urlpath = urlpath2;
+  }
+  b2_storage2.contiguous = backend.contiguous;
+  b2nd_context_t *ctx2 = b2nd_create_ctx(&b2_storage2, shapes.ndim, shapes.shape, shapes.chunkshape2,
+                                         shapes.blockshape2, NULL, 0, NULL, 0);
+  b2nd_array_t *dest;
+  B2ND_TEST_ASSERT(b2nd_rechunk(ctx2, src, max_memory, &dest));
+  for (int i = 0; i < shapes.ndim; ++i) {
+    CUTEST_ASSERT("Wrong chunkshape", dest->chunkshape[i] == shapes.chunkshape2[i]);
+    CUTEST_ASSERT("Wrong blockshape", dest->blockshape[i] == shapes.blockshape2[i]);
+  }
+
+  uint8_t *buffer_dest = malloc(buffersize > 0 ? buffersize : 1);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(dest, buffer_dest, buffersize));
+  for (int64_t i = 0; i < buffersize; ++i) {
+    CUTEST_ASSERT("Wrong item", buffer[i] == buffer_dest[i]);
+  }
+
+  CUTEST_ASSERT("The budget cannot be negative", b2nd_rechunk(ctx2, src, -1, &dest) < 0);
+
+  /* Free mallocs */
+  free(buffer);
+  free(buffer_dest);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free(dest));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx2));
+  blosc2_remove_urlpath(urlpath);
+  blosc2_remove_urlpath(urlpath2);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(rechunk) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(rechunk);
+}
@@ -0,0 +1,209 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include <math.h>
+
+#include "test_common.h"
+
+
+#define FILL_VALUE 7
+
+typedef struct {
+  char *dtype;
+  uint8_t typesize;
+} test_dtype;
+
+
+CUTEST_TEST_SETUP(reduce) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(dtype, test_dtype, CUTEST_DATA(
+      {"<f8", 8},
+      {"<f4", 4},
+      {"<i4", 4},
+      {"|u1", 1},
+  ));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {1, {50}, {20}, {7}},
+      {2, {21, 17}, {10, 8}, {4, 3}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+      {3, {10, 0, 9}, {4, 0, 4}, {2, 0, 2}},
+  ));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 2));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+
+/* The reduction of the items in `buffer`, one by one */
+static void reduce_reference(const b2nd_array_t *array, const uint8_t *buffer, b2nd_reduce_op op,
+                             int8_t axis, double *result, int64_t *count, int64_t out_nitems) {
+  for (int64_t i = 0; i < out_nitems; ++i) {
+    result[i] = op == B2ND_REDUCE_MIN ? INFINITY : op == B2ND_REDUCE_MAX ? -INFINITY : 0;
+    count[i] = 0;
+  }
+  for (int64_t nitem = 0; nitem < array->nitems; ++nitem) {
+    int64_t index[B2ND_MAX_DIM];
+    blosc2_unidim_to_multidim(array->ndim, (int64_t *) array->shape, nitem, index);
+    int64_t out = 0;
+    for (int i = 0; i < array->ndim; ++i) {
+      if (axis != -1 && i != axis) {
+        out = out * array->shape[i] + index[i];
+      }
+    }
+    double item = get_item(buffer, array->dtype, nitem);
+    if (isnan(item)) {
+      continue;
+    }
+    if (op == B2ND_REDUCE_MIN) {
+      result[out] = item < result[out] ? item : result[out];
+    } else if (op == B2ND_REDUCE_MAX) {
+      result[out] = item > result[out] ? item : result[out];
+    } else {
+      result[out] += item;
+    }
+    count[out]++;
+  }
+  for (int64_t i = 0; i < out_nitems; ++i) {
+    switch (op) {
+      case B2ND_REDUCE_COUNT:
+        result[i] = (double) count[i];
+        break;
+      case B2ND_REDUCE_MEAN:
+        result[i] = count[i] > 0 ? result[i] / (double) count[i] : NAN;
+        break;
+      case B2ND_REDUCE_SUM:
+        break;
+      default:
+        result[i] = count[i] > 0 ? result[i] : NAN;
+    }
+  }
+}
+
+
+CUTEST_TEST_TEST(reduce) {
+  CUTEST_GET_PARAMETER(dtype, test_dtype);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_reduce.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = dtype.typesize;
+  cparams.nthreads = nthreads;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, dtype.dtype, DTYPE_NUMPY_FORMAT, NULL, 0);
+
+  /* Create the array with some NaNs for the floats */
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t buffersize = nitems * dtype.typesize;
+  uint8_t *buffer = malloc(buffersize > 0 ? buffersize : 1);
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    double item = (double) ((nitem * 37) % 101) - 50;
+    if (dtype.dtype[1] == 'u') {
+      item += 50;
+    } else if (dtype.dtype[1] == 'f' && nitem % 13 == 0) {
+      item = NAN;
+    }
+    set_item(buffer, dtype.dtype, nitem, item);
+  }
+  b2nd_array_t *array;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &array, buffer, buffersize));
+
+  /* Replace some chunks with special ones */
+  int32_t chunk_nbytes = (int32_t) array->extchunknitems * dtype.typesize;
+  int32_t chunk_size = chunk_nbytes + BLOSC2_MAX_OVERHEAD;
+  uint8_t *chunk = malloc(chunk_size);
+  uint8_t value[sizeof(double)];
+  set_item(value, dtype.dtype, 0, FILL_VALUE);
+  for (int64_t nchunk = 1; nchunk < array->sc->nchunks; nchunk += 2) {
+    int csize;
+    if (nchunk % 3 == 0) {
+      csize = blosc2_chunk_zeros(cparams, chunk_nbytes, chunk, chunk_size);
+    } else if (nchunk % 3 == 1 || dtype.dtype[1] != 'f') {
+      csize = blosc2_chunk_repeatval(cparams, chunk_nbytes, chunk, chunk_size, value);
+    } else {
+      csize = blosc2_chunk_nans(cparams, chunk_nbytes, chunk, chunk_size);
+    }
+    CUTEST_ASSERT("Error creating chunk", csize > 0);
+    CUTEST_ASSERT("Error updating chunk", blosc2_schunk_update_chunk(array->sc, nchunk, chunk, true) >= 0);
+  }
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(array, buffer, buffersize));
+
+  /* Check every reduction along every axis */
+  int64_t max_out_nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    max_out_nitems *= shapes.shape[i] > 0 ? shapes.shape[i] : 1;
+  }
+  double *result = malloc(max_out_nitems * sizeof(double));
+  double *expected = malloc(max_out_nitems * sizeof(double));
+  int64_t *count = malloc(max_out_nitems * sizeof(int64_t));
+  for (int op = B2ND_REDUCE_SUM; op <= B2ND_REDUCE_COUNT; ++op) {
+    for (int8_t axis = -1; axis < shapes.ndim; ++axis) {
+      int64_t out_nitems = 1;
+      for (int i = 0; i < shapes.ndim; ++i) {
+        out_nitems *= (axis == -1 || i == axis) ? 1 : shapes.shape[i];
+      }
+      B2ND_TEST_ASSERT(b2nd_reduce(array, op, axis, result, max_out_nitems * (int64_t) sizeof(double)));
+      reduce_reference(array, buffer, op, axis, expected, count, out_nitems);
+      for (int64_t i = 0; i < out_nitems; ++i) {
+        if (isnan(expected[i])) {
+          CUTEST_ASSERT("Expected a NaN", isnan(result[i]));
+        } else {
+          CUTEST_ASSERT("Wrong result", fabs(result[i] - expected[i]) <= 1e-9 * (1 + fabs(expected[i])));
+        }
+      }
+    }
+  }
+
+  /* Bad parameters */
+  CUTEST_ASSERT("The axis must exist",
+                b2nd_reduce(array, B2ND_REDUCE_SUM, shapes.ndim, result, sizeof(double)) < 0);
+  if (nitems > 1) {
+    CUTEST_ASSERT("The buffer must hold the result",
+                  b2nd_reduce(array, B2ND_REDUCE_SUM, 0, result, 0) < 0);
+  }
+
+  /* Free mallocs */
+  free(count);
+  free(expected);
+  free(result);
+  free(chunk);
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free(array));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(reduce) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(reduce);
+}
@@ -0,0 +1,137 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+// Setting small slices in regular (non-special) chunks only recompresses the
+// touched blocks; check that the rest of the array is preserved.
+
+#include "test_common.h"
+
+typedef struct {
+  int8_t ndim;
+  int64_t shape[B2ND_MAX_DIM];
+  int32_t chunkshape[B2ND_MAX_DIM];
+  int32_t blockshape[B2ND_MAX_DIM];
+  int64_t start[B2ND_MAX_DIM];
+  int64_t stop[B2ND_MAX_DIM];
+} test_shapes_t;
+
+
+CUTEST_TEST_SETUP(set_slice_blocks) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(
+      1,
+      2,
+      4,
+      8,
+  ));
+
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, false},
+      {true, true},
+      {false, true},
+  ));
+
+  CUTEST_PARAMETRIZE(shapes, test_shapes_t, CUTEST_DATA(
+      {1, {10000}, {4000}, {500}, {3900}, {4100}}, // across two chunks
+      {1, {10000}, {4000}, {500}, {4010}, {4020}}, // a single block
+      {2, {100, 100}, {50, 50}, {10, 25}, {13, 7}, {17, 12}},
+      {2, {100, 100}, {50, 50}, {10, 25}, {40, 20}, {60, 80}},
+      {3, {40, 40, 40}, {20, 20, 20}, {10, 10, 10}, {5, 12, 3}, {9, 13, 31}},
+      {3, {45, 45, 45}, {20, 20, 20}, {10, 10, 10}, {38, 0, 10}, {45, 45, 20}}, // padded chunks
+  ));
+}
+
+CUTEST_TEST_TEST(set_slice_blocks) {
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+  CUTEST_GET_PARAMETER(shapes, test_shapes_t);
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+
+  char *urlpath = "test_set_slice_blocks.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.nthreads = 2;
+  cparams.typesize = typesize;
+  blosc2_storage b2_storage = {.cparams=&cparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape,
+                                        shapes.chunkshape, shapes.blockshape, NULL, 0, NULL, 0);
+
+  /* Create the array with a known content */
+  int64_t nitems = 1;
+  for (int i = 0; i < ctx->ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t arraysize = nitems * typesize;
+  uint8_t *arraybuffer = malloc(arraysize);
+  for (int64_t i = 0; i < nitems; ++i) {
+    uint64_t value = (uint64_t) i;
+    memcpy(&arraybuffer[i * typesize], &value, typesize);
+  }
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, arraybuffer, arraysize));
+
+  /* Overwrite a slice with different values */
+  int64_t shape[B2ND_MAX_DIM] = {0};
+  int64_t buffersize = typesize;
+  for (int i = 0; i < ctx->ndim; ++i) {
+    shape[i] = shapes.stop[i] - shapes.start[i];
+    buffersize *= shape[i];
+  }
+  uint8_t *buffer = malloc(buffersize);
+  for (int64_t i = 0; i < buffersize / typesize; ++i) {
+    uint64_t value = (uint64_t) (nitems + 3 * i + 1);
+    memcpy(&buffer[i * typesize], &value, typesize);
+  }
+  B2ND_TEST_ASSERT(b2nd_set_slice_cbuffer(buffer, shape, buffersize,
+                                          shapes.start, shapes.stop, src));
+
+  /* Check the whole array */
+  uint8_t *destbuffer = malloc(arraysize);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(src, destbuffer, arraysize));
+
+  for (int64_t i = 0; i < nitems; ++i) {
+    int64_t index[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(ctx->ndim, shapes.shape, i, index);
+    bool in_slice = true;
+    int64_t slice_index = 0;
+    for (int j = 0; j < ctx->ndim; ++j) {
+      in_slice &= (index[j] >= shapes.start[j] && index[j] < shapes.stop[j]);
+      slice_index = slice_index * shape[j] + (index[j] - shapes.start[j]);
+    }
+    uint8_t *expected = in_slice ? &buffer[slice_index * typesize] : &arraybuffer[i * typesize];
+    CUTEST_ASSERT("Elements are not equals!", memcmp(&destbuffer[i * typesize], expected, typesize) == 0);
+  }
+
+  /* Free mallocs */
+  free(arraybuffer);
+  free(buffer);
+  free(destbuffer);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(set_slice_blocks) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(set_slice_blocks);
+}
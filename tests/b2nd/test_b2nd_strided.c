@@ -0,0 +1,205 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+
+enum {
+  LAYOUT_FORTRAN,       // Fortran order
+  LAYOUT_C_GAPS,        // C order, every other item
+  LAYOUT_FORTRAN_GAPS,  // Fortran order, every other item
+};
+
+
+/* The strides (in bytes) of a buffer with `shape` and `layout`, and its size */
+static int64_t layout_strides(int8_t ndim, const int64_t *shape, int layout, uint8_t typesize,
+                              int64_t *strides) {
+  int64_t gap = layout == LAYOUT_FORTRAN ? 1 : 2;
+  int64_t size = typesize * gap;
+  if (layout == LAYOUT_C_GAPS) {
+    for (int i = ndim - 1; i >= 0; --i) {
+      strides[i] = size;
+      size *= shape[i];
+    }
+  } else {
+    for (int i = 0; i < ndim; ++i) {
+      strides[i] = size;
+      size *= shape[i];
+    }
+  }
+  return size;
+}
+
+
+/* The offset (in bytes) of the item `nitem` (in C order) of `shape` in a strided buffer */
+static int64_t strided_offset(int8_t ndim, int64_t *shape, const int64_t *strides, int64_t nitem) {
+  int64_t index[B2ND_MAX_DIM] = {0};
+  blosc2_unidim_to_multidim(ndim, shape, nitem, index);
+  int64_t offset = 0;
+  for (int i = 0; i < ndim; ++i) {
+    offset += index[i] * strides[i];
+  }
+  return offset;
+}
+
+
+CUTEST_TEST_SETUP(strided) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {0, {0}, {0}, {0}},
+      {1, {100}, {30}, {7}},
+      {2, {40, 33}, {20, 10}, {6, 4}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+  ));
+  CUTEST_PARAMETRIZE(layout, int, CUTEST_DATA(LAYOUT_FORTRAN, LAYOUT_C_GAPS, LAYOUT_FORTRAN_GAPS));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 3));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(strided) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(layout, int);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_strided.b2frame";
+  blosc2_remove_urlpath(urlpath);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  cparams.nthreads = nthreads;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, NULL, 0, NULL, 0);
+
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  uint8_t *buffer = malloc(nitems * typesize);
+  CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(buffer, typesize, nitems));
+  int64_t strides[B2ND_MAX_DIM];
+  int64_t size = layout_strides(shapes.ndim, shapes.shape, layout, typesize, strides);
+  uint8_t *strided = malloc(size);
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    memcpy(&strided[strided_offset(shapes.ndim, shapes.shape, strides, nitem)],
+           &buffer[nitem * typesize], typesize);
+  }
+
+  /* The array made from the strided buffer has the items of the C one */
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer_strided(ctx, &src, strided, strides, size));
+  uint8_t *result = malloc(nitems * typesize);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(src, result, nitems * typesize));
+  CUTEST_ASSERT("Wrong items", memcmp(result, buffer, nitems * typesize) == 0);
+
+  /* And back into a strided buffer, leaving the gaps alone */
+  uint8_t *strided_result = malloc(size);
+  memset(strided_result, 0xAA, size);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer_strided(src, strided_result, strides, size));
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    int64_t offset = strided_offset(shapes.ndim, shapes.shape, strides, nitem);
+    CUTEST_ASSERT("Wrong item", memcmp(&strided_result[offset], &buffer[nitem * typesize], typesize) == 0);
+    memset(&strided_result[offset], 0xAA, typesize);
+  }
+  for (int64_t j = 0; j < size; ++j) {
+    CUTEST_ASSERT("A gap was written", strided_result[j] == 0xAA);
+  }
+  int64_t span = strided_offset(shapes.ndim, shapes.shape, strides, nitems - 1) + typesize;
+  CUTEST_ASSERT("The buffer is too small",
+                b2nd_to_cbuffer_strided(src, strided_result, strides, span - 1) < 0);
+
+  /* Set and get a slice through strided buffers */
+  int64_t start[B2ND_MAX_DIM];
+  int64_t stop[B2ND_MAX_DIM];
+  int64_t slice_shape[B2ND_MAX_DIM];
+  int64_t slice_nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    start[i] = shapes.shape[i] / 3;
+    stop[i] = shapes.shape[i] - 1;
+    slice_shape[i] = stop[i] - start[i];
+    slice_nitems *= slice_shape[i];
+  }
+  int64_t slice_strides[B2ND_MAX_DIM];
+  int64_t slice_size = layout_strides(shapes.ndim, slice_shape, layout, typesize, slice_strides);
+  uint8_t *slice = malloc(slice_size);
+  for (int64_t j = 0; j < slice_size; ++j) {
+    slice[j] = (uint8_t) (j * 3 + 1);
+  }
+  B2ND_TEST_ASSERT(b2nd_set_slice_cbuffer_strided(slice, slice_strides, slice_size, start, stop, src));
+  uint8_t *slice_result = malloc(slice_nitems * typesize);
+  B2ND_TEST_ASSERT(b2nd_get_slice_cbuffer(src, start, stop, slice_result, slice_shape,
+                                          slice_nitems * typesize));
+  for (int64_t nitem = 0; nitem < slice_nitems; ++nitem) {
+    int64_t offset = strided_offset(shapes.ndim, slice_shape, slice_strides, nitem);
+    CUTEST_ASSERT("Wrong slice item",
+                  memcmp(&slice_result[nitem * typesize], &slice[offset], typesize) == 0);
+  }
+  uint8_t *strided_slice = malloc(slice_size);
+  B2ND_TEST_ASSERT(b2nd_get_slice_cbuffer_strided(src, start, stop, strided_slice, slice_strides,
+                                                  slice_size));
+  for (int64_t nitem = 0; nitem < slice_nitems; ++nitem) {
+    int64_t offset = strided_offset(shapes.ndim, slice_shape, slice_strides, nitem);
+    CUTEST_ASSERT("Wrong slice item", memcmp(&strided_slice[offset], &slice[offset], typesize) == 0);
+  }
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  blosc2_remove_urlpath(urlpath);
+
+  /* Special chunks fill the strided buffer item by item */
+  b2nd_array_t *zeros;
+  B2ND_TEST_ASSERT(b2nd_zeros(ctx, &zeros));
+  memset(strided_result, 0xAA, size);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer_strided(zeros, strided_result, strides, size));
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    int64_t offset = strided_offset(shapes.ndim, shapes.shape, strides, nitem);
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong zero", strided_result[offset + j] == 0);
+      strided_result[offset + j] = 0xAA;
+    }
+  }
+  for (int64_t j = 0; j < size; ++j) {
+    CUTEST_ASSERT("A gap was written", strided_result[j] == 0xAA);
+  }
+  B2ND_TEST_ASSERT(b2nd_free(zeros));
+  blosc2_remove_urlpath(urlpath);
+
+  /* Free mallocs */
+  free(strided_slice);
+  free(slice_result);
+  free(slice);
+  free(strided_result);
+  free(result);
+  free(strided);
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(strided) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(strided);
+}
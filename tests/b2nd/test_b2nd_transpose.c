@@ -0,0 +1,166 @@
+/*********************************************************************
+  Blosc - Blocked Shuffling and Compression Library
+
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+**********************************************************************/
+
+#include "test_common.h"
+
+
+/* Check that `array` holds the items of `buffer` (with shape `shape`) with the axes permuted */
+static int check_permuted(b2nd_array_t *array, const uint8_t *buffer, int8_t ndim, const int64_t *shape,
+                          const int8_t *axes, uint8_t typesize) {
+  int64_t nitems = 1;
+  for (int k = 0; k < ndim; ++k) {
+    CUTEST_ASSERT("Wrong shape", array->shape[k] == shape[axes[k]]);
+    nitems *= array->shape[k];
+  }
+  int64_t strides[B2ND_MAX_DIM];
+  strides[ndim > 0 ? ndim - 1 : 0] = 1;
+  for (int i = ndim - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * shape[i + 1];
+  }
+  uint8_t *result = malloc(nitems > 0 ? nitems * typesize : 1);
+  B2ND_TEST_ASSERT(b2nd_to_cbuffer(array, result, nitems * typesize));
+  for (int64_t nitem = 0; nitem < nitems; ++nitem) {
+    int64_t index[B2ND_MAX_DIM] = {0};
+    blosc2_unidim_to_multidim(ndim, array->shape, nitem, index);
+    int64_t src_nitem = 0;
+    for (int k = 0; k < ndim; ++k) {
+      src_nitem += index[k] * strides[axes[k]];
+    }
+    for (int j = 0; j < typesize; ++j) {
+      CUTEST_ASSERT("Wrong item", result[nitem * typesize + j] == buffer[src_nitem * typesize + j]);
+    }
+  }
+  free(result);
+  return 0;
+}
+
+
+CUTEST_TEST_SETUP(transpose) {
+  blosc2_init();
+
+  // Add parametrizations
+  CUTEST_PARAMETRIZE(typesize, uint8_t, CUTEST_DATA(1, 8));
+  CUTEST_PARAMETRIZE(shapes, _test_shapes, CUTEST_DATA(
+      {0, {0}, {0}, {0}},
+      {1, {100}, {30}, {7}},
+      {2, {40, 33}, {20, 10}, {6, 4}},
+      {3, {10, 12, 9}, {4, 6, 4}, {2, 3, 2}},
+      {3, {10, 0, 9}, {4, 0, 4}, {2, 0, 2}},
+  ));
+  CUTEST_PARAMETRIZE(aligned, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(nthreads, int16_t, CUTEST_DATA(1, 3));
+  CUTEST_PARAMETRIZE(delta, bool, CUTEST_DATA(false, true));
+  CUTEST_PARAMETRIZE(backend, _test_backend, CUTEST_DATA(
+      {false, false},
+      {true, true},
+  ));
+}
+
+CUTEST_TEST_TEST(transpose) {
+  CUTEST_GET_PARAMETER(typesize, uint8_t);
+  CUTEST_GET_PARAMETER(shapes, _test_shapes);
+  CUTEST_GET_PARAMETER(aligned, bool);
+  CUTEST_GET_PARAMETER(nthreads, int16_t);
+  CUTEST_GET_PARAMETER(delta, bool);
+  CUTEST_GET_PARAMETER(backend, _test_backend);
+
+  char *urlpath = "test_transpose.b2frame";
+  char *urlpath_dest = "test_transpose_dest.b2frame";
+  blosc2_remove_urlpath(urlpath);
+  blosc2_remove_urlpath(urlpath_dest);
+
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = typesize;
+  cparams.nthreads = nthreads;
+  if (delta) {
+    cparams.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+  }
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_storage b2_storage = {.cparams=&cparams, .dparams=&dparams};
+  if (backend.persistent) {
+    b2_storage.urlpath = urlpath;
+  }
+  b2_storage.contiguous = backend.contiguous;
+  b2nd_context_t *ctx = b2nd_create_ctx(&b2_storage, shapes.ndim, shapes.shape, shapes.chunkshape,
+                                        shapes.blockshape, NULL, 0, NULL, 0);
+
+  int64_t nitems = 1;
+  for (int i = 0; i < shapes.ndim; ++i) {
+    nitems *= shapes.shape[i];
+  }
+  int64_t buffersize = nitems * typesize;
+  uint8_t *buffer = malloc(buffersize > 0 ? buffersize : 1);
+  CUTEST_ASSERT("Buffer filled incorrectly", fill_buf(buffer, typesize, nitems));
+  b2nd_array_t *src;
+  B2ND_TEST_ASSERT(b2nd_from_cbuffer(ctx, &src, buffer, buffersize));
+
+  /* Reverse the axes, and then rotate them */
+  int8_t reversed[B2ND_MAX_DIM];
+  int8_t rotated[B2ND_MAX_DIM];
+  for (int k = 0; k < shapes.ndim; ++k) {
+    reversed[k] = (int8_t) (shapes.ndim - 1 - k);
+    rotated[k] = (int8_t) ((k + 1) % shapes.ndim);
+  }
+  int8_t *permutations[] = {reversed, rotated};
+  for (int n = 0; n < 2; ++n) {
+    int8_t *axes = permutations[n];
+    int32_t chunkshape[B2ND_MAX_DIM];
+    int32_t blockshape[B2ND_MAX_DIM];
+    for (int k = 0; k < shapes.ndim; ++k) {
+      // Empty axes need empty chunks
+      bool permuted = aligned || nitems == 0;
+      chunkshape[k] = permuted ? shapes.chunkshape[axes[k]] : shapes.chunkshape[k];
+      blockshape[k] = permuted ? shapes.blockshape[axes[k]] : shapes.blockshape[k];
+    }
+    blosc2_storage dest_storage = {.cparams=&cparams, .dparams=&dparams};
+    if (backend.persistent) {
+      dest_storage.urlpath = urlpath_dest;
+    }
+    dest_storage.contiguous = backend.contiguous;
+    b2nd_context_t *dest_ctx = b2nd_create_ctx(&dest_storage, shapes.ndim, shapes.shape, chunkshape,
+                                               blockshape, NULL, 0, NULL, 0);
+    b2nd_array_t *dest;
+    if (n == 0) {
+      B2ND_TEST_ASSERT(b2nd_transpose(dest_ctx, src, &dest));
+    } else {
+      B2ND_TEST_ASSERT(b2nd_permute_axes(dest_ctx, src, axes, &dest));
+    }
+    if (check_permuted(dest, buffer, shapes.ndim, shapes.shape, axes, typesize) != 0) {
+      return 1;
+    }
+    B2ND_TEST_ASSERT(b2nd_free(dest));
+    B2ND_TEST_ASSERT(b2nd_free_ctx(dest_ctx));
+    blosc2_remove_urlpath(urlpath_dest);
+  }
+
+  /* The axes must be a permutation */
+  if (shapes.ndim > 1) {
+    int8_t axes[B2ND_MAX_DIM] = {0};
+    b2nd_array_t *dest;
+    CUTEST_ASSERT("The axes must not repeat", b2nd_permute_axes(ctx, src, axes, &dest) < 0);
+  }
+
+  /* Free mallocs */
+  free(buffer);
+  B2ND_TEST_ASSERT(b2nd_free(src));
+  B2ND_TEST_ASSERT(b2nd_free_ctx(ctx));
+  blosc2_remove_urlpath(urlpath);
+
+  return 0;
+}
+
+CUTEST_TEST_TEARDOWN(transpose) {
+  blosc2_destroy();
+}
+
+int main() {
+  CUTEST_TEST_RUN(transpose);
+}
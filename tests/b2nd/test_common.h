@@ -55,6 +55,39 @@ static bool fill_buf(void *buf, uint8_t typesize, size_t buf_size) {
 }
 
 
+/* Items of a buffer with a `dtype` among "<f8", "<f4", "<i4" and "|u1", as doubles */
+static double get_item(const uint8_t *buffer, const char *dtype, int64_t nitem) B2ND_TEST_UNUSED;
+static void set_item(uint8_t *buffer, const char *dtype, int64_t nitem, double value) B2ND_TEST_UNUSED;
+
+static double get_item(const uint8_t *buffer, const char *dtype, int64_t nitem) {
+  switch (dtype[1]) {
+    case 'f':
+      return dtype[2] == '4' ? ((float *) buffer)[nitem] : ((double *) buffer)[nitem];
+    case 'i':
+      return ((int32_t *) buffer)[nitem];
+    default:
+      return buffer[nitem];
+  }
+}
+
+static void set_item(uint8_t *buffer, const char *dtype, int64_t nitem, double value) {
+  switch (dtype[1]) {
+    case 'f':
+      if (dtype[2] == '4') {
+        ((float *) buffer)[nitem] = (float) value;
+      } else {
+        ((double *) buffer)[nitem] = value;
+      }
+      break;
+    case 'i':
+      ((int32_t *) buffer)[nitem] = (int32_t) value;
+      break;
+    default:
+      buffer[nitem] = (uint8_t) value;
+  }
+}
+
+
 /* Tests data */
 
 typedef struct {
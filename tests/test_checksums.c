@@ -0,0 +1,213 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "blosc2.h"
+#include "cutest.h"
+
+
+#define CHUNKSIZE (50 * 1000)
+#define BLOCKSIZE (16 * 1000)
+#define NCHUNKS 3
+
+typedef struct {
+  int clevel;
+  int16_t nthreads;
+} test_checksums_params;
+
+
+CUTEST_TEST_DATA(checksums) {
+  int32_t src[CHUNKSIZE];
+  int32_t rec[CHUNKSIZE];
+  uint8_t chunk[CHUNKSIZE * sizeof(int32_t) + BLOSC2_MAX_OVERHEAD + 1024];
+};
+
+
+CUTEST_TEST_SETUP(checksums) {
+  blosc2_init();
+  uint32_t seed = 1234567;
+  for (int i = 0; i < CHUNKSIZE; i++) {
+    seed = seed * 1103515245 + 12345;
+    // Compressible, but with no runs
+    data->src[i] = i + (int32_t) ((seed >> 16) & 0xff);
+  }
+
+  CUTEST_PARAMETRIZE(params, test_checksums_params, CUTEST_DATA(
+      {5, 1},
+      {5, 2},
+      {0, 1},  // memcpyed
+      {0, 2},  // memcpyed
+  ));
+}
+
+
+CUTEST_TEST_TEST(checksums) {
+  CUTEST_GET_PARAMETER(params, test_checksums_params);
+
+  int32_t isize = CHUNKSIZE * sizeof(int32_t);
+  int32_t nblocks = (isize + BLOCKSIZE - 1) / BLOCKSIZE;
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = sizeof(int32_t);
+  cparams.clevel = (uint8_t) params.clevel;
+  cparams.nthreads = params.nthreads;
+  cparams.blocksize = BLOCKSIZE;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = params.nthreads;
+  dparams.verify_checksums = true;
+
+  /* Chunks without checksums have nothing to verify */
+  blosc2_context *cctx = blosc2_create_cctx(cparams);
+  int csize_plain = blosc2_compress_ctx(cctx, data->src, isize, data->chunk, sizeof(data->chunk));
+  CUTEST_ASSERT("Compression error", csize_plain > 0);
+  CUTEST_ASSERT("Unexpected checksums", blosc2_chunk_verify(data->chunk, csize_plain) == 0);
+  blosc2_free_ctx(cctx);
+
+  cparams.checksum = BLOSC2_CHECKSUM_CRC32C;
+  cctx = blosc2_create_cctx(cparams);
+  int csize = blosc2_compress_ctx(cctx, data->src, isize, data->chunk, sizeof(data->chunk));
+  CUTEST_ASSERT("Compression error", csize > 0);
+  CUTEST_ASSERT("Checksums should be at the end of the chunk",
+                csize == csize_plain + nblocks * (int) sizeof(uint32_t));
+  CUTEST_ASSERT("Wrong number of verified blocks", blosc2_chunk_verify(data->chunk, csize) == nblocks);
+
+  blosc2_context *dctx = blosc2_create_dctx(dparams);
+  int dsize = blosc2_decompress_ctx(dctx, data->chunk, csize, data->rec, isize);
+  CUTEST_ASSERT("Decompression error", dsize == isize);
+  CUTEST_ASSERT("Data differs", memcmp(data->src, data->rec, isize) == 0);
+
+  /* Flip a bit in the data of the last block */
+  int32_t corrupted = csize - nblocks * (int32_t) sizeof(uint32_t) - 1;
+  if (params.clevel > 0) {
+    // Threads may store the blocks in any order, so look for it.  Being a leftover, it is
+    // not split and its data starts after the size of its only stream.
+    int32_t bstart;
+    memcpy(&bstart, data->chunk + BLOSC_EXTENDED_HEADER_LENGTH + (nblocks - 1) * sizeof(int32_t),
+           sizeof(bstart));
+    corrupted = bstart + (int32_t) sizeof(int32_t);
+  }
+  data->chunk[corrupted] ^= 0x10;
+  CUTEST_ASSERT("Corruption not detected",
+                blosc2_chunk_verify(data->chunk, csize) == BLOSC2_ERROR_CHECKSUM);
+  dsize = blosc2_decompress_ctx(dctx, data->chunk, csize, data->rec, isize);
+  CUTEST_ASSERT("Corruption not detected when decompressing", dsize == BLOSC2_ERROR_CHECKSUM);
+  dsize = blosc2_getitem_ctx(dctx, data->chunk, csize, CHUNKSIZE - 10, 10, data->rec, isize);
+  CUTEST_ASSERT("Corruption not detected when getting items", dsize == BLOSC2_ERROR_CHECKSUM);
+  // The first block is fine
+  dsize = blosc2_getitem_ctx(dctx, data->chunk, csize, 0, 10, data->rec, isize);
+  CUTEST_ASSERT("Getting items error", dsize == 10 * (int) sizeof(int32_t));
+  data->chunk[corrupted] ^= 0x10;
+
+  /* Flip a bit in the size of the stream of the last block, which the checksum covers too */
+  if (params.clevel > 0) {
+    // The most significant byte, so that the size goes past the end of the chunk
+    corrupted -= 1;
+    data->chunk[corrupted] ^= 0x10;
+    CUTEST_ASSERT("Corruption of the stream size not detected",
+                  blosc2_chunk_verify(data->chunk, csize) == BLOSC2_ERROR_CHECKSUM);
+    dsize = blosc2_decompress_ctx(dctx, data->chunk, csize, data->rec, isize);
+    CUTEST_ASSERT("Corruption of the stream size not detected when decompressing",
+                  dsize == BLOSC2_ERROR_CHECKSUM);
+    data->chunk[corrupted] ^= 0x10;
+  }
+  CUTEST_ASSERT("Wrong number of verified blocks", blosc2_chunk_verify(data->chunk, csize) == nblocks);
+  blosc2_free_ctx(dctx);
+
+  /* Checksums of a chunk on disk are read with the lazy chunk */
+  char *urlpath = "test_checksums.b2frame";
+  blosc2_remove_urlpath(urlpath);
+  blosc2_storage storage = {.cparams=&cparams, .dparams=&dparams, .contiguous=true, .urlpath=urlpath};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+  CUTEST_ASSERT("Error creating the schunk", schunk != NULL);
+  for (int nchunk = 0; nchunk < NCHUNKS; nchunk++) {
+    CUTEST_ASSERT("Error appending chunk",
+                  blosc2_schunk_append_buffer(schunk, data->src, isize) == nchunk + 1);
+  }
+  blosc2_schunk_free(schunk);
+
+  schunk = blosc2_schunk_open(urlpath);
+  CUTEST_ASSERT("Error opening the schunk", schunk != NULL);
+  dparams.schunk = schunk;
+  dctx = blosc2_create_dctx(dparams);
+  for (int nchunk = 0; nchunk < NCHUNKS; nchunk++) {
+    uint8_t *lazy_chunk;
+    bool needs_free;
+    int cbytes = blosc2_schunk_get_lazychunk(schunk, nchunk, &lazy_chunk, &needs_free);
+    CUTEST_ASSERT("Error getting the lazy chunk", cbytes > 0);
+    dsize = blosc2_getitem_ctx(dctx, lazy_chunk, cbytes, CHUNKSIZE / 2, 100, data->rec, isize);
+    CUTEST_ASSERT("Getting items error", dsize == 100 * (int) sizeof(int32_t));
+    CUTEST_ASSERT("Data differs", memcmp(data->src + CHUNKSIZE / 2, data->rec, dsize) == 0);
+    dsize = blosc2_decompress_ctx(dctx, lazy_chunk, cbytes, data->rec, isize);
+    CUTEST_ASSERT("Decompression error", dsize == isize);
+    CUTEST_ASSERT("Data differs", memcmp(data->src, data->rec, isize) == 0);
+    if (needs_free) {
+      free(lazy_chunk);
+    }
+  }
+  blosc2_free_ctx(dctx);
+
+  /* The reopened frame keeps the kind of checksums, and so do its copies */
+  CUTEST_ASSERT("Error appending chunk",
+                blosc2_schunk_append_buffer(schunk, data->src, isize) == NCHUNKS + 1);
+  // A chunk without checksums, which the copy has to recompress
+  cparams.checksum = BLOSC2_CHECKSUM_NONE;
+  blosc2_context *plain_cctx = blosc2_create_cctx(cparams);
+  csize_plain = blosc2_compress_ctx(plain_cctx, data->src, isize, data->chunk, sizeof(data->chunk));
+  blosc2_free_ctx(plain_cctx);
+  cparams.checksum = BLOSC2_CHECKSUM_CRC32C;
+  CUTEST_ASSERT("Compression error", csize_plain > 0);
+  CUTEST_ASSERT("Error appending chunk",
+                blosc2_schunk_append_chunk(schunk, data->chunk, true) == NCHUNKS + 2);
+  blosc2_storage copy_storage = {.contiguous=true};
+  blosc2_schunk *copy = blosc2_schunk_copy(schunk, &copy_storage);
+  CUTEST_ASSERT("Error copying the schunk", copy != NULL);
+  for (int nchunk = 0; nchunk < NCHUNKS + 2; nchunk++) {
+    uint8_t *chunk;
+    bool needs_free;
+    int cbytes = blosc2_schunk_get_chunk(copy, nchunk, &chunk, &needs_free);
+    CUTEST_ASSERT("Error getting the chunk", cbytes > 0);
+    int nverified = blosc2_chunk_verify(chunk, cbytes);
+    if (needs_free) {
+      free(chunk);
+    }
+    // Memcpyed chunks of a super-chunk have no room for the checksums
+    CUTEST_ASSERT("The copy lost the checksums", nverified == (params.clevel > 0 ? nblocks : 0));
+  }
+  blosc2_schunk_free(copy);
+  blosc2_schunk_free(schunk);
+  blosc2_remove_urlpath(urlpath);
+
+  /* The CRC-32C check value */
+  if (params.clevel == 0) {
+    const char *check = "123456789";
+    cparams.typesize = 1;
+    cparams.blocksize = 0;
+    blosc2_free_ctx(cctx);
+    cctx = blosc2_create_cctx(cparams);
+    csize = blosc2_compress_ctx(cctx, check, 9, data->chunk, sizeof(data->chunk));
+    CUTEST_ASSERT("Compression error", csize == BLOSC_EXTENDED_HEADER_LENGTH + 9 + 4);
+    uint32_t crc;
+    memcpy(&crc, data->chunk + csize - sizeof(crc), sizeof(crc));
+    CUTEST_ASSERT("Wrong CRC-32C", crc == 0xE3069283U);
+  }
+  blosc2_free_ctx(cctx);
+
+  return 0;
+}
+
+
+CUTEST_TEST_TEARDOWN(checksums) {
+  BLOSC_UNUSED_PARAM(data);
+  blosc2_destroy();
+}
+
+
+int main() {
+  CUTEST_TEST_RUN(checksums);
+}
@@ -154,6 +154,49 @@ CUTEST_TEST_TEST(fill_special) {
     }
   }
 
+  // fileframe (file) + offset -> its own file through another path must leave it alone
+  if (blosc2_schunk_to_file(schunk_read_offset, "./frame_simple.b2frame") != BLOSC2_ERROR_INVALID_PARAM) {
+    printf("fileframe + offset was written onto its own file");
+    return -1;
+  }
+  uint8_t* cframe_read_again;
+  bool cframe_needs_free_again;
+  int64_t frame_len_again = blosc2_schunk_to_buffer(schunk_read_offset, &cframe_read_again,
+                                                    &cframe_needs_free_again);
+  if (frame_len_again != frame_len1 || memcmp(cframe_write_append, cframe_read_again, frame_len1) != 0) {
+    printf("fileframe + offset changed after writing onto its own file");
+    return -1;
+  }
+  if (cframe_needs_free_again) {
+    free(cframe_read_again);
+  }
+
+  // fileframe (file) + offset -> fileframe (file) of its own
+  remove("frame_offset_copy.b2frame");
+  int64_t frame_len4 = blosc2_schunk_to_file(schunk_read_offset, "frame_offset_copy.b2frame");
+  if (frame_len4 != frame_len1) {
+    return (int)frame_len4;
+  }
+  blosc2_schunk* schunk_read_copy = blosc2_schunk_open("frame_offset_copy.b2frame");
+  if (schunk_read_copy == NULL) {
+    return -1;
+  }
+  uint8_t* cframe_read_copy;
+  bool cframe_needs_free4;
+  int64_t frame_len5 = blosc2_schunk_to_buffer(schunk_read_copy, &cframe_read_copy, &cframe_needs_free4);
+  if (frame_len5 != frame_len1) {
+    return (int)frame_len5;
+  }
+  if (memcmp(cframe_write_append, cframe_read_copy, frame_len1) != 0) {
+    printf("schunk1 != copy of fileframe + offset");
+    return -1;
+  }
+  blosc2_schunk_free(schunk_read_copy);
+  if (cframe_needs_free4) {
+    free(cframe_read_copy);
+  }
+  remove("frame_offset_copy.b2frame");
+
   printf("Successful roundtrip schunk <-> frame <-> fileframe\n"
          "                     schunk1 <-> frame1 <-> fileframe + offset");
 
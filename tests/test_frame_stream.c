@@ -0,0 +1,184 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "blosc2.h"
+#include "frame.h"
+#include "cutest.h"
+
+
+#define CHUNKSIZE (20 * 1000)
+#define LEFTOVER (CHUNKSIZE / 3)
+
+typedef struct {
+  int nchunks;
+  bool leftover;
+} test_frame_stream_params;
+
+
+CUTEST_TEST_DATA(frame_stream) {
+  int32_t src[CHUNKSIZE];
+  int32_t rec[CHUNKSIZE];
+};
+
+
+CUTEST_TEST_SETUP(frame_stream) {
+  blosc2_init();
+  for (int i = 0; i < CHUNKSIZE; i++) {
+    data->src[i] = i;
+  }
+
+  CUTEST_PARAMETRIZE(params, test_frame_stream_params, CUTEST_DATA(
+      {0, false},
+      {1, false},
+      {5, false},
+      {5, true},
+  ));
+}
+
+
+static int check_schunk(blosc2_schunk *schunk, int32_t *src, int32_t *rec, int nchunks, bool leftover) {
+  int64_t nchunks_ = nchunks + (leftover ? 1 : 0);
+  CUTEST_ASSERT("Wrong number of chunks", schunk->nchunks == nchunks_);
+  int64_t nbytes = (int64_t) nchunks * CHUNKSIZE * sizeof(int32_t) + (leftover ? LEFTOVER * sizeof(int32_t) : 0);
+  CUTEST_ASSERT("Wrong uncompressed size", schunk->nbytes == nbytes);
+  for (int nchunk = 0; nchunk < nchunks_; nchunk++) {
+    int32_t isize = (int32_t) ((nchunk < nchunks ? CHUNKSIZE : LEFTOVER) * sizeof(int32_t));
+    int dsize = blosc2_schunk_decompress_chunk(schunk, nchunk, rec, CHUNKSIZE * sizeof(int32_t));
+    CUTEST_ASSERT("Decompression error", dsize == isize);
+    CUTEST_ASSERT("Data differs", memcmp(src, rec, isize) == 0);
+  }
+
+  uint8_t *content;
+  int32_t content_len;
+  CUTEST_ASSERT("Metalayer not found", blosc2_meta_get(schunk, "meta", &content, &content_len) >= 0);
+  CUTEST_ASSERT("Wrong metalayer", content_len == 5 && memcmp(content, "meta0", 5) == 0);
+  free(content);
+  CUTEST_ASSERT("Vlmetalayer not found", blosc2_vlmeta_get(schunk, "vlmeta", &content, &content_len) >= 0);
+  CUTEST_ASSERT("Wrong vlmetalayer", content_len == 7 && memcmp(content, "vlmeta0", 7) == 0);
+  free(content);
+  return 0;
+}
+
+
+CUTEST_TEST_TEST(frame_stream) {
+  CUTEST_GET_PARAMETER(params, test_frame_stream_params);
+
+  char *urlpath = "test_frame_stream.b2frame";
+  char *urlpath2 = "test_frame_stream2.b2frame";
+  blosc2_remove_urlpath(urlpath);
+  blosc2_remove_urlpath(urlpath2);
+
+  /* The template super-chunk */
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  cparams.typesize = sizeof(int32_t);
+  cparams.clevel = 5;
+  blosc2_storage storage = {.cparams=&cparams, .contiguous=false};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+  CUTEST_ASSERT("Error creating the schunk", schunk != NULL);
+  CUTEST_ASSERT("Error adding metalayer", blosc2_meta_add(schunk, "meta", (uint8_t *) "meta0", 5) >= 0);
+  CUTEST_ASSERT("Error adding vlmetalayer",
+                blosc2_vlmeta_add(schunk, "vlmeta", (uint8_t *) "vlmeta0", 7, NULL) >= 0);
+
+  /* Write the streamed frame */
+  blosc2_frame_writer *writer = blosc2_frame_writer_new(schunk, urlpath, NULL);
+  CUTEST_ASSERT("Error creating the writer", writer != NULL);
+  for (int nchunk = 0; nchunk < params.nchunks; nchunk++) {
+    int64_t nchunks = blosc2_frame_writer_append_buffer(writer, data->src, CHUNKSIZE * sizeof(int32_t));
+    CUTEST_ASSERT("Error appending chunk", nchunks == nchunk + 1);
+  }
+  if (params.leftover) {
+    int64_t nchunks = blosc2_frame_writer_append_buffer(writer, data->src, LEFTOVER * sizeof(int32_t));
+    CUTEST_ASSERT("Error appending last chunk", nchunks == params.nchunks + 1);
+    nchunks = blosc2_frame_writer_append_buffer(writer, data->src, LEFTOVER * sizeof(int32_t));
+    CUTEST_ASSERT("Only the last chunk can be smaller", nchunks < 0);
+  }
+  int64_t frame_len = blosc2_frame_writer_close(writer);
+  CUTEST_ASSERT("Error closing the writer", frame_len > 0);
+  blosc2_schunk_free(schunk);
+
+  /* Open it from the file */
+  schunk = blosc2_schunk_open(urlpath);
+  CUTEST_ASSERT("Error opening the streamed frame", schunk != NULL);
+  if (check_schunk(schunk, data->src, data->rec, params.nchunks, params.leftover) != 0) {
+    return 1;
+  }
+  CUTEST_ASSERT("Streamed frames must be read-only",
+                blosc2_schunk_append_buffer(schunk, data->src, CHUNKSIZE * sizeof(int32_t)) ==
+                BLOSC2_ERROR_READ_ONLY);
+  CUTEST_ASSERT("Streamed frames must be read-only",
+                blosc2_vlmeta_add(schunk, "vlmeta2", (uint8_t *) "v", 1, NULL) == BLOSC2_ERROR_READ_ONLY);
+
+  /* Copies are regular frames that can be modified */
+  CUTEST_ASSERT("Error copying to file", blosc2_schunk_to_file(schunk, urlpath2) > 0);
+  blosc2_schunk_free(schunk);
+  schunk = blosc2_schunk_open(urlpath2);
+  CUTEST_ASSERT("Error opening the copy", schunk != NULL);
+  if (check_schunk(schunk, data->src, data->rec, params.nchunks, params.leftover) != 0) {
+    return 1;
+  }
+  if (!params.leftover) {
+    CUTEST_ASSERT("The copy must be writable",
+                  blosc2_schunk_append_buffer(schunk, data->src, CHUNKSIZE * sizeof(int32_t)) ==
+                  params.nchunks + 1);
+  }
+  blosc2_schunk_free(schunk);
+
+  /* Open it from a buffer */
+  FILE *fp = fopen(urlpath, "rb");
+  uint8_t *cframe = malloc(frame_len);
+  CUTEST_ASSERT("Error reading the streamed frame", fread(cframe, 1, frame_len, fp) == (size_t) frame_len);
+  fclose(fp);
+  CUTEST_ASSERT("Missing streamed flag", cframe[FRAME_FLAGS] & FRAME_STREAMED);
+  schunk = blosc2_schunk_from_buffer(cframe, frame_len, false);
+  CUTEST_ASSERT("Error opening the streamed buffer", schunk != NULL);
+  if (check_schunk(schunk, data->src, data->rec, params.nchunks, params.leftover) != 0) {
+    return 1;
+  }
+  uint8_t *cframe2;
+  bool needs_free;
+  int64_t cframe2_len = blosc2_schunk_to_buffer(schunk, &cframe2, &needs_free);
+  CUTEST_ASSERT("Error converting to buffer", cframe2_len > 0 && needs_free);
+  CUTEST_ASSERT("The copy must be a regular frame", !(cframe2[FRAME_FLAGS] & FRAME_STREAMED));
+  blosc2_schunk_free(schunk);
+  free(cframe);
+  schunk = blosc2_schunk_from_buffer(cframe2, cframe2_len, false);
+  CUTEST_ASSERT("Error opening the regular buffer", schunk != NULL);
+  if (check_schunk(schunk, data->src, data->rec, params.nchunks, params.leftover) != 0) {
+    return 1;
+  }
+  blosc2_schunk_free(schunk);
+  free(cframe2);
+
+  /* A truncated streamed frame is rejected */
+  fp = fopen(urlpath, "r+b");
+  uint8_t zero = 0;
+  fseek(fp, -FRAME_FOOTER_LEN + 2, SEEK_END);
+  fwrite(&zero, 1, 1, fp);
+  fclose(fp);
+  schunk = blosc2_schunk_open(urlpath);
+  CUTEST_ASSERT("A corrupted footer must be detected", schunk == NULL);
+
+  blosc2_remove_urlpath(urlpath);
+  blosc2_remove_urlpath(urlpath2);
+
+  return 0;
+}
+
+
+CUTEST_TEST_TEARDOWN(frame_stream) {
+  BLOSC_UNUSED_PARAM(data);
+  blosc2_destroy();
+}
+
+
+int main() {
+  CUTEST_TEST_RUN(frame_stream);
+}
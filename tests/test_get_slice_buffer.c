@@ -22,6 +22,7 @@ typedef struct {
     char* urlpath;
     bool contiguous;
     bool shorter_last_chunk;
+    bool delta;
 } test_data;
 
 test_data tdata;
@@ -31,16 +32,19 @@ typedef struct {
     int64_t start;
     int64_t stop;
     bool shorter_last_chunk;
+    bool delta;
 } test_ndata;
 
 test_ndata tndata[] = {
-        {10, 0, 10 * CHUNKSIZE, false}, //whole schunk
-        {5,  3, 200, false}, //piece of 1 block
-        {33, 5, 679, false}, // blocks of same chunk
-        {12,  129 * 100, 134 * 100 * 3, false}, // blocks of different chunks
-        {2, 200 * 100, CHUNKSIZE * 2, false}, // 1 chunk
-        {5, 0, CHUNKSIZE * 5 + 200 * 100 + 300, true}, // last chunk shorter
-        {2, 10, CHUNKSIZE * 2 + 400, true}, // start != 0, last chunk shorter
+        {10, 0, 10 * CHUNKSIZE, false, false}, //whole schunk
+        {5,  3, 200, false, false}, //piece of 1 block
+        {33, 5, 679, false, false}, // blocks of same chunk
+        {12,  129 * 100, 134 * 100 * 3, false, false}, // blocks of different chunks
+        {2, 200 * 100, CHUNKSIZE * 2, false, false}, // 1 chunk
+        {5, 0, CHUNKSIZE * 5 + 200 * 100 + 300, true, false}, // last chunk shorter
+        {2, 10, CHUNKSIZE * 2 + 400, true, false}, // start != 0, last chunk shorter
+        {4, 1001, CHUNKSIZE * 3 + 123457, false, false}, // many blocks of first and last chunks
+        {4, 150 * 1000, CHUNKSIZE * 2 + 150 * 1000 + 33, false, true}, // many blocks, delta filter
 };
 
 typedef struct {
@@ -75,6 +79,9 @@ static char* test_get_slice_buffer(void) {
   cparams.nthreads = NTHREADS;
   dparams.nthreads = NTHREADS;
   cparams.blocksize = 0;
+  if (tdata.delta) {
+    cparams.filters[0] = BLOSC_DELTA;
+  }
   blosc2_storage storage = {.cparams=&cparams, .dparams=&dparams,
                             .urlpath=tdata.urlpath, .contiguous=tdata.contiguous};
   schunk = blosc2_schunk_new(&storage);
@@ -143,6 +150,7 @@ static char *all_tests(void) {
       tdata.start = tndata[j].start;
       tdata.stop = tndata[j].stop;
       tdata.shorter_last_chunk = tndata[j].shorter_last_chunk;
+      tdata.delta = tndata[j].delta;
       mu_run_test(test_get_slice_buffer);
     }
   }
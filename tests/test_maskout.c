@@ -138,6 +138,40 @@ static char *test_mask_nomask_mask(void) {
 }
 
 
+// Check decompression with the trailing blocks masked out into a buffer that only holds the rest
+static char *test_mask_short_dest(void) {
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  dparams.nthreads = nthreads;
+  blosc2_context *dctx = blosc2_create_dctx(dparams);
+
+  int nkept = nblocks / 3;
+  bool *maskout_tail = malloc(nblocks);
+  for (int i = 0; i < nblocks; i++) {
+    maskout_tail[i] = i >= nkept;
+  }
+  int extent = nkept * blocksize;
+  mu_assert("ERROR: setting maskout", blosc2_set_maskout(dctx, maskout_tail, nblocks) == 0);
+  nbytes = blosc2_decompress_ctx(dctx, dest, cbytes, dest2, extent - 1);
+  mu_assert("ERROR: the unmasked blocks cannot fit", nbytes == BLOSC2_ERROR_WRITE_BUFFER);
+
+  memset(dest2, 0, bytesize);
+  mu_assert("ERROR: setting maskout", blosc2_set_maskout(dctx, maskout_tail, nblocks) == 0);
+  nbytes = blosc2_decompress_ctx(dctx, dest, cbytes, dest2, extent);
+  mu_assert("ERROR: nbytes is not correct w/ mask", nbytes == bytesize);
+  int64_t* _src = src;
+  int64_t* _dst = dest2;
+  for (int i = 0; i < extent / typesize; i++) {
+    mu_assert("ERROR: wrong values in dest", _dst[i] == _src[i]);
+  }
+  for (int i = extent / typesize; i < size; i++) {
+    mu_assert("ERROR: masked values written in dest", _dst[i] == 0);
+  }
+  free(maskout_tail);
+  blosc2_free_ctx(dctx);
+  return 0;
+}
+
+
 static char *all_tests(void) {
   nthreads = 1;
   mu_run_test(test_nomask);
@@ -155,6 +189,10 @@ static char *all_tests(void) {
   mu_run_test(test_mask_nomask_mask);
   nthreads = 2;  // TODO: fix this case
   mu_run_test(test_mask_nomask_mask);
+  nthreads = 1;
+  mu_run_test(test_mask_short_dest);
+  nthreads = 2;
+  mu_run_test(test_mask_short_dest);
 
   return 0;
 }
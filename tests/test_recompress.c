@@ -0,0 +1,198 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "blosc2.h"
+#include "cutest.h"
+
+
+#define CHUNKSIZE (50 * 1000)
+#define NTHREADS 4
+
+typedef struct {
+  bool contiguous;
+  char *urlpath;
+} test_recompress_backend;
+
+
+CUTEST_TEST_DATA(recompress) {
+  blosc2_cparams cparams;
+  blosc2_cparams cparams2;
+};
+
+
+CUTEST_TEST_SETUP(recompress) {
+  blosc2_init();
+  data->cparams = BLOSC2_CPARAMS_DEFAULTS;
+  data->cparams.typesize = sizeof(int32_t);
+  data->cparams.compcode = BLOSC_LZ4;
+  data->cparams.clevel = 5;
+  // Automatic blocksizes are never taken as matching, so chunks could not be passed through
+  data->cparams.blocksize = 10 * 1000 * sizeof(int32_t);
+  data->cparams.nthreads = NTHREADS;
+
+  data->cparams2 = BLOSC2_CPARAMS_DEFAULTS;
+  data->cparams2.typesize = sizeof(int32_t);
+  data->cparams2.compcode = BLOSC_ZSTD;
+  data->cparams2.clevel = 3;
+  data->cparams2.filters[BLOSC2_MAX_FILTERS - 1] = BLOSC_BITSHUFFLE;
+  data->cparams2.filters[BLOSC2_MAX_FILTERS - 2] = BLOSC_DELTA;
+  data->cparams2.nthreads = NTHREADS;
+
+  CUTEST_PARAMETRIZE(nchunks, int32_t, CUTEST_DATA(
+      0, 1, 10, 33
+  ));
+  CUTEST_PARAMETRIZE(different_cparams, bool, CUTEST_DATA(
+      false, true
+  ));
+  CUTEST_PARAMETRIZE(backend, test_recompress_backend, CUTEST_DATA(
+      {false, NULL},  // memory - schunk
+      {true, NULL},  // memory - cframe
+      {true, "test_recompress.b2frame"}, // disk - cframe
+      {false, "test_recompress_s.b2frame"}, // disk - sframe
+  ));
+  CUTEST_PARAMETRIZE(backend2, test_recompress_backend, CUTEST_DATA(
+      {false, NULL},  // memory - schunk
+      {true, NULL},  // memory - cframe
+      {true, "test_recompress2.b2frame"}, // disk - cframe
+      {false, "test_recompress2_s.b2frame"}, // disk - sframe
+  ));
+}
+
+
+CUTEST_TEST_TEST(recompress) {
+  CUTEST_GET_PARAMETER(nchunks, int32_t);
+  CUTEST_GET_PARAMETER(different_cparams, bool);
+  CUTEST_GET_PARAMETER(backend, test_recompress_backend);
+  CUTEST_GET_PARAMETER(backend2, test_recompress_backend);
+
+  blosc2_remove_urlpath(backend.urlpath);
+  blosc2_remove_urlpath(backend2.urlpath);
+
+  int32_t isize = CHUNKSIZE * sizeof(int32_t);
+  int32_t *data_buffer = malloc(isize);
+  int32_t *rec_buffer = malloc(isize);
+
+  /* Create a super-chunk container */
+  blosc2_storage storage = {.cparams=&data->cparams, .contiguous=backend.contiguous,
+                            .urlpath=backend.urlpath};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+  CUTEST_ASSERT("Error creating a schunk", schunk != NULL);
+
+  int64_t meta_content = -66;
+  blosc2_meta_add(schunk, "test_recompress", (uint8_t *) &meta_content, sizeof(meta_content));
+  blosc2_vlmeta_add(schunk, "vlmetalayer", (uint8_t *) &meta_content, sizeof(meta_content), NULL);
+
+  /* Append the chunks; every third one is made of zeros, the one after it uses another codec
+   * than the super-chunk and the last one is shorter */
+  blosc2_cparams other_cparams = data->cparams;
+  other_cparams.compcode = BLOSC_BLOSCLZ;
+  other_cparams.nthreads = 1;
+  blosc2_context *other_cctx = blosc2_create_cctx(other_cparams);
+  uint8_t *other_chunk = malloc(isize + BLOSC2_MAX_OVERHEAD);
+  for (int nchunk = 0; nchunk < nchunks; nchunk++) {
+    int32_t nbytes = (nchunk == nchunks - 1 && nchunks > 1) ? isize / 2 : isize;
+    int64_t nc;
+    for (int i = 0; i < CHUNKSIZE; i++) {
+      data_buffer[i] = nchunk * CHUNKSIZE + i;
+    }
+    if (nchunk % 3 == 1) {
+      uint8_t chunk[BLOSC_EXTENDED_HEADER_LENGTH];
+      int csize = blosc2_chunk_zeros(data->cparams, nbytes, chunk, sizeof(chunk));
+      CUTEST_ASSERT("Error creating a zeros chunk", csize > 0);
+      nc = blosc2_schunk_append_chunk(schunk, chunk, true);
+    }
+    else if (nchunk % 3 == 2) {
+      int csize = blosc2_compress_ctx(other_cctx, data_buffer, nbytes, other_chunk,
+                                      isize + BLOSC2_MAX_OVERHEAD);
+      CUTEST_ASSERT("Error compressing a chunk", csize > 0);
+      nc = blosc2_schunk_append_chunk(schunk, other_chunk, true);
+    }
+    else {
+      nc = blosc2_schunk_append_buffer(schunk, data_buffer, nbytes);
+    }
+    CUTEST_ASSERT("Error appending chunk", nc >= 0);
+  }
+  free(other_chunk);
+  blosc2_free_ctx(other_cctx);
+
+  /* Recompress the schunk */
+  blosc2_storage storage2 = {.contiguous=backend2.contiguous, .urlpath=backend2.urlpath};
+  storage2.cparams = different_cparams ? &data->cparams2 : &data->cparams;
+  blosc2_schunk *schunk2 = blosc2_schunk_recompress(schunk, &storage2);
+  CUTEST_ASSERT("Error recompressing a schunk", schunk2 != NULL);
+  CUTEST_ASSERT("Number of chunks differ", schunk2->nchunks == schunk->nchunks);
+  CUTEST_ASSERT("Number of bytes differ", schunk2->nbytes == schunk->nbytes);
+  CUTEST_ASSERT("Wrong compressor", schunk2->compcode == storage2.cparams->compcode);
+
+  int64_t *content;
+  int32_t content_len;
+  blosc2_meta_get(schunk2, "test_recompress", (uint8_t **) &content, &content_len);
+  CUTEST_ASSERT("Metalayers are not equal.", *content == meta_content);
+  free(content);
+  blosc2_vlmeta_get(schunk2, "vlmetalayer", (uint8_t **) &content, &content_len);
+  CUTEST_ASSERT("Variable-length metalayers are not equal.", *content == meta_content);
+  free(content);
+
+  for (int nchunk = 0; nchunk < nchunks; nchunk++) {
+    int dsize = blosc2_schunk_decompress_chunk(schunk, nchunk, data_buffer, isize);
+    CUTEST_ASSERT("Decompression error", dsize >= 0);
+    int dsize2 = blosc2_schunk_decompress_chunk(schunk2, nchunk, rec_buffer, isize);
+    CUTEST_ASSERT("Decompression size differs", dsize2 == dsize);
+    CUTEST_ASSERT("Data differs", memcmp(data_buffer, rec_buffer, dsize) == 0);
+
+    uint8_t *chunk, *chunk2;
+    bool needs_free, needs_free2;
+    int cbytes = blosc2_schunk_get_chunk(schunk, nchunk, &chunk, &needs_free);
+    int cbytes2 = blosc2_schunk_get_chunk(schunk2, nchunk, &chunk2, &needs_free2);
+    CUTEST_ASSERT("Cannot get chunks", cbytes > 0 && cbytes2 > 0);
+    bool special = (chunk2[BLOSC2_CHUNK_BLOSC2_FLAGS] >> 4) & BLOSC2_SPECIAL_MASK;
+    CUTEST_ASSERT("Special chunks must be preserved", special == (nchunk % 3 == 1));
+    int compformat = different_cparams ? BLOSC_ZSTD_FORMAT : BLOSC_LZ4_FORMAT;
+    CUTEST_ASSERT("Chunk does not use the codec of the target",
+                  special || (chunk2[BLOSC2_CHUNK_FLAGS] >> 5) == compformat);
+    if (!different_cparams) {
+      // Chunks that already match the target parameters are passed through
+      bool same = cbytes == cbytes2 && memcmp(chunk, chunk2, cbytes) == 0;
+      CUTEST_ASSERT("Chunk has been transcoded", same == (nchunk % 3 != 2));
+    }
+    else if (!special) {
+      CUTEST_ASSERT("Chunk has not been transcoded",
+                    chunk2[BLOSC2_CHUNK_FILTER_CODES + BLOSC2_MAX_FILTERS - 1] == BLOSC_BITSHUFFLE);
+    }
+    if (needs_free) {
+      free(chunk);
+    }
+    if (needs_free2) {
+      free(chunk2);
+    }
+  }
+
+  /* Free resources */
+  free(data_buffer);
+  free(rec_buffer);
+  blosc2_schunk_free(schunk);
+  blosc2_schunk_free(schunk2);
+  blosc2_remove_urlpath(backend.urlpath);
+  blosc2_remove_urlpath(backend2.urlpath);
+
+  return 0;
+}
+
+
+CUTEST_TEST_TEARDOWN(recompress) {
+  BLOSC_UNUSED_PARAM(data);
+  blosc2_destroy();
+}
+
+
+int main() {
+  CUTEST_TEST_RUN(recompress);
+}
@@ -157,6 +157,10 @@ static char* test_schunk(void) {
   int rc = blosc2_vlmeta_exists(schunk, "vlmetalayer2");
   mu_assert("ERROR: the vlmetalayer was not deleted correctly", rc < 0);
 
+  // Delete the last vlmetalayer through its own name
+  nvlmeta = blosc2_vlmeta_delete(schunk, schunk->vlmetalayers[0]->name);
+  mu_assert("ERROR: error while deleting the vlmetalayer", nvlmeta == 0);
+
   /* Free resources */
   blosc2_schunk_free(schunk);
   /* Destroy the Blosc environment */
@@ -0,0 +1,160 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+*/
+
+#include <stdio.h>
+#include "test_common.h"
+
+#define CHUNKSIZE (200 * 1000)
+#define NTHREADS (2)
+
+/* Global vars */
+int tests_run = 0;
+
+typedef struct {
+    int nchunks;
+    int nbuffers;
+    int nstop;
+    char* urlpath;
+    bool contiguous;
+} test_data;
+
+test_data tdata;
+
+typedef struct {
+    int nchunks;
+    int nbuffers;
+    int nstop;
+} test_ndata;
+
+test_ndata tndata[] = {
+        {0, 2, -1}, // empty schunk
+        {1, 2, -1},
+        {10, 2, -1},
+        {10, 4, -1},
+        {7, 16, -1}, // more buffers than chunks
+        {10, 3, 4}, // stop the iteration early
+};
+
+typedef struct {
+    bool contiguous;
+    char *urlpath;
+} test_storage;
+
+test_storage tstorage[] = {
+        {false, NULL},  // memory - schunk
+        {true, NULL},  // memory - cframe
+        {true, "test_schunk_iter.b2frame"}, // disk - cframe
+        {false, "test_schunk_iter.b2frame"}, // disk - sframe
+};
+
+
+static char* test_schunk_iter(void) {
+  static int32_t data[CHUNKSIZE];
+  int32_t isize = CHUNKSIZE * sizeof(int32_t);
+  blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+  blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+  blosc2_schunk* schunk;
+
+  /* Initialize the Blosc compressor */
+  blosc2_init();
+
+  /* Create a super-chunk container */
+  blosc2_remove_urlpath(tdata.urlpath);
+  cparams.typesize = sizeof(int32_t);
+  cparams.clevel = 5;
+  cparams.nthreads = NTHREADS;
+  dparams.nthreads = NTHREADS;
+  blosc2_storage storage = {.cparams=&cparams, .dparams=&dparams,
+                            .urlpath=tdata.urlpath, .contiguous=tdata.contiguous};
+  schunk = blosc2_schunk_new(&storage);
+
+  // Feed it with data (the last chunk is shorter)
+  for (int nchunk = 0; nchunk < tdata.nchunks; nchunk++) {
+    for (int i = 0; i < CHUNKSIZE; i++) {
+      data[i] = i + nchunk * CHUNKSIZE;
+    }
+    int32_t nbytes = (nchunk == tdata.nchunks - 1) ? isize / 2 : isize;
+    int64_t nchunks_ = blosc2_schunk_append_buffer(schunk, data, nbytes);
+    mu_assert("ERROR: bad append in frame", nchunks_ > 0);
+  }
+
+  // Iterate over the chunks
+  blosc2_schunk_iter *iter = blosc2_schunk_iter_new(schunk, tdata.nbuffers);
+  mu_assert("ERROR: cannot create the iterator", iter != NULL);
+  int64_t nchunk;
+  uint8_t *chunk_data;
+  int32_t nbytes;
+  int niter = 0;
+  int rc;
+  while ((rc = blosc2_schunk_iter_next(iter, &nchunk, &chunk_data, &nbytes)) > 0) {
+    mu_assert("ERROR: chunks are not in order", nchunk == niter);
+    int32_t expected = (nchunk == tdata.nchunks - 1) ? isize / 2 : isize;
+    mu_assert("ERROR: bad chunk size", nbytes == expected);
+    int32_t *values = (int32_t *) chunk_data;
+    for (int i = 0; i < nbytes / (int32_t) sizeof(int32_t); i++) {
+      mu_assert("ERROR: bad chunk contents", values[i] == i + nchunk * CHUNKSIZE);
+    }
+    niter++;
+    if (niter == tdata.nstop) {
+      break;
+    }
+  }
+  mu_assert("ERROR: iteration failed", rc >= 0);
+  if (tdata.nstop < 0) {
+    mu_assert("ERROR: not all the chunks have been iterated", niter == tdata.nchunks);
+    // An exhausted iterator keeps signaling the end
+    mu_assert("ERROR: iterator not exhausted", blosc2_schunk_iter_next(iter, NULL, &chunk_data, &nbytes) == 0);
+  }
+  rc = blosc2_schunk_iter_free(iter);
+  mu_assert("ERROR: cannot free the iterator", rc >= 0);
+
+  /* Free resources */
+  blosc2_schunk_free(schunk);
+  blosc2_remove_urlpath(tdata.urlpath);
+  /* Destroy the Blosc environment */
+  blosc2_destroy();
+
+  return EXIT_SUCCESS;
+}
+
+static char *all_tests(void) {
+  for (int i = 0; i < (int) ARRAY_SIZE(tstorage); ++i) {
+    for (int j = 0; j < (int) ARRAY_SIZE(tndata); ++j) {
+      tdata.contiguous = tstorage[i].contiguous;
+      tdata.urlpath = tstorage[i].urlpath;
+      tdata.nchunks = tndata[j].nchunks;
+      tdata.nbuffers = tndata[j].nbuffers;
+      tdata.nstop = tndata[j].nstop;
+      mu_run_test(test_schunk_iter);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+int main(void) {
+  char *result;
+
+  install_blosc_callback_test(); /* optionally install callback test */
+  blosc2_init();
+
+  /* Run all the suite */
+  result = all_tests();
+  if (result != EXIT_SUCCESS) {
+    printf(" (%s)\n", result);
+  }
+  else {
+    printf(" ALL TESTS PASSED");
+  }
+  printf("\tTests run: %d\n", tests_run);
+
+  blosc2_destroy();
+
+  return result != EXIT_SUCCESS;
+}
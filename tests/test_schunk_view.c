@@ -0,0 +1,164 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "blosc2.h"
+#include "cutest.h"
+
+
+#define CHUNKSIZE (20 * 1000)
+#define NTHREADS 2
+
+
+static bool in_buffer(const uint8_t *ptr, const uint8_t *buffer, int64_t len) {
+  return ptr >= buffer && ptr < buffer + len;
+}
+
+
+CUTEST_TEST_DATA(schunk_view) {
+  blosc2_cparams cparams;
+};
+
+
+CUTEST_TEST_SETUP(schunk_view) {
+  blosc2_init();
+  data->cparams = BLOSC2_CPARAMS_DEFAULTS;
+  data->cparams.typesize = sizeof(int32_t);
+  data->cparams.nthreads = NTHREADS;
+
+  CUTEST_PARAMETRIZE(nchunks, int32_t, CUTEST_DATA(
+      0, 1, 5
+  ));
+}
+
+
+CUTEST_TEST_TEST(schunk_view) {
+  CUTEST_GET_PARAMETER(nchunks, int32_t);
+
+  int32_t isize = CHUNKSIZE * sizeof(int32_t);
+  int32_t *data_buffer = malloc(isize);
+  int32_t *rec_buffer = malloc(isize);
+
+  /* Create an in-memory frame with metalayers, vlmetalayers and a special chunk */
+  blosc2_storage storage = {.cparams=&data->cparams, .contiguous=true};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+  CUTEST_ASSERT("Error creating a schunk", schunk != NULL);
+
+  int64_t meta_content = -66;
+  blosc2_meta_add(schunk, "test_view", (uint8_t *) &meta_content, sizeof(meta_content));
+  blosc2_vlmeta_add(schunk, "vlmetalayer", (uint8_t *) &meta_content, sizeof(meta_content), NULL);
+
+  for (int nchunk = 0; nchunk < nchunks; nchunk++) {
+    int64_t nc;
+    if (nchunk == 1) {
+      uint8_t chunk[BLOSC_EXTENDED_HEADER_LENGTH];
+      int csize = blosc2_chunk_zeros(data->cparams, isize, chunk, sizeof(chunk));
+      CUTEST_ASSERT("Error creating a zeros chunk", csize > 0);
+      nc = blosc2_schunk_append_chunk(schunk, chunk, true);
+    }
+    else {
+      for (int i = 0; i < CHUNKSIZE; i++) {
+        data_buffer[i] = nchunk * CHUNKSIZE + i;
+      }
+      nc = blosc2_schunk_append_buffer(schunk, data_buffer, isize);
+    }
+    CUTEST_ASSERT("Error appending chunk", nc >= 0);
+  }
+
+  /* Make an external copy of the frame (e.g. an mmapped file) */
+  uint8_t *cframe;
+  bool cframe_needs_free;
+  int64_t len = blosc2_schunk_to_buffer(schunk, &cframe, &cframe_needs_free);
+  CUTEST_ASSERT("Error getting the frame", len > 0);
+  uint8_t *buffer = malloc(len);
+  memcpy(buffer, cframe, len);
+  uint8_t *pristine = malloc(len);
+  memcpy(pristine, cframe, len);
+
+  blosc2_schunk *view = blosc2_schunk_from_buffer_view(buffer, len);
+  CUTEST_ASSERT("Error creating the view", view != NULL);
+  CUTEST_ASSERT("Number of chunks differ", view->nchunks == schunk->nchunks);
+
+  /* Metalayers are borrowed from the buffer */
+  CUTEST_ASSERT("Metalayer not found", view->nmetalayers == 1);
+  CUTEST_ASSERT("Metalayer content is not borrowed",
+                in_buffer(view->metalayers[0]->content, buffer, len));
+  CUTEST_ASSERT("Metalayer content differs",
+                memcmp(view->metalayers[0]->content, &meta_content, sizeof(meta_content)) == 0);
+  CUTEST_ASSERT("Vlmetalayer not found", view->nvlmetalayers == 1);
+  CUTEST_ASSERT("Vlmetalayer content is not borrowed",
+                in_buffer(view->vlmetalayers[0]->content, buffer, len));
+  int64_t *content;
+  int32_t content_len;
+  CUTEST_ASSERT("Cannot get the vlmetalayer",
+                blosc2_vlmeta_get(view, "vlmetalayer", (uint8_t **) &content, &content_len) >= 0);
+  CUTEST_ASSERT("Vlmetalayer content differs", *content == meta_content);
+  free(content);
+
+  /* Chunks are borrowed from the buffer too */
+  for (int nchunk = 0; nchunk < nchunks; nchunk++) {
+    uint8_t *chunk;
+    bool needs_free;
+    int cbytes = blosc2_schunk_get_chunk(view, nchunk, &chunk, &needs_free);
+    CUTEST_ASSERT("Cannot get chunk", cbytes > 0);
+    if (nchunk != 1) {
+      CUTEST_ASSERT("Chunk is not borrowed", !needs_free && in_buffer(chunk, buffer, len));
+    }
+    if (needs_free) {
+      free(chunk);
+    }
+    int dsize = blosc2_schunk_decompress_chunk(schunk, nchunk, data_buffer, isize);
+    CUTEST_ASSERT("Decompression error", dsize == isize);
+    dsize = blosc2_schunk_decompress_chunk(view, nchunk, rec_buffer, isize);
+    CUTEST_ASSERT("Decompression error in view", dsize == isize);
+    CUTEST_ASSERT("Data differs", memcmp(data_buffer, rec_buffer, isize) == 0);
+  }
+
+  /* Views cannot be modified */
+  CUTEST_ASSERT("Append should fail",
+                blosc2_schunk_append_buffer(view, data_buffer, isize) == BLOSC2_ERROR_READ_ONLY);
+  CUTEST_ASSERT("Metalayer update should fail",
+                blosc2_meta_update(view, "test_view", (uint8_t *) &meta_content,
+                                   sizeof(meta_content)) == BLOSC2_ERROR_READ_ONLY);
+  CUTEST_ASSERT("Vlmetalayer add should fail",
+                blosc2_vlmeta_add(view, "other", (uint8_t *) &meta_content,
+                                  sizeof(meta_content), NULL) == BLOSC2_ERROR_READ_ONLY);
+  if (nchunks > 0) {
+    CUTEST_ASSERT("Delete should fail", blosc2_schunk_delete_chunk(view, 0) == BLOSC2_ERROR_READ_ONLY);
+  }
+  CUTEST_ASSERT("Buffer has been modified", memcmp(buffer, pristine, len) == 0);
+
+  /* The buffer is not owned by the view */
+  blosc2_schunk_free(view);
+  CUTEST_ASSERT("Buffer has been modified", memcmp(buffer, pristine, len) == 0);
+
+  /* Free resources */
+  free(buffer);
+  free(pristine);
+  if (cframe_needs_free) {
+    free(cframe);
+  }
+  free(data_buffer);
+  free(rec_buffer);
+  blosc2_schunk_free(schunk);
+
+  return 0;
+}
+
+
+CUTEST_TEST_TEARDOWN(schunk_view) {
+  BLOSC_UNUSED_PARAM(data);
+  blosc2_destroy();
+}
+
+
+int main() {
+  CUTEST_TEST_RUN(schunk_view);
+}
@@ -40,6 +40,8 @@ test_ndata tndata[] = {
         {12,  129 * 100, 134 * 100 * 3, false}, // blocks of different chunks
         {3, 200 * 100, CHUNKSIZE * 3, false}, // 2 chunks
         {3, 200 * 100 + 17, CHUNKSIZE * 3 + 23, true}, // last chunk shorter
+        {2, CHUNKSIZE * 2 + 189990, CHUNKSIZE * 2 + 190000, true}, // leftover block of last chunk
+        {4, CHUNKSIZE + 54321, CHUNKSIZE + 54321 + 7, false}, // a few items of a single block
 };
 
 typedef struct {
@@ -115,6 +117,16 @@ static char* test_set_slice_buffer(void) {
   for (int64_t i = 0; i < (tdata.stop - tdata.start); ++i) {
     mu_assert("ERROR: bad roundtrip",buffer[i] == res[i]);
   }
+  // Check that the data outside the slice has been preserved
+  int64_t nitems = schunk->nbytes / schunk->typesize;
+  int32_t *all = malloc(nitems * schunk->typesize);
+  rc = blosc2_schunk_get_slice_buffer(schunk, 0, nitems, all);
+  mu_assert("ERROR: cannot get slice correctly.", rc >= 0);
+  for (int64_t i = 0; i < nitems; ++i) {
+    int32_t expected = (i >= tdata.start && i < tdata.stop) ? buffer[i - tdata.start] : (int32_t) i;
+    mu_assert("ERROR: bad roundtrip outside the slice", all[i] == expected);
+  }
+  free(all);
 
   /* Free resources */
   blosc2_schunk_free(schunk);
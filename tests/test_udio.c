@@ -143,7 +143,12 @@ CUTEST_TEST_TEST(udio) {
     CUTEST_ASSERT("Error during compression", cbytes >= 0);
   }
 
+  // Opening a small frame only needs to read its header and its trailer
+  test_udio_params before_open = io_params;
   blosc2_schunk *schunk2 = blosc2_schunk_open_udio(backend.urlpath, &io);
+  CUTEST_ASSERT("Error opening the schunk", schunk2 != NULL);
+  CUTEST_ASSERT("Too many opens", io_params.open - before_open.open == 1);
+  CUTEST_ASSERT("Too many reads", io_params.read - before_open.read <= 2);
 
   for (int i = 0; i < NCHUNKS; ++i) {
     int32_t dbytes = blosc2_schunk_decompress_chunk(schunk2, i, rec_buffer, nbytes);
@@ -0,0 +1,138 @@
+/*
+  Copyright (c) 2021  Blosc Development Team <blosc@blosc.org>
+  https://blosc.org
+  License: BSD 3-Clause (see LICENSE.txt)
+
+  See LICENSE.txt for details about copyright and rights to use.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "blosc2.h"
+#include "cutest.h"
+
+
+#define CHUNKSIZE (10 * 1000)
+#define BIG_VLMETA_LEN (64 * 1024)
+
+typedef struct {
+  bool contiguous;
+  char *urlpath;
+} test_vlmeta_lazy_backend;
+
+
+CUTEST_TEST_DATA(vlmeta_lazy) {
+  blosc2_cparams cparams;
+  uint8_t big_content[BIG_VLMETA_LEN];
+};
+
+
+CUTEST_TEST_SETUP(vlmeta_lazy) {
+  blosc2_init();
+  data->cparams = BLOSC2_CPARAMS_DEFAULTS;
+  data->cparams.typesize = sizeof(int32_t);
+
+  // Make the big vlmetalayer hard to compress so that it does not fit in the prefetched trailer
+  uint32_t seed = 1234567;
+  for (int i = 0; i < BIG_VLMETA_LEN; i++) {
+    seed = seed * 1103515245 + 12345;
+    data->big_content[i] = (uint8_t) (seed >> 16);
+  }
+
+  CUTEST_PARAMETRIZE(backend, test_vlmeta_lazy_backend, CUTEST_DATA(
+      {true, "test_vlmeta_lazy.b2frame"}, // disk - cframe
+      {false, "test_vlmeta_lazy_s.b2frame"}, // disk - sframe
+  ));
+}
+
+
+CUTEST_TEST_TEST(vlmeta_lazy) {
+  CUTEST_GET_PARAMETER(backend, test_vlmeta_lazy_backend);
+
+  blosc2_remove_urlpath(backend.urlpath);
+
+  int32_t isize = CHUNKSIZE * sizeof(int32_t);
+  int32_t *data_buffer = malloc(isize);
+  for (int i = 0; i < CHUNKSIZE; i++) {
+    data_buffer[i] = i;
+  }
+
+  blosc2_storage storage = {.cparams=&data->cparams, .contiguous=backend.contiguous,
+                            .urlpath=backend.urlpath};
+  blosc2_schunk *schunk = blosc2_schunk_new(&storage);
+  CUTEST_ASSERT("Error creating a schunk", schunk != NULL);
+  CUTEST_ASSERT("Error appending chunk", blosc2_schunk_append_buffer(schunk, data_buffer, isize) == 1);
+
+  int64_t small_content = -66;
+  blosc2_vlmeta_add(schunk, "small", (uint8_t *) &small_content, sizeof(small_content), NULL);
+  blosc2_vlmeta_add(schunk, "big", data->big_content, BIG_VLMETA_LEN, NULL);
+  blosc2_vlmeta_add(schunk, "after_big", (uint8_t *) &small_content, sizeof(small_content), NULL);
+  blosc2_schunk_free(schunk);
+
+  /* Only the contents close to the index are read when opening */
+  schunk = blosc2_schunk_open(backend.urlpath);
+  CUTEST_ASSERT("Error opening the schunk", schunk != NULL);
+  CUTEST_ASSERT("Wrong number of vlmetalayers", schunk->nvlmetalayers == 3);
+  CUTEST_ASSERT("Small vlmetalayer should be read", schunk->vlmetalayers[0]->content != NULL);
+  CUTEST_ASSERT("Big vlmetalayer should not be read", schunk->vlmetalayers[1]->content == NULL);
+  CUTEST_ASSERT("Last vlmetalayer should not be read", schunk->vlmetalayers[2]->content == NULL);
+
+  uint8_t *content;
+  int32_t content_len;
+  CUTEST_ASSERT("Cannot get the vlmetalayer",
+                blosc2_vlmeta_get(schunk, "after_big", &content, &content_len) >= 0);
+  CUTEST_ASSERT("Vlmetalayer content differs",
+                content_len == sizeof(small_content) &&
+                memcmp(content, &small_content, sizeof(small_content)) == 0);
+  free(content);
+  CUTEST_ASSERT("Big vlmetalayer should not be read", schunk->vlmetalayers[1]->content == NULL);
+
+  /* Modifying the frame rewrites the trailer, so the pending contents must be preserved */
+  CUTEST_ASSERT("Error appending chunk", blosc2_schunk_append_buffer(schunk, data_buffer, isize) == 2);
+  blosc2_vlmeta_update(schunk, "small", (uint8_t *) &small_content, sizeof(small_content), NULL);
+  blosc2_schunk_free(schunk);
+
+  schunk = blosc2_schunk_open(backend.urlpath);
+  CUTEST_ASSERT("Error opening the schunk", schunk != NULL);
+  CUTEST_ASSERT("Wrong number of chunks", schunk->nchunks == 2);
+  CUTEST_ASSERT("Cannot get the vlmetalayer",
+                blosc2_vlmeta_get(schunk, "big", &content, &content_len) >= 0);
+  CUTEST_ASSERT("Big vlmetalayer content differs",
+                content_len == BIG_VLMETA_LEN &&
+                memcmp(content, data->big_content, BIG_VLMETA_LEN) == 0);
+  free(content);
+  CUTEST_ASSERT("Cannot get the vlmetalayer",
+                blosc2_vlmeta_get(schunk, "after_big", &content, &content_len) >= 0);
+  CUTEST_ASSERT("Vlmetalayer content differs",
+                memcmp(content, &small_content, sizeof(small_content)) == 0);
+  free(content);
+
+  /* Deleting shifts the vlmetalayers, which must all be read beforehand */
+  blosc2_schunk_free(schunk);
+  schunk = blosc2_schunk_open(backend.urlpath);
+  CUTEST_ASSERT("Error deleting the vlmetalayer", blosc2_vlmeta_delete(schunk, "big") == 2);
+  CUTEST_ASSERT("Cannot get the vlmetalayer",
+                blosc2_vlmeta_get(schunk, "after_big", &content, &content_len) >= 0);
+  CUTEST_ASSERT("Vlmetalayer content differs",
+                memcmp(content, &small_content, sizeof(small_content)) == 0);
+  free(content);
+
+  /* Free resources */
+  free(data_buffer);
+  blosc2_schunk_free(schunk);
+  blosc2_remove_urlpath(backend.urlpath);
+
+  return 0;
+}
+
+
+CUTEST_TEST_TEARDOWN(vlmeta_lazy) {
+  BLOSC_UNUSED_PARAM(data);
+  blosc2_destroy();
+}
+
+
+int main() {
+  CUTEST_TEST_RUN(vlmeta_lazy);
+}